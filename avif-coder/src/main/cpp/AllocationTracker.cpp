@@ -0,0 +1,143 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "AllocationTracker.h"
+#include <sstream>
+#include <stdexcept>
+
+namespace {
+constexpr uint32_t kNoStage = static_cast<uint32_t>(coder::DecodeStage::Count);
+
+thread_local coder::DecodeAllocationScope *gActiveScope = nullptr;
+thread_local uint32_t gActiveStage = kNoStage;
+
+const char *stageName(uint32_t stage) {
+  static const char *names[] = {"sniff", "parse", "decode", "yuv", "rescale", "color",
+                                "reformat", "copy"};
+  return stage < kNoStage ? names[stage] : "unstaged";
+}
+}
+
+namespace coder {
+
+DecodeAllocationScope::DecodeAllocationScope() {
+#if AVIF_CODER_TRACK_ALLOCATIONS
+  parent = gActiveScope;
+  gActiveScope = this;
+#endif
+}
+
+DecodeAllocationScope::~DecodeAllocationScope() {
+#if AVIF_CODER_TRACK_ALLOCATIONS
+  if (gActiveScope == this) {
+    gActiveScope = parent;
+  }
+#endif
+}
+
+bool DecodeAllocationScope::peakWithinFullFrames(double frames) const noexcept {
+  if (stats.fullFrameBytes == 0) {
+    return stats.peakBytes == 0;
+  }
+  return static_cast<double>(stats.peakBytes)
+      <= frames * static_cast<double>(stats.fullFrameBytes);
+}
+
+void DecodeAllocationScope::expectPeakWithinFullFrames(double frames) const {
+  if (peakWithinFullFrames(frames)) {
+    return;
+  }
+  std::ostringstream stream;
+  stream << "Decode peak " << stats.peakBytes << " bytes exceeds " << frames
+         << " full frames of " << stats.fullFrameBytes << " bytes; allocations="
+         << stats.allocations << ", full frame allocations=" << stats.fullFrameAllocations;
+  for (uint32_t i = 0; i <= kNoStage; ++i) {
+    const AllocationStageStats &stage = i < kNoStage ? stats.stages[i] : stats.unstaged;
+    if (stage.allocations) {
+      stream << ", " << stageName(i) << "={" << stage.allocations << " allocations, "
+             << stage.bytes << " bytes, peak " << stage.peakBytes << '}';
+    }
+  }
+  throw std::runtime_error(stream.str());
+}
+
+#if AVIF_CODER_TRACK_ALLOCATIONS
+void TrackAlignedAllocation(size_t bytes) noexcept {
+  DecodeAllocationScope *scope = gActiveScope;
+  if (!scope) {
+    return;
+  }
+  AllocationReport &report = scope->stats;
+  report.currentBytes += static_cast<int64_t>(bytes);
+  report.totalBytes += bytes;
+  report.allocations += 1;
+  if (report.fullFrameBytes != 0 && bytes >= report.fullFrameBytes) {
+    report.fullFrameAllocations += 1;
+  }
+  const uint64_t live = report.currentBytes > 0 ? static_cast<uint64_t>(report.currentBytes) : 0;
+  if (live > report.peakBytes) {
+    report.peakBytes = live;
+  }
+  AllocationStageStats &stage = gActiveStage < kNoStage ? report.stages[gActiveStage]
+                                                        : report.unstaged;
+  stage.allocations += 1;
+  stage.bytes += bytes;
+  if (live > stage.peakBytes) {
+    stage.peakBytes = live;
+  }
+}
+
+void TrackAlignedDeallocation(size_t bytes) noexcept {
+  DecodeAllocationScope *scope = gActiveScope;
+  if (!scope) {
+    return;
+  }
+  // Buffers allocated before the scope began may be released inside it,
+  // so current bytes are allowed to go negative
+  scope->stats.currentBytes -= static_cast<int64_t>(bytes);
+}
+
+void SetTrackedFullFrameBytes(uint64_t bytes) noexcept {
+  DecodeAllocationScope *scope = gActiveScope;
+  if (scope && scope->stats.fullFrameBytes == 0) {
+    scope->stats.fullFrameBytes = bytes;
+  }
+}
+
+uint32_t EnterTrackedStage(DecodeStage stage) noexcept {
+  const uint32_t previous = gActiveStage;
+  gActiveStage = static_cast<uint32_t>(stage);
+  return previous;
+}
+
+void LeaveTrackedStage(uint32_t previous) noexcept {
+  gActiveStage = previous;
+}
+#endif
+
+}
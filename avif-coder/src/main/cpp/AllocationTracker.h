@@ -0,0 +1,115 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_ALLOCATIONTRACKER_H_
+#define AVIF_CODER_SRC_MAIN_CPP_ALLOCATIONTRACKER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include "DecodeStats.h"
+
+// Build with -DAVIF_CODER_TRACK_ALLOCATIONS=1 (CMake option CODER_TRACK_ALLOCATIONS)
+// to account every aligned_allocator allocation. When off, hooks compile to nothing.
+#ifndef AVIF_CODER_TRACK_ALLOCATIONS
+#define AVIF_CODER_TRACK_ALLOCATIONS 0
+#endif
+
+namespace coder {
+
+struct AllocationStageStats {
+  uint64_t allocations;
+  uint64_t bytes;
+  // Largest amount of live tracked memory observed while the stage was active
+  uint64_t peakBytes;
+};
+
+struct AllocationReport {
+  // Live bytes allocated inside the scope and not yet released
+  int64_t currentBytes;
+  uint64_t peakBytes;
+  uint64_t totalBytes;
+  uint64_t allocations;
+  // RGBA image at source size, 0 until the decoder has parsed the header
+  uint64_t fullFrameBytes;
+  // Allocations of at least fullFrameBytes
+  uint64_t fullFrameAllocations;
+  AllocationStageStats stages[static_cast<uint32_t>(DecodeStage::Count)];
+  // Allocations made outside of any ScopedDecodeStage
+  AllocationStageStats unstaged;
+};
+
+/**
+ * Collects aligned_allocator traffic of the current thread for one decode.
+ * Scopes nest, the innermost one receives the accounting. Memory released on
+ * another thread or after the scope ended is not seen.
+ * Without AVIF_CODER_TRACK_ALLOCATIONS the report stays zeroed.
+ */
+class DecodeAllocationScope {
+ public:
+  DecodeAllocationScope();
+  DecodeAllocationScope(const DecodeAllocationScope &) = delete;
+  DecodeAllocationScope &operator=(const DecodeAllocationScope &) = delete;
+  ~DecodeAllocationScope();
+
+  [[nodiscard]] const AllocationReport &report() const noexcept { return stats; }
+
+  // True when peak memory of the decode stays within frames full RGBA frames
+  [[nodiscard]] bool peakWithinFullFrames(double frames) const noexcept;
+
+  // Throws std::runtime_error describing the report when the peak exceeds frames full frames
+  void expectPeakWithinFullFrames(double frames) const;
+
+ private:
+  friend void TrackAlignedAllocation(size_t bytes) noexcept;
+  friend void TrackAlignedDeallocation(size_t bytes) noexcept;
+  friend void SetTrackedFullFrameBytes(uint64_t bytes) noexcept;
+  friend uint32_t EnterTrackedStage(DecodeStage stage) noexcept;
+
+  AllocationReport stats = {};
+  DecodeAllocationScope *parent = nullptr;
+};
+
+#if AVIF_CODER_TRACK_ALLOCATIONS
+void TrackAlignedAllocation(size_t bytes) noexcept;
+void TrackAlignedDeallocation(size_t bytes) noexcept;
+// Sets the full frame size of the active scope, first call wins
+void SetTrackedFullFrameBytes(uint64_t bytes) noexcept;
+// Returns the previously active stage to be restored with LeaveTrackedStage
+uint32_t EnterTrackedStage(DecodeStage stage) noexcept;
+void LeaveTrackedStage(uint32_t previous) noexcept;
+#else
+inline void TrackAlignedAllocation(size_t) noexcept {}
+inline void TrackAlignedDeallocation(size_t) noexcept {}
+inline void SetTrackedFullFrameBytes(uint64_t) noexcept {}
+inline uint32_t EnterTrackedStage(DecodeStage) noexcept { return 0; }
+inline void LeaveTrackedStage(uint32_t) noexcept {}
+#endif
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_ALLOCATIONTRACKER_H_
@@ -0,0 +1,157 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "AnimationPlayer.h"
+#include <algorithm>
+#include <utility>
+#include "PixelReformat.h"
+
+namespace coder {
+
+AnimationPlayer::AnimationPlayer(std::unique_ptr<AvifDecoderController> source,
+                                 const PlaybackOptions &options)
+    : source(std::move(source)), options(options),
+      ring(std::max(options.bufferedFrames, 1u) + 1) {
+  const uint32_t framesCount = this->source->getFramesCount();
+  presentationMs.reserve(framesCount);
+  durationsMs.reserve(framesCount);
+  for (uint32_t i = 0; i < framesCount; ++i) {
+    // Zero durations would stack frames on one timestamp and stall the timeline
+    const uint64_t duration = std::max(this->source->getFrameDuration(i), 1u);
+    presentationMs.push_back(totalDurationMs);
+    durationsMs.push_back(duration);
+    totalDurationMs += duration;
+  }
+  // Repetition count excludes the first play, negative values loop forever
+  const auto repetitions = static_cast<int32_t>(this->source->getLoopsCount());
+  playCount = repetitions < 0 ? 0 : static_cast<uint64_t>(repetitions) + 1;
+}
+
+AnimationPlayer::~AnimationPlayer() {
+  stop();
+}
+
+void AnimationPlayer::start() {
+  if (started) {
+    throw std::runtime_error("Playback can be started only once");
+  }
+  started = true;
+  producer = std::thread(&AnimationPlayer::decodeLoop, this);
+}
+
+void AnimationPlayer::stop() {
+  stopped.store(true, std::memory_order_release);
+  consumerEpoch.fetch_add(1, std::memory_order_release);
+  consumerEpoch.notify_all();
+  if (producer.joinable()) {
+    producer.join();
+  }
+}
+
+const std::string *AnimationPlayer::failure() const {
+  return failed.load(std::memory_order_acquire) ? &failureMessage : nullptr;
+}
+
+void AnimationPlayer::decodeLoop() {
+  try {
+    uint64_t sequence = 0;
+    const auto framesCount = static_cast<uint32_t>(presentationMs.size());
+    for (uint64_t loop = 0; playCount == 0 || loop < playCount; ++loop) {
+      for (uint32_t i = 0; i < framesCount; ++i) {
+        if (stopped.load(std::memory_order_acquire)) {
+          return;
+        }
+        AvifImageFrame frame = source->getFrame(i, options.scaledWidth, options.scaledHeight,
+                                                options.colorConfig, options.scaleMode,
+                                                options.scalingQuality);
+        bool useFloats = frame.is16Bit && options.allowFloatPixels;
+        uint32_t stride = frame.width * 4 * (frame.is16Bit ? sizeof(uint16_t) : sizeof(uint8_t));
+        const PixelFormat format = ReformatPixels(frame.store, options.colorConfig,
+                                                  frame.bitDepth, frame.width, frame.height,
+                                                  &stride, &useFloats, false, frame.hasAlpha);
+        frame.admission.release();
+
+        // Only the producer waits, the render thread wakes it after releasing a slot
+        PlaybackFrame *slot = ring.beginWrite();
+        while (!slot) {
+          const uint32_t epoch = consumerEpoch.load(std::memory_order_acquire);
+          if (stopped.load(std::memory_order_acquire)) {
+            return;
+          }
+          slot = ring.beginWrite();
+          if (!slot) {
+            consumerEpoch.wait(epoch, std::memory_order_acquire);
+            slot = ring.beginWrite();
+          }
+        }
+
+        std::swap(slot->pixels, frame.store);
+        slot->stride = stride;
+        slot->width = frame.width;
+        slot->height = frame.height;
+        slot->format = format;
+        slot->frameIndex = i;
+        slot->presentationMs = loop * totalDurationMs + presentationMs[i];
+        slot->durationMs = durationsMs[i];
+        slot->sequence = ++sequence;
+        ring.commitWrite();
+        // Previous buffer of the slot goes back to the decoder for the next frames
+        source->recycleFrame(std::move(frame));
+      }
+    }
+  } catch (std::exception &err) {
+    failureMessage = err.what();
+    failed.store(true, std::memory_order_release);
+  }
+}
+
+const PlaybackFrame *AnimationPlayer::peekFrame(uint64_t timestampMs) {
+  PlaybackFrame *current = ring.peek();
+  if (!current) {
+    return nullptr;
+  }
+  // The presented frame stays in the ring until a newer one is due,
+  // frames whose turn passed while the render thread was away are skipped
+  PlaybackFrame *following;
+  while ((following = ring.peek(1)) && following->presentationMs <= timestampMs) {
+    ring.pop();
+    consumerEpoch.fetch_add(1, std::memory_order_release);
+    consumerEpoch.notify_one();
+    current = following;
+  }
+  if (current->presentationMs > timestampMs || current->sequence == lastPresented) {
+    return nullptr;
+  }
+  return current;
+}
+
+void AnimationPlayer::markPresented(const PlaybackFrame &frame) {
+  lastPresented = frame.sequence;
+}
+
+}
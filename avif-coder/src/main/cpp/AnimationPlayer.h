@@ -0,0 +1,126 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_ANIMATIONPLAYER_H_
+#define AVIF_CODER_SRC_MAIN_CPP_ANIMATIONPLAYER_H_
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AvifDecoderController.h"
+#include "ColorConfig.h"
+#include "FrameRing.h"
+#include "definitions.h"
+
+namespace coder {
+
+struct PlaybackOptions {
+  int32_t scaledWidth = 0;
+  int32_t scaledHeight = 0;
+  PreferredColorConfig colorConfig = Default;
+  ScaleMode scaleMode = Fit;
+  int scalingQuality = 0;
+  // Decoded frames kept ahead of the render thread
+  uint32_t bufferedFrames = 3;
+  // High bit depth frames may be reformatted to F16, Android bitmaps have it since API 26
+  bool allowFloatPixels = true;
+};
+
+// Frame ready for presentation, pixels are already in the output config
+struct PlaybackFrame {
+  aligned_uint8_vector pixels;
+  uint32_t stride = 0;
+  uint32_t width = 0;
+  uint32_t height = 0;
+  PixelFormat format = PixelFormat::Rgba8888;
+  uint32_t frameIndex = 0;
+  // Milliseconds since playback start, loops included
+  uint64_t presentationMs = 0;
+  uint64_t durationMs = 0;
+  uint64_t sequence = 0;
+};
+
+/**
+ * Decodes an animation on its own thread into a lock-free ring, ahead of the
+ * timeline given by frame durations. The render thread asks for the frame due
+ * at its own clock and never waits for decoding: when the decoder falls behind
+ * the last presented frame simply stays on screen.
+ */
+class AnimationPlayer {
+ public:
+  AnimationPlayer(std::unique_ptr<AvifDecoderController> source, const PlaybackOptions &options);
+  AnimationPlayer(const AnimationPlayer &) = delete;
+  AnimationPlayer &operator=(const AnimationPlayer &) = delete;
+  ~AnimationPlayer();
+
+  void start();
+  void stop();
+
+  /**
+   * Render thread only. Returns the frame due at timestampMs when it differs from
+   * the last presented one, nullptr otherwise. The frame stays valid until the
+   * next call. Frames that expired while a newer one is ready are skipped.
+   */
+  const PlaybackFrame *peekFrame(uint64_t timestampMs);
+
+  // Render thread only. Marks frame from peekFrame as shown, so it isn't returned again
+  void markPresented(const PlaybackFrame &frame);
+
+  [[nodiscard]] uint64_t loopDurationMs() const { return totalDurationMs; }
+
+  // Error that stopped the decode thread, nullptr while it is healthy
+  [[nodiscard]] const std::string *failure() const;
+
+ private:
+  void decodeLoop();
+
+  std::unique_ptr<AvifDecoderController> source;
+  PlaybackOptions options;
+  std::vector<uint64_t> presentationMs;
+  std::vector<uint64_t> durationsMs;
+  uint64_t totalDurationMs = 0;
+  // Number of times the animation is played, 0 loops forever
+  uint64_t playCount = 0;
+
+  SpscRing<PlaybackFrame> ring;
+  // Bumped by the consumer on every release and by stop(), the producer sleeps on it
+  std::atomic<uint32_t> consumerEpoch{0};
+  std::atomic<bool> stopped{false};
+  std::atomic<bool> failed{false};
+  std::string failureMessage;
+  bool started = false;
+  std::thread producer;
+  uint64_t lastPresented = 0;
+};
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_ANIMATIONPLAYER_H_
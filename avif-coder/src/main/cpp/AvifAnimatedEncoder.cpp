@@ -0,0 +1,241 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "AvifAnimatedEncoder.h"
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace {
+// Converted frames waiting for the encoder thread, next to the one being encoded
+constexpr size_t kMaxQueuedFrames = 2;
+
+avifPixelFormat toAvifPixelFormat(int32_t chromaSubsampling) {
+  switch (chromaSubsampling) {
+    case 2:return AVIF_PIXEL_FORMAT_YUV422;
+    case 3:
+    case 5:return AVIF_PIXEL_FORMAT_YUV444;
+    case 4:return AVIF_PIXEL_FORMAT_YUV400;
+    default:return AVIF_PIXEL_FORMAT_YUV420;
+  }
+}
+
+int toAvifSpeed(coder::EncodeSpeed speed) {
+  switch (speed) {
+    case coder::EncodeSpeed::Slow:return 2;
+    case coder::EncodeSpeed::Fast:return 9;
+    default:return 6;
+  }
+}
+
+std::string encoderError(const char *stage, avifResult result, const avifEncoder *encoder) {
+  std::string message = std::string(stage) + ": " + avifResultToString(result);
+  if (encoder && encoder->diag.error[0] != '\0') {
+    message += ", ";
+    message += encoder->diag.error;
+  }
+  return message;
+}
+
+}
+
+namespace coder {
+
+AvifAnimatedEncoder::AvifAnimatedEncoder(const AnimatedEncodeOptions &options) : options(options) {
+  if (options.width == 0 || options.height == 0) {
+    throw std::runtime_error("Animation size must be positive");
+  }
+  encoder = avif::EncoderPtr(avifEncoderCreate());
+  if (!encoder) {
+    throw std::runtime_error("Can't create encoder");
+  }
+  const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+  encoder->codecChoice = AVIF_CODEC_CHOICE_MAROONTREE;
+  encoder->maxThreads = static_cast<int>(options.threads == 0 ? cores : options.threads);
+  encoder->speed = toAvifSpeed(options.speed);
+  encoder->quality = std::clamp(options.quality, 0, 100);
+  encoder->qualityAlpha = encoder->quality;
+  encoder->timescale = 1000;
+  encoder->repetitionCount = options.repetitionCount < 0 ? AVIF_REPETITION_COUNT_INFINITE
+                                                         : options.repetitionCount;
+  worker = std::thread([this] { run(); });
+}
+
+AvifAnimatedEncoder::~AvifAnimatedEncoder() {
+  stopWorker();
+}
+
+void AvifAnimatedEncoder::addFrame(const ImageView &image, uint32_t durationMs) {
+  if (finished) {
+    throw std::runtime_error("Animation is already finished");
+  }
+  if (image.format != PixelFormat::Rgba8888) {
+    throw std::runtime_error("Animation frames must be RGBA 8888");
+  }
+  if (image.width != options.width || image.height != options.height) {
+    throw std::runtime_error("Animation frame size doesn't match the animation");
+  }
+  rethrowFailure();
+
+  avif::ImagePtr converted = acquireImage();
+  avifRGBImage rgb;
+  avifRGBImageSetDefaults(&rgb, converted.get());
+  rgb.format = AVIF_RGB_FORMAT_RGBA;
+  rgb.depth = 8;
+  rgb.pixels = const_cast<uint8_t *>(image.pixels);
+  rgb.rowBytes = image.stride;
+  rgb.alphaPremultiplied = image.premultiplied ? AVIF_TRUE : AVIF_FALSE;
+  avifResult result = avifImageRGBToYUV(converted.get(), &rgb);
+  if (result != AVIF_RESULT_OK) {
+    throw std::runtime_error(encoderError("RGB to YUV conversion has failed", result, nullptr));
+  }
+  enqueue(QueuedFrame{.image = std::move(converted), .durationMs = durationMs});
+  ++addedFrames;
+}
+
+void AvifAnimatedEncoder::finish(const EncodedChunkSink &sink) {
+  if (finished) {
+    throw std::runtime_error("Animation is already finished");
+  }
+  if (addedFrames == 0) {
+    throw std::runtime_error("Animation has no frames");
+  }
+  finished = true;
+  {
+    std::lock_guard guard(mutex);
+    draining = true;
+  }
+  changed.notify_all();
+  worker.join();
+  rethrowFailure();
+
+  avifRWData output = AVIF_DATA_EMPTY;
+  avifResult result = avifEncoderFinish(encoder.get(), &output);
+  if (result != AVIF_RESULT_OK) {
+    avifRWDataFree(&output);
+    throw std::runtime_error(encoderError("Animation encoding has failed", result, encoder.get()));
+  }
+  try {
+    sink(output.data, output.size);
+  } catch (...) {
+    avifRWDataFree(&output);
+    throw;
+  }
+  avifRWDataFree(&output);
+}
+
+avif::ImagePtr AvifAnimatedEncoder::acquireImage() {
+  {
+    std::lock_guard guard(mutex);
+    if (!spareImages.empty()) {
+      avif::ImagePtr image = std::move(spareImages.back());
+      spareImages.pop_back();
+      return image;
+    }
+  }
+  avif::ImagePtr image(avifImageCreate(options.width, options.height, 8,
+                                       toAvifPixelFormat(options.chromaSubsampling)));
+  if (!image) {
+    throw std::bad_alloc();
+  }
+  image->colorPrimaries = AVIF_COLOR_PRIMARIES_BT709;
+  image->transferCharacteristics = AVIF_TRANSFER_CHARACTERISTICS_SRGB;
+  image->matrixCoefficients = AVIF_MATRIX_COEFFICIENTS_BT601;
+  image->yuvRange = AVIF_RANGE_FULL;
+  const avifResult result = avifImageAllocatePlanes(image.get(),
+                                                    options.keepAlpha ? AVIF_PLANES_ALL
+                                                                      : AVIF_PLANES_YUV);
+  if (result != AVIF_RESULT_OK) {
+    throw std::runtime_error(encoderError("Can't allocate animation frame", result, nullptr));
+  }
+  return image;
+}
+
+void AvifAnimatedEncoder::enqueue(QueuedFrame &&frame) {
+  std::unique_lock lock(mutex);
+  changed.wait(lock, [this] { return queue.size() < kMaxQueuedFrames || failure; });
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+  queue.push_back(std::move(frame));
+  lock.unlock();
+  changed.notify_all();
+}
+
+void AvifAnimatedEncoder::run() {
+  while (true) {
+    QueuedFrame frame;
+    {
+      std::unique_lock lock(mutex);
+      changed.wait(lock, [this] { return !queue.empty() || draining || stopped; });
+      if (stopped || queue.empty()) {
+        return;
+      }
+      frame = std::move(queue.front());
+      queue.pop_front();
+    }
+    changed.notify_all();
+
+    const avifResult result = avifEncoderAddImage(encoder.get(), frame.image.get(),
+                                                  std::max<uint64_t>(1, frame.durationMs),
+                                                  AVIF_ADD_IMAGE_FLAG_NONE);
+    {
+      std::lock_guard guard(mutex);
+      if (result != AVIF_RESULT_OK) {
+        failure = std::make_exception_ptr(std::runtime_error(
+            encoderError("Animation frame encoding has failed", result, encoder.get())));
+      } else {
+        spareImages.push_back(std::move(frame.image));
+      }
+    }
+    changed.notify_all();
+    if (result != AVIF_RESULT_OK) {
+      return;
+    }
+  }
+}
+
+void AvifAnimatedEncoder::stopWorker() {
+  {
+    std::lock_guard guard(mutex);
+    stopped = true;
+  }
+  changed.notify_all();
+  if (worker.joinable()) {
+    worker.join();
+  }
+}
+
+void AvifAnimatedEncoder::rethrowFailure() {
+  std::lock_guard guard(mutex);
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+}
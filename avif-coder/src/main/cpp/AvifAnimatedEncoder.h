@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_AVIFANIMATEDENCODER_H_
+#define AVIF_CODER_SRC_MAIN_CPP_AVIFANIMATEDENCODER_H_
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "avif/avif_cxx.h"
+#include "CoderCore.h"
+
+namespace coder {
+
+struct AnimatedEncodeOptions {
+  uint32_t width = 0;
+  uint32_t height = 0;
+  int32_t quality = 80;
+  // AvifChromaSubsampling value, 0 chooses 4:2:0
+  int32_t chromaSubsampling = 0;
+  EncodeSpeed speed = EncodeSpeed::Medium;
+  // Encoder threads, 0 uses every core
+  uint32_t threads = 0;
+  // Extra plays after the first one, -1 loops forever
+  int32_t repetitionCount = -1;
+  // Without alpha the frames are encoded as opaque
+  bool keepAlpha = true;
+};
+
+using EncodedChunkSink = std::function<void(const uint8_t *data, size_t size)>;
+
+/**
+ * Encodes an AVIF image sequence frame by frame. addFrame converts RGBA to YUV
+ * on the calling thread and hands the planes to an encoder thread, at most a few
+ * raw frames are alive at once and only compressed samples are retained.
+ * maroontree codes every frame as a keyframe, so each sample is a sync sample.
+ * Not thread safe, throws std::runtime_error on failure.
+ */
+class AvifAnimatedEncoder {
+ public:
+  explicit AvifAnimatedEncoder(const AnimatedEncodeOptions &options);
+  AvifAnimatedEncoder(const AvifAnimatedEncoder &) = delete;
+  AvifAnimatedEncoder &operator=(const AvifAnimatedEncoder &) = delete;
+  ~AvifAnimatedEncoder();
+
+  // Only Rgba8888 frames of the configured size are accepted
+  void addFrame(const ImageView &image, uint32_t durationMs);
+  /**
+   * Encodes the remaining frames and writes the file to the sink. The sequence
+   * header needs every sample size, so the container is produced here.
+   */
+  void finish(const EncodedChunkSink &sink);
+  // Frames passed to addFrame so far
+  [[nodiscard]] uint32_t framesCount() const { return addedFrames; }
+
+ private:
+  struct QueuedFrame {
+    avif::ImagePtr image;
+    uint64_t durationMs;
+  };
+
+  avif::ImagePtr acquireImage();
+  void enqueue(QueuedFrame &&frame);
+  void run();
+  void stopWorker();
+  void rethrowFailure();
+
+  AnimatedEncodeOptions options;
+  avif::EncoderPtr encoder;
+  uint32_t addedFrames = 0;
+  bool finished = false;
+
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::deque<QueuedFrame> queue;
+  // Images the worker is done with, reused by the next conversions
+  std::vector<avif::ImagePtr> spareImages;
+  bool draining = false;
+  bool stopped = false;
+  std::exception_ptr failure;
+  std::thread worker;
+};
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_AVIFANIMATEDENCODER_H_
@@ -28,33 +28,94 @@
 
 #include "AvifDecoderController.h"
 #include "avif/avif.h"
+#include <algorithm>
+#include <condition_variable>
+#include <cstring>
 #include <exception>
+#include <map>
 #include <thread>
 #include "imagebits/CopyUnalignedRGBA.h"
 #include "colorspace.h"
 #include "Eigen/Eigen"
 #include "ColorSpaceProfile.h"
 #include "avifweaver.h"
-#include <android/log.h>
+#include "DecodeAdmission.h"
+#include "DecodeStats.h"
+#include "AllocationTracker.h"
+
+namespace {
+uint64_t imagePlanesBytes(const avifImage *image) {
+  uint64_t total = 0;
+  const uint32_t planesCount = image->yuvFormat == AVIF_PIXEL_FORMAT_YUV400 ? 1 : 3;
+  for (uint32_t i = 0; i < planesCount; ++i) {
+    if (image->yuvPlanes[i]) {
+      uint64_t planeHeight = image->height;
+      if (i > 0 && image->yuvFormat == AVIF_PIXEL_FORMAT_YUV420) {
+        planeHeight = (planeHeight + 1) / 2;
+      }
+      total += static_cast<uint64_t>(image->yuvRowBytes[i]) * planeHeight;
+    }
+  }
+  if (image->alphaPlane) {
+    total += static_cast<uint64_t>(image->alphaRowBytes) * image->height;
+  }
+  return total;
+}
+
+avifResult configureAndParse(avifDecoder *decoder,
+                             const aligned_uint8_vector &buffer,
+                             uint32_t frameDelay) {
+  auto result = avifDecoderSetIOMemory(decoder, buffer.data(), buffer.size());
+  if (result != AVIF_RESULT_OK) {
+    return result;
+  }
+  decoder->ignoreExif = false;
+  decoder->ignoreXMP = false;
+  decoder->strictFlags = AVIF_STRICT_DISABLED;
+
+  uint32_t hwThreads = std::thread::hardware_concurrency();
+  decoder->maxThreads = static_cast<int>(hwThreads);
+  decoder->maxFrameDelay = frameDelay;
+  return avifDecoderParse(decoder);
+}
+
+// Mirrors avifDecoderNthImage: continue from the current position while no
+// keyframe lies in between, otherwise restart from the keyframe
+uint32_t decodeCost(const avifDecoder *decoder, uint32_t frame, uint32_t keyframe) {
+  const int64_t position = decoder->imageIndex;
+  const auto requested = static_cast<int64_t>(frame);
+  if (requested == position) {
+    return 0;
+  }
+  if (requested > position && static_cast<int64_t>(keyframe) <= position + 1) {
+    return static_cast<uint32_t>(requested - position);
+  }
+  return frame - keyframe + 1;
+}
+}
 
 class AvifUniqueImage {
  public:
   avifRGBImage rgbImage;
 
-  AvifUniqueImage(avifDecoder *decoder) {
+  AvifUniqueImage(const avifImage *image, coder::FrameBufferPool *pool = nullptr) : pool(pool) {
     rgbImage = {0};
-    avifRGBImageSetDefaults(&rgbImage, decoder->image);
+    avifRGBImageSetDefaults(&rgbImage, image);
     rgbImage.format = AVIF_RGB_FORMAT_RGBA;
   }
 
   ~AvifUniqueImage() {
-    if (isPlanesAllocated) {
-      avifRGBImageFreePixels(&rgbImage);
-      isPlanesAllocated = false;
-    }
+    clear();
   }
 
   avifResult allocateImage() {
+    if (pool) {
+      // Same layout avifRGBImageAllocatePixels produces, backed by a recycled buffer
+      rgbImage.rowBytes = rgbImage.width * avifRGBImagePixelSize(&rgbImage);
+      pooledPixels = pool->acquire(static_cast<size_t>(rgbImage.rowBytes) * rgbImage.height);
+      rgbImage.pixels = pooledPixels.data();
+      return AVIF_RESULT_OK;
+    }
     auto result = avifRGBImageAllocatePixels(&rgbImage);
     if (result == AVIF_RESULT_OK) {
       this->isPlanesAllocated = true;
@@ -67,9 +128,16 @@ class AvifUniqueImage {
       avifRGBImageFreePixels(&rgbImage);
       isPlanesAllocated = false;
     }
+    if (pool && !pooledPixels.empty()) {
+      rgbImage.pixels = nullptr;
+      pool->recycle(std::move(pooledPixels));
+      pooledPixels = aligned_uint8_vector();
+    }
   }
 
  private:
+  coder::FrameBufferPool *pool;
+  aligned_uint8_vector pooledPixels;
   bool isPlanesAllocated = false;
 };
 
@@ -78,34 +146,273 @@ AvifImageFrame AvifDecoderController::getFrame(uint32_t frame,
                                                int32_t scaledHeight,
                                                PreferredColorConfig javaColorSpace,
                                                ScaleMode javaScaleMode,
-                                               int scalingQuality) {
-  std::lock_guard guard(this->mutex);
+                                               int scalingQuality,
+                                               coder::DecodeStats *stats,
+                                               std::vector<coder::DirtyRect> *dirtyRects) {
+  std::unique_lock lock(this->mutex);
   if (!this->isBufferAttached) {
     throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
   }
 
-  if (frame >= this->decoder->imageCount) {
+  if (frame >= metadataSnapshot().framesCount) {
     std::string str = "Can't time of frame number: " + std::to_string(frame);
     throw std::runtime_error(str);
   }
 
-  avifResult nextImageResult = avifDecoderNthImage(this->decoder.get(), frame);
+  // The main decoder keeps seek snapshots and sequential playback state, other
+  // calls decode concurrently on spare instances when the limit allows
+  this->decoderReturned.wait(lock, [this] {
+    return !this->decoderBusy || this->sparesInUse + 1 < this->maxDecoders;
+  });
+  avif::DecoderPtr spare;
+  avifDecoder *frameDecoder;
+  const int decoderThreads = decoderThreadsLocked();
+  const bool onMainDecoder = !this->decoderBusy;
+  if (onMainDecoder) {
+    selectDecoderForFrame(frame);
+    this->decoderBusy = true;
+    frameDecoder = this->decoder.get();
+  } else {
+    ++this->sparesInUse;
+    if (!this->spareDecoders.empty()) {
+      // The one closest to frame keeps the decode short
+      const uint32_t keyframe = nearestKeyframeLocked(frame);
+      auto closest = std::min_element(this->spareDecoders.begin(), this->spareDecoders.end(),
+                                      [&](const avif::DecoderPtr &a, const avif::DecoderPtr &b) {
+                                        return decodeCost(a.get(), frame, keyframe)
+                                            < decodeCost(b.get(), frame, keyframe);
+                                      });
+      spare = std::move(*closest);
+      this->spareDecoders.erase(closest);
+    }
+    frameDecoder = spare.get();
+  }
+  const uint32_t spareFrameDelay = this->frameDelay;
+  lock.unlock();
+
+  AvifImageFrame imageFrame;
+  try {
+    if (!frameDecoder) {
+      // Parsing runs outside the lock, the shared buffer never changes once attached
+      spare = createParsedDecoder(spareFrameDelay);
+      frameDecoder = spare.get();
+    }
+    frameDecoder->maxThreads = decoderThreads;
+    imageFrame = decodeFrame(frameDecoder, frame, scaledWidth, scaledHeight,
+                             javaColorSpace, javaScaleMode, scalingQuality, stats,
+                             false, &this->framePool);
+  } catch (...) {
+    lock.lock();
+    returnDecoder(onMainDecoder, std::move(spare));
+    throw;
+  }
+  lock.lock();
+  returnDecoder(onMainDecoder, std::move(spare));
+  if (!dirtyRects) {
+    return imageFrame;
+  }
+
+  // Pixels are compared before reformatting, so the caller converts and
+  // uploads only what changed since the previous frame it received
+  auto &reference = this->dirtyReference;
+  const uint32_t pixelSize = imageFrame.is16Bit ? 4 * sizeof(uint16_t) : 4 * sizeof(uint8_t);
+  const uint32_t stride = imageFrame.width * pixelSize;
+  const bool comparable = reference.width == imageFrame.width
+      && reference.height == imageFrame.height
+      && reference.is16Bit == imageFrame.is16Bit
+      && reference.scaledWidth == scaledWidth
+      && reference.scaledHeight == scaledHeight
+      && reference.colorConfig == javaColorSpace
+      && reference.scaleMode == javaScaleMode
+      && reference.scalingQuality == scalingQuality
+      && reference.store.size() == imageFrame.store.size();
+  if (comparable) {
+    *dirtyRects = coder::DiffFrames(reference.store.data(), imageFrame.store.data(), stride,
+                                    imageFrame.width, imageFrame.height, pixelSize);
+    // Outside the rectangles the reference already holds these pixels
+    for (const coder::DirtyRect &rect : *dirtyRects) {
+      const size_t offset = static_cast<size_t>(rect.left) * pixelSize;
+      const size_t rowBytes = static_cast<size_t>(rect.right - rect.left) * pixelSize;
+      for (uint32_t y = rect.top; y < rect.bottom; ++y) {
+        std::memcpy(reference.store.data() + static_cast<size_t>(y) * stride + offset,
+                    imageFrame.store.data() + static_cast<size_t>(y) * stride + offset,
+                    rowBytes);
+      }
+    }
+  } else {
+    *dirtyRects = {coder::DirtyRect{
+        .left = 0,
+        .top = 0,
+        .right = imageFrame.width,
+        .bottom = imageFrame.height,
+    }};
+    reference.store.assign(imageFrame.store.begin(), imageFrame.store.end());
+  }
+
+  reference.width = imageFrame.width;
+  reference.height = imageFrame.height;
+  reference.is16Bit = imageFrame.is16Bit;
+  reference.scaledWidth = scaledWidth;
+  reference.scaledHeight = scaledHeight;
+  reference.colorConfig = javaColorSpace;
+  reference.scaleMode = javaScaleMode;
+  reference.scalingQuality = scalingQuality;
+  return imageFrame;
+}
+
+std::unique_ptr<AvifDecoderController> AvifDecoderController::clone() {
+  std::lock_guard guard(this->mutex);
+  if (!this->isBufferAttached) {
+    throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
+  }
+  auto copy = std::make_unique<AvifDecoderController>();
+  copy->frameDelay = this->frameDelay;
+  copy->maxDecoders = this->maxDecoders;
+  copy->attachBuffer(this->buffer.data(), static_cast<uint32_t>(this->buffer.size()));
+  return copy;
+}
+
+void AvifDecoderController::returnDecoder(bool mainDecoder, avif::DecoderPtr spare) {
+  if (mainDecoder) {
+    this->decoderBusy = false;
+  } else {
+    --this->sparesInUse;
+    // Spares with an outdated frame delay or beyond the limit are released
+    const size_t idleLimit = this->maxDecoders - 1 - std::min(this->sparesInUse,
+                                                              this->maxDecoders - 1);
+    if (spare && spare->maxFrameDelay == this->frameDelay
+        && this->spareDecoders.size() < idleLimit) {
+      this->spareDecoders.push_back(std::move(spare));
+    }
+  }
+  this->decoderReturned.notify_all();
+}
+
+int AvifDecoderController::decoderThreadsLocked() const {
+  const uint32_t hwThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  return static_cast<int>(std::max(hwThreads / this->maxDecoders, 1u));
+}
+
+void AvifDecoderController::setMaxDecoders(uint32_t count) {
+  std::lock_guard guard(this->mutex);
+  this->maxDecoders = std::max(count, 1u);
+  if (this->spareDecoders.size() + 1 > this->maxDecoders) {
+    this->spareDecoders.resize(this->maxDecoders - 1);
+  }
+  this->decoderReturned.notify_all();
+}
+
+void AvifDecoderController::recycleFrame(AvifImageFrame &&imageFrame) {
+  imageFrame.admission.release();
+  this->framePool.recycle(std::move(imageFrame.store));
+}
+
+void AvifDecoderController::resetDirtyTracking() {
+  std::lock_guard guard(this->mutex);
+  this->dirtyReference = DirtyReference();
+}
+
+AvifImageFrame AvifDecoderController::decodeFrame(avifDecoder *decoder,
+                                                  uint32_t frame,
+                                                  int32_t scaledWidth,
+                                                  int32_t scaledHeight,
+                                                  PreferredColorConfig javaColorSpace,
+                                                  ScaleMode javaScaleMode,
+                                                  int scalingQuality,
+                                                  coder::DecodeStats *stats,
+                                                  bool preferYuvDownscale,
+                                                  coder::FrameBufferPool *pool) {
+  uint32_t chromaLayout = 1;
+  switch (decoder->image->yuvFormat) {
+    case AVIF_PIXEL_FORMAT_YUV400:chromaLayout = 0;
+      break;
+    case AVIF_PIXEL_FORMAT_YUV422:chromaLayout = 2;
+      break;
+    case AVIF_PIXEL_FORMAT_YUV444:chromaLayout = 3;
+      break;
+    default:break;
+  }
+
+  coder::DecodeMemoryRequest memoryRequest = {
+      .width = decoder->image->width,
+      .height = decoder->image->height,
+      .bitDepth = decoder->image->depth,
+      .chromaLayout = chromaLayout,
+      .hasAlpha = decoder->alphaPresent == AVIF_TRUE,
+      .allowYuvDownscale = true,
+      .preferYuvDownscale = preferYuvDownscale,
+      .scaledWidth = scaledWidth,
+      .scaledHeight = scaledHeight,
+      .scaleMode = javaScaleMode,
+      .colorConfig = javaColorSpace,
+  };
+  coder::DecodeAdmissionPlan admissionPlan = {0};
+  coder::DecodeAdmissionTicket admission = coder::AdmitDecode(memoryRequest, &admissionPlan);
+
+  coder::ScopedDecodeStage decodeStage(stats, coder::DecodeStage::Decode);
+  avifResult nextImageResult = avifDecoderNthImage(decoder, frame);
   if (nextImageResult != AVIF_RESULT_OK) {
     std::string str = "Can't time of frame number: " + std::to_string(frame);
     throw std::runtime_error(str);
   }
+  decodeStage.stop();
+
+  auto image = decoder->image;
+
+  if (stats) {
+    stats->addAllocation(coder::DecodeStage::Decode, imagePlanesBytes(image));
+    stats->colorObuSize = decoder->ioStats.colorOBUSize;
+    stats->alphaObuSize = decoder->ioStats.alphaOBUSize;
+    stats->decoderThreads = decoder->maxThreads;
+    // Conversion, scaling and color management run on the decoding thread only
+    stats->conversionThreads = 1;
+  }
+
+  coder::ScopedDecodeStage yuvToRgbaStage(stats, coder::DecodeStage::YuvToRgba);
+
+  // Budget didn't allow a full size RGBA intermediate, shrink planes first.
+  // The view doesn't own decoder planes, so scaling allocates its own ones
+  // and the decoder state stays intact for following frames.
+  avif::ImagePtr scaledView;
+  if (admissionPlan.downscaleInYuv
+      && (admissionPlan.yuvWidth != image->width || admissionPlan.yuvHeight != image->height)) {
+    scaledView = avif::ImagePtr(avifImageCreateEmpty());
+    if (!scaledView) {
+      throw std::bad_alloc();
+    }
+    avifCropRect fullRect = {
+        .x = 0,
+        .y = 0,
+        .width = image->width,
+        .height = image->height,
+    };
+    avifDiagnostics diagnostics;
+    if (avifImageSetViewRect(scaledView.get(), image, &fullRect) == AVIF_RESULT_OK
+        && avifImageScale(scaledView.get(), admissionPlan.yuvWidth, admissionPlan.yuvHeight,
+                          &diagnostics) == AVIF_RESULT_OK) {
+      image = scaledView.get();
+      coder::RecordDecodeAllocation(stats, coder::DecodeStage::YuvToRgba, imagePlanesBytes(image));
+    } else {
+      scaledView.reset();
+    }
+  }
 
-  AvifUniqueImage avifUniqueImage(this->decoder.get());
+  AvifUniqueImage avifUniqueImage(image, pool);
 
   auto
-      imageUsesAlpha = decoder->image->imageOwnsAlphaPlane || decoder->image->alphaPlane != nullptr;
+      imageUsesAlpha = image->imageOwnsAlphaPlane || image->alphaPlane != nullptr;
 
-  auto colorPrimaries = decoder->image->colorPrimaries;
-  auto transferCharacteristics = decoder->image->transferCharacteristics;
+  auto colorPrimaries = image->colorPrimaries;
+  auto transferCharacteristics = image->transferCharacteristics;
 
-  uint32_t bitDepth = decoder->image->depth;
+  uint32_t bitDepth = image->depth;
 
-  bool isImageRequires64Bit = avifImageUsesU16(decoder->image);
+  bool isImageRequires64Bit = avifImageUsesU16(image);
+  // Allocation budgets are expressed in RGBA frames at source size
+  coder::SetTrackedFullFrameBytes(static_cast<uint64_t>(decoder->image->width)
+                                      * decoder->image->height * 4
+                                      * (isImageRequires64Bit ? sizeof(uint16_t)
+                                                              : sizeof(uint8_t)));
   if (isImageRequires64Bit) {
     avifUniqueImage.rgbImage.alphaPremultiplied = false;
     avifUniqueImage.rgbImage.depth = bitDepth;
@@ -120,12 +427,13 @@ AvifImageFrame AvifDecoderController::getFrame(uint32_t frame,
         str = "Can't correctly allocate buffer for frame with numbers: " + std::to_string(frame);
     throw std::runtime_error(str);
   }
+  coder::RecordDecodeAllocation(stats, coder::DecodeStage::YuvToRgba,
+                                static_cast<uint64_t>(avifUniqueImage.rgbImage.rowBytes)
+                                    * avifUniqueImage.rgbImage.height);
 
   bool isImageConverted = false;
 
-  auto image = decoder->image;
-
-  auto type = decoder->image->yuvFormat;
+  auto type = image->yuvFormat;
 
   YuvMatrix matrix = YuvMatrix::Bt709;
   if (image->matrixCoefficients == AVIF_MATRIX_COEFFICIENTS_BT601) {
@@ -287,32 +595,39 @@ AvifImageFrame AvifDecoderController::getFrame(uint32_t frame,
         str = "Unfortunately image type is not supported" + std::to_string(frame);
     throw std::runtime_error(str);
   }
+  yuvToRgbaStage.stop();
 
   float intensityTarget =
-      decoder->image->clli.maxCLL == 0 ? 1000.0f : static_cast<float>(decoder->image->clli.maxCLL);
+      image->clli.maxCLL == 0 ? 1000.0f : static_cast<float>(image->clli.maxCLL);
 
   aligned_uint8_vector iccProfile(0);
-  if (decoder->image->icc.data && decoder->image->icc.size) {
-    iccProfile.resize(decoder->image->icc.size);
-    std::copy(decoder->image->icc.data,
-              decoder->image->icc.data + decoder->image->icc.size,
+  if (image->icc.data && image->icc.size) {
+    iccProfile.resize(image->icc.size);
+    std::copy(image->icc.data,
+              image->icc.data + image->icc.size,
               iccProfile.begin());
   }
 
-  uint32_t imageWidth = decoder->image->width;
-  uint32_t imageHeight = decoder->image->height;
+  uint32_t imageWidth = image->width;
+  uint32_t imageHeight = image->height;
 
   uint32_t stride = avifUniqueImage.rgbImage.rowBytes;
 
   aligned_uint8_vector imageStore;
 
+  coder::ScopedDecodeStage rescaleStage(stats, coder::DecodeStage::Rescale);
   imageStore = RescaleSourceImage(avifUniqueImage.rgbImage.pixels, &stride,
                                   bitDepth, isImageRequires64Bit, &imageWidth,
                                   &imageHeight, scaledWidth, scaledHeight, javaScaleMode,
-                                  scalingQuality, imageUsesAlpha);
+                                  scalingQuality, imageUsesAlpha, pool);
+  coder::RecordDecodeAllocation(stats, coder::DecodeStage::Rescale, imageStore.size());
 
   avifUniqueImage.clear();
+  scaledView.reset();
+  rescaleStage.stop();
 
+  coder::ScopedDecodeStage colorManagementStage(stats, coder::DecodeStage::ColorManagement);
+  coder::RecordDecodeAllocation(stats, coder::DecodeStage::ColorManagement, iccProfile.size());
   if (!iccProfile.empty()) {
     convertUseICC(imageStore, stride, imageWidth, imageHeight, iccProfile.data(),
                   iccProfile.size(),
@@ -416,101 +731,464 @@ AvifImageFrame AvifDecoderController::getFrame(uint32_t frame,
     }
 
   }
+  colorManagementStage.stop();
 
   AvifImageFrame imageFrame = {
-      .store = imageStore,
+      .store = std::move(imageStore),
       .width = imageWidth,
       .height = imageHeight,
       .is16Bit = isImageRequires64Bit,
       .bitDepth = bitDepth,
-      .hasAlpha = imageUsesAlpha
+      .hasAlpha = imageUsesAlpha,
+      .admission = std::move(admission),
   };
   return imageFrame;
 }
 
-void AvifDecoderController::attachBuffer(uint8_t *data, uint32_t bufferSize) {
+void AvifDecoderController::attachBuffer(uint8_t *data,
+                                         uint32_t bufferSize,
+                                         coder::DecodeStats *stats) {
   std::lock_guard guard(this->mutex);
   if (this->isBufferAttached) {
     throw std::runtime_error("AVIF controller can accept buffer only once");
   }
+  coder::ScopedDecodeStage parseStage(stats, coder::DecodeStage::Parse);
+  coder::RecordDecodeAllocation(stats, coder::DecodeStage::Parse, bufferSize);
   this->buffer.resize(bufferSize);
   std::copy(data, data + bufferSize, this->buffer.begin());
-  auto result =
-      avifDecoderSetIOMemory(this->decoder.get(), this->buffer.data(), this->buffer.size());
-  if (result != AVIF_RESULT_OK) {
+  auto result = configureAndParse(this->decoder.get(), this->buffer, this->frameDelay);
+  if (result == AVIF_RESULT_OUT_OF_MEMORY) {
     throw std::runtime_error("Can't successfully attach memory");
   }
-  this->decoder->ignoreExif = false;
-  this->decoder->ignoreXMP = false;
-  this->decoder->strictFlags = AVIF_STRICT_DISABLED;
-
-  uint32_t hwThreads = std::thread::hardware_concurrency();
-  this->decoder->maxThreads = static_cast<int>(hwThreads);
-  result = avifDecoderParse(decoder.get());
   if (result != AVIF_RESULT_OK) {
     throw std::runtime_error("This is doesn't looks like AVIF image");
   }
+
+  // Sync samples are known from the container, so the index costs nothing to build
+  this->keyframes.clear();
+  const auto imageCount = static_cast<uint32_t>(std::max(this->decoder->imageCount, 1));
+  for (uint32_t i = 0; i < imageCount; ++i) {
+    if (i == 0 || avifDecoderIsKeyframe(this->decoder.get(), i)) {
+      this->keyframes.push_back(i);
+    }
+  }
+
+  // Sample table is complete after parsing, so timings are resolved once here
+  auto snapshot = std::make_unique<MetadataSnapshot>();
+  snapshot->framesCount = static_cast<uint32_t>(this->decoder->imageCount);
+  snapshot->repetitionCount = this->decoder->repetitionCount;
+  if (this->decoder->image) {
+    snapshot->imageSize = {
+        .width = this->decoder->image->width,
+        .height = this->decoder->image->height,
+    };
+  } else {
+    snapshot->imageSize = {.width = 0, .height = 0};
+  }
+  snapshot->durationsMs.resize(snapshot->framesCount);
+  snapshot->startsMs.resize(snapshot->framesCount + 1);
+  uint64_t elapsedInTimescales = 0;
+  uint64_t timescale = 1;
+  for (uint32_t i = 0; i < snapshot->framesCount; ++i) {
+    avifImageTiming timing;
+    if (avifDecoderNthImageTiming(this->decoder.get(), i, &timing) != AVIF_RESULT_OK) {
+      std::string str = "Can't time of frame number: " + std::to_string(i);
+      throw std::runtime_error(str);
+    }
+    timescale = timing.timescale == 0 ? 1 : timing.timescale;
+    snapshot->startsMs[i] = elapsedInTimescales * 1000 / timescale;
+    snapshot->durationsMs[i] = static_cast<uint32_t>(timing.durationInTimescales * 1000 / timescale);
+    elapsedInTimescales += timing.durationInTimescales;
+  }
+  snapshot->startsMs[snapshot->framesCount] = elapsedInTimescales * 1000 / timescale;
+  this->metadataStore = std::move(snapshot);
+  this->metadata.store(this->metadataStore.get(), std::memory_order_release);
   this->isBufferAttached = true;
 }
 
-uint32_t AvifDecoderController::getFramesCount() {
+void AvifDecoderController::decodeRange(uint32_t from,
+                                        uint32_t to,
+                                        int32_t scaledWidth,
+                                        int32_t scaledHeight,
+                                        PreferredColorConfig javaColorSpace,
+                                        ScaleMode javaScaleMode,
+                                        int scalingQuality,
+                                        uint32_t maxWorkers,
+                                        const FrameConsumer &consumer) {
+  std::vector<std::pair<uint32_t, uint32_t>> segments;
+  uint32_t rangeFrameDelay;
+  {
+    std::lock_guard guard(this->mutex);
+    if (!this->isBufferAttached) {
+      throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
+    }
+    if (from >= to || to > metadataSnapshot().framesCount) {
+      std::string str = "Invalid frames range: " + std::to_string(from) + ".." + std::to_string(to);
+      throw std::runtime_error(str);
+    }
+    uint32_t start = from;
+    for (auto keyframe = std::upper_bound(this->keyframes.begin(), this->keyframes.end(), from);
+         keyframe != this->keyframes.end() && *keyframe < to; ++keyframe) {
+      segments.emplace_back(start, *keyframe);
+      start = *keyframe;
+    }
+    segments.emplace_back(start, to);
+    rangeFrameDelay = this->frameDelay;
+  }
+  // Buffer is immutable once attached, so workers parse their own decoders
+  // without holding the controller lock and getFrame stays available
+
+  const uint32_t hwThreads = std::max(std::thread::hardware_concurrency(), 1u);
+  const auto workersCount = static_cast<uint32_t>(std::min<size_t>(
+      maxWorkers == 0 ? hwThreads : maxWorkers, segments.size()));
+  const int decoderThreads = static_cast<int>(std::max(hwThreads / workersCount, 1u));
+  // Frames decoded ahead of the consumer are no longer covered by admission
+  // tickets, so the reorder window gets its own share of the budget
+  const uint64_t maxBufferedBytes = coder::GetDecodeMemoryBudget() / 4;
+
+  std::mutex rangeMutex;
+  std::condition_variable rangeCondition;
+  std::map<uint32_t, AvifImageFrame> ready;
+  uint64_t bufferedBytes = 0;
+  uint32_t nextFrame = from;
+  size_t nextSegment = 0;
+  bool cancelled = false;
+  std::exception_ptr failure;
+
+  auto cancel = [&](std::exception_ptr error) {
+    std::lock_guard lock(rangeMutex);
+    if (error && !failure) {
+      failure = error;
+    }
+    cancelled = true;
+    rangeCondition.notify_all();
+  };
+
+  auto worker = [&]() {
+    try {
+      auto segmentDecoder = createParsedDecoder(rangeFrameDelay);
+      segmentDecoder->maxThreads = decoderThreads;
+      for (;;) {
+        std::pair<uint32_t, uint32_t> segment;
+        {
+          std::lock_guard lock(rangeMutex);
+          if (cancelled || nextSegment == segments.size()) {
+            return;
+          }
+          segment = segments[nextSegment++];
+        }
+        for (uint32_t frame = segment.first; frame < segment.second; ++frame) {
+          AvifImageFrame decoded = decodeFrame(segmentDecoder.get(), frame,
+                                               scaledWidth, scaledHeight,
+                                               javaColorSpace, javaScaleMode,
+                                               scalingQuality, nullptr);
+          decoded.admission.release();
+          const uint64_t frameBytes = decoded.store.size();
+
+          // The frame the consumer waits for is always accepted, so the
+          // segment holding it can't be starved by frames decoded ahead
+          std::unique_lock lock(rangeMutex);
+          rangeCondition.wait(lock, [&] {
+            return cancelled || frame == nextFrame
+                || bufferedBytes + frameBytes <= maxBufferedBytes;
+          });
+          if (cancelled) {
+            return;
+          }
+          bufferedBytes += frameBytes;
+          ready.emplace(frame, std::move(decoded));
+          rangeCondition.notify_all();
+        }
+      }
+    } catch (...) {
+      cancel(std::current_exception());
+    }
+  };
+
+  std::vector<std::thread> workers;
+  workers.reserve(workersCount);
+  try {
+    for (uint32_t i = 0; i < workersCount; ++i) {
+      workers.emplace_back(worker);
+    }
+    while (nextFrame < to) {
+      std::unique_lock lock(rangeMutex);
+      rangeCondition.wait(lock, [&] {
+        return cancelled || ready.find(nextFrame) != ready.end();
+      });
+      if (cancelled) {
+        break;
+      }
+      auto node = ready.extract(nextFrame);
+      bufferedBytes -= node.mapped().store.size();
+      const uint32_t frame = nextFrame++;
+      rangeCondition.notify_all();
+      lock.unlock();
+
+      if (!consumer(frame, std::move(node.mapped()))) {
+        cancel(nullptr);
+        break;
+      }
+    }
+  } catch (...) {
+    cancel(std::current_exception());
+  }
+  for (auto &thread : workers) {
+    thread.join();
+  }
+  if (failure) {
+    std::rethrow_exception(failure);
+  }
+}
+
+std::vector<uint32_t> AvifDecoderController::thumbnailFrames(uint32_t count) {
   std::lock_guard guard(this->mutex);
   if (!this->isBufferAttached) {
     throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
   }
-  return this->decoder->imageCount;
+  const auto &snapshot = metadataSnapshot();
+  const auto presentationEnd = snapshot.startsMs.begin() + std::max(snapshot.framesCount, 1u);
+  const uint64_t duration = snapshot.startsMs.back();
+
+  std::vector<uint32_t> frames;
+  frames.reserve(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    const uint64_t timestamp = duration * i / count;
+    auto shown = std::upper_bound(snapshot.startsMs.begin(), presentationEnd, timestamp);
+    const auto frame = static_cast<uint32_t>(
+        shown == snapshot.startsMs.begin() ? 0 : std::distance(snapshot.startsMs.begin(), shown) - 1);
+    frames.push_back(nearestKeyframeLocked(frame));
+  }
+  return frames;
 }
 
-uint32_t AvifDecoderController::getLoopsCount() {
+void AvifDecoderController::decodeThumbnails(const std::vector<uint32_t> &frames,
+                                             int32_t scaledWidth,
+                                             int32_t scaledHeight,
+                                             PreferredColorConfig javaColorSpace,
+                                             ScaleMode javaScaleMode,
+                                             int scalingQuality,
+                                             const FrameConsumer &consumer) {
+  std::vector<uint32_t> distinct(frames);
+  std::sort(distinct.begin(), distinct.end());
+  distinct.erase(std::unique(distinct.begin(), distinct.end()), distinct.end());
+  {
+    std::lock_guard guard(this->mutex);
+    if (!this->isBufferAttached) {
+      throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
+    }
+    if (!distinct.empty() && distinct.back() >= metadataSnapshot().framesCount) {
+      std::string str = "Can't time of frame number: " + std::to_string(distinct.back());
+      throw std::runtime_error(str);
+    }
+  }
+
+  // Own decoder leaves the playback position and reference state untouched
+  auto thumbnailDecoder = createParsedDecoder(1);
+  for (uint32_t frame : distinct) {
+    AvifImageFrame decoded = decodeFrame(thumbnailDecoder.get(), frame,
+                                         scaledWidth, scaledHeight,
+                                         javaColorSpace, javaScaleMode,
+                                         scalingQuality, nullptr, true);
+    if (!consumer(frame, std::move(decoded))) {
+      return;
+    }
+  }
+}
+
+avif::DecoderPtr AvifDecoderController::createParsedDecoder(uint32_t delay) {
+  auto parsed = avif::DecoderPtr(avifDecoderCreate());
+  if (!parsed) {
+    throw std::bad_alloc();
+  }
+  if (configureAndParse(parsed.get(), this->buffer, delay) != AVIF_RESULT_OK) {
+    throw std::runtime_error("Can't create decoder for seeking");
+  }
+  return parsed;
+}
+
+void AvifDecoderController::selectDecoderForFrame(uint32_t frame) {
+  if (this->maxSnapshots == 0) {
+    return;
+  }
+  const uint32_t keyframe = this->nearestKeyframeLocked(frame);
+  uint32_t bestCost = decodeCost(this->decoder.get(), frame, keyframe);
+  if (bestCost <= 1) {
+    return;
+  }
+  const int64_t position = this->decoder->imageIndex;
+  const bool restartsFromKeyframe = static_cast<int64_t>(frame) <= position
+      || static_cast<int64_t>(keyframe) > position + 1;
+
+  size_t bestSnapshot = this->snapshots.size();
+  for (size_t i = 0; i < this->snapshots.size(); ++i) {
+    uint32_t cost = decodeCost(this->snapshots[i].decoder.get(), frame, keyframe);
+    if (cost < bestCost) {
+      bestCost = cost;
+      bestSnapshot = i;
+    }
+  }
+
+  if (bestSnapshot != this->snapshots.size()) {
+    // Resume from the parked state and park the current one in its place
+    std::swap(this->decoder, this->snapshots[bestSnapshot].decoder);
+    this->snapshots[bestSnapshot].lastUse = ++this->snapshotClock;
+    return;
+  }
+
+  // Restarting would drop the reference frames the current decoder holds,
+  // keep them for later seeks and restart on another instance instead
+  if (!restartsFromKeyframe || position < 0) {
+    return;
+  }
+  if (this->snapshots.size() < this->maxSnapshots) {
+    auto restarted = createParsedDecoder(this->frameDelay);
+    this->snapshots.push_back({
+                                  .decoder = std::move(this->decoder),
+                                  .lastUse = ++this->snapshotClock,
+                              });
+    this->decoder = std::move(restarted);
+    return;
+  }
+  auto oldest = std::min_element(this->snapshots.begin(), this->snapshots.end(),
+                                 [](const SeekSnapshot &a, const SeekSnapshot &b) {
+                                   return a.lastUse < b.lastUse;
+                                 });
+  std::swap(this->decoder, oldest->decoder);
+  oldest->lastUse = ++this->snapshotClock;
+}
+
+uint32_t AvifDecoderController::nearestKeyframeLocked(uint32_t frame) const {
+  auto next = std::upper_bound(this->keyframes.begin(), this->keyframes.end(), frame);
+  if (next == this->keyframes.begin()) {
+    return 0;
+  }
+  return *std::prev(next);
+}
+
+bool AvifDecoderController::isKeyframe(uint32_t frame) {
   std::lock_guard guard(this->mutex);
   if (!this->isBufferAttached) {
     throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
   }
-  return this->decoder->repetitionCount;
+  return std::binary_search(this->keyframes.begin(), this->keyframes.end(), frame);
 }
 
-uint32_t AvifDecoderController::getFrameDuration(uint32_t frame) {
+uint32_t AvifDecoderController::nearestKeyframe(uint32_t frame) {
   std::lock_guard guard(this->mutex);
   if (!this->isBufferAttached) {
     throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
   }
-
-  if (frame >= this->decoder->imageCount) {
-    std::string str = "Can't time of frame number: " + std::to_string(frame);
+  if (frame >= metadataSnapshot().framesCount) {
+    std::string str = "Can't find keyframe of frame number: " + std::to_string(frame);
     throw std::runtime_error(str);
   }
+  return nearestKeyframeLocked(frame);
+}
 
-  avifImageTiming timing;
-  auto result = avifDecoderNthImageTiming(this->decoder.get(), frame, &timing);
-  if (result != AVIF_RESULT_OK) {
-    std::string str = "Can't time of frame number: " + std::to_string(frame);
+uint32_t AvifDecoderController::seekCost(uint32_t frame) {
+  std::unique_lock lock(this->mutex);
+  if (!this->isBufferAttached) {
+    throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
+  }
+  if (frame >= metadataSnapshot().framesCount) {
+    std::string str = "Can't estimate seek to frame number: " + std::to_string(frame);
     throw std::runtime_error(str);
   }
-  return (uint32_t) (1000.0f / ((float) timing.timescale) * (float) timing.durationInTimescales);
+  // Position of the main decoder is only stable while no call decodes on it
+  this->decoderReturned.wait(lock, [this] { return !this->decoderBusy; });
+  const uint32_t keyframe = nearestKeyframeLocked(frame);
+  uint32_t cost = decodeCost(this->decoder.get(), frame, keyframe);
+  for (const auto &snapshot : this->snapshots) {
+    cost = std::min(cost, decodeCost(snapshot.decoder.get(), frame, keyframe));
+  }
+  return cost;
 }
 
-uint32_t AvifDecoderController::getTotalDuration() {
-  std::lock_guard guard(this->mutex);
-  if (!this->isBufferAttached) {
-    throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
+void AvifDecoderController::setFrameDelay(uint32_t frames) {
+  std::unique_lock lock(this->mutex);
+  const uint32_t delay = std::max(frames, 1u);
+  if (delay == this->frameDelay) {
+    return;
+  }
+  this->decoderReturned.wait(lock, [this] { return !this->decoderBusy; });
+  this->frameDelay = delay;
+  // Codecs pick the delay up when they are created, parked states would
+  // keep the old one until their next keyframe, so they are dropped
+  this->snapshots.clear();
+  this->spareDecoders.clear();
+  this->decoder->maxFrameDelay = delay;
+  if (this->isBufferAttached && this->decoder->imageIndex >= 0) {
+    if (avifDecoderReset(this->decoder.get()) != AVIF_RESULT_OK) {
+      throw std::runtime_error("Can't reset decoder");
+    }
   }
-  return (uint32_t) (1000.0f / ((float) this->decoder->timescale)
-      * (float) this->decoder->durationInTimescales);
 }
 
-AvifImageSize AvifDecoderController::getImageSize() {
+void AvifDecoderController::setSeekSnapshots(uint32_t count) {
   std::lock_guard guard(this->mutex);
-  if (!this->isBufferAttached) {
+  this->maxSnapshots = count;
+  if (this->snapshots.size() <= count) {
+    return;
+  }
+  std::sort(this->snapshots.begin(), this->snapshots.end(),
+            [](const SeekSnapshot &a, const SeekSnapshot &b) {
+              return a.lastUse > b.lastUse;
+            });
+  this->snapshots.resize(count);
+}
+
+const AvifDecoderController::MetadataSnapshot &AvifDecoderController::metadataSnapshot() const {
+  const MetadataSnapshot *snapshot = this->metadata.load(std::memory_order_acquire);
+  if (!snapshot) {
     throw std::runtime_error("AVIF controller methods can't be called without attached buffer");
   }
-  if (!this->decoder->image) {
+  return *snapshot;
+}
+
+uint32_t AvifDecoderController::getFramesCount() {
+  return metadataSnapshot().framesCount;
+}
+
+uint32_t AvifDecoderController::getLoopsCount() {
+  return metadataSnapshot().repetitionCount;
+}
+
+uint32_t AvifDecoderController::getFrameDuration(uint32_t frame) {
+  const auto &snapshot = metadataSnapshot();
+  if (frame >= snapshot.framesCount) {
+    std::string str = "Can't time of frame number: " + std::to_string(frame);
+    throw std::runtime_error(str);
+  }
+  return snapshot.durationsMs[frame];
+}
+
+uint32_t AvifDecoderController::getTotalDuration() {
+  const auto &snapshot = metadataSnapshot();
+  return static_cast<uint32_t>(snapshot.startsMs.back());
+}
+
+AvifImageSize AvifDecoderController::getImageSize() {
+  const auto &snapshot = metadataSnapshot();
+  if (snapshot.imageSize.width == 0 || snapshot.imageSize.height == 0) {
     throw std::runtime_error("Parsed image is expected but there are nothing");
   }
-  AvifImageSize imageSize = {
-      .width = this->decoder->image->width,
-      .height = this->decoder->image->height,
-  };
-  return imageSize;
+  return snapshot.imageSize;
+}
+
+uint32_t AvifDecoderController::frameAtTime(uint64_t timeMs) {
+  const auto &snapshot = metadataSnapshot();
+  if (snapshot.framesCount == 0) {
+    throw std::runtime_error("Can't time of frame at: " + std::to_string(timeMs));
+  }
+  const uint64_t totalMs = snapshot.startsMs.back();
+  if (totalMs > 0) {
+    timeMs %= totalMs;
+  }
+  auto frameEnd = snapshot.startsMs.begin() + snapshot.framesCount;
+  auto shown = std::upper_bound(snapshot.startsMs.begin(), frameEnd, timeMs);
+  return static_cast<uint32_t>(
+      shown == snapshot.startsMs.begin() ? 0 : std::distance(snapshot.startsMs.begin(), shown) - 1);
 }
 
 AvifImageSize AvifDecoderController::getImageSize(uint8_t *data, uint32_t bufferSize) {
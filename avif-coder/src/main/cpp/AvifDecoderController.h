@@ -31,11 +31,18 @@
 
 #include "avif/avif_cxx.h"
 #include <vector>
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <memory>
 #include "definitions.h"
 #include "SizeScaler.h"
-#include "Support.h"
+#include "ColorConfig.h"
 #include <thread>
 #include "ImageFrame.h"
+#include "DecodeStats.h"
+#include "imagebits/FrameDiff.h"
+#include "FrameBufferPool.h"
 
 class AvifDecoderController {
  public:
@@ -58,20 +65,166 @@ class AvifDecoderController {
                           int32_t scaledHeight,
                           PreferredColorConfig javaColorSpace,
                           ScaleMode javaScaleMode,
-                          int scalingQuality);
-  void attachBuffer(uint8_t *data, uint32_t bufferSize);
+                          int scalingQuality,
+                          coder::DecodeStats *stats = nullptr,
+                          std::vector<coder::DirtyRect> *dirtyRects = nullptr);
+  // Next frame requested with dirtyRects reports the whole frame as changed
+  void resetDirtyTracking();
+  /**
+   * Returns the store of a frame from getFrame once its pixels are consumed.
+   * Following frames of the same size reuse it instead of allocating.
+   */
+  void recycleFrame(AvifImageFrame &&imageFrame);
+  // Receives decoded frames in order, returning false stops the range
+  using FrameConsumer = std::function<bool(uint32_t frame, AvifImageFrame &&imageFrame)>;
+
+  /**
+   * Decodes frames [from, to). The range is split at keyframes and the segments
+   * are decoded in parallel, each on its own decoder, with dav1d threads divided
+   * between them. Frames reach the consumer in order on the calling thread.
+   * maxWorkers 0 uses every available core.
+   */
+  void decodeRange(uint32_t from,
+                   uint32_t to,
+                   int32_t scaledWidth,
+                   int32_t scaledHeight,
+                   PreferredColorConfig javaColorSpace,
+                   ScaleMode javaScaleMode,
+                   int scalingQuality,
+                   uint32_t maxWorkers,
+                   const FrameConsumer &consumer);
+  /**
+   * Keyframes shown at count evenly spaced timestamps, starting at 0. Every timestamp
+   * snaps back to the keyframe it depends on, so entries may repeat.
+   */
+  std::vector<uint32_t> thumbnailFrames(uint32_t count);
+  /**
+   * Decodes each distinct frame once in ascending order on a separate decoder,
+   * planes are shrunk to the target size before YUV -> RGB. With keyframes from
+   * thumbnailFrames every frame costs a single intra decode.
+   */
+  void decodeThumbnails(const std::vector<uint32_t> &frames,
+                        int32_t scaledWidth,
+                        int32_t scaledHeight,
+                        PreferredColorConfig javaColorSpace,
+                        ScaleMode javaScaleMode,
+                        int scalingQuality,
+                        const FrameConsumer &consumer);
+  void attachBuffer(uint8_t *data, uint32_t bufferSize, coder::DecodeStats *stats = nullptr);
+  // Independent controller over a copy of the attached buffer with the same settings
+  std::unique_ptr<AvifDecoderController> clone();
+  // Metadata getters read the snapshot taken at parse time and never wait for a decode
   uint32_t getFramesCount();
   uint32_t getLoopsCount();
   uint32_t getTotalDuration();
   uint32_t getFrameDuration(uint32_t frame);
   AvifImageSize getImageSize();
+  // Frame shown at timeMs, timestamps past the end wrap around the loop
+  uint32_t frameAtTime(uint64_t timeMs);
+
+  bool isKeyframe(uint32_t frame);
+  // Closest keyframe at or before frame, decoding of frame has to start from it
+  uint32_t nearestKeyframe(uint32_t frame);
+  // Number of frames getFrame has to decode to present frame from the current state
+  uint32_t seekCost(uint32_t frame);
+  /**
+   * Keeps up to count additional decoders parked at previously decoded positions.
+   * A seek resumes from the closest parked reference state instead of rewinding to
+   * the keyframe, so scrubbing long GOPs stays bounded. Every parked decoder holds
+   * its own AV1 reference frames, 0 disables parking and releases them.
+   */
+  void setSeekSnapshots(uint32_t count);
+
+  /**
+   * Lets dav1d decode up to frames consecutive frames of the sequence in parallel.
+   * Pays off for sequential playback of small frames where tile threading can't
+   * use the cores; a seek that restarts from a keyframe drops the frames in flight.
+   * 1 decodes frame by frame with all threads on a single frame.
+   */
+  void setFrameDelay(uint32_t frames);
+
+  /**
+   * Lets up to count getFrame calls decode at the same time. Calls that find the main
+   * decoder busy run on spare decoders parsed from the same buffer, which stay around
+   * for later calls; dav1d threads are split between all of them. 1 serializes every
+   * call on the main decoder.
+   */
+  void setMaxDecoders(uint32_t count);
 
   static AvifImageSize getImageSize(uint8_t *data, uint32_t bufferSize);
 
  private:
+  // Last frame delivered with dirty rectangles, together with what it was requested as
+  struct DirtyReference {
+    aligned_uint8_vector store;
+    uint32_t width = 0;
+    uint32_t height = 0;
+    bool is16Bit = false;
+    int32_t scaledWidth = 0;
+    int32_t scaledHeight = 0;
+    PreferredColorConfig colorConfig = Default;
+    ScaleMode scaleMode = Fit;
+    int scalingQuality = 0;
+  };
+
+  // Immutable once published, everything the getters need without touching the decoder
+  struct MetadataSnapshot {
+    uint32_t framesCount;
+    int32_t repetitionCount;
+    AvifImageSize imageSize;
+    std::vector<uint32_t> durationsMs;
+    // Start of every frame in milliseconds with the end of the sequence as the last
+    // entry. Durations are summed in timescale units and each start is converted
+    // from that sum, so per-frame rounding doesn't drift
+    std::vector<uint64_t> startsMs;
+  };
+
+  struct SeekSnapshot {
+    avif::DecoderPtr decoder;
+    uint64_t lastUse;
+  };
+
+  static AvifImageFrame decodeFrame(avifDecoder *decoder,
+                                    uint32_t frame,
+                                    int32_t scaledWidth,
+                                    int32_t scaledHeight,
+                                    PreferredColorConfig javaColorSpace,
+                                    ScaleMode javaScaleMode,
+                                    int scalingQuality,
+                                    coder::DecodeStats *stats,
+                                    bool preferYuvDownscale = false,
+                                    coder::FrameBufferPool *pool = nullptr);
+  avif::DecoderPtr createParsedDecoder(uint32_t delay);
+  // Swaps in the decoder that reaches frame with the fewest decoded frames
+  void selectDecoderForFrame(uint32_t frame);
+  uint32_t nearestKeyframeLocked(uint32_t frame) const;
+  // Hands the decoder of a finished getFrame back, spare is empty when it never got parsed
+  void returnDecoder(bool mainDecoder, avif::DecoderPtr spare);
+  int decoderThreadsLocked() const;
+  const MetadataSnapshot &metadataSnapshot() const;
+
   bool isBufferAttached;
+  // Written once in attachBuffer before publishing, lives as long as the controller
+  std::unique_ptr<const MetadataSnapshot> metadataStore;
+  std::atomic<const MetadataSnapshot *> metadata{nullptr};
   aligned_uint8_vector buffer;
   avif::DecoderPtr decoder;
+  // Sorted indices of sync samples, always starts with 0
+  std::vector<uint32_t> keyframes;
+  std::vector<SeekSnapshot> snapshots;
+  uint32_t maxSnapshots = 0;
+  uint64_t snapshotClock = 0;
+  uint32_t frameDelay = 1;
+  // Main decoder is checked out by a getFrame call running outside the lock
+  bool decoderBusy = false;
+  // Idle spare decoders, together with the ones in use never more than maxDecoders - 1
+  std::vector<avif::DecoderPtr> spareDecoders;
+  uint32_t sparesInUse = 0;
+  uint32_t maxDecoders = 1;
+  std::condition_variable decoderReturned;
+  DirtyReference dirtyReference;
+  // Intermediate and output stores of getFrame, has its own lock
+  coder::FrameBufferPool framePool;
   std::mutex mutex;
 };
 
@@ -0,0 +1,43 @@
+# JNI free decode/encode core, linked into libcoder on Android and used
+# directly by host tools and servers. avif_shared and avifweaver targets
+# have to be declared before including this file.
+
+set(CODER_CORE_DIR ${CMAKE_CURRENT_LIST_DIR})
+
+add_library(coder_core STATIC
+        ${CODER_CORE_DIR}/CoderCore.cpp
+        ${CODER_CORE_DIR}/PixelReformat.cpp
+        ${CODER_CORE_DIR}/AvifDecoderController.cpp
+        ${CODER_CORE_DIR}/AnimationPlayer.cpp
+        ${CODER_CORE_DIR}/AvifAnimatedEncoder.cpp
+        ${CODER_CORE_DIR}/FrameBufferPool.cpp
+        ${CODER_CORE_DIR}/DecodeAdmission.cpp
+        ${CODER_CORE_DIR}/EncodeDeadline.cpp
+        ${CODER_CORE_DIR}/DecodeStats.cpp
+        ${CODER_CORE_DIR}/AllocationTracker.cpp
+        ${CODER_CORE_DIR}/SizeScaler.cpp
+        ${CODER_CORE_DIR}/colorspace/colorspace.cpp
+        ${CODER_CORE_DIR}/imagebits/CopyUnalignedRGBA.cpp
+        ${CODER_CORE_DIR}/imagebits/FrameDiff.cpp
+        ${CODER_CORE_DIR}/imagebits/RGBAlpha.cpp
+        ${CODER_CORE_DIR}/imagebits/Rgb1010102.cpp
+        ${CODER_CORE_DIR}/imagebits/Rgb565.cpp
+        ${CODER_CORE_DIR}/imagebits/Rgba16.cpp
+        ${CODER_CORE_DIR}/imagebits/Rgba8ToF16.cpp
+        ${CODER_CORE_DIR}/imagebits/RgbaF16bitToNBitU16.cpp
+        ${CODER_CORE_DIR}/imagebits/half.cpp
+)
+
+target_include_directories(coder_core PUBLIC ${CODER_CORE_DIR} ${CODER_CORE_DIR}/algo
+        ${CODER_CORE_DIR}/colorspace)
+# Core sources never see jni.h, avifweaver.h declares its JNI entry points opaque
+target_compile_definitions(coder_core PRIVATE AVIFWEAVER_NO_JNI=1)
+set_target_properties(coder_core PROPERTIES POSITION_INDEPENDENT_CODE ON)
+
+# Per decode accounting of aligned_allocator traffic, see AllocationTracker.h.
+# PUBLIC since the allocator is a header template instantiated by every user.
+option(CODER_TRACK_ALLOCATIONS "Track aligned_allocator allocations per decode" OFF)
+if (CODER_TRACK_ALLOCATIONS)
+    target_compile_definitions(coder_core PUBLIC AVIF_CODER_TRACK_ALLOCATIONS=1)
+endif ()
+target_link_libraries(coder_core PUBLIC avif_shared avifweaver)
@@ -0,0 +1,1206 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "CoderCore.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <cstring>
+#include <deque>
+#include <exception>
+#include <limits>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include "AvifDecoderController.h"
+#include "EncodeDeadline.h"
+#include "PixelReformat.h"
+#include "avif/avif_cxx.h"
+#include "avifweaver.h"
+
+namespace {
+WeavePixelFormat toWeavePixelFormat(coder::PixelFormat format) {
+  switch (format) {
+    case coder::PixelFormat::Rgba8888:return WeavePixelFormat::Rgba8888;
+    case coder::PixelFormat::RgbaF16:return WeavePixelFormat::RgbaF16;
+    case coder::PixelFormat::Rgb565:return WeavePixelFormat::Rgb565;
+    case coder::PixelFormat::Rgba1010102:return WeavePixelFormat::Rgba1010102;
+    default:throw std::runtime_error("Pixel format is not supported by the encoder");
+  }
+}
+
+AvEncodingSpeed toWeaveSpeed(coder::EncodeSpeed speed) {
+  switch (speed) {
+    case coder::EncodeSpeed::Slow:return AvEncodingSpeed::Slow;
+    case coder::EncodeSpeed::Fast:return AvEncodingSpeed::Fast;
+    default:return AvEncodingSpeed::Medium;
+  }
+}
+
+WeaveImageBuffer toWeaveBuffer(const coder::ImageView &image) {
+  return WeaveImageBuffer{
+      .data = image.pixels,
+      .stride = image.stride,
+      .width = image.width,
+      .height = image.height,
+      .format = toWeavePixelFormat(image.format),
+      .premultiplied = image.premultiplied,
+  };
+}
+
+WeaveYuvImage toWeaveYuv(const coder::YuvImageView &image) {
+  return WeaveYuvImage{
+      .y = image.y,
+      .y_stride = image.yStride,
+      .u = image.u,
+      .u_stride = image.uStride,
+      .v = image.v,
+      .v_stride = image.vStride,
+      .a = image.a,
+      .a_stride = image.aStride,
+      .width = image.width,
+      .height = image.height,
+      .bit_depth = image.bitDepth,
+      .chroma_subsampling_code = image.chromaSubsampling,
+      .color_primaries = image.colorPrimaries,
+      .transfer_characteristics = image.transferCharacteristics,
+      .matrix_coefficients = image.matrixCoefficients,
+      .full_range = image.fullRange,
+      .chroma_pixel_stride = image.chromaPixelStride,
+      .msb_aligned = image.msbAligned,
+  };
+}
+
+AvifEncodingOptions toWeaveOptions(const coder::EncodeOptions &options) {
+  return AvifEncodingOptions{
+      .color_space = options.colorSpace,
+      .quality = options.quality,
+      .lossless = options.lossless,
+      .chroma_subsampling_code = options.chromaSubsampling,
+      .speed = toWeaveSpeed(options.speed),
+      .screen_content_coding = options.screenContentCoding,
+  };
+}
+
+struct PreparedDeleter {
+  void operator()(WeaveAv1Prepared *prepared) const { weave_av1_prepared_free(prepared); }
+};
+
+struct TranscodeDeleter {
+  void operator()(WeaveHeicTranscode *transcode) const { weave_heic_transcode_free(transcode); }
+};
+
+struct PreparedItem {
+  std::unique_ptr<WeaveAv1Prepared, PreparedDeleter> prepared;
+  std::vector<uint8_t> exif;
+  bool last;
+};
+
+struct ScopedEncodedImage {
+  EncodedImage image;
+  ~ScopedEncodedImage() { weave_encoded_image_free(image); }
+};
+
+// Smallest grid cell MIAF allows
+constexpr uint32_t kMinGridTile = 64;
+
+uint32_t bytesPerPixel(coder::PixelFormat format) {
+  switch (format) {
+    case coder::PixelFormat::RgbaF16:return 8;
+    case coder::PixelFormat::Rgb565:return 2;
+    default:return 4;
+  }
+}
+
+avifPixelFormat yuvFormatOf(int32_t chromaSubsampling) {
+  switch (chromaSubsampling) {
+    case 2:return AVIF_PIXEL_FORMAT_YUV422;
+    case 3:return AVIF_PIXEL_FORMAT_YUV444;
+    case 4:return AVIF_PIXEL_FORMAT_YUV400;
+    default:return AVIF_PIXEL_FORMAT_YUV420;
+  }
+}
+
+// Chroma layout the encoder ends up with, grid cells have to respect its parity rules
+avifPixelFormat encodedYuvFormat(const coder::EncodeOptions &options) {
+  if (options.lossless) {
+    return AVIF_PIXEL_FORMAT_YUV444;
+  }
+  return yuvFormatOf(options.chromaSubsampling);
+}
+
+std::string avifError(const char *stage, avifResult result, const avifEncoder *encoder) {
+  std::string message = std::string(stage) + ": " + avifResultToString(result);
+  if (encoder && encoder->diag.error[0] != '\0') {
+    message += ", ";
+    message += encoder->diag.error;
+  }
+  return message;
+}
+
+// Colour description an AV1 sample was coded with, shared by every cell of a grid
+struct CodedFormat {
+  uint32_t depth;
+  avifPixelFormat yuvFormat;
+  avifRange yuvRange;
+  avifColorPrimaries colorPrimaries;
+  avifTransferCharacteristics transferCharacteristics;
+  avifMatrixCoefficients matrixCoefficients;
+};
+
+struct GridCell {
+  std::vector<uint8_t> color;
+  // Empty when alpha of the cell is constant
+  std::vector<uint8_t> alpha;
+  // Alpha of every pixel at the coded bit depth when alpha is empty
+  uint16_t constantAlpha = 255;
+};
+
+/**
+ * Lifts the AV1 sample of the primary item out of a still AVIF file from
+ * the encoder, format receives the colour description it was coded with.
+ */
+std::vector<uint8_t> primaryItemSample(const EncodedImage &encoded, CodedFormat *format) {
+  if (encoded.error || !encoded.data) {
+    throw std::runtime_error(encoded.error ? encoded.error : "AVIF encoding has failed");
+  }
+  avif::DecoderPtr decoder(avifDecoderCreate());
+  if (!decoder) {
+    throw std::bad_alloc();
+  }
+  decoder->ignoreExif = AVIF_TRUE;
+  decoder->ignoreXMP = AVIF_TRUE;
+  avifResult result = avifDecoderSetIOMemory(decoder.get(), encoded.data, encoded.length);
+  if (result == AVIF_RESULT_OK) {
+    result = avifDecoderParse(decoder.get());
+  }
+  avifExtent extent{};
+  if (result == AVIF_RESULT_OK) {
+    result = avifDecoderNthImageMaxExtent(decoder.get(), 0, &extent);
+  }
+  if (result != AVIF_RESULT_OK || extent.size == 0 || extent.offset > encoded.length
+      || extent.size > encoded.length - extent.offset) {
+    throw std::runtime_error("Encoded image has no usable AV1 sample");
+  }
+  if (format) {
+    const avifImage *image = decoder->image;
+    *format = CodedFormat{
+        .depth = image->depth,
+        .yuvFormat = image->yuvFormat,
+        .yuvRange = image->yuvRange,
+        .colorPrimaries = image->colorPrimaries,
+        .transferCharacteristics = image->transferCharacteristics,
+        .matrixCoefficients = image->matrixCoefficients,
+    };
+  }
+  const uint8_t *sample = encoded.data + extent.offset;
+  return {sample, sample + extent.size};
+}
+
+WeaveYuvImage alphaAsMonochrome(const WeaveYuvImage &planes) {
+  return WeaveYuvImage{
+      .y = planes.a,
+      .y_stride = planes.a_stride,
+      .width = planes.width,
+      .height = planes.height,
+      .bit_depth = planes.bit_depth,
+      .chroma_subsampling_code = 4,
+      .color_primaries = AVIF_COLOR_PRIMARIES_UNSPECIFIED,
+      .transfer_characteristics = AVIF_TRANSFER_CHARACTERISTICS_UNSPECIFIED,
+      .matrix_coefficients = AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED,
+      .full_range = true,
+  };
+}
+
+/**
+ * Converts and encodes the cells of a grid on a few threads. Cells are taken
+ * in raster order, so conversion walks the source in strips of cells and only
+ * the cells in flight have their planes alive.
+ */
+class GridCellEncoder {
+ public:
+  GridCellEncoder(const coder::ImageView &image,
+                  const AvifEncodingOptions &options,
+                  uint32_t tileSize,
+                  uint32_t columns,
+                  uint32_t rows)
+      : image(image), options(options), tileSize(tileSize), columns(columns), rows(rows),
+        cells(static_cast<size_t>(columns) * rows) {}
+
+  std::vector<GridCell> encode() {
+    const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+    const auto workers = static_cast<uint32_t>(std::min<size_t>(cores, cells.size()));
+    threadsPerCell = std::max(1u, cores / workers);
+    std::vector<std::thread> helpers;
+    helpers.reserve(workers - 1);
+    try {
+      for (uint32_t worker = 1; worker < workers; ++worker) {
+        helpers.emplace_back([this] { run(); });
+      }
+    } catch (...) {
+      stop.store(true);
+      for (std::thread &helper : helpers) {
+        helper.join();
+      }
+      throw;
+    }
+    run();
+    for (std::thread &helper : helpers) {
+      helper.join();
+    }
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+    return std::move(cells);
+  }
+
+  const CodedFormat &colorFormat() const { return format; }
+
+ private:
+  void run() {
+    try {
+      while (!stop.load()) {
+        const size_t index = next.fetch_add(1);
+        if (index >= cells.size()) {
+          return;
+        }
+        encodeCell(index);
+      }
+    } catch (...) {
+      std::lock_guard guard(mutex);
+      if (!failure) {
+        failure = std::current_exception();
+      }
+      stop.store(true);
+    }
+  }
+
+  void encodeCell(size_t index) {
+    const uint32_t pixelSize = bytesPerPixel(image.format);
+    const uint32_t x = static_cast<uint32_t>(index % columns) * tileSize;
+    const uint32_t y = static_cast<uint32_t>(index / columns) * tileSize;
+    const uint32_t width = std::min(tileSize, image.width - x);
+    const uint32_t height = std::min(tileSize, image.height - y);
+    const uint8_t *origin = image.pixels + static_cast<size_t>(y) * image.stride
+        + static_cast<size_t>(x) * pixelSize;
+    uint32_t stride = image.stride;
+
+    // Every cell is coded at the full tile size, right and bottom cells repeat
+    // their last column and row, decoders crop them back
+    std::vector<uint8_t> padded;
+    if (width < tileSize || height < tileSize) {
+      const size_t paddedStride = static_cast<size_t>(tileSize) * pixelSize;
+      padded.resize(paddedStride * tileSize);
+      for (uint32_t row = 0; row < tileSize; ++row) {
+        const uint8_t *source = origin + static_cast<size_t>(std::min(row, height - 1)) * stride;
+        uint8_t *target = padded.data() + row * paddedStride;
+        std::memcpy(target, source, static_cast<size_t>(width) * pixelSize);
+        for (uint32_t column = width; column < tileSize; ++column) {
+          std::memcpy(target + static_cast<size_t>(column) * pixelSize,
+                      source + static_cast<size_t>(width - 1) * pixelSize, pixelSize);
+        }
+      }
+      origin = padded.data();
+      stride = static_cast<uint32_t>(paddedStride);
+    }
+
+    GridCell &cell = cells[index];
+    WeaveAv1PrepareResult prepareResult = weave_av1_prepare(WeaveImageBuffer{
+        .data = origin,
+        .stride = stride,
+        .width = tileSize,
+        .height = tileSize,
+        .format = toWeavePixelFormat(image.format),
+        .premultiplied = image.premultiplied,
+    }, options);
+    std::unique_ptr<WeaveAv1Prepared, PreparedDeleter> prepared(prepareResult.prepared);
+    if (prepareResult.error || !prepared) {
+      std::string message = prepareResult.error ? prepareResult.error : "AVIF encoding has failed";
+      weave_av1_prepare_error_free(prepareResult.error);
+      throw std::runtime_error(message);
+    }
+    padded = std::vector<uint8_t>();
+
+    // Colour and alpha become separate items of the grid, so they are coded apart
+    const WeaveYuvImage planes = weave_av1_prepared_planes(prepared.get());
+    if (!planes.y) {
+      throw std::runtime_error("Prepared grid cell has no planes");
+    }
+    WeaveYuvImage color = planes;
+    color.a = nullptr;
+    color.a_stride = 0;
+    {
+      ScopedEncodedImage encoded{weave_av1_encode_yuv(color, nullptr, 0, options, threadsPerCell)};
+      CodedFormat cellFormat{};
+      cell.color = primaryItemSample(encoded.image, index == 0 ? &cellFormat : nullptr);
+      if (index == 0) {
+        format = cellFormat;
+      }
+    }
+    if (planes.a) {
+      ScopedEncodedImage encoded{weave_av1_encode_yuv(alphaAsMonochrome(planes), nullptr, 0,
+                                                      options, threadsPerCell)};
+      cell.alpha = primaryItemSample(encoded.image, nullptr);
+    } else {
+      // Taken from the same unpacked pixels as alpha planes, so every format agrees on it
+      cell.constantAlpha = weave_av1_prepared_constant_alpha(prepared.get());
+    }
+  }
+
+  const coder::ImageView &image;
+  const AvifEncodingOptions options;
+  const uint32_t tileSize;
+  const uint32_t columns;
+  const uint32_t rows;
+  uint32_t threadsPerCell = 1;
+  std::vector<GridCell> cells;
+  // Written by the worker of cell 0 before its join
+  CodedFormat format{};
+  std::atomic<size_t> next{0};
+  std::atomic<bool> stop{false};
+  std::mutex mutex;
+  std::exception_ptr failure;
+};
+
+// Pre-coded samples handed to the maroontree codec in its encoding order
+struct CodedSamples {
+  std::vector<const std::vector<uint8_t> *> color;
+  std::vector<const std::vector<uint8_t> *> alpha;
+  size_t nextColor = 0;
+  size_t nextAlpha = 0;
+};
+
+avifResult nextCodedSample(void *userData, avifBool alpha, avifROData *sample) {
+  auto samples = static_cast<CodedSamples *>(userData);
+  const auto &queue = alpha ? samples->alpha : samples->color;
+  size_t &next = alpha ? samples->nextAlpha : samples->nextColor;
+  if (next >= queue.size()) {
+    return alpha ? AVIF_RESULT_ENCODE_ALPHA_FAILED : AVIF_RESULT_ENCODE_COLOR_FAILED;
+  }
+  const std::vector<uint8_t> *payload = queue[next++];
+  sample->data = payload->data();
+  sample->size = payload->size();
+  return AVIF_RESULT_OK;
+}
+
+struct ScopedSampleSource {
+  explicit ScopedSampleSource(CodedSamples *samples) {
+    avifMaroontreeSetSampleSource(nextCodedSample, samples);
+  }
+  ~ScopedSampleSource() { avifMaroontreeSetSampleSource(nullptr, nullptr); }
+};
+
+// Alpha sample of a cell whose alpha is value everywhere, value is at depth already
+std::vector<uint8_t> constantAlphaSample(uint16_t value,
+                                         uint32_t tileSize,
+                                         uint32_t depth,
+                                         const AvifEncodingOptions &options) {
+  const uint32_t sampleSize = depth > 8 ? 2 : 1;
+  std::vector<uint8_t> plane(static_cast<size_t>(tileSize) * tileSize * sampleSize);
+  if (sampleSize == 1) {
+    std::fill(plane.begin(), plane.end(), static_cast<uint8_t>(value));
+  } else {
+    auto samples = reinterpret_cast<uint16_t *>(plane.data());
+    std::fill(samples, samples + static_cast<size_t>(tileSize) * tileSize, value);
+  }
+  const WeaveYuvImage alpha{
+      .a = plane.data(),
+      .a_stride = tileSize * sampleSize,
+      .width = tileSize,
+      .height = tileSize,
+      .bit_depth = depth,
+  };
+  ScopedEncodedImage encoded{weave_av1_encode_yuv(alphaAsMonochrome(alpha), nullptr, 0,
+                                                  options, 0)};
+  return primaryItemSample(encoded.image, nullptr);
+}
+
+/**
+ * Image that only describes a pre-coded sample to the libavif writer. Pixels are
+ * never looked at beyond the opacity check, so every row of every plane aliases
+ * row, which has to be zeroed and hold a row of 16 bit samples. Exif of options
+ * is attached when set.
+ */
+avif::ImagePtr codedImageDescriptor(uint32_t width,
+                                    uint32_t height,
+                                    const CodedFormat &format,
+                                    bool hasAlpha,
+                                    uint8_t *row,
+                                    const coder::EncodeOptions &options) {
+  avif::ImagePtr image(avifImageCreateEmpty());
+  if (!image) {
+    throw std::bad_alloc();
+  }
+  image->width = width;
+  image->height = height;
+  image->depth = format.depth;
+  image->yuvFormat = format.yuvFormat;
+  image->yuvRange = format.yuvRange;
+  image->colorPrimaries = format.colorPrimaries;
+  image->transferCharacteristics = format.transferCharacteristics;
+  image->matrixCoefficients = format.matrixCoefficients;
+  image->imageOwnsYUVPlanes = AVIF_FALSE;
+  image->imageOwnsAlphaPlane = AVIF_FALSE;
+  image->yuvPlanes[AVIF_CHAN_Y] = row;
+  if (format.yuvFormat != AVIF_PIXEL_FORMAT_YUV400) {
+    image->yuvPlanes[AVIF_CHAN_U] = row;
+    image->yuvPlanes[AVIF_CHAN_V] = row;
+  }
+  if (hasAlpha) {
+    image->alphaPlane = row;
+  }
+  if (options.exif && options.exifSize > 0) {
+    const avifResult result = avifImageSetMetadataExif(image.get(), options.exif,
+                                                       options.exifSize);
+    if (result != AVIF_RESULT_OK) {
+      throw std::runtime_error(avifError("Can't attach exif", result, nullptr));
+    }
+  }
+  return image;
+}
+
+// Writes the container around samples, addImages feeds the descriptors to the encoder
+std::vector<uint8_t> writeCodedSamples(CodedSamples *samples,
+                                       const coder::EncodeOptions &options,
+                                       const char *failure,
+                                       const std::function<avifResult(avifEncoder *)> &addImages) {
+  avif::EncoderPtr encoder(avifEncoderCreate());
+  if (!encoder) {
+    throw std::runtime_error("Can't create encoder");
+  }
+  encoder->codecChoice = AVIF_CODEC_CHOICE_MAROONTREE;
+  encoder->quality = std::clamp(options.quality, 0, 100);
+  encoder->qualityAlpha = encoder->quality;
+  avifRWData output = AVIF_DATA_EMPTY;
+  {
+    ScopedSampleSource source(samples);
+    avifResult result = addImages(encoder.get());
+    if (result == AVIF_RESULT_OK) {
+      result = avifEncoderFinish(encoder.get(), &output);
+    }
+    if (result != AVIF_RESULT_OK) {
+      avifRWDataFree(&output);
+      throw std::runtime_error(avifError(failure, result, encoder.get()));
+    }
+  }
+  std::vector<uint8_t> encoded(output.data, output.data + output.size);
+  avifRWDataFree(&output);
+  return encoded;
+}
+
+// AV1 samples of colour and alpha, alpha is empty for opaque planes
+struct CodedPlanes {
+  std::vector<uint8_t> color;
+  std::vector<uint8_t> alpha;
+  CodedFormat format;
+};
+
+/**
+ * Codes colour and alpha of prepared planes at the same time, threads split by
+ * their sample counts. Opaque planes are coded with every thread.
+ */
+CodedPlanes encodeColorAndAlpha(const WeaveYuvImage &planes,
+                                const AvifEncodingOptions &encodingOptions) {
+  CodedPlanes coded{};
+  if (!planes.a) {
+    ScopedEncodedImage encoded{weave_av1_encode_yuv(planes, nullptr, 0, encodingOptions, 0)};
+    coded.color = primaryItemSample(encoded.image, &coded.format);
+    return coded;
+  }
+
+  uint32_t chromaWidth = 0, chromaHeight = 0;
+  switch (planes.chroma_subsampling_code) {
+    case 1:chromaWidth = (planes.width + 1) / 2;
+      chromaHeight = (planes.height + 1) / 2;
+      break;
+    case 2:chromaWidth = (planes.width + 1) / 2;
+      chromaHeight = planes.height;
+      break;
+    case 3:chromaWidth = planes.width;
+      chromaHeight = planes.height;
+      break;
+    default:break;
+  }
+  const uint64_t lumaSamples = static_cast<uint64_t>(planes.width) * planes.height;
+  const uint64_t colorSamples = lumaSamples + 2ull * chromaWidth * chromaHeight;
+  const uint32_t cores = std::max(2u, std::thread::hardware_concurrency());
+  const auto colorThreads = static_cast<uint32_t>(std::clamp<uint64_t>(
+      (cores * colorSamples + (colorSamples + lumaSamples) / 2) / (colorSamples + lumaSamples),
+      1, cores - 1));
+  const uint32_t alphaThreads = cores - colorThreads;
+
+  WeaveYuvImage color = planes;
+  color.a = nullptr;
+  color.a_stride = 0;
+  std::exception_ptr alphaFailure;
+  std::thread alphaWorker([&] {
+    try {
+      ScopedEncodedImage encoded{weave_av1_encode_yuv(alphaAsMonochrome(planes), nullptr, 0,
+                                                      encodingOptions, alphaThreads)};
+      coded.alpha = primaryItemSample(encoded.image, nullptr);
+    } catch (...) {
+      alphaFailure = std::current_exception();
+    }
+  });
+  try {
+    ScopedEncodedImage encoded{weave_av1_encode_yuv(color, nullptr, 0, encodingOptions,
+                                                    colorThreads)};
+    coded.color = primaryItemSample(encoded.image, &coded.format);
+  } catch (...) {
+    alphaWorker.join();
+    throw;
+  }
+  alphaWorker.join();
+  if (alphaFailure) {
+    std::rethrow_exception(alphaFailure);
+  }
+  return coded;
+}
+
+// clap of a transcoded HEIC, unset when there is none or libavif couldn't read it back
+std::optional<avifCleanApertureBox> heicCleanAperture(const WeaveHeicMetadata &metadata,
+                                                      const WeaveYuvImage &planes) {
+  if (!metadata.has_clean_aperture) {
+    return std::nullopt;
+  }
+  const uint32_t *fraction = metadata.clean_aperture;
+  const avifCleanApertureBox clap{
+      .widthN = fraction[0],
+      .widthD = fraction[1],
+      .heightN = fraction[2],
+      .heightD = fraction[3],
+      .horizOffN = fraction[4],
+      .horizOffD = fraction[5],
+      .vertOffN = fraction[6],
+      .vertOffD = fraction[7],
+  };
+  avifCropRect rect{};
+  avifDiagnostics diag{};
+  if (!avifCropRectConvertCleanApertureBox(&rect, &clap, planes.width, planes.height,
+                                           yuvFormatOf(planes.chroma_subsampling_code), &diag)) {
+    return std::nullopt;
+  }
+  return clap;
+}
+
+// Replaces the orientation libavif read from the Exif with the HEIF one, HEIC Exif doesn't orient
+void applyHeicTransforms(avifImage *image,
+                         const WeaveHeicMetadata &metadata,
+                         const std::optional<avifCleanApertureBox> &clap) {
+  image->transformFlags &= ~(AVIF_TRANSFORM_IROT | AVIF_TRANSFORM_IMIR | AVIF_TRANSFORM_CLAP);
+  if (metadata.rotation != 0) {
+    image->transformFlags |= AVIF_TRANSFORM_IROT;
+    image->irot.angle = metadata.rotation;
+  }
+  if (metadata.mirror >= 0) {
+    image->transformFlags |= AVIF_TRANSFORM_IMIR;
+    image->imir.axis = static_cast<uint8_t>(metadata.mirror);
+  }
+  if (clap) {
+    image->transformFlags |= AVIF_TRANSFORM_CLAP;
+    image->clap = *clap;
+  }
+}
+
+/**
+ * Hands converted images one at a time to a single encoder thread. The caller
+ * blocks in submit only while the previous image still waits for the encoder,
+ * finished bitstreams are delivered to the sink meanwhile.
+ */
+class BatchEncodePipeline {
+ public:
+  BatchEncodePipeline(size_t count, const AvifEncodingOptions &options)
+      : count(count), options(options) {
+    const uint32_t cores = std::max(1u, std::thread::hardware_concurrency());
+    allThreads = cores;
+    // One core stays with the caller converting the next image
+    sharedThreads = std::max(1u, cores - 1);
+    worker = std::thread([this] { run(); });
+  }
+
+  BatchEncodePipeline(const BatchEncodePipeline &) = delete;
+  BatchEncodePipeline &operator=(const BatchEncodePipeline &) = delete;
+
+  ~BatchEncodePipeline() {
+    {
+      std::lock_guard guard(mutex);
+      stopped = true;
+    }
+    changed.notify_all();
+    worker.join();
+    for (EncodedImage &image : finished) {
+      weave_encoded_image_free(image);
+    }
+  }
+
+  void submit(PreparedItem &&item, const coder::BatchEncodedSink &sink) {
+    std::unique_lock lock(mutex);
+    while (pending) {
+      changed.wait(lock, [this] { return !pending || !finished.empty() || failure; });
+      deliver(lock, sink);
+    }
+    pending = std::move(item);
+    lock.unlock();
+    changed.notify_all();
+  }
+
+  // Waits for every submitted image to reach the sink
+  void finish(const coder::BatchEncodedSink &sink) {
+    std::unique_lock lock(mutex);
+    while (delivered < count) {
+      changed.wait(lock, [this] { return !finished.empty() || failure; });
+      deliver(lock, sink);
+    }
+  }
+
+ private:
+  void deliver(std::unique_lock<std::mutex> &lock, const coder::BatchEncodedSink &sink) {
+    if (failure) {
+      std::rethrow_exception(failure);
+    }
+    while (!finished.empty()) {
+      ScopedEncodedImage encoded{finished.front()};
+      finished.pop_front();
+      const size_t index = delivered++;
+      lock.unlock();
+      if (encoded.image.error || !encoded.image.data) {
+        throw std::runtime_error(encoded.image.error ? encoded.image.error
+                                                     : "AVIF encoding has failed");
+      }
+      sink(index, encoded.image.data, encoded.image.length);
+      lock.lock();
+    }
+  }
+
+  void run() {
+    try {
+      for (size_t index = 0; index < count; ++index) {
+        PreparedItem item;
+        {
+          std::unique_lock lock(mutex);
+          changed.wait(lock, [this] { return pending.has_value() || stopped; });
+          if (stopped) {
+            return;
+          }
+          item = std::move(*pending);
+          pending.reset();
+        }
+        changed.notify_all();
+
+        const uint32_t threads = item.last ? allThreads : sharedThreads;
+        EncodedImage encoded = weave_av1_encode_prepared(item.prepared.get(),
+                                                         item.exif.data(), item.exif.size(),
+                                                         options, threads);
+        item.prepared.reset();
+        {
+          std::lock_guard guard(mutex);
+          try {
+            finished.push_back(encoded);
+          } catch (...) {
+            weave_encoded_image_free(encoded);
+            throw;
+          }
+        }
+        changed.notify_all();
+      }
+    } catch (...) {
+      {
+        std::lock_guard guard(mutex);
+        failure = std::current_exception();
+      }
+      changed.notify_all();
+    }
+  }
+
+  const size_t count;
+  const AvifEncodingOptions options;
+  uint32_t allThreads;
+  uint32_t sharedThreads;
+  std::mutex mutex;
+  std::condition_variable changed;
+  std::optional<PreparedItem> pending;
+  std::deque<EncodedImage> finished;
+  size_t delivered = 0;
+  bool stopped = false;
+  std::exception_ptr failure;
+  std::thread worker;
+};
+
+// Search stops once a fitting file uses this share of the budget
+constexpr double kSizeSearchSlack = 0.92;
+// Full encodes a size search may spend before settling on the best fit
+constexpr uint32_t kMaxSizeSearchEncodes = 6;
+// log(bytes) per quality step assumed when the probes can't tell
+constexpr double kDefaultSizeSlope = 0.03;
+
+std::vector<uint8_t> encodePreparedAt(const WeaveAv1Prepared *prepared,
+                                      const coder::EncodeOptions &options,
+                                      int32_t quality,
+                                      coder::EncodeSpeed speed) {
+  AvifEncodingOptions weaveOptions = toWeaveOptions(options);
+  weaveOptions.quality = quality;
+  weaveOptions.lossless = false;
+  weaveOptions.speed = toWeaveSpeed(speed);
+  ScopedEncodedImage encoded{weave_av1_encode_prepared(prepared, options.exif, options.exifSize,
+                                                       weaveOptions, 0)};
+  if (encoded.image.error || !encoded.image.data) {
+    throw std::runtime_error(encoded.image.error ? encoded.image.error
+                                                 : "AVIF encoding has failed");
+  }
+  return std::vector<uint8_t>(encoded.image.data, encoded.image.data + encoded.image.length);
+}
+
+/**
+ * log(bytes) as a line over quality. Probes give the slope, every full encode
+ * moves the offset so the line passes through the latest real result.
+ */
+class SizeModel {
+ public:
+  SizeModel(int32_t lowQuality, size_t lowBytes, int32_t highQuality, size_t highBytes) {
+    slope = kDefaultSizeSlope;
+    if (highQuality > lowQuality && highBytes > lowBytes) {
+      slope = (std::log(static_cast<double>(highBytes)) - std::log(static_cast<double>(lowBytes)))
+          / (highQuality - lowQuality);
+    }
+    intercept = std::log(static_cast<double>(highBytes)) - slope * highQuality;
+  }
+
+  void calibrate(int32_t quality, size_t bytes) {
+    intercept = std::log(static_cast<double>(bytes)) - slope * quality;
+  }
+
+  // Highest quality predicted to stay within bytes
+  int32_t qualityFor(size_t bytes) const {
+    return static_cast<int32_t>(std::floor(
+        (std::log(static_cast<double>(bytes)) - intercept) / slope));
+  }
+
+ private:
+  double slope;
+  double intercept;
+};
+}
+
+namespace coder {
+
+DecodedImage DecodeImage(const uint8_t *data, size_t size, const DecodeOptions &options) {
+  if (size > std::numeric_limits<uint32_t>::max()) {
+    throw std::runtime_error("Image is too big to be decoded");
+  }
+  ScopedDecodeStage sniffStage(options.stats, DecodeStage::ContainerSniff);
+  const ImageContainer container = container_recognisance(data, size);
+  sniffStage.stop();
+  if (container == ImageContainer::Heic || container == ImageContainer::Av2) {
+    // avifweaver decodes these straight into android.graphics.Bitmap
+    throw std::runtime_error("HEIC and AV2 images can be decoded only on Android");
+  }
+
+  // Hardware bitmaps are a JNI concept, here they are just pixels in the default layout
+  const PreferredColorConfig colorConfig = options.colorConfig == Hardware ? Default
+                                                                           : options.colorConfig;
+
+  AvifImageFrame frame;
+  {
+    AvifDecoderController controller;
+    controller.attachBuffer(const_cast<uint8_t *>(data), static_cast<uint32_t>(size),
+                            options.stats);
+    frame = controller.getFrame(0, options.scaledWidth, options.scaledHeight, colorConfig,
+                                options.scaleMode, options.scalingQuality, options.stats);
+  }
+
+  ScopedDecodeStage reformatStage(options.stats, DecodeStage::Reformat);
+  bool useFloats = frame.is16Bit;
+  uint32_t stride = frame.width * 4 * (frame.is16Bit ? sizeof(uint16_t) : sizeof(uint8_t));
+  auto sourceStore = frame.store.data();
+  const PixelFormat format = ReformatPixels(frame.store, colorConfig, frame.bitDepth,
+                                            frame.width, frame.height, &stride, &useFloats,
+                                            false, frame.hasAlpha);
+  if (frame.store.data() != sourceStore) {
+    RecordDecodeAllocation(options.stats, DecodeStage::Reformat,
+                           static_cast<uint64_t>(stride) * frame.height);
+  }
+  reformatStage.stop();
+
+  return DecodedImage{
+      .pixels = std::move(frame.store),
+      .width = frame.width,
+      .height = frame.height,
+      .stride = stride,
+      .format = format,
+      .bitDepth = frame.bitDepth,
+      .hasAlpha = frame.hasAlpha,
+      .admission = std::move(frame.admission),
+  };
+}
+
+std::vector<uint8_t> EncodeImage(const ImageView &image, const EncodeOptions &options) {
+  const AvifEncodingOptions encodingOptions = toWeaveOptions(options);
+  WeaveAv1PrepareResult prepareResult = weave_av1_prepare(toWeaveBuffer(image), encodingOptions);
+  std::unique_ptr<WeaveAv1Prepared, PreparedDeleter> prepared(prepareResult.prepared);
+  if (prepareResult.error || !prepared) {
+    std::string message = prepareResult.error ? prepareResult.error : "AVIF encoding has failed";
+    weave_av1_prepare_error_free(prepareResult.error);
+    throw std::runtime_error(message);
+  }
+
+  // Alpha is only kept by prepare when it isn't constant, opaque images go out in one piece
+  const WeaveYuvImage planes = weave_av1_prepared_planes(prepared.get());
+  if (!planes.a) {
+    ScopedEncodedImage encoded{weave_av1_encode_prepared(prepared.get(), options.exif,
+                                                         options.exifSize, encodingOptions, 0)};
+    if (encoded.image.error || !encoded.image.data) {
+      throw std::runtime_error(encoded.image.error ? encoded.image.error
+                                                   : "AVIF encoding has failed");
+    }
+    return std::vector<uint8_t>(encoded.image.data, encoded.image.data + encoded.image.length);
+  }
+
+  // Colour and alpha are coded at the same time, threads split by their sample counts
+  CodedPlanes coded = encodeColorAndAlpha(planes, encodingOptions);
+  prepared.reset();
+
+  CodedSamples samples{.color = {&coded.color}, .alpha = {&coded.alpha}};
+  std::vector<uint8_t> sharedRow(static_cast<size_t>(image.width) * sizeof(uint16_t));
+  avif::ImagePtr descriptor = codedImageDescriptor(image.width, image.height, coded.format, true,
+                                                   sharedRow.data(), options);
+  return writeCodedSamples(&samples, options, "AVIF encoding has failed",
+                           [&](avifEncoder *encoder) {
+                             return avifEncoderAddImage(encoder, descriptor.get(), 1,
+                                                        AVIF_ADD_IMAGE_FLAG_SINGLE);
+                           });
+}
+
+std::vector<uint8_t> EncodeYuvImage(const YuvImageView &image, const EncodeOptions &options) {
+  EncodedImage encoded = weave_av1_encode_yuv(toWeaveYuv(image), options.exif, options.exifSize,
+                                               toWeaveOptions(options), 0);
+  if (encoded.error || !encoded.data) {
+    std::string message = encoded.error ? encoded.error : "AVIF encoding has failed";
+    weave_encoded_image_free(encoded);
+    throw std::runtime_error(message);
+  }
+  std::vector<uint8_t> result(encoded.data, encoded.data + encoded.length);
+  weave_encoded_image_free(encoded);
+  return result;
+}
+
+std::vector<uint8_t> TranscodeHeic(const uint8_t *data,
+                                   size_t size,
+                                   const EncodeOptions &options) {
+  const AvifEncodingOptions encodingOptions = toWeaveOptions(options);
+  std::unique_ptr<WeaveHeicTranscode, TranscodeDeleter> transcode;
+  WeaveHeicMetadata metadata{};
+  WeaveYuvImage planes{};
+  std::optional<avifCleanApertureBox> clap;
+  // A clean aperture libavif couldn't read back is cropped through RGB instead
+  for (const bool throughRgb : {false, true}) {
+    WeaveHeicTranscodeResult result = weave_heic_transcode_prepare(data, size, encodingOptions,
+                                                                   throughRgb);
+    transcode.reset(result.transcode);
+    if (result.error || !transcode) {
+      std::string message = result.error ? result.error : "HEIC transcoding has failed";
+      weave_av1_prepare_error_free(result.error);
+      throw std::runtime_error(message);
+    }
+    metadata = weave_heic_transcode_metadata(transcode.get());
+    planes = weave_av1_prepared_planes(weave_heic_transcode_prepared(transcode.get()));
+    clap = heicCleanAperture(metadata, planes);
+    if (clap || !metadata.has_clean_aperture) {
+      break;
+    }
+  }
+
+  CodedPlanes coded = encodeColorAndAlpha(planes, encodingOptions);
+  // The sequence header may only approximate the code points of the source
+  coded.format.colorPrimaries = static_cast<avifColorPrimaries>(metadata.color_primaries);
+  coded.format.transferCharacteristics =
+      static_cast<avifTransferCharacteristics>(metadata.transfer_characteristics);
+  coded.format.matrixCoefficients =
+      static_cast<avifMatrixCoefficients>(metadata.matrix_coefficients);
+
+  EncodeOptions muxOptions = options;
+  muxOptions.exif = metadata.exif;
+  muxOptions.exifSize = metadata.exif_length;
+  const bool hasAlpha = !coded.alpha.empty();
+  CodedSamples samples{.color = {&coded.color}};
+  if (hasAlpha) {
+    samples.alpha = {&coded.alpha};
+  }
+  std::vector<uint8_t> sharedRow(static_cast<size_t>(planes.width) * sizeof(uint16_t));
+  avif::ImagePtr descriptor = codedImageDescriptor(planes.width, planes.height, coded.format,
+                                                   hasAlpha, sharedRow.data(), muxOptions);
+  if (metadata.icc) {
+    const avifResult result = avifImageSetProfileICC(descriptor.get(), metadata.icc,
+                                                     metadata.icc_length);
+    if (result != AVIF_RESULT_OK) {
+      throw std::runtime_error(avifError("Can't attach ICC profile", result, nullptr));
+    }
+  }
+  applyHeicTransforms(descriptor.get(), metadata, clap);
+  return writeCodedSamples(&samples, options, "HEIC transcoding has failed",
+                           [&](avifEncoder *encoder) {
+                             return avifEncoderAddImage(encoder, descriptor.get(), 1,
+                                                        AVIF_ADD_IMAGE_FLAG_SINGLE);
+                           });
+}
+
+std::vector<uint8_t> EncodeImageGrid(const ImageView &image,
+                                     const EncodeOptions &options,
+                                     uint32_t tileSize) {
+  tileSize = std::max(kMinGridTile, tileSize & ~1u);
+  const uint32_t columns = (image.width + tileSize - 1) / tileSize;
+  const uint32_t rows = (image.height + tileSize - 1) / tileSize;
+  const avifPixelFormat yuvFormat = encodedYuvFormat(options);
+  const bool oddWidth = (image.width & 1) != 0
+      && (yuvFormat == AVIF_PIXEL_FORMAT_YUV420 || yuvFormat == AVIF_PIXEL_FORMAT_YUV422);
+  const bool oddHeight = (image.height & 1) != 0 && yuvFormat == AVIF_PIXEL_FORMAT_YUV420;
+  if (image.width == 0 || image.height == 0 || (columns == 1 && rows == 1)
+      || oddWidth || oddHeight) {
+    return EncodeImage(image, options);
+  }
+  // Unsupported formats fail here rather than on every worker
+  toWeavePixelFormat(image.format);
+
+  const AvifEncodingOptions encodingOptions = toWeaveOptions(options);
+  GridCellEncoder cellEncoder(image, encodingOptions, tileSize, columns, rows);
+  std::vector<GridCell> cells = cellEncoder.encode();
+  const CodedFormat &format = cellEncoder.colorFormat();
+
+  // Alpha is one grid too, cells with constant alpha still need their sample
+  const bool hasAlpha = std::any_of(cells.begin(), cells.end(),
+                                    [](const GridCell &cell) { return !cell.alpha.empty(); });
+  std::map<uint16_t, std::vector<uint8_t>> constantAlphas;
+  CodedSamples samples;
+  for (const GridCell &cell : cells) {
+    samples.color.push_back(&cell.color);
+    if (!hasAlpha) {
+      continue;
+    }
+    if (!cell.alpha.empty()) {
+      samples.alpha.push_back(&cell.alpha);
+      continue;
+    }
+    auto constant = constantAlphas.find(cell.constantAlpha);
+    if (constant == constantAlphas.end()) {
+      constant = constantAlphas.emplace(cell.constantAlpha,
+                                        constantAlphaSample(cell.constantAlpha, tileSize,
+                                                            format.depth, encodingOptions)).first;
+    }
+    samples.alpha.push_back(&constant->second);
+  }
+
+  // Cells only describe the grid, the codec takes their samples from samples
+  std::vector<uint8_t> sharedRow(static_cast<size_t>(tileSize) * sizeof(uint16_t));
+  std::vector<avif::ImagePtr> cellImages;
+  std::vector<const avifImage *> cellPointers;
+  cellImages.reserve(cells.size());
+  for (size_t index = 0; index < cells.size(); ++index) {
+    const auto x = static_cast<uint32_t>(index % columns) * tileSize;
+    const auto y = static_cast<uint32_t>(index / columns) * tileSize;
+    avif::ImagePtr cell = codedImageDescriptor(std::min(tileSize, image.width - x),
+                                               std::min(tileSize, image.height - y),
+                                               format, hasAlpha, sharedRow.data(),
+                                               index == 0 ? options : EncodeOptions{});
+    cellPointers.push_back(cell.get());
+    cellImages.push_back(std::move(cell));
+  }
+
+  return writeCodedSamples(&samples, options, "AVIF grid encoding has failed",
+                           [&](avifEncoder *encoder) {
+                             return avifEncoderAddImageGrid(encoder, columns, rows,
+                                                            cellPointers.data(),
+                                                            AVIF_ADD_IMAGE_FLAG_SINGLE);
+                           });
+}
+
+void EncodeImages(size_t count,
+                  const EncodeOptions &options,
+                  const BatchItemSource &acquire,
+                  const BatchItemRelease &release,
+                  const BatchEncodedSink &sink) {
+  if (count == 0) {
+    return;
+  }
+  const AvifEncodingOptions encodingOptions = toWeaveOptions(options);
+  BatchEncodePipeline pipeline(count, encodingOptions);
+  for (size_t index = 0; index < count; ++index) {
+    PreparedItem item{.last = index + 1 == count};
+    WeaveAv1PrepareResult prepared{};
+    const BatchEncodeItem source = acquire(index);
+    try {
+      if (source.exif && source.exifSize > 0) {
+        item.exif.assign(source.exif, source.exif + source.exifSize);
+      }
+      AvifEncodingOptions imageOptions = encodingOptions;
+      imageOptions.color_space = source.colorSpace;
+      prepared = weave_av1_prepare(toWeaveBuffer(source.image), imageOptions);
+    } catch (...) {
+      release(index);
+      throw;
+    }
+    release(index);
+
+    item.prepared.reset(prepared.prepared);
+    if (prepared.error || !item.prepared) {
+      std::string message = prepared.error ? prepared.error : "AVIF encoding has failed";
+      weave_av1_prepare_error_free(prepared.error);
+      throw std::runtime_error(message);
+    }
+    pipeline.submit(std::move(item), sink);
+  }
+  pipeline.finish(sink);
+}
+
+SizedEncodeResult EncodeImageToSize(const ImageView &image,
+                                    const EncodeOptions &options,
+                                    size_t maxBytes) {
+  if (maxBytes == 0) {
+    throw std::runtime_error("Target size must be positive");
+  }
+  EncodeOptions lossy = options;
+  lossy.lossless = false;
+  WeaveAv1PrepareResult prepareResult = weave_av1_prepare(toWeaveBuffer(image),
+                                                          toWeaveOptions(lossy));
+  std::unique_ptr<WeaveAv1Prepared, PreparedDeleter> prepared(prepareResult.prepared);
+  if (prepareResult.error || !prepared) {
+    std::string message = prepareResult.error ? prepareResult.error : "AVIF encoding has failed";
+    weave_av1_prepare_error_free(prepareResult.error);
+    throw std::runtime_error(message);
+  }
+
+  const int32_t maxQuality = std::clamp(options.quality, 1, 100);
+  SizedEncodeResult result;
+  // Highest quality known to fit and lowest one known not to, data belongs to the fit
+  int32_t fitQuality = 0;
+  int32_t overQuality = maxQuality + 1;
+  std::vector<uint8_t> overData;
+  bool settled = false;
+  auto consider = [&](int32_t quality, std::vector<uint8_t> &&data) {
+    ++result.encodes;
+    if (data.size() <= maxBytes) {
+      if (quality > fitQuality) {
+        fitQuality = quality;
+        result.data = std::move(data);
+        settled = result.data.size() >= static_cast<size_t>(maxBytes * kSizeSearchSlack);
+      }
+    } else if (quality < overQuality) {
+      overQuality = quality;
+      overData = std::move(data);
+    }
+  };
+
+  // Fast probes on the same planes give the shape of the curve, at Fast they are the real thing
+  const bool probesAreFinal = options.speed == EncodeSpeed::Fast;
+  const int32_t lowProbe = std::max(1, maxQuality / 2);
+  std::vector<uint8_t> highData = encodePreparedAt(prepared.get(), options, maxQuality,
+                                                   EncodeSpeed::Fast);
+  const size_t highBytes = highData.size();
+  size_t lowBytes = highBytes;
+  if (probesAreFinal) {
+    consider(maxQuality, std::move(highData));
+  }
+  if (lowProbe < maxQuality && !settled && fitQuality < maxQuality) {
+    std::vector<uint8_t> lowData = encodePreparedAt(prepared.get(), options, lowProbe,
+                                                    EncodeSpeed::Fast);
+    lowBytes = lowData.size();
+    if (probesAreFinal) {
+      consider(lowProbe, std::move(lowData));
+    }
+  }
+
+  SizeModel model(lowProbe, lowBytes, maxQuality, highBytes);
+  while (!settled && overQuality - fitQuality > 1 && result.encodes < kMaxSizeSearchEncodes) {
+    int32_t quality = std::clamp(model.qualityFor(maxBytes), fitQuality + 1, overQuality - 1);
+    // A prediction stuck on the edge of a wide bracket falls back to bisection
+    if (result.encodes >= 2 && fitQuality > 0 && overQuality <= maxQuality
+        && overQuality - fitQuality > 4
+        && (quality == fitQuality + 1 || quality == overQuality - 1)) {
+      quality = fitQuality + (overQuality - fitQuality) / 2;
+    }
+    std::vector<uint8_t> data = encodePreparedAt(prepared.get(), options, quality, options.speed);
+    model.calibrate(quality, data.size());
+    consider(quality, std::move(data));
+  }
+
+  if (fitQuality == 0 && overQuality > 1) {
+    // Out of attempts without a fit, the lowest quality is the only candidate left
+    consider(1, encodePreparedAt(prepared.get(), options, 1, options.speed));
+  }
+  if (fitQuality == 0) {
+    result.data = std::move(overData);
+    result.quality = 1;
+    result.fits = false;
+    return result;
+  }
+  result.quality = fitQuality;
+  result.fits = true;
+  return result;
+}
+
+DeadlineEncodeResult EncodeImageWithin(const ImageView &image,
+                                       const EncodeOptions &options,
+                                       uint32_t deadlineMs) {
+  const EncodePlan plan = PlanEncode(image.width, image.height, options.lossless, deadlineMs);
+  const auto start = std::chrono::steady_clock::now();
+
+  EncodeOptions planned = options;
+  planned.speed = plan.speed;
+  WeaveAv1PrepareResult prepareResult = weave_av1_prepare(toWeaveBuffer(image),
+                                                          toWeaveOptions(planned));
+  std::unique_ptr<WeaveAv1Prepared, PreparedDeleter> prepared(prepareResult.prepared);
+  if (prepareResult.error || !prepared) {
+    std::string message = prepareResult.error ? prepareResult.error : "AVIF encoding has failed";
+    weave_av1_prepare_error_free(prepareResult.error);
+    throw std::runtime_error(message);
+  }
+  ScopedEncodedImage encoded{weave_av1_encode_prepared(prepared.get(), options.exif,
+                                                       options.exifSize, toWeaveOptions(planned),
+                                                       plan.threads)};
+  if (encoded.image.error || !encoded.image.data) {
+    throw std::runtime_error(encoded.image.error ? encoded.image.error
+                                                 : "AVIF encoding has failed");
+  }
+
+  const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+      std::chrono::steady_clock::now() - start).count();
+  RecordEncode(image.width, image.height, options.lossless, plan, static_cast<uint64_t>(elapsed));
+  return DeadlineEncodeResult{
+      .data = std::vector<uint8_t>(encoded.image.data, encoded.image.data + encoded.image.length),
+      .speed = plan.speed,
+      .threads = plan.threads,
+      .expectedMs = plan.expectedMs,
+      .actualMs = static_cast<uint32_t>(std::min<int64_t>(elapsed, UINT32_MAX)),
+  };
+}
+
+}
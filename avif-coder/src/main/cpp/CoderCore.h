@@ -0,0 +1,233 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_CODERCORE_H_
+#define AVIF_CODER_SRC_MAIN_CPP_CODERCORE_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <vector>
+#include "ColorConfig.h"
+#include "DecodeAdmission.h"
+#include "DecodeStats.h"
+#include "SizeScaler.h"
+#include "definitions.h"
+
+/**
+ * JNI free entry points of the coder. libcoder only adapts Java objects
+ * to these, host tools and servers link coder_core directly.
+ */
+namespace coder {
+
+struct DecodeOptions {
+  // Non positive keeps the original size
+  int32_t scaledWidth = 0;
+  int32_t scaledHeight = 0;
+  ScaleMode scaleMode = Fit;
+  // Hardware is not available here and behaves as Default
+  PreferredColorConfig colorConfig = Default;
+  int scalingQuality = 0;
+  DecodeStats *stats = nullptr;
+};
+
+struct DecodedImage {
+  aligned_uint8_vector pixels;
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  PixelFormat format;
+  uint32_t bitDepth;
+  // Alpha is always premultiplied
+  bool hasAlpha;
+  // Keeps decode memory reserved while pixels are alive
+  DecodeAdmissionTicket admission;
+};
+
+struct ImageView {
+  const uint8_t *pixels;
+  uint32_t width;
+  uint32_t height;
+  uint32_t stride;
+  // Rgba16 is not accepted by the encoder
+  PixelFormat format;
+  bool premultiplied;
+};
+
+// Caller owned YUV planes, samples are u8 for 8 bit and native endian u16 above
+struct YuvImageView {
+  const uint8_t *y;
+  uint32_t yStride;
+  const uint8_t *u;
+  uint32_t uStride;
+  const uint8_t *v;
+  uint32_t vStride;
+  // Samples between two chroma samples of a row, 2 when U and V are interleaved
+  uint32_t chromaPixelStride;
+  // Nullptr when there is no alpha
+  const uint8_t *a;
+  uint32_t aStride;
+  uint32_t width;
+  uint32_t height;
+  // 8 or 10
+  uint32_t bitDepth;
+  // u16 samples keep their bits at the top, as in P010
+  bool msbAligned;
+  // AvifChromaSubsampling value describing the planes
+  int32_t chromaSubsampling;
+  // ITU-T H.273 code points
+  uint16_t colorPrimaries;
+  uint16_t transferCharacteristics;
+  uint16_t matrixCoefficients;
+  bool fullRange;
+};
+
+enum class EncodeSpeed : uint32_t {
+  Slow = 0,
+  Medium = 1,
+  Fast = 2,
+};
+
+struct EncodeOptions {
+  // ADataSpace of the pixels, 0 (unknown) is treated as sRGB
+  int32_t colorSpace = 0;
+  int32_t quality = 80;
+  bool lossless = false;
+  // AvifChromaSubsampling value, 0 chooses 4:2:0
+  int32_t chromaSubsampling = 0;
+  EncodeSpeed speed = EncodeSpeed::Medium;
+  bool screenContentCoding = false;
+  const uint8_t *exif = nullptr;
+  size_t exifSize = 0;
+};
+
+// Decodes the first image of an AVIF file, throws std::runtime_error on failure
+DecodedImage DecodeImage(const uint8_t *data, size_t size, const DecodeOptions &options);
+
+/**
+ * Encodes AVIF/AV1. Colour and a non-constant alpha are coded concurrently, the
+ * cores split between them by sample count; constant alpha is dropped.
+ * Throws std::runtime_error on failure.
+ */
+std::vector<uint8_t> EncodeImage(const ImageView &image, const EncodeOptions &options);
+
+/**
+ * Encodes AVIF/AV1 straight from YUV planes without any colour conversion.
+ * Colour space and chroma subsampling of options are ignored, the image describes
+ * them. Throws std::runtime_error on failure.
+ */
+std::vector<uint8_t> EncodeYuvImage(const YuvImageView &image, const EncodeOptions &options);
+
+/**
+ * Transcodes HEIC to AVIF/AV1 without leaving YUV: the HEVC planes go to the encoder
+ * as they are, with alpha, ICC, Exif, orientation and clean aperture carried over.
+ * Only GBR and matrices AV1 can't signal, or a clean aperture libavif can't carry,
+ * are converted through RGB. 12 bit planes are rounded to 10 bits. Colour space and
+ * chroma subsampling of options are ignored, the source keeps its own.
+ * Throws std::runtime_error on failure.
+ */
+std::vector<uint8_t> TranscodeHeic(const uint8_t *data, size_t size, const EncodeOptions &options);
+
+/**
+ * Encodes AVIF/AV1 as a grid of tileSize x tileSize cells. Cells are converted and
+ * encoded independently on every core in raster order, only the cells in flight hold
+ * YUV planes, and decoders may decode them in parallel later. tileSize is rounded
+ * down to even and raised to 64. Images fitting a single cell, and images whose odd
+ * size can't be split under the chosen chroma subsampling, go through EncodeImage.
+ * Throws std::runtime_error on failure.
+ */
+std::vector<uint8_t> EncodeImageGrid(const ImageView &image,
+                                     const EncodeOptions &options,
+                                     uint32_t tileSize);
+
+struct SizedEncodeResult {
+  std::vector<uint8_t> data;
+  int32_t quality = 0;
+  // Encodes at the requested speed spent by the search, Fast probes excluded
+  uint32_t encodes = 0;
+  // Unset when even quality 1 exceeds the budget, data then holds that encode
+  bool fits = false;
+};
+
+/**
+ * Encodes AVIF/AV1 at the highest quality up to options.quality whose file fits in
+ * maxBytes. RGB -> YUV runs once. Two Fast probes on the same planes estimate the
+ * quality/size curve, then full encodes search around its prediction, recalibrating
+ * it with every result. Lossless is not searched. Throws std::runtime_error on failure.
+ */
+SizedEncodeResult EncodeImageToSize(const ImageView &image,
+                                    const EncodeOptions &options,
+                                    size_t maxBytes);
+
+struct DeadlineEncodeResult {
+  std::vector<uint8_t> data;
+  EncodeSpeed speed;
+  uint32_t threads;
+  uint32_t expectedMs;
+  uint32_t actualMs;
+};
+
+/**
+ * Encodes AVIF/AV1 with the slowest speed and the threads PlanEncode expects to
+ * finish within deadlineMs, options.speed is ignored. The measured time calibrates
+ * later plans, see SetEncodeCalibrationPath. Throws std::runtime_error on failure.
+ */
+DeadlineEncodeResult EncodeImageWithin(const ImageView &image,
+                                       const EncodeOptions &options,
+                                       uint32_t deadlineMs);
+
+struct BatchEncodeItem {
+  ImageView image;
+  int32_t colorSpace;
+  // Copied, doesn't have to outlive the release of the item
+  const uint8_t *exif;
+  size_t exifSize;
+};
+
+// Item index has to stay readable until the matching BatchItemRelease call
+using BatchItemSource = std::function<BatchEncodeItem(size_t index)>;
+using BatchItemRelease = std::function<void(size_t index)>;
+using BatchEncodedSink = std::function<void(size_t index, const uint8_t *data, size_t size)>;
+
+/**
+ * Encodes count images with one set of options, the colour space and exif of
+ * options are replaced by the ones of every item. RGB -> YUV of image k + 1 runs
+ * on the calling thread while a single encoder thread works on image k with the
+ * remaining cores, the last image gets all of them. Every callback runs on the
+ * calling thread and images reach the sink in order. Throws std::runtime_error
+ * on the first failure, nothing after it is delivered.
+ */
+void EncodeImages(size_t count,
+                  const EncodeOptions &options,
+                  const BatchItemSource &acquire,
+                  const BatchItemRelease &release,
+                  const BatchEncodedSink &sink);
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_CODERCORE_H_
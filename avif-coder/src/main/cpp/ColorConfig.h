@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_COLORCONFIG_H_
+#define AVIF_CODER_SRC_MAIN_CPP_COLORCONFIG_H_
+
+#include <cstdint>
+
+enum PreferredColorConfig {
+  Default = 1,
+  Rgba_8888 = 2,
+  Rgba_F16 = 3,
+  Rgb_565 = 4,
+  Rgba_1010102 = 5,
+  Hardware = 6
+};
+
+namespace coder {
+
+// Memory layout of a decoded or to be encoded image
+enum class PixelFormat : uint32_t {
+  // 4 x u8, R, G, B, A
+  Rgba8888 = 0,
+  // 4 x u16 holding bitDepth significant bits
+  Rgba16 = 1,
+  // 4 x f16
+  RgbaF16 = 2,
+  // One packed u16, 5/6/5 bits
+  Rgb565 = 3,
+  // One packed u32, 10/10/10/2 bits
+  Rgba1010102 = 4,
+};
+
+constexpr uint32_t PixelFormatBytes(PixelFormat format) {
+  switch (format) {
+    case PixelFormat::Rgba16:
+    case PixelFormat::RgbaF16:return 8;
+    case PixelFormat::Rgb565:return 2;
+    default:return 4;
+  }
+}
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_COLORCONFIG_H_
@@ -0,0 +1,263 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "DecodeAdmission.h"
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+#include <unistd.h>
+
+namespace {
+constexpr uint64_t kMinimumDecodeBudget = 128ull * 1024ull * 1024ull;
+
+std::mutex gAdmissionMutex;
+std::condition_variable gAdmissionCondition;
+uint64_t gInFlightBytes = 0;
+std::atomic<uint64_t> gBudgetOverride{0};
+
+uint64_t defaultDecodeBudget() {
+  long pages = sysconf(_SC_PHYS_PAGES);
+  long pageSize = sysconf(_SC_PAGE_SIZE);
+  if (pages <= 0 || pageSize <= 0) {
+    return kMinimumDecodeBudget;
+  }
+  // Keep decodes within a quarter of physical memory, the rest belongs
+  // to the app, the Java heap and graphics buffers
+  uint64_t physical = static_cast<uint64_t>(pages) * static_cast<uint64_t>(pageSize);
+  return std::max(physical / 4, kMinimumDecodeBudget);
+}
+
+uint64_t roundedRatio(uint64_t numerator, uint64_t denominator) {
+  return (numerator + denominator / 2) / denominator;
+}
+
+uint64_t planeBytes(uint64_t width, uint64_t height, uint32_t bitDepth) {
+  return width * height * (bitDepth > 8 ? sizeof(uint16_t) : sizeof(uint8_t));
+}
+
+uint64_t yuvBytes(uint32_t width, uint32_t height, uint32_t bitDepth,
+                  uint32_t chromaLayout, bool hasAlpha) {
+  uint64_t chromaWidth = width;
+  uint64_t chromaHeight = height;
+  if (chromaLayout == 1) {
+    chromaWidth = (width + 1) / 2;
+    chromaHeight = (height + 1) / 2;
+  } else if (chromaLayout == 2) {
+    chromaWidth = (width + 1) / 2;
+  }
+  uint64_t total = planeBytes(width, height, bitDepth);
+  if (chromaLayout != 0) {
+    total += 2 * planeBytes(chromaWidth, chromaHeight, bitDepth);
+  }
+  if (hasAlpha) {
+    total += planeBytes(width, height, bitDepth);
+  }
+  return total;
+}
+
+uint64_t outputPixelSize(PreferredColorConfig config, bool is16Bit) {
+  switch (config) {
+    case Rgba_8888:
+    case Rgba_1010102:return 4;
+    case Rgba_F16:return 8;
+    case Rgb_565:return 2;
+    default:return is16Bit ? 8 : 4;
+  }
+}
+
+uint64_t estimate(const coder::DecodeMemoryRequest &request,
+                  uint32_t yuvWidth, uint32_t yuvHeight) {
+  const bool is16Bit = request.bitDepth > 8;
+  const uint64_t rgbaPixelSize = is16Bit ? 4 * sizeof(uint16_t) : 4 * sizeof(uint8_t);
+
+  uint32_t outWidth = 0, outHeight = 0;
+  coder::ComputeScaledDimensions(yuvWidth, yuvHeight,
+                                 request.scaledWidth, request.scaledHeight,
+                                 request.scaleMode, &outWidth, &outHeight);
+
+  const uint64_t decoded = yuvBytes(request.width, request.height, request.bitDepth,
+                                    request.chromaLayout, request.hasAlpha);
+  uint64_t scaledPlanes = 0;
+  if (yuvWidth != request.width || yuvHeight != request.height) {
+    scaledPlanes = yuvBytes(yuvWidth, yuvHeight, request.bitDepth,
+                            request.chromaLayout, request.hasAlpha);
+  }
+  const uint64_t rgba = static_cast<uint64_t>(yuvWidth) * yuvHeight * rgbaPixelSize;
+  const uint64_t rescaled = static_cast<uint64_t>(outWidth) * outHeight * rgbaPixelSize;
+  const uint64_t output = static_cast<uint64_t>(outWidth) * outHeight
+      * outputPixelSize(request.colorConfig, is16Bit);
+
+  // Decoded planes, the RGBA weave target and the rescaled copy coexist
+  // in RescaleSourceImage; afterwards only the rescaled store, the reformatted
+  // copy and the Bitmap pixels are alive
+  const uint64_t rescaleStage = decoded + scaledPlanes + rgba + rescaled;
+  const uint64_t reformatStage = decoded + rescaled + 2 * output;
+  return std::max(rescaleStage, reformatStage);
+}
+}
+
+namespace coder {
+
+DecodeAdmissionTicket::DecodeAdmissionTicket(DecodeAdmissionTicket &&other) noexcept
+    : bytes(other.bytes) {
+  other.bytes = 0;
+}
+
+DecodeAdmissionTicket &DecodeAdmissionTicket::operator=(DecodeAdmissionTicket &&other) noexcept {
+  if (this != &other) {
+    release();
+    bytes = other.bytes;
+    other.bytes = 0;
+  }
+  return *this;
+}
+
+DecodeAdmissionTicket::~DecodeAdmissionTicket() {
+  release();
+}
+
+void DecodeAdmissionTicket::release() noexcept {
+  if (bytes == 0) {
+    return;
+  }
+  {
+    std::lock_guard guard(gAdmissionMutex);
+    gInFlightBytes -= std::min(gInFlightBytes, bytes);
+  }
+  bytes = 0;
+  gAdmissionCondition.notify_all();
+}
+
+void SetDecodeMemoryBudget(uint64_t bytes) noexcept {
+  gBudgetOverride.store(bytes, std::memory_order_relaxed);
+  {
+    // A waiter between its predicate and its sleep holds the mutex, so it can't miss the store
+    std::lock_guard guard(gAdmissionMutex);
+  }
+  gAdmissionCondition.notify_all();
+}
+
+uint64_t GetDecodeMemoryBudget() noexcept {
+  uint64_t budget = gBudgetOverride.load(std::memory_order_relaxed);
+  if (budget != 0) {
+    return budget;
+  }
+  static const uint64_t defaultBudget = defaultDecodeBudget();
+  return defaultBudget;
+}
+
+uint64_t GetDecodeMemoryInFlight() noexcept {
+  std::lock_guard guard(gAdmissionMutex);
+  return gInFlightBytes;
+}
+
+void ComputeScaledDimensions(uint32_t width, uint32_t height,
+                             int32_t scaledWidth, int32_t scaledHeight,
+                             ScaleMode scaleMode,
+                             uint32_t *outWidth, uint32_t *outHeight) {
+  if (scaledWidth <= 0 || scaledHeight <= 0 || width == 0 || height == 0) {
+    *outWidth = width;
+    *outHeight = height;
+    return;
+  }
+  const auto targetWidth = static_cast<uint64_t>(scaledWidth);
+  const auto targetHeight = static_cast<uint64_t>(scaledHeight);
+  if (scaleMode == Fit) {
+    if (targetWidth * height <= targetHeight * width) {
+      *outWidth = static_cast<uint32_t>(targetWidth);
+      *outHeight = static_cast<uint32_t>(std::clamp<uint64_t>(
+          roundedRatio(static_cast<uint64_t>(height) * targetWidth, width), 1, targetHeight));
+    } else {
+      *outWidth = static_cast<uint32_t>(std::clamp<uint64_t>(
+          roundedRatio(static_cast<uint64_t>(width) * targetHeight, height), 1, targetWidth));
+      *outHeight = static_cast<uint32_t>(targetHeight);
+    }
+    return;
+  }
+  *outWidth = static_cast<uint32_t>(targetWidth);
+  *outHeight = static_cast<uint32_t>(targetHeight);
+}
+
+uint64_t EstimateDecodePeakBytes(const DecodeMemoryRequest &request) {
+  return estimate(request, request.width, request.height);
+}
+
+DecodeAdmissionTicket AdmitDecode(const DecodeMemoryRequest &request, DecodeAdmissionPlan *plan) {
+  const uint64_t fullEstimate = EstimateDecodePeakBytes(request);
+
+  // Planes might be shrunk before YUV -> RGB only when the final image is
+  // smaller than the source along both axes. Fill crops after scaling, so
+  // the planes are scaled to cover the target and the crop stays in RGBA.
+  uint32_t yuvWidth = request.width;
+  uint32_t yuvHeight = request.height;
+  bool canDownscale = false;
+  if (request.allowYuvDownscale && request.scaledWidth > 0 && request.scaledHeight > 0
+      && request.width > 0 && request.height > 0) {
+    if (request.scaleMode == Fill) {
+      const double ratio = std::max(static_cast<double>(request.scaledWidth) / request.width,
+                                    static_cast<double>(request.scaledHeight) / request.height);
+      if (ratio < 1.0) {
+        yuvWidth = std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(request.width * ratio)));
+        yuvHeight =
+            std::max<uint32_t>(1, static_cast<uint32_t>(std::ceil(request.height * ratio)));
+      }
+    } else {
+      ComputeScaledDimensions(request.width, request.height,
+                              request.scaledWidth, request.scaledHeight,
+                              request.scaleMode, &yuvWidth, &yuvHeight);
+    }
+    canDownscale = yuvWidth < request.width && yuvHeight < request.height;
+  }
+  const uint64_t downscaledEstimate = canDownscale ? estimate(request, yuvWidth, yuvHeight)
+                                                   : fullEstimate;
+
+  std::unique_lock lock(gAdmissionMutex);
+  const uint64_t budget = GetDecodeMemoryBudget();
+  const uint64_t available = budget > gInFlightBytes ? budget - gInFlightBytes : 0;
+
+  // Full quality path is preferred whenever it fits right now; otherwise it is
+  // cheaper to degrade the resampling than to wait for other decodes
+  bool downscale = canDownscale && (request.preferYuvDownscale || fullEstimate > available);
+  uint64_t reserve = downscale ? downscaledEstimate : fullEstimate;
+
+  gAdmissionCondition.wait(lock, [&] {
+    const uint64_t currentBudget = GetDecodeMemoryBudget();
+    return gInFlightBytes == 0 || gInFlightBytes + reserve <= currentBudget;
+  });
+  gInFlightBytes += reserve;
+
+  plan->estimatedBytes = reserve;
+  plan->downscaleInYuv = downscale;
+  plan->yuvWidth = downscale ? yuvWidth : request.width;
+  plan->yuvHeight = downscale ? yuvHeight : request.height;
+  return DecodeAdmissionTicket(reserve);
+}
+
+}
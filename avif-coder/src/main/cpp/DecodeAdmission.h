@@ -0,0 +1,109 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_DECODEADMISSION_H_
+#define AVIF_CODER_SRC_MAIN_CPP_DECODEADMISSION_H_
+
+#include <cstdint>
+#include "SizeScaler.h"
+#include "ColorConfig.h"
+
+namespace coder {
+
+struct DecodeMemoryRequest {
+  uint32_t width;
+  uint32_t height;
+  uint32_t bitDepth;
+  // 0 - 4:0:0, 1 - 4:2:0, 2 - 4:2:2, 3 - 4:4:4
+  uint32_t chromaLayout;
+  bool hasAlpha;
+  // Pipeline is able to shrink planes before YUV -> RGB
+  bool allowYuvDownscale;
+  // Shrink planes whenever allowed even if the full size path fits, for previews
+  bool preferYuvDownscale;
+  int32_t scaledWidth;
+  int32_t scaledHeight;
+  ScaleMode scaleMode;
+  PreferredColorConfig colorConfig;
+};
+
+struct DecodeAdmissionPlan {
+  uint64_t estimatedBytes;
+  // When set, planes have to be scaled to yuvWidth x yuvHeight before YUV -> RGB
+  bool downscaleInYuv;
+  uint32_t yuvWidth;
+  uint32_t yuvHeight;
+};
+
+/**
+ * Releases reserved decode budget on destruction.
+ * Empty ticket holds nothing.
+ */
+class DecodeAdmissionTicket {
+ public:
+  DecodeAdmissionTicket() = default;
+  DecodeAdmissionTicket(const DecodeAdmissionTicket &) = delete;
+  DecodeAdmissionTicket &operator=(const DecodeAdmissionTicket &) = delete;
+  DecodeAdmissionTicket(DecodeAdmissionTicket &&other) noexcept;
+  DecodeAdmissionTicket &operator=(DecodeAdmissionTicket &&other) noexcept;
+  ~DecodeAdmissionTicket();
+
+  void release() noexcept;
+  [[nodiscard]] uint64_t reservedBytes() const noexcept { return bytes; }
+
+ private:
+  explicit DecodeAdmissionTicket(uint64_t bytes) : bytes(bytes) {}
+  friend DecodeAdmissionTicket AdmitDecode(const DecodeMemoryRequest &request,
+                                           DecodeAdmissionPlan *plan);
+
+  uint64_t bytes = 0;
+};
+
+// Process wide budget for all in-flight decodes, 0 restores the default
+void SetDecodeMemoryBudget(uint64_t bytes) noexcept;
+uint64_t GetDecodeMemoryBudget() noexcept;
+uint64_t GetDecodeMemoryInFlight() noexcept;
+
+// Output size of the rescale step for the given scale mode
+void ComputeScaledDimensions(uint32_t width, uint32_t height,
+                             int32_t scaledWidth, int32_t scaledHeight,
+                             ScaleMode scaleMode,
+                             uint32_t *outWidth, uint32_t *outHeight);
+
+uint64_t EstimateDecodePeakBytes(const DecodeMemoryRequest &request);
+
+/**
+ * Chooses between full decode and YUV-domain downscale, then blocks until
+ * the chosen amount fits into the budget. A request is always admitted when
+ * nothing else is in flight, so a single oversized image still decodes.
+ */
+DecodeAdmissionTicket AdmitDecode(const DecodeMemoryRequest &request, DecodeAdmissionPlan *plan);
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_DECODEADMISSION_H_
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "DecodeStats.h"
+#include <ctime>
+#include "AllocationTracker.h"
+
+namespace {
+uint64_t clockNanos(clockid_t clock) {
+  timespec ts = {0};
+  if (clock_gettime(clock, &ts) != 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(ts.tv_sec) * 1000000000ull + static_cast<uint64_t>(ts.tv_nsec);
+}
+}
+
+namespace coder {
+
+ScopedDecodeStage::ScopedDecodeStage(DecodeStats *stats, DecodeStage stage)
+    : stats(stats), stage(stage) {
+#if AVIF_CODER_TRACK_ALLOCATIONS
+  previousTrackedStage = EnterTrackedStage(stage);
+  tracking = true;
+#endif
+  if (stats) {
+    wallStart = clockNanos(CLOCK_MONOTONIC);
+    cpuStart = clockNanos(CLOCK_THREAD_CPUTIME_ID);
+  }
+}
+
+ScopedDecodeStage::~ScopedDecodeStage() {
+  stop();
+}
+
+void ScopedDecodeStage::stop() {
+  if (tracking) {
+    LeaveTrackedStage(previousTrackedStage);
+    tracking = false;
+  }
+  if (!stats) {
+    return;
+  }
+  const uint64_t wallEnd = clockNanos(CLOCK_MONOTONIC);
+  const uint64_t cpuEnd = clockNanos(CLOCK_THREAD_CPUTIME_ID);
+  auto &entry = stats->stages[static_cast<uint32_t>(stage)];
+  entry.wallNanos += wallEnd > wallStart ? wallEnd - wallStart : 0;
+  entry.cpuNanos += cpuEnd > cpuStart ? cpuEnd - cpuStart : 0;
+  stats = nullptr;
+}
+
+void RecordDecodeAllocation(DecodeStats *stats, DecodeStage stage, uint64_t bytes) {
+  if (stats) {
+    stats->addAllocation(stage, bytes);
+  }
+}
+
+}
@@ -0,0 +1,103 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_DECODESTATS_H_
+#define AVIF_CODER_SRC_MAIN_CPP_DECODESTATS_H_
+
+#include <cstdint>
+
+namespace coder {
+
+// Order matches DecodeStage.kt
+enum class DecodeStage : uint32_t {
+  ContainerSniff = 0,
+  Parse = 1,
+  // avifDecoderNthImage, or the whole avifweaver pipeline for HEIC and AV2
+  Decode = 2,
+  YuvToRgba = 3,
+  Rescale = 4,
+  ColorManagement = 5,
+  Reformat = 6,
+  BitmapCopy = 7,
+  Count = 8,
+};
+
+struct DecodeStageStats {
+  uint64_t wallNanos;
+  // CPU time of the decoding thread, every stage runs there. Work the AV1 decoder
+  // hands to its own worker threads can't be attributed and is not included
+  uint64_t cpuNanos;
+  // Estimate from the sizes of the buffers the pipeline requested, allocator
+  // overhead and codec internals are not counted
+  uint64_t estimatedAllocatedBytes;
+};
+
+struct DecodeStats {
+  DecodeStageStats stages[static_cast<uint32_t>(DecodeStage::Count)] = {};
+  uint64_t colorObuSize = 0;
+  uint64_t alphaObuSize = 0;
+  // Threads the AV1 decoder was allowed to use
+  int32_t decoderThreads = 0;
+  // Threads that ran YUV conversion, scaling and color management
+  int32_t conversionThreads = 0;
+
+  void addAllocation(DecodeStage stage, uint64_t bytes) {
+    stages[static_cast<uint32_t>(stage)].estimatedAllocatedBytes += bytes;
+  }
+};
+
+/**
+ * Accumulates elapsed wall time and the CPU time of the current thread into the
+ * stage on destruction or stop(), so other decodes running concurrently don't inflate it.
+ * Null stats make it a no-op, so call sites don't need to branch.
+ * With allocation tracking compiled in, it also marks the stage allocations belong to.
+ */
+class ScopedDecodeStage {
+ public:
+  ScopedDecodeStage(DecodeStats *stats, DecodeStage stage);
+  ScopedDecodeStage(const ScopedDecodeStage &) = delete;
+  ScopedDecodeStage &operator=(const ScopedDecodeStage &) = delete;
+  ~ScopedDecodeStage();
+
+  void stop();
+
+ private:
+  DecodeStats *stats;
+  DecodeStage stage;
+  uint64_t wallStart = 0;
+  uint64_t cpuStart = 0;
+  uint32_t previousTrackedStage = 0;
+  bool tracking = false;
+};
+
+// Safe to call with null stats
+void RecordDecodeAllocation(DecodeStats *stats, DecodeStage stage, uint64_t bytes);
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_DECODESTATS_H_
@@ -0,0 +1,230 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "EncodeDeadline.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdio>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include <unistd.h>
+
+namespace {
+// Pixels a single thread is worth giving to the encoder, smaller images get fewer threads
+constexpr uint64_t kPixelsPerThread = 256 * 512;
+// Weight of a new measurement once the model has seen a few
+constexpr double kMinimumSampleWeight = 0.25;
+constexpr const char *kCalibrationHeader = "avif-coder-encode-throughput 1";
+
+struct Throughput {
+  // Pixels per millisecond of one core at full clock, prepare and encode together
+  double pixelsPerMs;
+  uint32_t samples;
+};
+
+// Conservative first guesses indexed by [lossless][EncodeSpeed], replaced by measurements
+constexpr std::array<std::array<Throughput, 3>, 2> kDefaultThroughput = {{
+    {{{150.0, 0}, {600.0, 0}, {2000.0, 0}}},
+    {{{75.0, 0}, {300.0, 0}, {1000.0, 0}}},
+}};
+
+using ThroughputTable = std::array<std::array<Throughput, 3>, 2>;
+
+std::mutex gCalibrationMutex;
+ThroughputTable gThroughput = kDefaultThroughput;
+std::string gCalibrationPath;
+// Bumped with every measurement, so a stale table is never written over a newer one
+uint64_t gCalibrationGeneration = 0;
+
+// Serializes writes of the file, held without gCalibrationMutex so planning never waits on I/O
+std::mutex gCalibrationFileMutex;
+uint64_t gSavedGeneration = 0;
+
+Throughput &throughputOf(bool lossless, coder::EncodeSpeed speed) {
+  return gThroughput[lossless ? 1 : 0][static_cast<uint32_t>(speed)];
+}
+
+bool readSysfsValue(const std::string &path, uint64_t *value) {
+  FILE *file = std::fopen(path.c_str(), "r");
+  if (file == nullptr) {
+    return false;
+  }
+  unsigned long long parsed = 0;
+  const bool ok = std::fscanf(file, "%llu", &parsed) == 1 && parsed > 0;
+  std::fclose(file);
+  *value = parsed;
+  return ok;
+}
+
+uint32_t onlineCores() {
+  return std::max<uint32_t>(1, std::thread::hardware_concurrency());
+}
+
+// Entries of the file replace the ones measured so far, a missing file keeps them
+void loadCalibrationLocked() {
+  if (gCalibrationPath.empty()) {
+    return;
+  }
+  std::ifstream input(gCalibrationPath);
+  std::string header;
+  if (!std::getline(input, header) || header != kCalibrationHeader) {
+    return;
+  }
+  uint32_t lossless, speed, samples;
+  double pixelsPerMs;
+  while (input >> lossless >> speed >> pixelsPerMs >> samples) {
+    if (lossless < 2 && speed < 3 && std::isfinite(pixelsPerMs) && pixelsPerMs > 0) {
+      gThroughput[lossless][speed] = Throughput{pixelsPerMs, samples};
+    }
+  }
+}
+
+// Writes a table taken under gCalibrationMutex, called without holding it
+void saveCalibration(const std::string &path, const ThroughputTable &table, uint64_t generation) {
+  if (path.empty()) {
+    return;
+  }
+  std::lock_guard guard(gCalibrationFileMutex);
+  if (generation <= gSavedGeneration) {
+    return;
+  }
+  // Written aside and renamed, a concurrent reader never sees half a file
+  const std::string temporary = path + ".tmp";
+  {
+    std::ofstream output(temporary, std::ios::trunc);
+    if (!output) {
+      return;
+    }
+    output << kCalibrationHeader << '\n';
+    for (uint32_t lossless = 0; lossless < 2; ++lossless) {
+      for (uint32_t speed = 0; speed < 3; ++speed) {
+        const Throughput &entry = table[lossless][speed];
+        output << lossless << ' ' << speed << ' ' << entry.pixelsPerMs << ' '
+               << entry.samples << '\n';
+      }
+    }
+    if (!output) {
+      return;
+    }
+  }
+  if (std::rename(temporary.c_str(), path.c_str()) == 0) {
+    gSavedGeneration = generation;
+  }
+}
+}
+
+namespace coder {
+
+double GovernorCoreBudget() {
+  const long configured = sysconf(_SC_NPROCESSORS_CONF);
+  std::vector<std::pair<uint64_t, uint64_t>> limits;
+  uint64_t fastestCore = 0;
+  for (long cpu = 0; cpu < configured; ++cpu) {
+    const std::string base = "/sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/cpufreq/";
+    uint64_t allowed = 0, maximum = 0;
+    // Offline cores have no readable cpufreq and add nothing
+    if (readSysfsValue(base + "scaling_max_freq", &allowed)
+        && readSysfsValue(base + "cpuinfo_max_freq", &maximum)) {
+      limits.emplace_back(allowed, maximum);
+      fastestCore = std::max(fastestCore, maximum);
+    }
+  }
+  if (limits.empty()) {
+    return static_cast<double>(onlineCores());
+  }
+  // Little cores count as the fraction of a big core their clock allows
+  double budget = 0;
+  for (const auto &[allowed, maximum] : limits) {
+    budget += static_cast<double>(std::min(allowed, maximum)) / static_cast<double>(fastestCore);
+  }
+  return budget;
+}
+
+EncodePlan PlanEncode(uint32_t width, uint32_t height, bool lossless, uint32_t deadlineMs) {
+  const uint64_t pixels = std::max<uint64_t>(1, static_cast<uint64_t>(width) * height);
+  const uint32_t cores = onlineCores();
+  const auto threads = static_cast<uint32_t>(std::clamp<uint64_t>(
+      (pixels + kPixelsPerThread - 1) / kPixelsPerThread, 1, cores));
+  const double coreScale = std::clamp(GovernorCoreBudget() / cores, 0.05, 1.0);
+
+  std::lock_guard guard(gCalibrationMutex);
+  EncodePlan plan{};
+  for (EncodeSpeed speed : {EncodeSpeed::Slow, EncodeSpeed::Medium, EncodeSpeed::Fast}) {
+    const double expected = static_cast<double>(pixels)
+        / (throughputOf(lossless, speed).pixelsPerMs * threads * coreScale);
+    plan = EncodePlan{
+        .speed = speed,
+        .threads = threads,
+        .expectedMs = static_cast<uint32_t>(std::min(std::ceil(expected), 4294967295.0)),
+        .coreScale = coreScale,
+    };
+    if (plan.expectedMs <= deadlineMs) {
+      break;
+    }
+  }
+  return plan;
+}
+
+void RecordEncode(uint32_t width, uint32_t height, bool lossless,
+                  const EncodePlan &plan, uint64_t elapsedMs) {
+  const uint64_t pixels = static_cast<uint64_t>(width) * height;
+  if (pixels == 0 || plan.threads == 0) {
+    return;
+  }
+  const double measured = static_cast<double>(pixels)
+      / (static_cast<double>(std::max<uint64_t>(elapsedMs, 1)) * plan.threads * plan.coreScale);
+
+  std::string path;
+  ThroughputTable table;
+  uint64_t generation;
+  {
+    std::lock_guard guard(gCalibrationMutex);
+    Throughput &entry = throughputOf(lossless, plan.speed);
+    // First measurements replace the guess quickly, later ones only nudge the average
+    const double weight = std::max(kMinimumSampleWeight, 1.0 / (entry.samples + 1.0));
+    entry.pixelsPerMs = entry.pixelsPerMs * (1.0 - weight) + measured * weight;
+    entry.samples = std::min<uint32_t>(entry.samples + 1, 1000);
+    path = gCalibrationPath;
+    table = gThroughput;
+    generation = ++gCalibrationGeneration;
+  }
+  saveCalibration(path, table, generation);
+}
+
+void SetEncodeCalibrationPath(const std::string &path) {
+  std::lock_guard guard(gCalibrationMutex);
+  gCalibrationPath = path;
+  loadCalibrationLocked();
+}
+
+}
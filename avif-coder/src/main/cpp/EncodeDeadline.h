@@ -0,0 +1,70 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_ENCODEDEADLINE_H_
+#define AVIF_CODER_SRC_MAIN_CPP_ENCODEDEADLINE_H_
+
+#include <cstdint>
+#include <string>
+#include "CoderCore.h"
+
+namespace coder {
+
+struct EncodePlan {
+  EncodeSpeed speed;
+  // Encoder threads, never more than the online cores
+  uint32_t threads;
+  uint32_t expectedMs;
+  // Share of full clock speed the governors allowed per core while planning
+  double coreScale;
+};
+
+/**
+ * Slowest speed expected to encode width x height within deadlineMs, together with
+ * the threads to run it on. Expectations come from the throughput measured by
+ * RecordEncode on this device, scaled by the clock limits the CPU frequency governors
+ * currently impose. Fast is returned when nothing fits.
+ */
+EncodePlan PlanEncode(uint32_t width, uint32_t height, bool lossless, uint32_t deadlineMs);
+
+// Feeds the wall time of an encode run with plan back into the throughput model
+void RecordEncode(uint32_t width, uint32_t height, bool lossless,
+                  const EncodePlan &plan, uint64_t elapsedMs);
+
+/**
+ * File the throughput model is loaded from right away and saved to after every
+ * recorded encode, so calibration survives restarts. Empty keeps it in memory.
+ */
+void SetEncodeCalibrationPath(const std::string &path);
+
+// Big core equivalents the frequency governors allow right now
+double GovernorCoreBudget();
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_ENCODEDEADLINE_H_
@@ -0,0 +1,82 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "FrameBufferPool.h"
+#include <algorithm>
+
+namespace coder {
+
+aligned_uint8_vector FrameBufferPool::acquire(size_t size) {
+  aligned_uint8_vector buffer;
+  {
+    std::lock_guard guard(this->mutex);
+    // Tightest fit keeps large buffers for large requests
+    auto best = this->buffers.end();
+    for (auto it = this->buffers.begin(); it != this->buffers.end(); ++it) {
+      if (it->capacity() >= size
+          && (best == this->buffers.end() || it->capacity() < best->capacity())) {
+        best = it;
+      }
+    }
+    if (best != this->buffers.end()) {
+      buffer = std::move(*best);
+      this->buffers.erase(best);
+    }
+  }
+  // Within capacity resize never reallocates, only grown tail is zeroed
+  buffer.resize(size);
+  return buffer;
+}
+
+void FrameBufferPool::recycle(aligned_uint8_vector &&buffer) {
+  if (buffer.capacity() == 0) {
+    return;
+  }
+  aligned_uint8_vector dropped;
+  std::lock_guard guard(this->mutex);
+  if (this->buffers.size() < this->maxBuffers) {
+    this->buffers.push_back(std::move(buffer));
+    return;
+  }
+  auto smallest = std::min_element(this->buffers.begin(), this->buffers.end(),
+                                   [](const aligned_uint8_vector &a,
+                                      const aligned_uint8_vector &b) {
+                                     return a.capacity() < b.capacity();
+                                   });
+  if (smallest != this->buffers.end() && smallest->capacity() < buffer.capacity()) {
+    dropped = std::move(*smallest);
+    *smallest = std::move(buffer);
+  }
+}
+
+void FrameBufferPool::clear() {
+  std::lock_guard guard(this->mutex);
+  this->buffers.clear();
+}
+
+}
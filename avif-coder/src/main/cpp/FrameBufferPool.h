@@ -0,0 +1,65 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_FRAMEBUFFERPOOL_H_
+#define AVIF_CODER_SRC_MAIN_CPP_FRAMEBUFFERPOOL_H_
+
+#include <cstddef>
+#include <mutex>
+#include <vector>
+#include "definitions.h"
+
+namespace coder {
+
+/**
+ * Small set of released frame buffers handed out again by size. Animation frames
+ * keep the same dimensions, so after the first frames every intermediate and output
+ * store is served from here and steady state playback doesn't touch the allocator.
+ */
+class FrameBufferPool {
+ public:
+  explicit FrameBufferPool(size_t maxBuffers = 4) : maxBuffers(maxBuffers) {}
+
+  FrameBufferPool(const FrameBufferPool &) = delete;
+  FrameBufferPool &operator=(const FrameBufferPool &) = delete;
+
+  // Buffer of exactly size bytes, contents are unspecified
+  aligned_uint8_vector acquire(size_t size);
+  // Takes the buffer back, the smallest one is dropped when the pool is full
+  void recycle(aligned_uint8_vector &&buffer);
+  void clear();
+
+ private:
+  std::vector<aligned_uint8_vector> buffers;
+  size_t maxBuffers;
+  std::mutex mutex;
+};
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_FRAMEBUFFERPOOL_H_
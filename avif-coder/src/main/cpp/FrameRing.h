@@ -0,0 +1,95 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_FRAMERING_H_
+#define AVIF_CODER_SRC_MAIN_CPP_FRAMERING_H_
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+namespace coder {
+
+/**
+ * Single producer, single consumer ring of preallocated slots. Neither side ever
+ * blocks: the producer fills the slot from beginWrite() and publishes it with
+ * commitWrite(), the consumer reads slots from peek() and releases them with pop().
+ * Slots are reused, so buffers inside them keep their capacity between frames.
+ */
+template<typename T>
+class SpscRing {
+ public:
+  explicit SpscRing(size_t capacity) : slots(capacity + 1) {}
+
+  SpscRing(const SpscRing &) = delete;
+  SpscRing &operator=(const SpscRing &) = delete;
+
+  // Producer side, nullptr when every slot is still owned by the consumer
+  T *beginWrite() {
+    const size_t tail = this->tail.load(std::memory_order_relaxed);
+    if (next(tail) == this->head.load(std::memory_order_acquire)) {
+      return nullptr;
+    }
+    return &slots[tail];
+  }
+
+  void commitWrite() {
+    const size_t tail = this->tail.load(std::memory_order_relaxed);
+    this->tail.store(next(tail), std::memory_order_release);
+  }
+
+  // Consumer side, offset 0 is the oldest published slot
+  T *peek(size_t offset = 0) {
+    const size_t head = this->head.load(std::memory_order_relaxed);
+    const size_t tail = this->tail.load(std::memory_order_acquire);
+    const size_t available = tail >= head ? tail - head : tail + slots.size() - head;
+    if (offset >= available) {
+      return nullptr;
+    }
+    return &slots[(head + offset) % slots.size()];
+  }
+
+  void pop() {
+    const size_t head = this->head.load(std::memory_order_relaxed);
+    this->head.store(next(head), std::memory_order_release);
+  }
+
+ private:
+  [[nodiscard]] size_t next(size_t index) const {
+    return index + 1 == slots.size() ? 0 : index + 1;
+  }
+
+  // One slot always stays empty to tell a full ring from an empty one
+  std::vector<T> slots;
+  alignas(64) std::atomic<size_t> head{0};
+  alignas(64) std::atomic<size_t> tail{0};
+};
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_FRAMERING_H_
@@ -44,6 +44,10 @@ AHardwareBufferReleaseFunc AHardwareBuffer_release_compat = nullptr;
 AHardwareBufferLockFunc AHardwareBuffer_lock_compat = nullptr;
 AHardwareBufferToHardwareBufferFunc AHardwareBuffer_toHardwareBuffer_compat = nullptr;
 AHardwareBufferDescribeFunc AHardwareBuffer_describe_compat = nullptr;
+AHardwareBufferLockPlanesFunc AHardwareBuffer_lockPlanes_compat = nullptr;
+AHardwareBufferFromHardwareBufferFunc AHardwareBuffer_fromHardwareBuffer_compat = nullptr;
+
+bool alreadyHdPlanesLoaded = false;
 
 bool loadAHardwareBuffersAPI() {
   // Bitmap doesn't support wrapping before 29 API
@@ -109,4 +113,34 @@ bool loadAHardwareBuffersAPI() {
   }
 
   return true;
-}
\ No newline at end of file
+}
+
+bool loadAHardwareBufferPlanesAPI() {
+  if (!loadAHardwareBuffersAPI()) {
+    return false;
+  }
+  std::lock_guard guard(dlMutex);
+  if (alreadyHdPlanesLoaded) {
+    return AHardwareBuffer_lockPlanes_compat != nullptr
+        && AHardwareBuffer_fromHardwareBuffer_compat != nullptr;
+  }
+  alreadyHdPlanesLoaded = true;
+  void *hhl = dlopen("libandroid.so", RTLD_NOW);
+  if (!hhl) {
+    return false;
+  }
+
+  AHardwareBuffer_lockPlanes_compat = (AHardwareBufferLockPlanesFunc) dlsym(hhl,
+                                                                            "AHardwareBuffer_lockPlanes");
+  if (AHardwareBuffer_lockPlanes_compat == nullptr) {
+    return false;
+  }
+
+  AHardwareBuffer_fromHardwareBuffer_compat =
+      (AHardwareBufferFromHardwareBufferFunc) dlsym(hhl, "AHardwareBuffer_fromHardwareBuffer");
+  if (AHardwareBuffer_fromHardwareBuffer_compat == nullptr) {
+    return false;
+  }
+
+  return true;
+}
@@ -34,6 +34,8 @@
 #include <android/hardware_buffer_jni.h>
 
 bool loadAHardwareBuffersAPI();
+// Plane locking of YUV buffers and access to the buffer behind a Java HardwareBuffer
+bool loadAHardwareBufferPlanesAPI();
 
 typedef int (*AHardwareBufferAllocateFunc)(
     const AHardwareBuffer_Desc *_Nonnull desc, AHardwareBuffer *_Nullable *_Nonnull outBuffer
@@ -64,6 +66,15 @@ typedef jobject (*AHardwareBufferToHardwareBufferFunc)(
     JNIEnv *env, AHardwareBuffer *hardwareBuffer
 );
 
+typedef int (*AHardwareBufferLockPlanesFunc)(
+    AHardwareBuffer *_Nonnull buffer, uint64_t usage, int32_t fence,
+    const ARect *_Nullable rect, AHardwareBuffer_Planes *_Nonnull outPlanes
+);
+
+typedef AHardwareBuffer *(*AHardwareBufferFromHardwareBufferFunc)(
+    JNIEnv *env, jobject hardwareBufferObj
+);
+
 extern AHardwareBufferAllocateFunc AHardwareBuffer_allocate_compat;
 extern AHardwareBufferIsSupportedFunc AHardwareBuffer_isSupported_compat;
 extern AHardwareBufferUnlockFunc AHardwareBuffer_unlock_compat;
@@ -71,5 +82,7 @@ extern AHardwareBufferReleaseFunc AHardwareBuffer_release_compat;
 extern AHardwareBufferLockFunc AHardwareBuffer_lock_compat;
 extern AHardwareBufferToHardwareBufferFunc AHardwareBuffer_toHardwareBuffer_compat;
 extern AHardwareBufferDescribeFunc AHardwareBuffer_describe_compat;
+extern AHardwareBufferLockPlanesFunc AHardwareBuffer_lockPlanes_compat;
+extern AHardwareBufferFromHardwareBufferFunc AHardwareBuffer_fromHardwareBuffer_compat;
 
 #endif //AVIF_HARDWAREBUFFERSCOMPAT_H
@@ -31,6 +31,7 @@
 
 #include <cstdint>
 #include "definitions.h"
+#include "DecodeAdmission.h"
 
 struct AvifImageSize {
   uint32_t width;
@@ -44,6 +45,8 @@ struct AvifImageFrame {
   bool is16Bit;
   uint32_t bitDepth;
   bool hasAlpha;
+  // Keeps decode memory reserved until the frame is handed over to a Bitmap
+  coder::DecodeAdmissionTicket admission;
 };
 
 #endif //AVIF_CODER_SRC_MAIN_CPP_IMAGEFRAME_H_
@@ -32,6 +32,107 @@
 #include "aligned_allocator.h"
 #include "JniBitmap.h"
 #include "ReformatBitmap.h"
+#include "DecodeStats.h"
+#include "JniDecodeStats.h"
+#include "PixelReformat.h"
+#include <android/bitmap.h>
+#include <cstring>
+
+namespace {
+jobject frameToBitmap(JNIEnv *env,
+                      AvifImageFrame &frame,
+                      PreferredColorConfig preferredColorConfig,
+                      coder::DecodeStats *stats) {
+  int osVersion = androidOSVersion();
+
+  bool useBitmapHalf16Floats = false;
+
+  if (frame.is16Bit && osVersion >= 26) {
+    useBitmapHalf16Floats = true;
+  }
+
+  std::string imageConfig = useBitmapHalf16Floats ? "RGBA_F16" : "ARGB_8888";
+
+  jobject hwBuffer = nullptr;
+
+  uint32_t stride = frame.width * 4 * (frame.is16Bit ? sizeof(uint16_t) : sizeof(uint8_t));
+
+  coder::ScopedDecodeStage reformatStage(stats, coder::DecodeStage::Reformat);
+  auto sourceStore = frame.store.data();
+  coder::ReformatColorConfig(env, ref(frame.store), ref(imageConfig), preferredColorConfig,
+                             frame.bitDepth, frame.width,
+                             frame.height, &stride, &useBitmapHalf16Floats, &hwBuffer,
+                             false, frame.hasAlpha);
+  if (frame.store.data() != sourceStore || hwBuffer) {
+    coder::RecordDecodeAllocation(stats, coder::DecodeStage::Reformat,
+                                  static_cast<uint64_t>(stride) * frame.height);
+  }
+  reformatStage.stop();
+
+  coder::ScopedDecodeStage bitmapCopyStage(stats, coder::DecodeStage::BitmapCopy);
+  jobject bitmap = createBitmap(env, ref(frame.store), imageConfig, stride,
+                                frame.width, frame.height, useBitmapHalf16Floats, hwBuffer);
+  if (!hwBuffer) {
+    coder::RecordDecodeAllocation(stats, coder::DecodeStage::BitmapCopy,
+                                  static_cast<uint64_t>(stride) * frame.height);
+  }
+  bitmapCopyStage.stop();
+  return bitmap;
+}
+
+bool bitmapColorConfig(int32_t format, PreferredColorConfig *config, uint32_t *pixelSize) {
+  switch (format) {
+    case ANDROID_BITMAP_FORMAT_RGBA_8888:*config = Rgba_8888;
+      *pixelSize = 4;
+      return true;
+    case ANDROID_BITMAP_FORMAT_RGBA_F16:*config = Rgba_F16;
+      *pixelSize = 8;
+      return true;
+    case ANDROID_BITMAP_FORMAT_RGB_565:*config = Rgb_565;
+      *pixelSize = 2;
+      return true;
+    case ANDROID_BITMAP_FORMAT_RGBA_1010102:*config = Rgba_1010102;
+      *pixelSize = 4;
+      return true;
+    default:return false;
+  }
+}
+
+// Reformats only the rectangle and writes it at the same place into locked bitmap pixels
+void writeDirtyRect(AvifImageFrame &frame, const coder::DirtyRect &rect,
+                    PreferredColorConfig config, uint32_t bitmapPixelSize,
+                    uint8_t *pixels, uint32_t bitmapStride) {
+  const uint32_t sourcePixelSize = frame.is16Bit ? 4 * sizeof(uint16_t) : 4 * sizeof(uint8_t);
+  const uint32_t sourceStride = frame.width * sourcePixelSize;
+  const uint32_t rectWidth = rect.right - rect.left;
+  const uint32_t rectHeight = rect.bottom - rect.top;
+
+  uint32_t stride = rectWidth * sourcePixelSize;
+  aligned_uint8_vector region(static_cast<size_t>(stride) * rectHeight);
+  for (uint32_t y = 0; y < rectHeight; ++y) {
+    std::memcpy(region.data() + static_cast<size_t>(y) * stride,
+                frame.store.data() + static_cast<size_t>(rect.top + y) * sourceStride
+                    + static_cast<size_t>(rect.left) * sourcePixelSize,
+                stride);
+  }
+
+  bool useFloats = frame.is16Bit && androidOSVersion() >= 26;
+  coder::PixelFormat format = coder::ReformatPixels(region, config, frame.bitDepth,
+                                                    rectWidth, rectHeight, &stride,
+                                                    &useFloats, false, frame.hasAlpha);
+  if (coder::PixelFormatBytes(format) != bitmapPixelSize) {
+    throw std::runtime_error("Decoded frame can't be written into this bitmap config");
+  }
+
+  const size_t rowBytes = static_cast<size_t>(rectWidth) * bitmapPixelSize;
+  for (uint32_t y = 0; y < rectHeight; ++y) {
+    std::memcpy(pixels + static_cast<size_t>(rect.top + y) * bitmapStride
+                    + static_cast<size_t>(rect.left) * bitmapPixelSize,
+                region.data() + static_cast<size_t>(y) * stride,
+                rowBytes);
+  }
+}
+}
 
 extern "C"
 JNIEXPORT void JNICALL
@@ -167,6 +268,30 @@ Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getFrameDurationImpl(
   }
 }
 extern "C"
+JNIEXPORT jint JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_frameAtTimeImpl(JNIEnv *env,
+                                                                           jobject thiz,
+                                                                           jlong ptr,
+                                                                           jlong timeMs) {
+  try {
+    if (timeMs < 0) {
+      std::string exception = "Time must be non negative but it was " + std::to_string(timeMs);
+      throwException(env, exception);
+      return static_cast<jint>(-1);
+    }
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    return static_cast<jint>(controller->frameAtTime(static_cast<uint64_t>(timeMs)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  }
+}
+extern "C"
 JNIEXPORT jobject JNICALL
 Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getFrameImpl(JNIEnv *env,
                                                                         jobject thiz,
@@ -177,8 +302,12 @@ Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getFrameImpl(JNIEnv *
                                                                         jint javaColorSpace,
                                                                         jint javaScaleMode,
                                                                         jint scaleQuality,
-                                                                        jint javaToneMapper) {
+                                                                        jint javaToneMapper,
+                                                                        jobject statsListener) {
   try {
+    coder::DecodeStats decodeStats;
+    coder::DecodeStats *stats = statsListener ? &decodeStats : nullptr;
+
     PreferredColorConfig preferredColorConfig;
     ScaleMode scaleMode;
     if (!checkDecodePreconditions(env, javaColorSpace, &preferredColorConfig, javaScaleMode,
@@ -194,37 +323,106 @@ Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getFrameImpl(JNIEnv *
                                       scaledHeight,
                                       preferredColorConfig,
                                       scaleMode,
-                                      scaleQuality);
-
-    int osVersion = androidOSVersion();
+                                      scaleQuality,
+                                      stats);
 
-    bool useBitmapHalf16Floats = false;
+    jobject bitmap = frameToBitmap(env, frame, preferredColorConfig, stats);
+    // Bitmap owns a copy of the pixels now
+    controller->recycleFrame(std::move(frame));
 
-    if (frame.is16Bit && osVersion >= 26) {
-      useBitmapHalf16Floats = true;
+    if (stats && bitmap) {
+      deliverDecodeStats(env, statsListener, *stats);
     }
+    return bitmap;
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jobject>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jobject>(nullptr);
+  }
+}
 
-    std::string imageConfig = useBitmapHalf16Floats ? "RGBA_F16" : "ARGB_8888";
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getFrameIntoImpl(JNIEnv *env,
+                                                                            jobject thiz,
+                                                                            jlong ptr,
+                                                                            jint frameIndex,
+                                                                            jobject target,
+                                                                            jint javaScaleMode,
+                                                                            jint scaleQuality) {
+  try {
+    AndroidBitmapInfo info;
+    if (AndroidBitmap_getInfo(env, target, &info) < 0) {
+      throwPixelsException(env);
+      return;
+    }
+    PreferredColorConfig preferredColorConfig;
+    uint32_t bitmapPixelSize;
+    if (!bitmapColorConfig(info.format, &preferredColorConfig, &bitmapPixelSize)) {
+      std::string exception = "Only RGBA_8888, RGBA_F16, RGB_565 and RGBA_1010102 bitmaps can be reused";
+      throwException(env, exception);
+      return;
+    }
+    PreferredColorConfig checkedColorConfig;
+    ScaleMode scaleMode;
+    if (!checkDecodePreconditions(env, preferredColorConfig, &checkedColorConfig, javaScaleMode,
+                                  &scaleMode)) {
+      std::string exception = "Can't retrieve basic values";
+      throwException(env, exception);
+      return;
+    }
 
-    jobject hwBuffer = nullptr;
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    auto frame = controller->getFrame(static_cast<uint32_t>(frameIndex),
+                                      static_cast<int32_t>(info.width),
+                                      static_cast<int32_t>(info.height),
+                                      preferredColorConfig,
+                                      scaleMode,
+                                      scaleQuality);
+    if (frame.width != info.width || frame.height != info.height) {
+      std::string exception = "Frame of " + std::to_string(frame.width) + "x"
+          + std::to_string(frame.height) + " doesn't fill target bitmap, use FILL or RESIZE";
+      controller->recycleFrame(std::move(frame));
+      throwException(env, exception);
+      return;
+    }
 
     uint32_t stride = frame.width * 4 * (frame.is16Bit ? sizeof(uint16_t) : sizeof(uint8_t));
+    bool useFloats = frame.is16Bit && androidOSVersion() >= 26;
+    coder::PixelFormat format = coder::ReformatPixels(frame.store, preferredColorConfig,
+                                                      frame.bitDepth, frame.width, frame.height,
+                                                      &stride, &useFloats, false, frame.hasAlpha);
+    if (coder::PixelFormatBytes(format) != bitmapPixelSize) {
+      throw std::runtime_error("Decoded frame can't be written into this bitmap config");
+    }
 
-    coder::ReformatColorConfig(env, ref(frame.store), ref(imageConfig), preferredColorConfig,
-                               frame.bitDepth, frame.width,
-                               frame.height, &stride, &useBitmapHalf16Floats, &hwBuffer,
-                               false, frame.hasAlpha);
-
-    return createBitmap(env, ref(frame.store), imageConfig, stride, frame.width, frame.height,
-                        useBitmapHalf16Floats, hwBuffer);
+    void *addr;
+    if (AndroidBitmap_lockPixels(env, target, &addr) != 0) {
+      controller->recycleFrame(std::move(frame));
+      throwPixelsException(env);
+      return;
+    }
+    const size_t rowBytes = static_cast<size_t>(frame.width) * bitmapPixelSize;
+    for (uint32_t y = 0; y < frame.height; ++y) {
+      std::memcpy(reinterpret_cast<uint8_t *>(addr) + static_cast<size_t>(y) * info.stride,
+                  frame.store.data() + static_cast<size_t>(y) * stride,
+                  rowBytes);
+    }
+    controller->recycleFrame(std::move(frame));
+    if (AndroidBitmap_unlockPixels(env, target) != 0) {
+      throwPixelsException(env);
+      return;
+    }
   } catch (std::bad_alloc &err) {
     std::string exception = "Not enough memory to decode this image";
     throwException(env, exception);
-    return static_cast<jobject>(nullptr);
   } catch (std::runtime_error &err) {
     std::string exception(err.what());
     throwException(env, exception);
-    return static_cast<jobject>(nullptr);
   }
 }
 
@@ -252,4 +450,372 @@ Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getSizeImpl(JNIEnv *e
     throwException(env, exception);
     return static_cast<jobject>(nullptr);
   }
-}
\ No newline at end of file
+}
+
+extern "C"
+JNIEXPORT jboolean JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_isKeyframeImpl(JNIEnv *env,
+                                                                          jobject thiz,
+                                                                          jlong ptr,
+                                                                          jint frame) {
+  try {
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    return controller->isKeyframe(static_cast<uint32_t>(frame)) ? JNI_TRUE : JNI_FALSE;
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return JNI_FALSE;
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return JNI_FALSE;
+  }
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_nearestKeyframeImpl(JNIEnv *env,
+                                                                               jobject thiz,
+                                                                               jlong ptr,
+                                                                               jint frame) {
+  try {
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    return static_cast<jint>(controller->nearestKeyframe(static_cast<uint32_t>(frame)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  }
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_seekCostImpl(JNIEnv *env,
+                                                                        jobject thiz,
+                                                                        jlong ptr,
+                                                                        jint frame) {
+  try {
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    return static_cast<jint>(controller->seekCost(static_cast<uint32_t>(frame)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_setSeekSnapshotsImpl(JNIEnv *env,
+                                                                                jobject thiz,
+                                                                                jlong ptr,
+                                                                                jint count) {
+  auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+  controller->setSeekSnapshots(static_cast<uint32_t>(count));
+}
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_decodeRangeImpl(JNIEnv *env,
+                                                                           jobject thiz,
+                                                                           jlong ptr,
+                                                                           jint from,
+                                                                           jint to,
+                                                                           jint scaledWidth,
+                                                                           jint scaledHeight,
+                                                                           jint javaColorSpace,
+                                                                           jint javaScaleMode,
+                                                                           jint scaleQuality,
+                                                                           jint maxWorkers,
+                                                                           jobject callback) {
+  try {
+    PreferredColorConfig preferredColorConfig;
+    ScaleMode scaleMode;
+    if (!checkDecodePreconditions(env, javaColorSpace, &preferredColorConfig, javaScaleMode,
+                                  &scaleMode)) {
+      std::string exception = "Can't retrieve basic values";
+      throwException(env, exception);
+      return;
+    }
+    if (from < 0 || to < 0) {
+      std::string exception = "Frames range can't be negative";
+      throwException(env, exception);
+      return;
+    }
+
+    jclass callbackClass = env->GetObjectClass(callback);
+    jmethodID onFrame = env->GetMethodID(callbackClass, "onFrame", "(ILandroid/graphics/Bitmap;)Z");
+    env->DeleteLocalRef(callbackClass);
+    if (!onFrame) {
+      return;
+    }
+
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    controller->decodeRange(static_cast<uint32_t>(from),
+                            static_cast<uint32_t>(to),
+                            scaledWidth,
+                            scaledHeight,
+                            preferredColorConfig,
+                            scaleMode,
+                            scaleQuality,
+                            static_cast<uint32_t>(std::max(maxWorkers, 0)),
+                            [&](uint32_t frameIndex, AvifImageFrame &&frame) {
+                              jobject bitmap =
+                                  frameToBitmap(env, frame, preferredColorConfig, nullptr);
+                              if (!bitmap || env->ExceptionCheck()) {
+                                return false;
+                              }
+                              jboolean proceed = env->CallBooleanMethod(callback, onFrame,
+                                                                        static_cast<jint>(frameIndex),
+                                                                        bitmap);
+                              env->DeleteLocalRef(bitmap);
+                              // Exception thrown by the callback stays pending for the caller
+                              return !env->ExceptionCheck() && proceed == JNI_TRUE;
+                            });
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+  }
+}
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_setFrameDelayImpl(JNIEnv *env,
+                                                                             jobject thiz,
+                                                                             jlong ptr,
+                                                                             jint frames) {
+  try {
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    controller->setFrameDelay(static_cast<uint32_t>(std::max(frames, 1)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+  }
+}
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_setMaxDecodersImpl(JNIEnv *env,
+                                                                              jobject thiz,
+                                                                              jlong ptr,
+                                                                              jint count) {
+  try {
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    controller->setMaxDecoders(static_cast<uint32_t>(std::max(count, 1)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+  }
+}
+extern "C"
+JNIEXPORT jintArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getThumbnailFramesImpl(JNIEnv *env,
+                                                                                  jobject thiz,
+                                                                                  jlong ptr,
+                                                                                  jint count) {
+  try {
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    auto frames = controller->thumbnailFrames(static_cast<uint32_t>(std::max(count, 0)));
+    std::vector<jint> javaFrames(frames.begin(), frames.end());
+    jintArray result = env->NewIntArray(static_cast<jsize>(javaFrames.size()));
+    if (!result) {
+      return static_cast<jintArray>(nullptr);
+    }
+    env->SetIntArrayRegion(result, 0, static_cast<jsize>(javaFrames.size()), javaFrames.data());
+    return result;
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jintArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jintArray>(nullptr);
+  }
+}
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_getThumbnailsImpl(JNIEnv *env,
+                                                                             jobject thiz,
+                                                                             jlong ptr,
+                                                                             jint count,
+                                                                             jint scaledWidth,
+                                                                             jint scaledHeight,
+                                                                             jint javaColorSpace,
+                                                                             jint javaScaleMode,
+                                                                             jint scaleQuality) {
+  try {
+    PreferredColorConfig preferredColorConfig;
+    ScaleMode scaleMode;
+    if (!checkDecodePreconditions(env, javaColorSpace, &preferredColorConfig, javaScaleMode,
+                                  &scaleMode)) {
+      std::string exception = "Can't retrieve basic values";
+      throwException(env, exception);
+      return static_cast<jobjectArray>(nullptr);
+    }
+
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    auto frames = controller->thumbnailFrames(static_cast<uint32_t>(std::max(count, 0)));
+
+    jclass bitmapClass = env->FindClass("android/graphics/Bitmap");
+    jobjectArray result = env->NewObjectArray(static_cast<jsize>(frames.size()), bitmapClass, nullptr);
+    env->DeleteLocalRef(bitmapClass);
+    if (!result) {
+      return static_cast<jobjectArray>(nullptr);
+    }
+
+    // Cells snapped to the same keyframe share one Bitmap
+    controller->decodeThumbnails(frames, scaledWidth, scaledHeight, preferredColorConfig,
+                                 scaleMode, scaleQuality,
+                                 [&](uint32_t frameIndex, AvifImageFrame &&frame) {
+                                   jobject bitmap =
+                                       frameToBitmap(env, frame, preferredColorConfig, nullptr);
+                                   if (!bitmap || env->ExceptionCheck()) {
+                                     return false;
+                                   }
+                                   for (size_t i = 0; i < frames.size(); ++i) {
+                                     if (frames[i] == frameIndex) {
+                                       env->SetObjectArrayElement(result,
+                                                                  static_cast<jsize>(i),
+                                                                  bitmap);
+                                     }
+                                   }
+                                   env->DeleteLocalRef(bitmap);
+                                   return true;
+                                 });
+    if (env->ExceptionCheck()) {
+      return static_cast<jobjectArray>(nullptr);
+    }
+    return result;
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jobjectArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jobjectArray>(nullptr);
+  }
+}
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_updateFrameImpl(JNIEnv *env,
+                                                                           jobject thiz,
+                                                                           jlong ptr,
+                                                                           jint frameIndex,
+                                                                           jobject target,
+                                                                           jint javaScaleMode,
+                                                                           jint scaleQuality) {
+  try {
+    AndroidBitmapInfo info;
+    if (AndroidBitmap_getInfo(env, target, &info) < 0) {
+      throwPixelsException(env);
+      return static_cast<jobjectArray>(nullptr);
+    }
+    PreferredColorConfig preferredColorConfig;
+    uint32_t bitmapPixelSize;
+    if (!bitmapColorConfig(info.format, &preferredColorConfig, &bitmapPixelSize)) {
+      std::string exception = "Only RGBA_8888, RGBA_F16, RGB_565 and RGBA_1010102 bitmaps can be updated";
+      throwException(env, exception);
+      return static_cast<jobjectArray>(nullptr);
+    }
+    PreferredColorConfig checkedColorConfig;
+    ScaleMode scaleMode;
+    if (!checkDecodePreconditions(env, preferredColorConfig, &checkedColorConfig, javaScaleMode,
+                                  &scaleMode)) {
+      std::string exception = "Can't retrieve basic values";
+      throwException(env, exception);
+      return static_cast<jobjectArray>(nullptr);
+    }
+
+    auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+    std::vector<coder::DirtyRect> dirtyRects;
+    auto frame = controller->getFrame(static_cast<uint32_t>(frameIndex),
+                                      static_cast<int32_t>(info.width),
+                                      static_cast<int32_t>(info.height),
+                                      preferredColorConfig,
+                                      scaleMode,
+                                      scaleQuality,
+                                      nullptr,
+                                      &dirtyRects);
+    if (frame.width != info.width || frame.height != info.height) {
+      // Bitmap content no longer matches what the next diff is based on
+      controller->resetDirtyTracking();
+      std::string exception = "Frame of " + std::to_string(frame.width) + "x"
+          + std::to_string(frame.height) + " doesn't fill target bitmap, use FILL or RESIZE";
+      throwException(env, exception);
+      return static_cast<jobjectArray>(nullptr);
+    }
+
+    void *addr;
+    if (AndroidBitmap_lockPixels(env, target, &addr) != 0) {
+      controller->resetDirtyTracking();
+      throwPixelsException(env);
+      return static_cast<jobjectArray>(nullptr);
+    }
+    try {
+      for (const auto &rect : dirtyRects) {
+        writeDirtyRect(frame, rect, preferredColorConfig, bitmapPixelSize,
+                       reinterpret_cast<uint8_t *>(addr), info.stride);
+      }
+    } catch (...) {
+      AndroidBitmap_unlockPixels(env, target);
+      controller->resetDirtyTracking();
+      throw;
+    }
+    if (AndroidBitmap_unlockPixels(env, target) != 0) {
+      throwPixelsException(env);
+      return static_cast<jobjectArray>(nullptr);
+    }
+
+    jclass rectClass = env->FindClass("android/graphics/Rect");
+    jmethodID rectInit = env->GetMethodID(rectClass, "<init>", "(IIII)V");
+    jobjectArray result =
+        env->NewObjectArray(static_cast<jsize>(dirtyRects.size()), rectClass, nullptr);
+    if (!result) {
+      return static_cast<jobjectArray>(nullptr);
+    }
+    for (size_t i = 0; i < dirtyRects.size(); ++i) {
+      const auto &rect = dirtyRects[i];
+      jobject javaRect = env->NewObject(rectClass, rectInit,
+                                        static_cast<jint>(rect.left),
+                                        static_cast<jint>(rect.top),
+                                        static_cast<jint>(rect.right),
+                                        static_cast<jint>(rect.bottom));
+      env->SetObjectArrayElement(result, static_cast<jsize>(i), javaRect);
+      env->DeleteLocalRef(javaRect);
+    }
+    env->DeleteLocalRef(rectClass);
+    return result;
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jobjectArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jobjectArray>(nullptr);
+  }
+}
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedDecoder_resetDirtyTrackingImpl(JNIEnv *env,
+                                                                                  jobject thiz,
+                                                                                  jlong ptr) {
+  auto controller = reinterpret_cast<AvifDecoderController *>(ptr);
+  controller->resetDirtyTracking();
+}
@@ -0,0 +1,221 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <jni.h>
+#include <android/bitmap.h>
+#include <algorithm>
+#include <string>
+#include "AvifAnimatedEncoder.h"
+#include "JniException.h"
+
+namespace {
+// Size of the byte[] finishToStreamImpl hands to OutputStream.write
+constexpr size_t kStreamChunkSize = 64 * 1024;
+
+// Thrown out of a sink when a Java exception is already pending
+struct PendingJavaException {};
+
+coder::EncodeSpeed toEncodeSpeed(jint speed) {
+  // AvSpeed values
+  switch (speed) {
+    case 1:return coder::EncodeSpeed::Medium;
+    case 2:return coder::EncodeSpeed::Slow;
+    default:return coder::EncodeSpeed::Fast;
+  }
+}
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedEncoder_createEncoder(JNIEnv *env,
+                                                                         jobject thiz,
+                                                                         jint width,
+                                                                         jint height,
+                                                                         jint quality,
+                                                                         jint chromaSubsampling,
+                                                                         jint speed,
+                                                                         jint threads,
+                                                                         jint repetitionCount,
+                                                                         jboolean keepAlpha) {
+  try {
+    if (width <= 0 || height <= 0) {
+      std::string exception = "Animation size must be positive";
+      throwException(env, exception);
+      return static_cast<jlong>(-1);
+    }
+    coder::AnimatedEncodeOptions options = {
+        .width = static_cast<uint32_t>(width),
+        .height = static_cast<uint32_t>(height),
+        .quality = quality,
+        .chromaSubsampling = chromaSubsampling,
+        .speed = toEncodeSpeed(speed),
+        .threads = static_cast<uint32_t>(std::max(threads, 0)),
+        .repetitionCount = repetitionCount,
+        .keepAlpha = keepAlpha == JNI_TRUE,
+    };
+    auto encoder = new coder::AvifAnimatedEncoder(options);
+    return reinterpret_cast<jlong>(encoder);
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this animation";
+    throwException(env, exception);
+    return static_cast<jlong>(-1);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jlong>(-1);
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedEncoder_destroy(JNIEnv *env,
+                                                                   jobject thiz,
+                                                                   jlong ptr) {
+  auto encoder = reinterpret_cast<coder::AvifAnimatedEncoder *>(ptr);
+  delete encoder;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedEncoder_addFrameImpl(JNIEnv *env,
+                                                                        jobject thiz,
+                                                                        jlong ptr,
+                                                                        jobject bitmap,
+                                                                        jint durationMs) {
+  auto encoder = reinterpret_cast<coder::AvifAnimatedEncoder *>(ptr);
+  AndroidBitmapInfo info;
+  if (AndroidBitmap_getInfo(env, bitmap, &info) < 0) {
+    std::string exception = "Can't get bitmap info";
+    throwException(env, exception);
+    return;
+  }
+  if (info.format != ANDROID_BITMAP_FORMAT_RGBA_8888) {
+    std::string exception = "Animation frames must be ARGB_8888 bitmaps";
+    throwException(env, exception);
+    return;
+  }
+  void *addr = nullptr;
+  if (AndroidBitmap_lockPixels(env, bitmap, &addr) != 0 || addr == nullptr) {
+    std::string exception = "Can't lock bitmap pixels";
+    throwException(env, exception);
+    return;
+  }
+  try {
+    coder::ImageView image = {
+        .pixels = reinterpret_cast<const uint8_t *>(addr),
+        .width = info.width,
+        .height = info.height,
+        .stride = info.stride,
+        .format = coder::PixelFormat::Rgba8888,
+        .premultiplied = (info.flags & ANDROID_BITMAP_FLAGS_ALPHA_MASK)
+            != ANDROID_BITMAP_FLAGS_ALPHA_UNPREMUL,
+    };
+    encoder->addFrame(image, static_cast<uint32_t>(std::max(durationMs, 1)));
+    AndroidBitmap_unlockPixels(env, bitmap);
+  } catch (std::bad_alloc &err) {
+    AndroidBitmap_unlockPixels(env, bitmap);
+    std::string exception = "Not enough memory to encode this animation";
+    throwException(env, exception);
+  } catch (std::runtime_error &err) {
+    AndroidBitmap_unlockPixels(env, bitmap);
+    std::string exception(err.what());
+    throwException(env, exception);
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedEncoder_finishImpl(JNIEnv *env,
+                                                                      jobject thiz,
+                                                                      jlong ptr) {
+  auto encoder = reinterpret_cast<coder::AvifAnimatedEncoder *>(ptr);
+  try {
+    jbyteArray result = nullptr;
+    encoder->finish([&](const uint8_t *data, size_t size) {
+      result = env->NewByteArray(static_cast<jsize>(size));
+      if (result == nullptr) {
+        throw PendingJavaException();
+      }
+      env->SetByteArrayRegion(result, 0, static_cast<jsize>(size),
+                              reinterpret_cast<const jbyte *>(data));
+    });
+    return result;
+  } catch (PendingJavaException &) {
+    return nullptr;
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this animation";
+    throwException(env, exception);
+    return nullptr;
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimatedEncoder_finishToStreamImpl(JNIEnv *env,
+                                                                              jobject thiz,
+                                                                              jlong ptr,
+                                                                              jobject output) {
+  auto encoder = reinterpret_cast<coder::AvifAnimatedEncoder *>(ptr);
+  try {
+    jclass streamClass = env->GetObjectClass(output);
+    jmethodID writeMethod = env->GetMethodID(streamClass, "write", "([BII)V");
+    env->DeleteLocalRef(streamClass);
+    if (writeMethod == nullptr) {
+      return;
+    }
+    encoder->finish([&](const uint8_t *data, size_t size) {
+      const auto chunkSize = static_cast<jsize>(std::min(size, kStreamChunkSize));
+      jbyteArray chunk = env->NewByteArray(chunkSize);
+      if (chunk == nullptr) {
+        throw PendingJavaException();
+      }
+      for (size_t offset = 0; offset < size; offset += kStreamChunkSize) {
+        const auto length = static_cast<jsize>(std::min(size - offset, kStreamChunkSize));
+        env->SetByteArrayRegion(chunk, 0, length, reinterpret_cast<const jbyte *>(data + offset));
+        env->CallVoidMethod(output, writeMethod, chunk, 0, length);
+        if (env->ExceptionCheck()) {
+          env->DeleteLocalRef(chunk);
+          throw PendingJavaException();
+        }
+      }
+      env->DeleteLocalRef(chunk);
+    });
+  } catch (PendingJavaException &) {
+    return;
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this animation";
+    throwException(env, exception);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+  }
+}
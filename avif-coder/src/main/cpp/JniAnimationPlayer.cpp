@@ -0,0 +1,191 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <jni.h>
+#include <android/bitmap.h>
+#include <cstring>
+#include "AnimationPlayer.h"
+#include "AvifDecoderController.h"
+#include "JniException.h"
+#include "Support.h"
+
+namespace {
+bool bitmapPixelFormat(int32_t format, coder::PixelFormat *pixelFormat) {
+  switch (format) {
+    case ANDROID_BITMAP_FORMAT_RGBA_8888:*pixelFormat = coder::PixelFormat::Rgba8888;
+      return true;
+    case ANDROID_BITMAP_FORMAT_RGBA_F16:*pixelFormat = coder::PixelFormat::RgbaF16;
+      return true;
+    case ANDROID_BITMAP_FORMAT_RGB_565:*pixelFormat = coder::PixelFormat::Rgb565;
+      return true;
+    case ANDROID_BITMAP_FORMAT_RGBA_1010102:*pixelFormat = coder::PixelFormat::Rgba1010102;
+      return true;
+    default:return false;
+  }
+}
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimationPlayer_createPlayer(JNIEnv *env,
+                                                                        jobject thiz,
+                                                                        jlong controllerPtr,
+                                                                        jint scaledWidth,
+                                                                        jint scaledHeight,
+                                                                        jint javaColorSpace,
+                                                                        jint javaScaleMode,
+                                                                        jint scaleQuality,
+                                                                        jint bufferedFrames) {
+  try {
+    PreferredColorConfig preferredColorConfig;
+    ScaleMode scaleMode;
+    if (!checkDecodePreconditions(env, javaColorSpace, &preferredColorConfig, javaScaleMode,
+                                  &scaleMode)) {
+      std::string exception = "Can't retrieve basic values";
+      throwException(env, exception);
+      return static_cast<jlong>(-1);
+    }
+    if (preferredColorConfig == Hardware) {
+      std::string exception = "Playback renders into mutable bitmaps, HARDWARE is not supported";
+      throwException(env, exception);
+      return static_cast<jlong>(-1);
+    }
+    auto controller = reinterpret_cast<AvifDecoderController *>(controllerPtr);
+    coder::PlaybackOptions options = {
+        .scaledWidth = scaledWidth,
+        .scaledHeight = scaledHeight,
+        .colorConfig = preferredColorConfig,
+        .scaleMode = scaleMode,
+        .scalingQuality = scaleQuality,
+        .bufferedFrames = static_cast<uint32_t>(std::max(bufferedFrames, 1)),
+        .allowFloatPixels = androidOSVersion() >= 26,
+    };
+    auto player = new coder::AnimationPlayer(controller->clone(), options);
+    return reinterpret_cast<jlong>(player);
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to decode this image";
+    throwException(env, exception);
+    return static_cast<jlong>(-1);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jlong>(-1);
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimationPlayer_destroy(JNIEnv *env,
+                                                                   jobject thiz,
+                                                                   jlong ptr) {
+  auto player = reinterpret_cast<coder::AnimationPlayer *>(ptr);
+  delete player;
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimationPlayer_startImpl(JNIEnv *env,
+                                                                     jobject thiz,
+                                                                     jlong ptr) {
+  try {
+    auto player = reinterpret_cast<coder::AnimationPlayer *>(ptr);
+    player->start();
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+  }
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimationPlayer_getLoopDurationImpl(JNIEnv *env,
+                                                                               jobject thiz,
+                                                                               jlong ptr) {
+  auto player = reinterpret_cast<coder::AnimationPlayer *>(ptr);
+  return static_cast<jlong>(player->loopDurationMs());
+}
+
+extern "C"
+JNIEXPORT jint JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_AvifAnimationPlayer_renderFrameImpl(JNIEnv *env,
+                                                                           jobject thiz,
+                                                                           jlong ptr,
+                                                                           jlong timestampMs,
+                                                                           jobject target) {
+  auto player = reinterpret_cast<coder::AnimationPlayer *>(ptr);
+  if (auto failure = player->failure()) {
+    std::string exception(*failure);
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  }
+  AndroidBitmapInfo info;
+  if (AndroidBitmap_getInfo(env, target, &info) < 0) {
+    throwPixelsException(env);
+    return static_cast<jint>(-1);
+  }
+  coder::PixelFormat targetFormat;
+  if (!bitmapPixelFormat(info.format, &targetFormat)) {
+    std::string exception =
+        "Only RGBA_8888, RGBA_F16, RGB_565 and RGBA_1010102 bitmaps can be rendered into";
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  }
+
+  // The frame is only marked as shown once it is in the bitmap, a failed render keeps it due
+  const coder::PlaybackFrame *frame =
+      player->peekFrame(static_cast<uint64_t>(std::max<jlong>(timestampMs, 0)));
+  if (!frame) {
+    return static_cast<jint>(-1);
+  }
+  if (info.width != frame->width || info.height != frame->height
+      || targetFormat != frame->format) {
+    std::string exception = "Target bitmap doesn't match playback frames of "
+        + std::to_string(frame->width) + "x" + std::to_string(frame->height);
+    throwException(env, exception);
+    return static_cast<jint>(-1);
+  }
+
+  void *addr;
+  if (AndroidBitmap_lockPixels(env, target, &addr) != 0) {
+    throwPixelsException(env);
+    return static_cast<jint>(-1);
+  }
+  const size_t rowBytes =
+      static_cast<size_t>(frame->width) * coder::PixelFormatBytes(frame->format);
+  for (uint32_t y = 0; y < frame->height; ++y) {
+    std::memcpy(reinterpret_cast<uint8_t *>(addr) + static_cast<size_t>(y) * info.stride,
+                frame->pixels.data() + static_cast<size_t>(y) * frame->stride,
+                rowBytes);
+  }
+  if (AndroidBitmap_unlockPixels(env, target) != 0) {
+    throwPixelsException(env);
+    return static_cast<jint>(-1);
+  }
+  player->markPresented(*frame);
+  return static_cast<jint>(frame->frameIndex);
+}
@@ -0,0 +1,80 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "JniDecodeStats.h"
+
+void deliverDecodeStats(JNIEnv *env, jobject listener, const coder::DecodeStats &stats) {
+  if (!listener || env->ExceptionCheck()) {
+    return;
+  }
+  constexpr auto stagesCount = static_cast<jsize>(coder::DecodeStage::Count);
+  jlong wall[stagesCount];
+  jlong cpu[stagesCount];
+  jlong allocated[stagesCount];
+  for (jsize i = 0; i < stagesCount; ++i) {
+    wall[i] = static_cast<jlong>(stats.stages[i].wallNanos);
+    cpu[i] = static_cast<jlong>(stats.stages[i].cpuNanos);
+    allocated[i] = static_cast<jlong>(stats.stages[i].estimatedAllocatedBytes);
+  }
+
+  jlongArray wallArray = env->NewLongArray(stagesCount);
+  jlongArray cpuArray = env->NewLongArray(stagesCount);
+  jlongArray allocatedArray = env->NewLongArray(stagesCount);
+  if (!wallArray || !cpuArray || !allocatedArray) {
+    return;
+  }
+  env->SetLongArrayRegion(wallArray, 0, stagesCount, wall);
+  env->SetLongArrayRegion(cpuArray, 0, stagesCount, cpu);
+  env->SetLongArrayRegion(allocatedArray, 0, stagesCount, allocated);
+
+  jclass statsClass = env->FindClass("com/radzivon/bartoshyk/avif/coder/DecodeStats");
+  if (!statsClass) {
+    return;
+  }
+  jmethodID constructor = env->GetMethodID(statsClass, "<init>", "([J[J[JJJII)V");
+  if (!constructor) {
+    return;
+  }
+  jobject statsObject = env->NewObject(statsClass, constructor,
+                                       wallArray, cpuArray, allocatedArray,
+                                       static_cast<jlong>(stats.colorObuSize),
+                                       static_cast<jlong>(stats.alphaObuSize),
+                                       static_cast<jint>(stats.decoderThreads),
+                                       static_cast<jint>(stats.conversionThreads));
+  if (!statsObject) {
+    return;
+  }
+
+  jclass listenerClass = env->GetObjectClass(listener);
+  jmethodID onDecodeStats = env->GetMethodID(listenerClass, "onDecodeStats",
+                                             "(Lcom/radzivon/bartoshyk/avif/coder/DecodeStats;)V");
+  if (!onDecodeStats) {
+    return;
+  }
+  env->CallVoidMethod(listener, onDecodeStats, statsObject);
+}
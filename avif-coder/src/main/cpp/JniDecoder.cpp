@@ -19,13 +19,47 @@
 #include "JniBitmap.h"
 #include <dlfcn.h>
 #include "avifweaver.h"
+#include "DecodeAdmission.h"
+#include "DecodeStats.h"
+#include "JniDecodeStats.h"
 
 using namespace std;
 
+namespace {
+
+// HEIC and AV2 pipelines live in avifweaver, so nothing might be downgraded
+// there, but they still have to wait for their share of the budget
+coder::DecodeAdmissionTicket admitContainerDecode(const HeicInfo &info,
+                                                  jint scaledWidth,
+                                                  jint scaledHeight,
+                                                  jint scaleMode,
+                                                  jint clrConfig) {
+  if (!info.supported_image) {
+    return {};
+  }
+  coder::DecodeMemoryRequest memoryRequest = {
+      .width = info.width,
+      .height = info.height,
+      .bitDepth = info.bit_depth,
+      .chromaLayout = 1,
+      .hasAlpha = true,
+      .allowYuvDownscale = false,
+      .scaledWidth = scaledWidth,
+      .scaledHeight = scaledHeight,
+      .scaleMode = static_cast<ScaleMode>(scaleMode),
+      .colorConfig = static_cast<PreferredColorConfig>(clrConfig),
+  };
+  coder::DecodeAdmissionPlan plan = {0};
+  return coder::AdmitDecode(memoryRequest, &plan);
+}
+
+}
+
 jobject decodeImplementationNative(JNIEnv *env, jobject thiz,
                                    std::vector<uint8_t> &srcBuffer, jint scaledWidth,
                                    jint scaledHeight, jint clrConfig, jint javaScaleMode,
-                                   jint scalingQuality) {
+                                   jint scalingQuality, jobject statsListener,
+                                   coder::DecodeStats *stats) {
   PreferredColorConfig preferredColorConfig;
   ScaleMode scaleMode;
 
@@ -42,13 +76,14 @@ jobject decodeImplementationNative(JNIEnv *env, jobject thiz,
 
     if (is_avif_image(srcBuffer.data(), srcBuffer.size())) {
       AvifDecoderController avifController;
-      avifController.attachBuffer(srcBuffer.data(), srcBuffer.size());
+      avifController.attachBuffer(srcBuffer.data(), srcBuffer.size(), stats);
       frame = avifController.getFrame(0,
                                       scaledWidth,
                                       scaledHeight,
                                       preferredColorConfig,
                                       scaleMode,
-                                      scalingQuality);
+                                      scalingQuality,
+                                      stats);
     } else {
       WeaveScaleMode mScaleMode = WeaveScaleMode::ScaleToFill;
       if (scaleMode == 1) {
@@ -69,12 +104,18 @@ jobject decodeImplementationNative(JNIEnv *env, jobject thiz,
         mConfig = WeaverPreferredColorConfig::Hardware;
       }
 
-      return decode_heic_file(env,
-                              srcBuffer.data(),
-                              srcBuffer.size(),
-                              scaledWidth,
-                              scaledHeight,
-                              mScaleMode, mConfig);
+      coder::ScopedDecodeStage decodeStage(stats, coder::DecodeStage::Decode);
+      jobject bitmap = decode_heic_file(env,
+                                        srcBuffer.data(),
+                                        srcBuffer.size(),
+                                        scaledWidth,
+                                        scaledHeight,
+                                        mScaleMode, mConfig);
+      decodeStage.stop();
+      if (stats && bitmap) {
+        deliverDecodeStats(env, statsListener, *stats);
+      }
+      return bitmap;
     }
 
     // The controller owns its own compressed-input copy and has already been
@@ -97,6 +138,8 @@ jobject decodeImplementationNative(JNIEnv *env, jobject thiz,
 
     uint32_t stride = frame.width * 4 * (frame.is16Bit ? sizeof(uint16_t) : sizeof(uint8_t));
 
+    coder::ScopedDecodeStage reformatStage(stats, coder::DecodeStage::Reformat);
+    auto sourceStore = frame.store.data();
     coder::ReformatColorConfig(env, ref(frame.store), ref(imageConfig), preferredColorConfig,
                                frame.bitDepth, frame.width,
                                frame.height, &stride, &useBitmapHalf16Floats, &hwBuffer,
@@ -104,9 +147,25 @@ jobject decodeImplementationNative(JNIEnv *env, jobject thiz,
     if (env->ExceptionCheck()) {
       return static_cast<jobject>(nullptr);
     }
+    if (frame.store.data() != sourceStore || hwBuffer) {
+      coder::RecordDecodeAllocation(stats, coder::DecodeStage::Reformat,
+                                    static_cast<uint64_t>(stride) * frame.height);
+    }
+    reformatStage.stop();
+
+    coder::ScopedDecodeStage bitmapCopyStage(stats, coder::DecodeStage::BitmapCopy);
+    jobject bitmap = createBitmap(env, ref(frame.store), imageConfig, stride,
+                                  frame.width, frame.height, useBitmapHalf16Floats, hwBuffer);
+    if (!hwBuffer) {
+      coder::RecordDecodeAllocation(stats, coder::DecodeStage::BitmapCopy,
+                                    static_cast<uint64_t>(stride) * frame.height);
+    }
+    bitmapCopyStage.stop();
 
-    return createBitmap(env, ref(frame.store), imageConfig, stride, frame.width, frame.height,
-                        useBitmapHalf16Floats, hwBuffer);
+    if (stats && bitmap) {
+      deliverDecodeStats(env, statsListener, *stats);
+    }
+    return bitmap;
   } catch (std::runtime_error &err) {
     string exception(err.what());
     throwException(env, exception);
@@ -123,14 +182,20 @@ Java_com_radzivon_bartoshyk_avif_coder_Coder_decodeImpl(JNIEnv *env,
                                                         jint scaledHeight,
                                                         jint clrConfig,
                                                         jint scaleMode,
-                                                        jint scaleQuality) {
+                                                        jint scaleQuality,
+                                                        jobject statsListener) {
   try {
+    coder::DecodeStats decodeStats;
+    coder::DecodeStats *stats = statsListener ? &decodeStats : nullptr;
+
     auto totalLength = env->GetArrayLength(byte_array);
     std::vector<uint8_t> srcBuffer(totalLength);
     env->GetByteArrayRegion(byte_array, 0, totalLength,
                             reinterpret_cast<jbyte *>(srcBuffer.data()));
 
+    coder::ScopedDecodeStage sniffStage(stats, coder::DecodeStage::ContainerSniff);
     auto containerType = container_recognisance(srcBuffer.data(), srcBuffer.size());
+    sniffStage.stop();
 
     WeaveScaleMode mScaleMode = WeaveScaleMode::ScaleToFill;
     if (scaleMode == 1) {
@@ -152,24 +217,42 @@ Java_com_radzivon_bartoshyk_avif_coder_Coder_decodeImpl(JNIEnv *env,
     }
 
     if (containerType == ImageContainer::Heic) {
-      return decode_heic_file(env,
-                              srcBuffer.data(),
-                              srcBuffer.size(),
-                              scaledWidth,
-                              scaledHeight,
-                              mScaleMode, mConfig);
+      auto admission = admitContainerDecode(read_heic_file_info(srcBuffer.data(),
+                                                                srcBuffer.size()),
+                                            scaledWidth, scaledHeight, scaleMode, clrConfig);
+      coder::ScopedDecodeStage decodeStage(stats, coder::DecodeStage::Decode);
+      jobject bitmap = decode_heic_file(env,
+                                        srcBuffer.data(),
+                                        srcBuffer.size(),
+                                        scaledWidth,
+                                        scaledHeight,
+                                        mScaleMode, mConfig);
+      decodeStage.stop();
+      if (stats && bitmap) {
+        deliverDecodeStats(env, statsListener, *stats);
+      }
+      return bitmap;
     } else if (containerType == ImageContainer::Av2) {
-      return decode_av2_file(env,
-                             srcBuffer.data(),
-                             srcBuffer.size(),
-                             scaledWidth,
-                             scaledHeight,
-                             mScaleMode, mConfig);
+      auto admission = admitContainerDecode(read_av2_file_info(srcBuffer.data(),
+                                                               srcBuffer.size()),
+                                            scaledWidth, scaledHeight, scaleMode, clrConfig);
+      coder::ScopedDecodeStage decodeStage(stats, coder::DecodeStage::Decode);
+      jobject bitmap = decode_av2_file(env,
+                                       srcBuffer.data(),
+                                       srcBuffer.size(),
+                                       scaledWidth,
+                                       scaledHeight,
+                                       mScaleMode, mConfig);
+      decodeStage.stop();
+      if (stats && bitmap) {
+        deliverDecodeStats(env, statsListener, *stats);
+      }
+      return bitmap;
     }
     return decodeImplementationNative(env, thiz, srcBuffer,
                                       scaledWidth, scaledHeight,
                                       clrConfig, scaleMode,
-                                      scaleQuality);
+                                      scaleQuality, statsListener, stats);
   } catch (std::bad_alloc &err) {
     std::string exception = "Not enough memory to decode this image";
     throwException(env, exception);
@@ -185,8 +268,12 @@ Java_com_radzivon_bartoshyk_avif_coder_Coder_decodeByteBufferImpl(JNIEnv *env,
                                                                   jint scaledHeight,
                                                                   jint clrConfig,
                                                                   jint scaleMode,
-                                                                  jint scalingQuality) {
+                                                                  jint scalingQuality,
+                                                                  jobject statsListener) {
   try {
+    coder::DecodeStats decodeStats;
+    coder::DecodeStats *stats = statsListener ? &decodeStats : nullptr;
+
     auto bufferAddress = reinterpret_cast<uint8_t *>(env->GetDirectBufferAddress(byteBuffer));
     int length = (int) env->GetDirectBufferCapacity(byteBuffer);
     if (!bufferAddress || length <= 0) {
@@ -196,7 +283,9 @@ Java_com_radzivon_bartoshyk_avif_coder_Coder_decodeByteBufferImpl(JNIEnv *env,
     }
     std::vector<uint8_t> srcBuffer(length);
     std::copy(bufferAddress, bufferAddress + length, srcBuffer.begin());
+    coder::ScopedDecodeStage sniffStage(stats, coder::DecodeStage::ContainerSniff);
     auto containerType = container_recognisance(srcBuffer.data(), srcBuffer.size());
+    sniffStage.stop();
 
     WeaveScaleMode mScaleMode = WeaveScaleMode::ScaleToFill;
     if (scaleMode == 1) {
@@ -218,26 +307,59 @@ Java_com_radzivon_bartoshyk_avif_coder_Coder_decodeByteBufferImpl(JNIEnv *env,
     }
 
     if (containerType == ImageContainer::Heic) {
-      return decode_heic_file(env,
-                              srcBuffer.data(),
-                              srcBuffer.size(),
-                              scaledWidth,
-                              scaledHeight,
-                              mScaleMode, mConfig);
+      auto admission = admitContainerDecode(read_heic_file_info(srcBuffer.data(),
+                                                                srcBuffer.size()),
+                                            scaledWidth, scaledHeight, scaleMode, clrConfig);
+      coder::ScopedDecodeStage decodeStage(stats, coder::DecodeStage::Decode);
+      jobject bitmap = decode_heic_file(env,
+                                        srcBuffer.data(),
+                                        srcBuffer.size(),
+                                        scaledWidth,
+                                        scaledHeight,
+                                        mScaleMode, mConfig);
+      decodeStage.stop();
+      if (stats && bitmap) {
+        deliverDecodeStats(env, statsListener, *stats);
+      }
+      return bitmap;
     } else if (containerType == ImageContainer::Av2) {
-      return decode_av2_file(env,
-                             srcBuffer.data(),
-                             srcBuffer.size(),
-                             scaledWidth,
-                             scaledHeight,
-                             mScaleMode, mConfig);
+      auto admission = admitContainerDecode(read_av2_file_info(srcBuffer.data(),
+                                                               srcBuffer.size()),
+                                            scaledWidth, scaledHeight, scaleMode, clrConfig);
+      coder::ScopedDecodeStage decodeStage(stats, coder::DecodeStage::Decode);
+      jobject bitmap = decode_av2_file(env,
+                                       srcBuffer.data(),
+                                       srcBuffer.size(),
+                                       scaledWidth,
+                                       scaledHeight,
+                                       mScaleMode, mConfig);
+      decodeStage.stop();
+      if (stats && bitmap) {
+        deliverDecodeStats(env, statsListener, *stats);
+      }
+      return bitmap;
     }
     return decodeImplementationNative(env, thiz, srcBuffer,
                                       scaledWidth, scaledHeight,
-                                      clrConfig, scaleMode, scalingQuality);
+                                      clrConfig, scaleMode, scalingQuality,
+                                      statsListener, stats);
   } catch (std::bad_alloc &err) {
     std::string exception = "Not enough memory to decode this image";
     throwException(env, exception);
     return static_cast<jobject>(nullptr);
   }
-}
\ No newline at end of file
+}
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_setDecodeMemoryBudgetImpl(JNIEnv *env,
+                                                                       jobject thiz,
+                                                                       jlong bytes) {
+  coder::SetDecodeMemoryBudget(bytes > 0 ? static_cast<uint64_t>(bytes) : 0);
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_getDecodeMemoryBudgetImpl(JNIEnv *env,
+                                                                       jobject thiz) {
+  return static_cast<jlong>(coder::GetDecodeMemoryBudget());
+}
@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <jni.h>
+#include <cerrno>
+#include <cstring>
+#include <string>
+#include <unistd.h>
+#include "JniException.h"
+#include "NativeEncodedImage.h"
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_NativeEncodedImage_destroy(JNIEnv *env,
+                                                                  jobject thiz,
+                                                                  jlong ptr) {
+  auto image = reinterpret_cast<coder::NativeEncodedImage *>(ptr);
+  delete image;
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_NativeEncodedImage_sizeImpl(JNIEnv *env,
+                                                                   jobject thiz,
+                                                                   jlong ptr) {
+  auto image = reinterpret_cast<coder::NativeEncodedImage *>(ptr);
+  return static_cast<jlong>(image->size());
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_NativeEncodedImage_copyToImpl(JNIEnv *env,
+                                                                     jobject thiz,
+                                                                     jlong ptr,
+                                                                     jobject buffer,
+                                                                     jint position) {
+  auto image = reinterpret_cast<coder::NativeEncodedImage *>(ptr);
+  auto address = static_cast<uint8_t *>(env->GetDirectBufferAddress(buffer));
+  const jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (address == nullptr || position < 0 || capacity < position
+      || static_cast<uint64_t>(capacity - position) < image->size()) {
+    std::string exception = "Output has to be a direct ByteBuffer with room for the image";
+    throwException(env, exception);
+    return;
+  }
+  std::memcpy(address + position, image->data(), image->size());
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_NativeEncodedImage_writeToImpl(JNIEnv *env,
+                                                                      jobject thiz,
+                                                                      jlong ptr,
+                                                                      jint fd) {
+  auto image = reinterpret_cast<coder::NativeEncodedImage *>(ptr);
+  const uint8_t *data = image->data();
+  size_t remaining = image->size();
+  while (remaining > 0) {
+    const ssize_t written = write(fd, data, remaining);
+    if (written < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      std::string exception = "Can't write the encoded image: " + std::string(strerror(errno));
+      throwException(env, exception);
+      return;
+    }
+    data += written;
+    remaining -= static_cast<size_t>(written);
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_NativeEncodedImage_toByteArrayImpl(JNIEnv *env,
+                                                                          jobject thiz,
+                                                                          jlong ptr) {
+  auto image = reinterpret_cast<coder::NativeEncodedImage *>(ptr);
+  jbyteArray result = env->NewByteArray(static_cast<jsize>(image->size()));
+  if (result != nullptr) {
+    env->SetByteArrayRegion(result, 0, static_cast<jsize>(image->size()),
+                            reinterpret_cast<const jbyte *>(image->data()));
+  }
+  return result;
+}
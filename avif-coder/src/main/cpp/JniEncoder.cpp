@@ -36,6 +36,7 @@
 #include <android/data_space.h>
 #include <sys/system_properties.h>
 #include "colorspace/colorspace.h"
+#include <algorithm>
 #include <cmath>
 #include <limits>
 #include "imagebits/RgbaF16bitToNBitU16.h"
@@ -47,7 +48,11 @@
 #include "avif/avif_cxx.h"
 #include <libyuv.h>
 #include "AvifDecoderController.h"
+#include "CoderCore.h"
+#include "EncodeDeadline.h"
+#include "HardwareBuffersCompat.h"
 #include "avifweaver.h"
+#include "NativeEncodedImage.h"
 
 using namespace std;
 
@@ -256,6 +261,350 @@ bool readHevcEncodingOptions(JNIEnv *env,
   return !env->ExceptionCheck();
 }
 
+coder::PixelFormat bitmapPixelFormat(int32_t format) {
+  switch (format) {
+    case ANDROID_BITMAP_FORMAT_RGBA_8888:return coder::PixelFormat::Rgba8888;
+    case ANDROID_BITMAP_FORMAT_RGB_565:return coder::PixelFormat::Rgb565;
+    case ANDROID_BITMAP_FORMAT_RGBA_F16:return coder::PixelFormat::RgbaF16;
+    case ANDROID_BITMAP_FORMAT_RGBA_1010102:return coder::PixelFormat::Rgba1010102;
+    default:throw std::runtime_error("Bitmap config is not supported by the encoder");
+  }
+}
+
+coder::EncodeOptions toEncodeOptions(const AvifEncodingOptions &options) {
+  coder::EncodeOptions encodeOptions{
+      .colorSpace = options.color_space,
+      .quality = options.quality,
+      .lossless = options.lossless,
+      .chromaSubsampling = options.chroma_subsampling_code,
+      .screenContentCoding = options.screen_content_coding,
+  };
+  switch (options.speed) {
+    case AvEncodingSpeed::Slow:encodeOptions.speed = coder::EncodeSpeed::Slow;
+      break;
+    case AvEncodingSpeed::Medium:encodeOptions.speed = coder::EncodeSpeed::Medium;
+      break;
+    case AvEncodingSpeed::Fast:encodeOptions.speed = coder::EncodeSpeed::Fast;
+      break;
+  }
+  return encodeOptions;
+}
+
+std::vector<uint8_t> readOptionalByteArray(JNIEnv *env, jbyteArray array) {
+  std::vector<uint8_t> data;
+  if (array == nullptr) {
+    return data;
+  }
+  data.resize(env->GetArrayLength(array));
+  env->GetByteArrayRegion(array, 0, static_cast<jsize>(data.size()),
+                          reinterpret_cast<jbyte *>(data.data()));
+  return data;
+}
+
+// Bytes spanned by a plane, the last row ends right after its last sample
+uint64_t planeSpan(uint32_t columns, uint32_t rows, uint32_t rowStride,
+                   uint32_t pixelStride, uint32_t sampleSize) {
+  if (columns == 0 || rows == 0) {
+    return 0;
+  }
+  return static_cast<uint64_t>(rows - 1) * rowStride
+      + static_cast<uint64_t>(columns - 1) * pixelStride * sampleSize + sampleSize;
+}
+
+const uint8_t *directPlane(JNIEnv *env, jobject buffer, uint64_t requiredBytes) {
+  if (buffer == nullptr) {
+    throw std::runtime_error("YUV plane is missing");
+  }
+  auto address = static_cast<const uint8_t *>(env->GetDirectBufferAddress(buffer));
+  if (address == nullptr) {
+    throw std::runtime_error("YUV planes must be direct ByteBuffers");
+  }
+  const jlong capacity = env->GetDirectBufferCapacity(buffer);
+  if (capacity < 0 || static_cast<uint64_t>(capacity) < requiredBytes) {
+    throw std::runtime_error("YUV plane is smaller than its strides describe");
+  }
+  return address;
+}
+
+void yuvChromaSize(const WeaveYuvImage &image, uint32_t *width, uint32_t *height) {
+  switch (image.chroma_subsampling_code) {
+    case AVIF_CHROMA_YUV_422:*width = (image.width + 1) / 2;
+      *height = image.height;
+      break;
+    case AVIF_CHROMA_YUV_444:*width = image.width;
+      *height = image.height;
+      break;
+    case AVIF_CHROMA_YUV_400:*width = 0;
+      *height = 0;
+      break;
+    default:*width = (image.width + 1) / 2;
+      *height = (image.height + 1) / 2;
+      break;
+  }
+}
+
+// Locks the planes of a YUV AHardwareBuffer for reading until destroyed
+class LockedHardwareBuffer {
+ public:
+  LockedHardwareBuffer(JNIEnv *env, jobject hardwareBuffer) {
+    if (!loadAHardwareBufferPlanesAPI()) {
+      throw std::runtime_error("Encoding a HardwareBuffer requires Android 10");
+    }
+    buffer = AHardwareBuffer_fromHardwareBuffer_compat(env, hardwareBuffer);
+    if (buffer == nullptr) {
+      throw std::runtime_error("Can't access the HardwareBuffer");
+    }
+    AHardwareBuffer_describe_compat(buffer, &desc);
+    if (AHardwareBuffer_lockPlanes_compat(buffer, AHARDWAREBUFFER_USAGE_CPU_READ_OFTEN, -1,
+                                          nullptr, &planes) != 0) {
+      throw std::runtime_error("Can't lock the HardwareBuffer planes, is it CPU readable?");
+    }
+  }
+
+  LockedHardwareBuffer(const LockedHardwareBuffer &) = delete;
+  LockedHardwareBuffer &operator=(const LockedHardwareBuffer &) = delete;
+
+  ~LockedHardwareBuffer() {
+    AHardwareBuffer_unlock_compat(buffer, nullptr);
+  }
+
+  // Y8Cb8Cr8_420 and YCbCr_P010 are accepted, pixels stay where they are
+  WeaveYuvImage describe() const {
+    uint32_t sampleSize;
+    WeaveYuvImage image{
+        .width = desc.width,
+        .height = desc.height,
+        .chroma_subsampling_code = AVIF_CHROMA_YUV_420,
+    };
+    if (desc.format == AHARDWAREBUFFER_FORMAT_Y8Cb8Cr8_420) {
+      image.bit_depth = 8;
+      sampleSize = 1;
+    } else if (desc.format == AHARDWAREBUFFER_FORMAT_YCbCr_P010) {
+      image.bit_depth = 10;
+      image.msb_aligned = true;
+      sampleSize = 2;
+    } else {
+      throw std::runtime_error("HardwareBuffer has to be YCBCR_420_888 or YCBCR_P010");
+    }
+    if (planes.planeCount < 3 || planes.planes[0].pixelStride != sampleSize
+        || planes.planes[1].pixelStride != planes.planes[2].pixelStride
+        || planes.planes[1].pixelStride % sampleSize != 0) {
+      throw std::runtime_error("HardwareBuffer plane layout is not supported");
+    }
+    image.y = static_cast<const uint8_t *>(planes.planes[0].data);
+    image.y_stride = planes.planes[0].rowStride;
+    image.u = static_cast<const uint8_t *>(planes.planes[1].data);
+    image.u_stride = planes.planes[1].rowStride;
+    image.v = static_cast<const uint8_t *>(planes.planes[2].data);
+    image.v_stride = planes.planes[2].rowStride;
+    image.chroma_pixel_stride = planes.planes[1].pixelStride / sampleSize;
+    return image;
+  }
+
+ private:
+  AHardwareBuffer *buffer = nullptr;
+  AHardwareBuffer_Desc desc{};
+  AHardwareBuffer_Planes planes{};
+};
+
+WeaveYuvImage readYuvPlanes(JNIEnv *env,
+                            jobjectArray planes,
+                            jintArray rowStrides,
+                            jint chromaPixelStride,
+                            jint width,
+                            jint height,
+                            jint bitDepth,
+                            jboolean msbAligned,
+                            jint chromaSubsampling) {
+  if (width <= 0 || height <= 0) {
+    throw std::runtime_error("YUV image size must be positive");
+  }
+  if (bitDepth != 8 && bitDepth != 10) {
+    throw std::runtime_error("YUV bit depth has to be 8 or 10");
+  }
+  const jsize planesCount = env->GetArrayLength(planes);
+  if (planesCount < 3 || planesCount > 4 || env->GetArrayLength(rowStrides) != planesCount) {
+    throw std::runtime_error("YUV image needs Y, U, V and optionally A planes with their strides");
+  }
+  std::vector<jint> strides(planesCount);
+  env->GetIntArrayRegion(rowStrides, 0, planesCount, strides.data());
+  for (jint stride : strides) {
+    if (stride <= 0) {
+      throw std::runtime_error("YUV plane strides must be positive");
+    }
+  }
+
+  WeaveYuvImage image{
+      .width = static_cast<uint32_t>(width),
+      .height = static_cast<uint32_t>(height),
+      .bit_depth = static_cast<uint32_t>(bitDepth),
+      .chroma_subsampling_code = chromaSubsampling,
+      .chroma_pixel_stride = static_cast<uint32_t>(std::max(chromaPixelStride, 1)),
+      .msb_aligned = msbAligned == JNI_TRUE,
+  };
+  const uint32_t sampleSize = bitDepth > 8 ? 2 : 1;
+  uint32_t chromaWidth, chromaHeight;
+  yuvChromaSize(image, &chromaWidth, &chromaHeight);
+
+  auto plane = [&](jsize index, uint32_t columns, uint32_t rows, uint32_t pixelStride) {
+    jobject buffer = env->GetObjectArrayElement(planes, index);
+    const uint8_t *address = nullptr;
+    try {
+      address = directPlane(env, buffer, planeSpan(columns, rows,
+                                                    static_cast<uint32_t>(strides[index]),
+                                                    pixelStride, sampleSize));
+    } catch (...) {
+      env->DeleteLocalRef(buffer);
+      throw;
+    }
+    // Direct buffer memory outlives the local reference
+    env->DeleteLocalRef(buffer);
+    return address;
+  };
+
+  image.y = plane(0, image.width, image.height, 1);
+  image.y_stride = static_cast<uint32_t>(strides[0]);
+  if (chromaWidth > 0) {
+    image.u = plane(1, chromaWidth, chromaHeight, image.chroma_pixel_stride);
+    image.u_stride = static_cast<uint32_t>(strides[1]);
+    image.v = plane(2, chromaWidth, chromaHeight, image.chroma_pixel_stride);
+    image.v_stride = static_cast<uint32_t>(strides[2]);
+  }
+  if (planesCount == 4) {
+    image.a = plane(3, image.width, image.height, 1);
+    image.a_stride = static_cast<uint32_t>(strides[3]);
+  }
+  return image;
+}
+
+// Keeps the pixels of a software bitmap locked until destroyed
+class LockedBitmap {
+ public:
+  LockedBitmap(JNIEnv *env, jobject bitmap) : env(env), bitmap(bitmap) {
+    if (bitmap == nullptr || AndroidBitmap_getInfo(env, bitmap, &info) != 0) {
+      throw std::runtime_error("Can't read bitmap info");
+    }
+    if (info.flags & ANDROID_BITMAP_FLAGS_IS_HARDWARE) {
+      throw std::runtime_error("Hardware bitmaps can't be encoded, copy them first");
+    }
+    format = bitmapPixelFormat(info.format);
+    if (AndroidBitmap_lockPixels(env, bitmap, &pixels) != 0) {
+      throw std::runtime_error("Can't lock bitmap pixels");
+    }
+  }
+
+  LockedBitmap(const LockedBitmap &) = delete;
+  LockedBitmap &operator=(const LockedBitmap &) = delete;
+
+  ~LockedBitmap() {
+    AndroidBitmap_unlockPixels(env, bitmap);
+  }
+
+  coder::ImageView view() const {
+    return coder::ImageView{
+        .pixels = static_cast<const uint8_t *>(pixels),
+        .width = info.width,
+        .height = info.height,
+        .stride = info.stride,
+        .format = format,
+        .premultiplied = (info.flags & ANDROID_BITMAP_FLAGS_ALPHA_MASK)
+            == ANDROID_BITMAP_FLAGS_ALPHA_PREMUL,
+    };
+  }
+
+  WeaveImageBuffer weaveBuffer() const {
+    WeavePixelFormat weaveFormat = WeavePixelFormat::Rgba8888;
+    switch (format) {
+      case coder::PixelFormat::Rgb565:weaveFormat = WeavePixelFormat::Rgb565;
+        break;
+      case coder::PixelFormat::RgbaF16:weaveFormat = WeavePixelFormat::RgbaF16;
+        break;
+      case coder::PixelFormat::Rgba1010102:weaveFormat = WeavePixelFormat::Rgba1010102;
+        break;
+      default:break;
+    }
+    const coder::ImageView image = view();
+    return WeaveImageBuffer{
+        .data = image.pixels,
+        .stride = image.stride,
+        .width = image.width,
+        .height = image.height,
+        .format = weaveFormat,
+        .premultiplied = image.premultiplied,
+    };
+  }
+
+ private:
+  JNIEnv *env;
+  jobject bitmap;
+  AndroidBitmapInfo info{};
+  coder::PixelFormat format = coder::PixelFormat::Rgba8888;
+  void *pixels = nullptr;
+};
+
+jbyteArray encodedToByteArray(JNIEnv *env, EncodedImage encoded) {
+  if (encoded.error || !encoded.data) {
+    std::string message = encoded.error ? encoded.error : "Encoding has failed";
+    weave_encoded_image_free(encoded);
+    throw std::runtime_error(message);
+  }
+  jbyteArray result = env->NewByteArray(static_cast<jsize>(encoded.length));
+  if (result != nullptr) {
+    env->SetByteArrayRegion(result, 0, static_cast<jsize>(encoded.length),
+                            reinterpret_cast<const jbyte *>(encoded.data));
+  }
+  weave_encoded_image_free(encoded);
+  return result;
+}
+
+// AV2 reads its exif from a ByteBuffer, exif is the content of exifArray
+jbyteArray encodeAv2Bitmap(JNIEnv *env,
+                           jobject bitmap,
+                           jbyteArray exifArray,
+                           std::vector<uint8_t> &exif,
+                           const AvifEncodingOptions &options) {
+  jobject exifBuffer = nullptr;
+  if (exifArray != nullptr) {
+    exifBuffer = env->NewDirectByteBuffer(exif.data(), static_cast<jlong>(exif.size()));
+  }
+  jbyteArray encoded = encode_avif_av2_file(env, bitmap, exifBuffer, options);
+  env->DeleteLocalRef(exifBuffer);
+  return encoded;
+}
+
+jbyteArray bytesToByteArray(JNIEnv *env, const std::vector<uint8_t> &bytes) {
+  jbyteArray result = env->NewByteArray(static_cast<jsize>(bytes.size()));
+  if (result != nullptr) {
+    env->SetByteArrayRegion(result, 0, static_cast<jsize>(bytes.size()),
+                            reinterpret_cast<const jbyte *>(bytes.data()));
+  }
+  return result;
+}
+
+jbyteArray encodeAvifYuv(JNIEnv *env, WeaveYuvImage image, jbyteArray exif, jobject javaOptions) {
+  AvifEncodingOptions options{};
+  bool useAv2 = false;
+  if (!readAvifEncodingOptions(env, javaOptions, 0, &options, &useAv2)) {
+    return nullptr;
+  }
+  if (useAv2) {
+    throw std::runtime_error("AV2 can't be encoded from YUV planes");
+  }
+  std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
+  return encodedToByteArray(env, weave_av1_encode_yuv(image, exifData.data(), exifData.size(),
+                                                      options, 0));
+}
+
+jbyteArray encodeHeicYuv(JNIEnv *env, WeaveYuvImage image, jbyteArray exif, jobject javaOptions) {
+  HevcEncodingOptions options{};
+  if (!readHevcEncodingOptions(env, javaOptions, 0, &options)) {
+    return nullptr;
+  }
+  std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
+  return encodedToByteArray(env, weave_hevc_encode_yuv(image, exifData.data(), exifData.size(),
+                                                       options, 0));
+}
+
 }
 
 extern "C"
@@ -263,7 +612,7 @@ JNIEXPORT jbyteArray JNICALL
 Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeAvifImpl(JNIEnv *env,
                                                             jobject thiz,
                                                             jobject bitmap,
-                                                            jobject exif,
+                                                            jbyteArray exif,
                                                             jint dataSpace,
                                                             jobject javaOptions) {
   try {
@@ -272,19 +621,447 @@ Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeAvifImpl(JNIEnv *env,
     if (!readAvifEncodingOptions(env, javaOptions, dataSpace, &options, &useAv2)) {
       return static_cast<jbyteArray>(nullptr);
     }
+    std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
     if (useAv2) {
-      return encode_avif_av2_file(
-          env, bitmap, exif, options
-      );
-    } else {
-      return encode_avif_av1_file(
-          env, bitmap, exif, options
-      );
+      return encodeAv2Bitmap(env, bitmap, exif, exifData, options);
+    }
+    // Goes through the core so colour and alpha are coded concurrently
+    coder::EncodeOptions encodeOptions = toEncodeOptions(options);
+    encodeOptions.exif = exifData.data();
+    encodeOptions.exifSize = exifData.size();
+    std::vector<uint8_t> encoded;
+    {
+      LockedBitmap locked(env, bitmap);
+      encoded = coder::EncodeImage(locked.view(), encodeOptions);
+    }
+    return bytesToByteArray(env, encoded);
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this image";
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  }
+}
+
+extern "C"
+JNIEXPORT jobjectArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeAvifBatchImpl(JNIEnv *env,
+                                                                 jobject thiz,
+                                                                 jobjectArray bitmaps,
+                                                                 jobjectArray exifs,
+                                                                 jintArray dataSpaces,
+                                                                 jobject javaOptions) {
+  try {
+    AvifEncodingOptions options{};
+    bool useAv2 = false;
+    if (!readAvifEncodingOptions(env, javaOptions, 0, &options, &useAv2)) {
+      return static_cast<jobjectArray>(nullptr);
+    }
+    const jsize count = env->GetArrayLength(bitmaps);
+    if (env->GetArrayLength(dataSpaces) != count
+        || (exifs != nullptr && env->GetArrayLength(exifs) != count)) {
+      std::string exception = "Every bitmap of the batch needs its own data space and exif";
+      throwException(env, exception);
+      return static_cast<jobjectArray>(nullptr);
+    }
+    std::vector<jint> spaces(count);
+    env->GetIntArrayRegion(dataSpaces, 0, count, spaces.data());
+
+    jclass byteArrayClass = env->FindClass("[B");
+    jobjectArray results = env->NewObjectArray(count, byteArrayClass, nullptr);
+    env->DeleteLocalRef(byteArrayClass);
+    if (results == nullptr) {
+      return static_cast<jobjectArray>(nullptr);
+    }
+
+    if (useAv2) {
+      // AV2 goes through the per bitmap entry point, only the options are shared
+      for (jsize index = 0; index < count; ++index) {
+        jobject bitmap = env->GetObjectArrayElement(bitmaps, index);
+        std::vector<uint8_t> exif;
+        jobject exifBuffer = nullptr;
+        if (exifs != nullptr) {
+          auto exifArray = reinterpret_cast<jbyteArray>(env->GetObjectArrayElement(exifs, index));
+          exif = readOptionalByteArray(env, exifArray);
+          if (exifArray != nullptr) {
+            exifBuffer = env->NewDirectByteBuffer(exif.data(), static_cast<jlong>(exif.size()));
+          }
+          env->DeleteLocalRef(exifArray);
+        }
+        options.color_space = spaces[index];
+        jbyteArray encoded = encode_avif_av2_file(env, bitmap, exifBuffer, options);
+        env->DeleteLocalRef(exifBuffer);
+        env->DeleteLocalRef(bitmap);
+        if (env->ExceptionCheck()) {
+          return static_cast<jobjectArray>(nullptr);
+        }
+        env->SetObjectArrayElement(results, index, encoded);
+        env->DeleteLocalRef(encoded);
+      }
+      return results;
+    }
+
+    // Bitmap locked by acquire, released right after its RGB -> YUV conversion
+    jobject lockedBitmap = nullptr;
+    std::vector<uint8_t> exif;
+    auto unlockBitmap = [&]() {
+      if (lockedBitmap != nullptr) {
+        AndroidBitmap_unlockPixels(env, lockedBitmap);
+        env->DeleteLocalRef(lockedBitmap);
+        lockedBitmap = nullptr;
+      }
+    };
+
+    try {
+      coder::EncodeImages(
+          static_cast<size_t>(count), toEncodeOptions(options),
+          [&](size_t index) -> coder::BatchEncodeItem {
+            jobject bitmap = env->GetObjectArrayElement(bitmaps, static_cast<jsize>(index));
+            AndroidBitmapInfo info;
+            if (bitmap == nullptr || AndroidBitmap_getInfo(env, bitmap, &info) != 0) {
+              env->DeleteLocalRef(bitmap);
+              throw std::runtime_error("Can't read info of bitmap " + std::to_string(index));
+            }
+            if (info.flags & ANDROID_BITMAP_FLAGS_IS_HARDWARE) {
+              env->DeleteLocalRef(bitmap);
+              throw std::runtime_error("Hardware bitmaps can't be encoded, copy them first");
+            }
+            coder::PixelFormat format = coder::PixelFormat::Rgba8888;
+            try {
+              format = bitmapPixelFormat(info.format);
+            } catch (...) {
+              env->DeleteLocalRef(bitmap);
+              throw;
+            }
+            void *addr = nullptr;
+            if (AndroidBitmap_lockPixels(env, bitmap, &addr) != 0) {
+              env->DeleteLocalRef(bitmap);
+              throw std::runtime_error("Can't lock pixels of bitmap " + std::to_string(index));
+            }
+            lockedBitmap = bitmap;
+
+            if (exifs != nullptr) {
+              auto exifArray = reinterpret_cast<jbyteArray>(
+                  env->GetObjectArrayElement(exifs, static_cast<jsize>(index)));
+              exif = readOptionalByteArray(env, exifArray);
+              env->DeleteLocalRef(exifArray);
+            }
+
+            return coder::BatchEncodeItem{
+                .image = {
+                    .pixels = reinterpret_cast<const uint8_t *>(addr),
+                    .width = info.width,
+                    .height = info.height,
+                    .stride = info.stride,
+                    .format = format,
+                    .premultiplied = (info.flags & ANDROID_BITMAP_FLAGS_ALPHA_MASK)
+                        == ANDROID_BITMAP_FLAGS_ALPHA_PREMUL,
+                },
+                .colorSpace = spaces[index],
+                .exif = exif.data(),
+                .exifSize = exif.size(),
+            };
+          },
+          [&](size_t index) {
+            unlockBitmap();
+          },
+          [&](size_t index, const uint8_t *data, size_t size) {
+            jbyteArray encoded = env->NewByteArray(static_cast<jsize>(size));
+            if (encoded == nullptr) {
+              throw std::bad_alloc();
+            }
+            env->SetByteArrayRegion(encoded, 0, static_cast<jsize>(size),
+                                    reinterpret_cast<const jbyte *>(data));
+            env->SetObjectArrayElement(results, static_cast<jsize>(index), encoded);
+            env->DeleteLocalRef(encoded);
+          });
+    } catch (...) {
+      unlockBitmap();
+      throw;
+    }
+    return results;
+  } catch (std::bad_alloc &err) {
+    // A pending OutOfMemoryError from NewByteArray is more precise than ours
+    if (!env->ExceptionCheck()) {
+      std::string exception = "Not enough memory to encode this image";
+      throwException(env, exception);
+    }
+    return static_cast<jobjectArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jobjectArray>(nullptr);
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeAvifGridImpl(JNIEnv *env,
+                                                                jobject thiz,
+                                                                jobject bitmap,
+                                                                jbyteArray exif,
+                                                                jint dataSpace,
+                                                                jint tileSize,
+                                                                jobject javaOptions) {
+  try {
+    AvifEncodingOptions options{};
+    bool useAv2 = false;
+    if (!readAvifEncodingOptions(env, javaOptions, dataSpace, &options, &useAv2)) {
+      return static_cast<jbyteArray>(nullptr);
+    }
+    if (useAv2) {
+      throw std::runtime_error("Grid encoding is available only for AV1");
+    }
+    std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
+    coder::EncodeOptions encodeOptions = toEncodeOptions(options);
+    encodeOptions.exif = exifData.data();
+    encodeOptions.exifSize = exifData.size();
+
+    std::vector<uint8_t> encoded;
+    {
+      LockedBitmap locked(env, bitmap);
+      encoded = coder::EncodeImageGrid(locked.view(), encodeOptions,
+                                       static_cast<uint32_t>(std::max(tileSize, 0)));
+    }
+    jbyteArray result = env->NewByteArray(static_cast<jsize>(encoded.size()));
+    if (result != nullptr) {
+      env->SetByteArrayRegion(result, 0, static_cast<jsize>(encoded.size()),
+                              reinterpret_cast<const jbyte *>(encoded.data()));
     }
+    return result;
   } catch (std::bad_alloc &err) {
     std::string exception = "Not enough memory to encode this image";
     throwException(env, exception);
     return static_cast<jbyteArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  }
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeAvifToSizeImpl(JNIEnv *env,
+                                                                  jobject thiz,
+                                                                  jobject bitmap,
+                                                                  jbyteArray exif,
+                                                                  jint dataSpace,
+                                                                  jint maxBytes,
+                                                                  jobject javaOptions) {
+  try {
+    AvifEncodingOptions options{};
+    bool useAv2 = false;
+    if (!readAvifEncodingOptions(env, javaOptions, dataSpace, &options, &useAv2)) {
+      return nullptr;
+    }
+    if (useAv2) {
+      throw std::runtime_error("Target size encoding is available only for AV1");
+    }
+    if (maxBytes <= 0) {
+      throw std::runtime_error("Target size must be positive");
+    }
+    std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
+    coder::EncodeOptions encodeOptions = toEncodeOptions(options);
+    encodeOptions.exif = exifData.data();
+    encodeOptions.exifSize = exifData.size();
+
+    coder::SizedEncodeResult sized;
+    {
+      LockedBitmap locked(env, bitmap);
+      sized = coder::EncodeImageToSize(locked.view(), encodeOptions,
+                                       static_cast<size_t>(maxBytes));
+    }
+
+    jbyteArray data = env->NewByteArray(static_cast<jsize>(sized.data.size()));
+    if (data == nullptr) {
+      return nullptr;
+    }
+    env->SetByteArrayRegion(data, 0, static_cast<jsize>(sized.data.size()),
+                            reinterpret_cast<const jbyte *>(sized.data.data()));
+    jclass resultClass = env->FindClass("com/radzivon/bartoshyk/avif/coder/TargetSizeEncoding");
+    if (resultClass == nullptr) {
+      return nullptr;
+    }
+    jmethodID constructor = env->GetMethodID(resultClass, "<init>", "([BIIZ)V");
+    if (constructor == nullptr) {
+      return nullptr;
+    }
+    return env->NewObject(resultClass, constructor, data,
+                          static_cast<jint>(sized.quality),
+                          static_cast<jint>(sized.encodes),
+                          sized.fits ? JNI_TRUE : JNI_FALSE);
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this image";
+    throwException(env, exception);
+    return nullptr;
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT jobject JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeAvifWithinImpl(JNIEnv *env,
+                                                                  jobject thiz,
+                                                                  jobject bitmap,
+                                                                  jbyteArray exif,
+                                                                  jint dataSpace,
+                                                                  jint deadlineMs,
+                                                                  jobject javaOptions) {
+  try {
+    AvifEncodingOptions options{};
+    bool useAv2 = false;
+    if (!readAvifEncodingOptions(env, javaOptions, dataSpace, &options, &useAv2)) {
+      return nullptr;
+    }
+    if (useAv2) {
+      throw std::runtime_error("Deadline encoding is available only for AV1");
+    }
+    std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
+    coder::EncodeOptions encodeOptions = toEncodeOptions(options);
+    encodeOptions.exif = exifData.data();
+    encodeOptions.exifSize = exifData.size();
+
+    coder::DeadlineEncodeResult timed;
+    {
+      LockedBitmap locked(env, bitmap);
+      timed = coder::EncodeImageWithin(locked.view(), encodeOptions,
+                                       static_cast<uint32_t>(std::max(deadlineMs, 0)));
+    }
+
+    jbyteArray data = env->NewByteArray(static_cast<jsize>(timed.data.size()));
+    if (data == nullptr) {
+      return nullptr;
+    }
+    env->SetByteArrayRegion(data, 0, static_cast<jsize>(timed.data.size()),
+                            reinterpret_cast<const jbyte *>(timed.data.data()));
+    // AvSpeed values
+    jint speed = 0;
+    switch (timed.speed) {
+      case coder::EncodeSpeed::Slow:speed = 2;
+        break;
+      case coder::EncodeSpeed::Medium:speed = 1;
+        break;
+      case coder::EncodeSpeed::Fast:speed = 0;
+        break;
+    }
+    jclass resultClass = env->FindClass("com/radzivon/bartoshyk/avif/coder/DeadlineEncoding");
+    if (resultClass == nullptr) {
+      return nullptr;
+    }
+    jmethodID constructor = env->GetMethodID(resultClass, "<init>", "([BIIII)V");
+    if (constructor == nullptr) {
+      return nullptr;
+    }
+    return env->NewObject(resultClass, constructor, data, speed,
+                          static_cast<jint>(timed.threads),
+                          static_cast<jint>(std::min<uint32_t>(timed.expectedMs, INT32_MAX)),
+                          static_cast<jint>(std::min<uint32_t>(timed.actualMs, INT32_MAX)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this image";
+    throwException(env, exception);
+    return nullptr;
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return nullptr;
+  }
+}
+
+extern "C"
+JNIEXPORT void JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_setEncodeCalibrationFileImpl(JNIEnv *env,
+                                                                          jobject thiz,
+                                                                          jstring path) {
+  if (path == nullptr) {
+    coder::SetEncodeCalibrationPath(std::string());
+    return;
+  }
+  const char *chars = env->GetStringUTFChars(path, nullptr);
+  if (chars == nullptr) {
+    return;
+  }
+  std::string filePath(chars);
+  env->ReleaseStringUTFChars(path, chars);
+  coder::SetEncodeCalibrationPath(filePath);
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeAvifNativeImpl(JNIEnv *env,
+                                                                  jobject thiz,
+                                                                  jobject bitmap,
+                                                                  jbyteArray exif,
+                                                                  jint dataSpace,
+                                                                  jobject javaOptions) {
+  try {
+    AvifEncodingOptions options{};
+    bool useAv2 = false;
+    if (!readAvifEncodingOptions(env, javaOptions, dataSpace, &options, &useAv2)) {
+      return 0;
+    }
+    std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
+    if (useAv2) {
+      // AV2 has no buffer entry point, its byte[] is moved into native memory once
+      jbyteArray encoded = encodeAv2Bitmap(env, bitmap, exif, exifData, options);
+      if (encoded == nullptr || env->ExceptionCheck()) {
+        return 0;
+      }
+      std::vector<uint8_t> bytes(env->GetArrayLength(encoded));
+      env->GetByteArrayRegion(encoded, 0, static_cast<jsize>(bytes.size()),
+                              reinterpret_cast<jbyte *>(bytes.data()));
+      env->DeleteLocalRef(encoded);
+      return reinterpret_cast<jlong>(new coder::NativeEncodedImage(std::move(bytes)));
+    }
+    coder::EncodeOptions encodeOptions = toEncodeOptions(options);
+    encodeOptions.exif = exifData.data();
+    encodeOptions.exifSize = exifData.size();
+    LockedBitmap locked(env, bitmap);
+    return reinterpret_cast<jlong>(new coder::NativeEncodedImage(
+        coder::EncodeImage(locked.view(), encodeOptions)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this image";
+    throwException(env, exception);
+    return 0;
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return 0;
+  }
+}
+
+extern "C"
+JNIEXPORT jlong JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeHeicNativeImpl(JNIEnv *env,
+                                                                  jobject thiz,
+                                                                  jobject bitmap,
+                                                                  jbyteArray exif,
+                                                                  jint dataSpace,
+                                                                  jobject javaOptions) {
+  try {
+    HevcEncodingOptions options{};
+    if (!readHevcEncodingOptions(env, javaOptions, dataSpace, &options)) {
+      return 0;
+    }
+    std::vector<uint8_t> exifData = readOptionalByteArray(env, exif);
+    LockedBitmap locked(env, bitmap);
+    EncodedImage encoded = encode_heic_buffer(locked.weaveBuffer(), exifData.data(),
+                                              exifData.size(), options);
+    return reinterpret_cast<jlong>(new coder::NativeEncodedImage(encoded));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this image";
+    throwException(env, exception);
+    return 0;
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return 0;
   }
 }
 
@@ -303,6 +1080,106 @@ Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeHeicImpl(JNIEnv *env,
   return encode_heic_file(env, bitmap, exif, options);
 }
 
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeYuvImpl(JNIEnv *env,
+                                                           jobject thiz,
+                                                           jobjectArray planes,
+                                                           jintArray rowStrides,
+                                                           jint chromaPixelStride,
+                                                           jint width,
+                                                           jint height,
+                                                           jint bitDepth,
+                                                           jboolean msbAligned,
+                                                           jint chromaSubsampling,
+                                                           jint colorPrimaries,
+                                                           jint transferCharacteristics,
+                                                           jint matrixCoefficients,
+                                                           jboolean fullRange,
+                                                           jbyteArray exif,
+                                                           jobject javaOptions,
+                                                           jboolean heic) {
+  try {
+    WeaveYuvImage image = readYuvPlanes(env, planes, rowStrides, chromaPixelStride, width,
+                                        height, bitDepth, msbAligned, chromaSubsampling);
+    image.color_primaries = static_cast<uint16_t>(colorPrimaries);
+    image.transfer_characteristics = static_cast<uint16_t>(transferCharacteristics);
+    image.matrix_coefficients = static_cast<uint16_t>(matrixCoefficients);
+    image.full_range = fullRange == JNI_TRUE;
+    return heic == JNI_TRUE ? encodeHeicYuv(env, image, exif, javaOptions)
+                            : encodeAvifYuv(env, image, exif, javaOptions);
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this image";
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_encodeHardwareBufferImpl(JNIEnv *env,
+                                                                      jobject thiz,
+                                                                      jobject hardwareBuffer,
+                                                                      jint colorPrimaries,
+                                                                      jint transferCharacteristics,
+                                                                      jint matrixCoefficients,
+                                                                      jboolean fullRange,
+                                                                      jbyteArray exif,
+                                                                      jobject javaOptions,
+                                                                      jboolean heic) {
+  try {
+    LockedHardwareBuffer locked(env, hardwareBuffer);
+    WeaveYuvImage image = locked.describe();
+    image.color_primaries = static_cast<uint16_t>(colorPrimaries);
+    image.transfer_characteristics = static_cast<uint16_t>(transferCharacteristics);
+    image.matrix_coefficients = static_cast<uint16_t>(matrixCoefficients);
+    image.full_range = fullRange == JNI_TRUE;
+    return heic == JNI_TRUE ? encodeHeicYuv(env, image, exif, javaOptions)
+                            : encodeAvifYuv(env, image, exif, javaOptions);
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to encode this image";
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  }
+}
+
+extern "C"
+JNIEXPORT jbyteArray JNICALL
+Java_com_radzivon_bartoshyk_avif_coder_Coder_transcodeHeicImpl(JNIEnv *env,
+                                                               jobject thiz,
+                                                               jbyteArray input,
+                                                               jobject javaOptions) {
+  try {
+    AvifEncodingOptions options{};
+    bool useAv2 = false;
+    if (!readAvifEncodingOptions(env, javaOptions, 0, &options, &useAv2)) {
+      return static_cast<jbyteArray>(nullptr);
+    }
+    if (useAv2) {
+      throw std::runtime_error("HEIC can be transcoded only to AV1");
+    }
+    std::vector<uint8_t> heic = readOptionalByteArray(env, input);
+    return bytesToByteArray(env, coder::TranscodeHeic(heic.data(), heic.size(),
+                                                      toEncodeOptions(options)));
+  } catch (std::bad_alloc &err) {
+    std::string exception = "Not enough memory to transcode this image";
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  } catch (std::runtime_error &err) {
+    std::string exception(err.what());
+    throwException(env, exception);
+    return static_cast<jbyteArray>(nullptr);
+  }
+}
+
 extern "C"
 JNIEXPORT jboolean JNICALL
 Java_com_radzivon_bartoshyk_avif_coder_Coder_isHeifImageImpl(JNIEnv *env, jobject thiz,
@@ -0,0 +1,83 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_NATIVEENCODEDIMAGE_H_
+#define AVIF_CODER_SRC_MAIN_CPP_NATIVEENCODEDIMAGE_H_
+
+#include <cstdint>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "avifweaver.h"
+
+namespace coder {
+
+/**
+ * Encoded file kept in native memory until Java copies it into a direct buffer
+ * or writes it to a file descriptor, so it never has to pass through the Java heap.
+ */
+class NativeEncodedImage {
+ public:
+  // Takes ownership of a successful encode, throws the error of a failed one
+  explicit NativeEncodedImage(EncodedImage image) {
+    if (image.error || !image.data) {
+      std::string message = image.error ? image.error : "Encoding has failed";
+      weave_encoded_image_free(image);
+      throw std::runtime_error(message);
+    }
+    encoded = image;
+  }
+
+  explicit NativeEncodedImage(std::vector<uint8_t> bytes) : owned(std::move(bytes)) {}
+
+  NativeEncodedImage(const NativeEncodedImage &) = delete;
+  NativeEncodedImage &operator=(const NativeEncodedImage &) = delete;
+
+  ~NativeEncodedImage() {
+    if (encoded.data) {
+      weave_encoded_image_free(encoded);
+    }
+  }
+
+  [[nodiscard]] const uint8_t *data() const {
+    return encoded.data ? encoded.data : owned.data();
+  }
+
+  [[nodiscard]] size_t size() const {
+    return encoded.data ? static_cast<size_t>(encoded.length) : owned.size();
+  }
+
+ private:
+  EncodedImage encoded{};
+  std::vector<uint8_t> owned;
+};
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_NATIVEENCODEDIMAGE_H_
@@ -0,0 +1,177 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "PixelReformat.h"
+#include "imagebits/Rgba8ToF16.h"
+#include "imagebits/Rgb565.h"
+#include "imagebits/Rgba16.h"
+#include "imagebits/RGBAlpha.h"
+#include "avifweaver.h"
+
+namespace coder {
+
+PixelFormat ReformatPixels(aligned_uint8_vector &imageData,
+                           PreferredColorConfig preferredColorConfig, uint32_t depth,
+                           uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride,
+                           bool *useFloats, bool alphaPremultiplied, bool doesImageHasAlpha) {
+  if (!alphaPremultiplied && doesImageHasAlpha) {
+    if (!(*useFloats)) {
+      coder::AssociateAlphaRgba8(imageData.data(), *stride,
+                                 imageData.data(), *stride,
+                                 imageWidth,
+                                 imageHeight);
+    } else {
+      coder::AssociateAlphaRgba16(reinterpret_cast<uint16_t *>(imageData.data()), *stride,
+                                  reinterpret_cast<uint16_t *>(imageData.data()), *stride,
+                                  imageWidth,
+                                  imageHeight, depth);
+    }
+  }
+
+  switch (preferredColorConfig) {
+    case Rgba_8888:
+      if (*useFloats) {
+        uint32_t
+            lineWidth = imageWidth * 4 * (uint32_t)
+            sizeof(uint8_t);
+        uint32_t alignment = 64;
+        uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
+        uint32_t dstStride = lineWidth + padding;
+        aligned_uint8_vector rgba8888Data(dstStride * imageHeight);
+        coder::Rgba16ToRgba8(reinterpret_cast<const uint16_t *>(imageData.data()),
+                             *stride, rgba8888Data.data(), dstStride, imageWidth,
+                             imageHeight, depth);
+        *stride = dstStride;
+        *useFloats = false;
+        imageData = std::move(rgba8888Data);
+      }
+      return PixelFormat::Rgba8888;
+    case Rgba_F16:
+      if (*useFloats) {
+        weave_cvt_rgba16_to_rgba_f16(reinterpret_cast<const uint16_t *>(imageData.data()),
+                                     *stride,
+                                     depth,
+                                     reinterpret_cast<uint16_t *>(imageData.data()),
+                                     *stride,
+                                     imageWidth, imageHeight);
+      } else {
+        uint32_t
+            lineWidth = imageWidth * 4 * (uint32_t)
+            sizeof(uint16_t);
+        uint32_t dstStride = lineWidth;
+        aligned_uint8_vector rgbaF16Data(dstStride * imageHeight);
+        weave_cvt_rgba8_to_rgba_f16(
+            imageData.data(), *stride,
+            reinterpret_cast<uint16_t *>(rgbaF16Data.data()), dstStride,
+            imageWidth, imageHeight);
+        *stride = dstStride;
+        *useFloats = true;
+        imageData = std::move(rgbaF16Data);
+      }
+      return PixelFormat::RgbaF16;
+    case Rgb_565:
+      if (*useFloats) {
+        uint32_t
+            lineWidth = imageWidth * (uint32_t)
+            sizeof(uint16_t);
+        uint32_t alignment = 64;
+        uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
+        uint32_t dstStride = lineWidth + padding;
+        aligned_uint8_vector rgb565Data(dstStride * imageHeight);
+        coder::Rgba16To565(reinterpret_cast<const uint16_t *>(imageData.data()),
+                           *stride,
+                           reinterpret_cast<uint16_t *>(rgb565Data.data()), dstStride,
+                           imageWidth, imageHeight, depth);
+        *stride = dstStride;
+        *useFloats = false;
+        imageData = std::move(rgb565Data);
+      } else {
+        uint32_t lineWidth = imageWidth * (uint32_t)
+            sizeof(uint16_t);
+        uint32_t alignment = 64;
+        uint32_t padding = (alignment - (lineWidth % alignment)) % alignment;
+        uint32_t dstStride = lineWidth + padding;
+        aligned_uint8_vector rgb565Data(dstStride * imageHeight);
+        coder::Rgba8To565(imageData.data(), *stride,
+                          reinterpret_cast<uint16_t *>(rgb565Data.data()), dstStride,
+                          imageWidth, imageHeight,
+                          !alphaPremultiplied);
+        *stride = dstStride;
+        *useFloats = false;
+        imageData = std::move(rgb565Data);
+      }
+      return PixelFormat::Rgb565;
+    case Rgba_1010102:
+      if (*useFloats) {
+        uint32_t
+            lineWidth = imageWidth * (uint32_t)
+            sizeof(uint32_t);
+        uint32_t dstStride = lineWidth;
+        aligned_uint8_vector rgba1010102Data(dstStride * imageHeight);
+        weave_cvt_rgba16_to_ar30(reinterpret_cast<const uint16_t *>(imageData.data()),
+                                 *stride,
+                                 depth,
+                                 reinterpret_cast<uint8_t *>(rgba1010102Data.data()),
+                                 dstStride,
+                                 imageWidth, imageHeight);
+        *stride = dstStride;
+        *useFloats = false;
+        imageData = std::move(rgba1010102Data);
+      } else {
+        uint32_t
+            dstStride = imageWidth * (uint32_t)
+            sizeof(uint32_t) * 4;
+        aligned_uint8_vector rgba1010102Data(dstStride * imageHeight);
+        weave_cvt_rgba8_to_ar30(reinterpret_cast<const uint8_t *>(imageData.data()),
+                                *stride,
+                                reinterpret_cast<uint8_t *>(rgba1010102Data.data()),
+                                dstStride,
+                                imageWidth, imageHeight);
+        *stride = dstStride;
+        *useFloats = false;
+        imageData = std::move(rgba1010102Data);
+      }
+      return PixelFormat::Rgba1010102;
+    case Hardware:
+      return *useFloats ? PixelFormat::Rgba16 : PixelFormat::Rgba8888;
+    default: {
+      if (*useFloats) {
+        weave_cvt_rgba16_to_rgba_f16(reinterpret_cast<const uint16_t *>(imageData.data()),
+                                     *stride,
+                                     depth,
+                                     reinterpret_cast<uint16_t *>(imageData.data()),
+                                     *stride,
+                                     imageWidth, imageHeight);
+        return PixelFormat::RgbaF16;
+      }
+      return PixelFormat::Rgba8888;
+    }
+  }
+}
+
+}
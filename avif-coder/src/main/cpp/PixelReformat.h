@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_PIXELREFORMAT_H_
+#define AVIF_CODER_SRC_MAIN_CPP_PIXELREFORMAT_H_
+
+#include <cstdint>
+#include "ColorConfig.h"
+#include "definitions.h"
+
+namespace coder {
+
+/**
+ * Premultiplies alpha and converts RGBA 8 or RGBA 16 (when useFloats is set) into the
+ * preferred config in software. Hardware leaves pixels as they are for the caller to upload.
+ * Returns the resulting layout, stride and useFloats are updated accordingly.
+ */
+PixelFormat ReformatPixels(aligned_uint8_vector &imageData,
+                           PreferredColorConfig preferredColorConfig, uint32_t depth,
+                           uint32_t imageWidth, uint32_t imageHeight, uint32_t *stride,
+                           bool *useFloats, bool alphaPremultiplied, bool doesImageHasAlpha);
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_PIXELREFORMAT_H_
@@ -30,11 +30,16 @@
 #include <vector>
 #include "imagebits/CopyUnalignedRGBA.h"
 #include <string>
-#include <jni.h>
-#include "JniException.h"
+#include <cstring>
 #include "definitions.h"
 #include "avifweaver.h"
 
+namespace {
+aligned_uint8_vector storeOf(coder::FrameBufferPool *pool, size_t size) {
+  return pool ? pool->acquire(size) : aligned_uint8_vector(size);
+}
+}
+
 aligned_uint8_vector RescaleSourceImage(uint8_t *sourceData,
                                         uint32_t *stride,
                                         uint32_t bitDepth,
@@ -45,7 +50,8 @@ aligned_uint8_vector RescaleSourceImage(uint8_t *sourceData,
                                         int32_t scaledHeight,
                                         ScaleMode scaleMode,
                                         int scalingQuality,
-                                        bool isRgba) {
+                                        bool isRgba,
+                                        coder::FrameBufferPool *pool) {
   uint32_t imageWidth = *imageWidthPtr;
   uint32_t imageHeight = *imageHeightPtr;
   if ((scaledHeight != 0 || scaledWidth != 0) && (scaledWidth != 0 && scaledHeight != 0)) {
@@ -59,63 +65,54 @@ aligned_uint8_vector RescaleSourceImage(uint8_t *sourceData,
         break;
     }
 
-    aligned_uint8_vector outData;
+    uint32_t newWidth = 0;
+    uint32_t newHeight = 0;
+    if (!weave_scaled_size(imageWidth, imageHeight, scaledWidth, scaledHeight, mScaleMode,
+                           &newWidth, &newHeight)) {
+      std::string exception = "Scaling image has failed";
+      throw std::runtime_error(exception);
+    }
+    uint32_t newStride = newWidth * 4 * (bitDepth == 8 ? sizeof(uint8_t) : sizeof(uint16_t));
+    aligned_uint8_vector dataStore = storeOf(pool, static_cast<size_t>(newStride) * newHeight);
 
+    bool scaled;
     if (bitDepth == 8) {
-      auto scalingResult = weave_scale_u8(sourceData,
-                                          *stride,
-                                          imageWidth,
-                                          imageHeight,
-                                          scaledWidth,
-                                          scaledHeight,
-                                          isRgba,
-                                          mScaleMode
-      );
-      if (scalingResult.data == nullptr) {
-        std::string exception = "Scaling image has failed";
-        throw std::runtime_error(exception);
-      }
-      aligned_uint8_vector dataStore(scalingResult.length);
-      *imageWidthPtr = static_cast<int>(scalingResult.width);
-      *imageHeightPtr = static_cast<int>(scalingResult.height);
-      *stride = static_cast<int>(scalingResult.stride);
-      memcpy(
-          dataStore.data(),
-          scalingResult.data,
-          scalingResult.length
+      scaled = weave_scale_u8_into(sourceData,
+                                   *stride,
+                                   imageWidth,
+                                   imageHeight,
+                                   scaledWidth,
+                                   scaledHeight,
+                                   isRgba,
+                                   mScaleMode,
+                                   dataStore.data(),
+                                   newStride
       );
-      weave_scaling_result_free(scalingResult);
-      return dataStore;
     } else {
-      auto scalingResult = weave_scale_u16(reinterpret_cast<const uint16_t *>(sourceData),
-                                           *stride,
-                                           imageWidth,
-                                           imageHeight,
-                                           scaledWidth,
-                                           scaledHeight,
-                                           bitDepth,
-                                           isRgba,
-                                           mScaleMode
+      scaled = weave_scale_u16_into(reinterpret_cast<const uint16_t *>(sourceData),
+                                    *stride,
+                                    imageWidth,
+                                    imageHeight,
+                                    scaledWidth,
+                                    scaledHeight,
+                                    bitDepth,
+                                    isRgba,
+                                    mScaleMode,
+                                    reinterpret_cast<uint16_t *>(dataStore.data()),
+                                    newStride
       );
-      if (scalingResult.data == nullptr) {
-        std::string exception = "Scaling image has failed";
-        throw std::runtime_error(exception);
-      }
-      aligned_uint8_vector dataStore(scalingResult.length * sizeof(uint16_t));
-      *imageWidthPtr = static_cast<int>(scalingResult.width);
-      *imageHeightPtr = static_cast<int>(scalingResult.height);
-      *stride = static_cast<int>(scalingResult.stride * 2);
-      memcpy(
-          dataStore.data(),
-          reinterpret_cast<const uint8_t * >(scalingResult.data),
-          scalingResult.length * sizeof(uint16_t)
-      );
-      weave_scaling_result16_free(scalingResult);
-      return dataStore;
     }
+    if (!scaled) {
+      std::string exception = "Scaling image has failed";
+      throw std::runtime_error(exception);
+    }
+    *imageWidthPtr = newWidth;
+    *imageHeightPtr = newHeight;
+    *stride = newStride;
+    return dataStore;
   } else {
     uint32_t newStride = imageWidth * 4 * (isImage64Bits ? sizeof(uint16_t) : sizeof(uint8_t));
-    aligned_uint8_vector dataStore(newStride * imageHeight);
+    aligned_uint8_vector dataStore = storeOf(pool, static_cast<size_t>(newStride) * imageHeight);
 
     if (isImage64Bits) {
       coder::CopyUnaligned(reinterpret_cast<const uint16_t *>(sourceData), *stride,
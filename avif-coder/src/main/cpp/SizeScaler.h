@@ -30,8 +30,8 @@
 #define AVIF_SIZESCALER_H
 
 #include <vector>
-#include <jni.h>
 #include "definitions.h"
+#include "FrameBufferPool.h"
 
 enum ScaleMode {
   Fit = 1,
@@ -49,6 +49,7 @@ aligned_uint8_vector RescaleSourceImage(uint8_t *data,
                                         int32_t scaledHeight,
                                         ScaleMode scaleMode,
                                         int scalingQuality,
-                                        bool isRgba);
+                                        bool isRgba,
+                                        coder::FrameBufferPool *pool = nullptr);
 
 #endif //AVIF_SIZESCALER_H
@@ -31,15 +31,7 @@
 
 #include <jni.h>
 #include "SizeScaler.h"
-
-enum PreferredColorConfig {
-    Default = 1,
-    Rgba_8888 = 2,
-    Rgba_F16 = 3,
-    Rgb_565 = 4,
-    Rgba_1010102 = 5,
-    Hardware = 6
-};
+#include "ColorConfig.h"
 
 bool checkDecodePreconditions(JNIEnv *env, jint javaColorspace, PreferredColorConfig *config,
                               jint javaScaleMode, ScaleMode *scaleMode);
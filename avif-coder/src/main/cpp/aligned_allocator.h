@@ -32,6 +32,7 @@
 #include <cstdint>
 #include <vector>
 #include <iostream>
+#include "AllocationTracker.h"
 
 template<typename T, std::size_t Alignment>
 class aligned_allocator {
@@ -128,10 +129,19 @@ public:
             throw std::bad_alloc();
         }
 
+#if AVIF_CODER_TRACK_ALLOCATIONS
+        coder::TrackAlignedAllocation(n * sizeof(T));
+#endif
+
         return static_cast<T *>(pv);
     }
 
-    void deallocate(T *const p, const std::size_t) const {
+    void deallocate(T *const p, [[maybe_unused]] const std::size_t n) const {
+#if AVIF_CODER_TRACK_ALLOCATIONS
+        if (p) {
+            coder::TrackAlignedDeallocation(n * sizeof(T));
+        }
+#endif
         free(p);
     }
 
@@ -1088,6 +1088,9 @@ static struct AvailableCodec availableCodecs[] = {
 #if defined(AVIF_CODEC_SVT)
     { AVIF_CODEC_CHOICE_SVT, AVIF_CODEC_TYPE_AV1, "svt", avifCodecVersionSvt, avifCodecCreateSvt, AVIF_CODEC_FLAG_CAN_ENCODE },
 #endif
+#if defined(AVIF_CODEC_MAROONTREE)
+    { AVIF_CODEC_CHOICE_MAROONTREE, AVIF_CODEC_TYPE_AV1, "maroontree", avifCodecVersionMaroontree, avifCodecCreateMaroontree, AVIF_CODEC_FLAG_CAN_ENCODE },
+#endif
 #if defined(AVIF_CODEC_AVM)
     { AVIF_CODEC_CHOICE_AVM, AVIF_CODEC_TYPE_AV2, "avm", avifCodecVersionAVM, avifCodecCreateAVM, AVIF_CODEC_FLAG_CAN_DECODE | AVIF_CODEC_FLAG_CAN_ENCODE },
 #endif
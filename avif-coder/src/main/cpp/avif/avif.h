@@ -1005,7 +1005,8 @@ typedef enum avifCodecChoice
     AVIF_CODEC_CHOICE_LIBGAV1, // Decode only
     AVIF_CODEC_CHOICE_RAV1E,   // Encode only
     AVIF_CODEC_CHOICE_SVT,     // Encode only
-    AVIF_CODEC_CHOICE_AVM      // Experimental (AV2)
+    AVIF_CODEC_CHOICE_AVM,     // Experimental (AV2)
+    AVIF_CODEC_CHOICE_MAROONTREE // Encode only, intra frames
 } avifCodecChoice;
 
 typedef enum avifCodecFlag
@@ -1295,6 +1296,13 @@ typedef struct avifDecoder
 
     // Version 1.1.0 ends here. Add any new members after this line.
 
+    // Maximum number of consecutive samples of an image sequence kept in flight by codecs capable of
+    // frame threading (defaults to 1). Values above 1 let the codec decode following frames in
+    // parallel while the current one is returned, which only pays off for sequential decoding:
+    // any seek that restarts from a keyframe drops the samples in flight. Only used with persistent
+    // IO, single tile inputs and when allowIncremental is false.
+    uint32_t maxFrameDelay;
+
 #if defined(AVIF_ENABLE_EXPERIMENTAL_GAIN_MAP)
     // Enable parsing the gain map metadata if present (defaults to AVIF_FALSE).
     // Gain map metadata is read during avifDecoderParse(). Like Exif and XMP, this data
@@ -1565,6 +1573,14 @@ AVIF_API avifResult avifEncoderFinish(avifEncoder * encoder, avifRWData * output
 // AVIF_RESULT_INVALID_CODEC_SPECIFIC_OPTION from avifEncoderWrite() or avifEncoderAddImage().
 AVIF_API avifResult avifEncoderSetCodecSpecificOption(avifEncoder * encoder, const char * key, const char * value);
 
+// Supplies the AV1 samples of AVIF_CODEC_CHOICE_MAROONTREE items instead of encoding the pixels
+// handed to the codec. It is asked once per encoded item in the order items are encoded: every
+// color cell in raster order, then every alpha cell. sample has to stay valid until the call returns.
+typedef avifResult (*avifMaroontreeSampleSource)(void * userData, avifBool alpha, avifROData * sample);
+// Installs source for the avifEncoderAddImage*() calls made on the calling thread, NULL restores
+// regular encoding. Lets cells encoded elsewhere in parallel be assembled into a grid.
+AVIF_API void avifMaroontreeSetSampleSource(avifMaroontreeSampleSource source, void * userData);
+
 #if defined(AVIF_ENABLE_EXPERIMENTAL_GAIN_MAP)
 // Returns the size in bytes of the AV1 image item containing gain map samples, or 0 if no gain map was encoded.
 AVIF_API size_t avifEncoderGetGainMapSizeBytes(avifEncoder * encoder);
@@ -28,6 +28,11 @@ struct avifCodecInternal
     Dav1dPicture dav1dPicture;
     avifBool hasPicture;
     avifRange colorRange;
+
+    // Frame threading state, frameDelay is 1 when samples are decoded one at a time
+    uint32_t frameDelay;
+    uint32_t samplesInFlight; // Sent or pending samples whose pictures were not returned yet
+    Dav1dData pendingData;    // Sample dav1d could not accept yet, counted in samplesInFlight
 };
 
 static void avifDav1dFreeCallback(const uint8_t * buf, void * cookie)
@@ -39,6 +44,9 @@ static void avifDav1dFreeCallback(const uint8_t * buf, void * cookie)
 
 static void dav1dCodecDestroyInternal(avifCodec * codec)
 {
+    if (codec->internal->pendingData.data) {
+        dav1d_data_unref(&codec->internal->pendingData);
+    }
     if (codec->internal->hasPicture) {
         dav1d_picture_unref(&codec->internal->dav1dPicture);
     }
@@ -48,40 +56,72 @@ static void dav1dCodecDestroyInternal(avifCodec * codec)
     avifFree(codec->internal);
 }
 
-static avifBool dav1dCodecGetNextImage(struct avifCodec * codec,
-                                       const avifDecodeSample * sample,
-                                       avifBool alpha,
-                                       avifBool * isLimitedRangeAlpha,
-                                       avifImage * image)
+static avifBool dav1dCodecSendPending(struct avifCodecInternal * internal)
 {
-    if (codec->internal->dav1dContext == NULL) {
-        Dav1dSettings dav1dSettings;
-        dav1d_default_settings(&dav1dSettings);
-        // Give all available threads to decode a single frame as fast as possible
-#if DAV1D_API_VERSION_MAJOR >= 6
-        dav1dSettings.max_frame_delay = 1;
-        dav1dSettings.n_threads = AVIF_CLAMP(codec->maxThreads, 1, DAV1D_MAX_THREADS);
-#else
-        dav1dSettings.n_frame_threads = 1;
-        dav1dSettings.n_tile_threads = AVIF_CLAMP(codec->maxThreads, 1, DAV1D_MAX_TILE_THREADS);
-#endif // DAV1D_API_VERSION_MAJOR >= 6
-        // Set a maximum frame size limit to avoid OOM'ing fuzzers. In 32-bit builds, if
-        // frame_size_limit > 8192 * 8192, dav1d reduces frame_size_limit to 8192 * 8192 and logs
-        // a message, so we set frame_size_limit to at most 8192 * 8192 to avoid the dav1d_log
-        // message.
-        dav1dSettings.frame_size_limit = (sizeof(size_t) < 8) ? AVIF_MIN(codec->imageSizeLimit, 8192 * 8192) : codec->imageSizeLimit;
-        dav1dSettings.operating_point = codec->operatingPoint;
-        dav1dSettings.all_layers = codec->allLayers;
+    if (!internal->pendingData.data) {
+        return AVIF_TRUE;
+    }
+    // EAGAIN means nothing was consumed, the data is retried after the next dav1d_get_picture()
+    int res = dav1d_send_data(internal->dav1dContext, &internal->pendingData);
+    if ((res < 0) && (res != DAV1D_ERR(EAGAIN))) {
+        dav1d_data_unref(&internal->pendingData);
+        return AVIF_FALSE;
+    }
+    return AVIF_TRUE;
+}
 
-        if (dav1d_open(&codec->internal->dav1dContext, &dav1dSettings) != 0) {
+static avifBool dav1dCodecQueueSample(struct avifCodecInternal * internal, const avifDecodeSample * sample)
+{
+    if (dav1d_data_wrap(&internal->pendingData, sample->data.data, sample->data.size, avifDav1dFreeCallback, NULL) != 0) {
+        return AVIF_FALSE;
+    }
+    ++internal->samplesInFlight;
+    return dav1dCodecSendPending(internal);
+}
+
+// Every sample of a single layer sequence yields exactly one picture, in sample order. The
+// current sample is sent unless it already went ahead, then up to frameDelay following samples
+// are kept in flight so the frame threads always have work while pictures are handed out.
+static avifBool dav1dCodecGetPipelinedPicture(struct avifCodec * codec, const avifDecodeSample * sample, Dav1dPicture * picture)
+{
+    struct avifCodecInternal * internal = codec->internal;
+    if (internal->samplesInFlight == 0) {
+        if (!dav1dCodecQueueSample(internal, sample)) {
+            return AVIF_FALSE;
+        }
+    }
+    while (!internal->pendingData.data && (internal->samplesInFlight < internal->frameDelay) &&
+           (internal->samplesInFlight - 1 < codec->lookaheadCount)) {
+        if (!dav1dCodecQueueSample(internal, &codec->lookaheadSamples[internal->samplesInFlight - 1])) {
             return AVIF_FALSE;
         }
     }
 
-    avifBool gotPicture = AVIF_FALSE;
-    Dav1dPicture nextFrame;
-    memset(&nextFrame, 0, sizeof(Dav1dPicture));
+    int idleRounds = 0;
+    for (;;) {
+        if (!dav1dCodecSendPending(internal)) {
+            return AVIF_FALSE;
+        }
+        int res = dav1d_get_picture(internal->dav1dContext, picture);
+        if (res == 0) {
+            break;
+        }
+        if (res != DAV1D_ERR(EAGAIN)) {
+            return AVIF_FALSE;
+        }
+        // A second dav1d_get_picture() in a row drains the oldest frame in flight, so getting
+        // EAGAIN from it with nothing left to send means the sample produced no picture.
+        if (!internal->pendingData.data && (++idleRounds > 1)) {
+            return AVIF_FALSE;
+        }
+    }
+    --internal->samplesInFlight;
+    return AVIF_TRUE;
+}
 
+// Sends one sample and waits for its picture, dropping anything else the sample produced
+static avifBool dav1dCodecGetSinglePicture(struct avifCodec * codec, const avifDecodeSample * sample, Dav1dPicture * nextFrame, avifBool * gotPicture)
+{
     Dav1dData dav1dData;
     if (dav1d_data_wrap(&dav1dData, sample->data.data, sample->data.size, avifDav1dFreeCallback, NULL) != 0) {
         return AVIF_FALSE;
@@ -97,7 +137,7 @@ static avifBool dav1dCodecGetNextImage(struct avifCodec * codec,
             }
         }
 
-        res = dav1d_get_picture(codec->internal->dav1dContext, &nextFrame);
+        res = dav1d_get_picture(codec->internal->dav1dContext, nextFrame);
         if (res == DAV1D_ERR(EAGAIN)) {
             if (dav1dData.data) {
                 // send more data
@@ -112,11 +152,11 @@ static avifBool dav1dCodecGetNextImage(struct avifCodec * codec,
             return AVIF_FALSE;
         } else {
             // Got a picture!
-            if ((sample->spatialID != AVIF_SPATIAL_ID_UNSET) && (sample->spatialID != nextFrame.frame_hdr->spatial_id)) {
+            if ((sample->spatialID != AVIF_SPATIAL_ID_UNSET) && (sample->spatialID != nextFrame->frame_hdr->spatial_id)) {
                 // Layer selection: skip this unwanted layer
-                dav1d_picture_unref(&nextFrame);
+                dav1d_picture_unref(nextFrame);
             } else {
-                gotPicture = AVIF_TRUE;
+                *gotPicture = AVIF_TRUE;
                 break;
             }
         }
@@ -136,8 +176,8 @@ static avifBool dav1dCodecGetNextImage(struct avifCodec * codec,
         res = dav1d_get_picture(codec->internal->dav1dContext, &bufferedFrame);
         if (res < 0) {
             if (res != DAV1D_ERR(EAGAIN)) {
-                if (gotPicture) {
-                    dav1d_picture_unref(&nextFrame);
+                if (*gotPicture) {
+                    dav1d_picture_unref(nextFrame);
                 }
                 return AVIF_FALSE;
             }
@@ -145,6 +185,56 @@ static avifBool dav1dCodecGetNextImage(struct avifCodec * codec,
             dav1d_picture_unref(&bufferedFrame);
         }
     } while (res == 0);
+    return AVIF_TRUE;
+}
+
+static avifBool dav1dCodecGetNextImage(struct avifCodec * codec,
+                                       const avifDecodeSample * sample,
+                                       avifBool alpha,
+                                       avifBool * isLimitedRangeAlpha,
+                                       avifImage * image)
+{
+    if (codec->internal->dav1dContext == NULL) {
+        Dav1dSettings dav1dSettings;
+        dav1d_default_settings(&dav1dSettings);
+        // Give all available threads to decode a single frame as fast as possible, unless the
+        // caller decodes a sequence frame after frame and frames may be decoded in parallel
+        codec->internal->frameDelay = 1;
+        if ((codec->maxFrameDelay > 1) && !codec->allLayers && (sample->spatialID == AVIF_SPATIAL_ID_UNSET)) {
+            codec->internal->frameDelay = AVIF_MIN(codec->maxFrameDelay, 256); // DAV1D_MAX_FRAME_DELAY
+        }
+#if DAV1D_API_VERSION_MAJOR >= 6
+        dav1dSettings.max_frame_delay = (unsigned int)codec->internal->frameDelay;
+        dav1dSettings.n_threads = AVIF_CLAMP(codec->maxThreads, 1, DAV1D_MAX_THREADS);
+#else
+        dav1dSettings.n_frame_threads = (int)codec->internal->frameDelay;
+        dav1dSettings.n_tile_threads = AVIF_CLAMP(codec->maxThreads, 1, DAV1D_MAX_TILE_THREADS);
+#endif // DAV1D_API_VERSION_MAJOR >= 6
+        // Set a maximum frame size limit to avoid OOM'ing fuzzers. In 32-bit builds, if
+        // frame_size_limit > 8192 * 8192, dav1d reduces frame_size_limit to 8192 * 8192 and logs
+        // a message, so we set frame_size_limit to at most 8192 * 8192 to avoid the dav1d_log
+        // message.
+        dav1dSettings.frame_size_limit = (sizeof(size_t) < 8) ? AVIF_MIN(codec->imageSizeLimit, 8192 * 8192) : codec->imageSizeLimit;
+        dav1dSettings.operating_point = codec->operatingPoint;
+        dav1dSettings.all_layers = codec->allLayers;
+
+        if (dav1d_open(&codec->internal->dav1dContext, &dav1dSettings) != 0) {
+            return AVIF_FALSE;
+        }
+    }
+
+    avifBool gotPicture = AVIF_FALSE;
+    Dav1dPicture nextFrame;
+    memset(&nextFrame, 0, sizeof(Dav1dPicture));
+
+    if (codec->internal->frameDelay > 1) {
+        if (!dav1dCodecGetPipelinedPicture(codec, sample, &nextFrame)) {
+            return AVIF_FALSE;
+        }
+        gotPicture = AVIF_TRUE;
+    } else if (!dav1dCodecGetSinglePicture(codec, sample, &nextFrame, &gotPicture)) {
+        return AVIF_FALSE;
+    }
 
     if (gotPicture) {
         dav1d_picture_unref(&codec->internal->dav1dPicture);
@@ -0,0 +1,252 @@
+// Copyright 2026 Radzivon Bartoshyk. All rights reserved.
+// SPDX-License-Identifier: BSD-2-Clause
+
+// AV1 encoder backed by maroontree through avifweaver. maroontree is a still
+// image encoder producing whole AVIF files, the AV1 payload of their primary
+// item is lifted out and handed to write.c, so every sample is a keyframe.
+
+#include "avif/internal.h"
+
+#include <stdbool.h>
+#include <string.h>
+
+// C mirrors of the avifweaver declarations used here, avifweaver.h is C++ only
+typedef struct WeaveYuvImage
+{
+    const uint8_t * y;
+    uint32_t y_stride;
+    const uint8_t * u;
+    uint32_t u_stride;
+    const uint8_t * v;
+    uint32_t v_stride;
+    const uint8_t * a;
+    uint32_t a_stride;
+    uint32_t width;
+    uint32_t height;
+    uint32_t bit_depth;
+    int32_t chroma_subsampling_code;
+    uint16_t color_primaries;
+    uint16_t transfer_characteristics;
+    uint16_t matrix_coefficients;
+    bool full_range;
+    uint32_t chroma_pixel_stride;
+    bool msb_aligned;
+} WeaveYuvImage;
+
+typedef enum WeaveEncodingSpeed
+{
+    WEAVE_SPEED_SLOW = 0,
+    WEAVE_SPEED_MEDIUM = 1,
+    WEAVE_SPEED_FAST = 2
+} WeaveEncodingSpeed;
+
+typedef struct WeaveEncodingOptions
+{
+    int32_t color_space;
+    int32_t quality;
+    bool lossless;
+    int32_t chroma_subsampling_code;
+    WeaveEncodingSpeed speed;
+    bool screen_content_coding;
+} WeaveEncodingOptions;
+
+typedef struct WeaveEncodedImage
+{
+    uint8_t * data;
+    uintptr_t length;
+    uintptr_t capacity;
+    char * error;
+} WeaveEncodedImage;
+
+WeaveEncodedImage weave_av1_encode_yuv(WeaveYuvImage image,
+                                       const uint8_t * exif,
+                                       uintptr_t exif_length,
+                                       WeaveEncodingOptions options,
+                                       uint32_t threads);
+void weave_encoded_image_free(WeaveEncodedImage image);
+
+// Pre-encoded samples of the calling thread, see avifMaroontreeSetSampleSource()
+static _Thread_local avifMaroontreeSampleSource sampleSource = NULL;
+static _Thread_local void * sampleSourceUserData = NULL;
+
+void avifMaroontreeSetSampleSource(avifMaroontreeSampleSource source, void * userData)
+{
+    sampleSource = source;
+    sampleSourceUserData = source ? userData : NULL;
+}
+
+static int32_t maroontreeChromaCode(avifPixelFormat format)
+{
+    switch (format) {
+        case AVIF_PIXEL_FORMAT_YUV422:
+            return 2;
+        case AVIF_PIXEL_FORMAT_YUV444:
+            return 3;
+        case AVIF_PIXEL_FORMAT_YUV400:
+            return 4;
+        default:
+            return 1;
+    }
+}
+
+static WeaveEncodingSpeed maroontreeSpeed(int speed)
+{
+    if (speed == AVIF_SPEED_DEFAULT) {
+        return WEAVE_SPEED_MEDIUM;
+    }
+    if (speed <= 3) {
+        return WEAVE_SPEED_SLOW;
+    }
+    return speed <= 7 ? WEAVE_SPEED_MEDIUM : WEAVE_SPEED_FAST;
+}
+
+// Byte range of the primary item payload inside a still AVIF file
+static avifResult maroontreeFindPayload(const uint8_t * data, size_t size, avifDiagnostics * diag, avifROData * payload)
+{
+    avifDecoder * decoder = avifDecoderCreate();
+    if (decoder == NULL) {
+        return AVIF_RESULT_OUT_OF_MEMORY;
+    }
+    decoder->ignoreExif = AVIF_TRUE;
+    decoder->ignoreXMP = AVIF_TRUE;
+    avifResult result = avifDecoderSetIOMemory(decoder, data, size);
+    if (result == AVIF_RESULT_OK) {
+        result = avifDecoderParse(decoder);
+    }
+    avifExtent extent;
+    if (result == AVIF_RESULT_OK) {
+        result = avifDecoderNthImageMaxExtent(decoder, 0, &extent);
+    }
+    if (result == AVIF_RESULT_OK) {
+        if ((extent.size == 0) || (extent.offset > size) || (extent.size > size - extent.offset)) {
+            avifDiagnosticsPrintf(diag, "maroontree output has no usable AV1 payload");
+            result = AVIF_RESULT_ENCODE_COLOR_FAILED;
+        } else {
+            payload->data = data + extent.offset;
+            payload->size = extent.size;
+        }
+    } else {
+        avifDiagnosticsPrintf(diag, "Failed to parse maroontree output: %s", avifResultToString(result));
+    }
+    avifDecoderDestroy(decoder);
+    return result;
+}
+
+static avifResult maroontreeCodecEncodeImage(avifCodec * codec,
+                                             avifEncoder * encoder,
+                                             const avifImage * image,
+                                             avifBool alpha,
+                                             int tileRowsLog2,
+                                             int tileColsLog2,
+                                             int quantizer,
+                                             avifEncoderChanges encoderChanges,
+                                             avifBool disableLaggedOutput,
+                                             avifAddImageFlags addImageFlags,
+                                             avifCodecEncodeOutput * output)
+{
+    // Every frame is encoded on its own, settings may change between them
+    (void)encoderChanges;
+    (void)disableLaggedOutput;
+    (void)addImageFlags;
+
+    if (sampleSource != NULL) {
+        avifROData sample = AVIF_DATA_EMPTY;
+        avifResult result = sampleSource(sampleSourceUserData, alpha, &sample);
+        if (result != AVIF_RESULT_OK) {
+            return result;
+        }
+        if ((sample.data == NULL) || (sample.size == 0)) {
+            avifDiagnosticsPrintf(codec->diag, "maroontree: sample source has no %s sample", alpha ? "alpha" : "color");
+            return alpha ? AVIF_RESULT_ENCODE_ALPHA_FAILED : AVIF_RESULT_ENCODE_COLOR_FAILED;
+        }
+        return avifCodecEncodeOutputAddSample(output, sample.data, sample.size, /*sync=*/AVIF_TRUE);
+    }
+
+    if ((tileRowsLog2 != 0) || (tileColsLog2 != 0) || (encoder->extraLayerCount > 0)) {
+        return AVIF_RESULT_NOT_IMPLEMENTED;
+    }
+    if ((image->depth != 8) && (image->depth != 10)) {
+        return AVIF_RESULT_NOT_IMPLEMENTED;
+    }
+
+    WeaveYuvImage planes;
+    memset(&planes, 0, sizeof(planes));
+    planes.width = image->width;
+    planes.height = image->height;
+    planes.bit_depth = image->depth;
+    if (alpha) {
+        planes.y = image->alphaPlane;
+        planes.y_stride = image->alphaRowBytes;
+        planes.chroma_subsampling_code = 4;
+        planes.color_primaries = AVIF_COLOR_PRIMARIES_UNSPECIFIED;
+        planes.transfer_characteristics = AVIF_TRANSFER_CHARACTERISTICS_UNSPECIFIED;
+        planes.matrix_coefficients = AVIF_MATRIX_COEFFICIENTS_UNSPECIFIED;
+        planes.full_range = true;
+    } else {
+        planes.y = image->yuvPlanes[AVIF_CHAN_Y];
+        planes.y_stride = image->yuvRowBytes[AVIF_CHAN_Y];
+        planes.u = image->yuvPlanes[AVIF_CHAN_U];
+        planes.u_stride = image->yuvRowBytes[AVIF_CHAN_U];
+        planes.v = image->yuvPlanes[AVIF_CHAN_V];
+        planes.v_stride = image->yuvRowBytes[AVIF_CHAN_V];
+        planes.chroma_subsampling_code = maroontreeChromaCode(image->yuvFormat);
+        planes.color_primaries = (uint16_t)image->colorPrimaries;
+        planes.transfer_characteristics = (uint16_t)image->transferCharacteristics;
+        planes.matrix_coefficients = (uint16_t)image->matrixCoefficients;
+        planes.full_range = image->yuvRange == AVIF_RANGE_FULL;
+    }
+    if (planes.y == NULL) {
+        return alpha ? AVIF_RESULT_ENCODE_ALPHA_FAILED : AVIF_RESULT_ENCODE_COLOR_FAILED;
+    }
+
+    // Inverse of the quality -> quantizer mapping of write.c
+    int quality = ((AVIF_QUANTIZER_WORST_QUALITY - quantizer) * 100 + AVIF_QUANTIZER_WORST_QUALITY / 2) /
+                  AVIF_QUANTIZER_WORST_QUALITY;
+    WeaveEncodingOptions options;
+    memset(&options, 0, sizeof(options));
+    options.quality = AVIF_CLAMP(quality, 1, 100);
+    options.lossless = quantizer == AVIF_QUANTIZER_LOSSLESS;
+    options.chroma_subsampling_code = planes.chroma_subsampling_code;
+    options.speed = maroontreeSpeed(encoder->speed);
+
+    const uint32_t threads = (uint32_t)AVIF_MAX(encoder->maxThreads, 1);
+    WeaveEncodedImage encoded = weave_av1_encode_yuv(planes, NULL, 0, options, threads);
+    if ((encoded.error != NULL) || (encoded.data == NULL)) {
+        avifDiagnosticsPrintf(codec->diag, "maroontree: %s", encoded.error ? encoded.error : "encoding failed");
+        weave_encoded_image_free(encoded);
+        return alpha ? AVIF_RESULT_ENCODE_ALPHA_FAILED : AVIF_RESULT_ENCODE_COLOR_FAILED;
+    }
+
+    avifROData payload;
+    avifResult result = maroontreeFindPayload(encoded.data, encoded.length, codec->diag, &payload);
+    if (result == AVIF_RESULT_OK) {
+        result = avifCodecEncodeOutputAddSample(output, payload.data, payload.size, /*sync=*/AVIF_TRUE);
+    }
+    weave_encoded_image_free(encoded);
+    return result;
+}
+
+static avifBool maroontreeCodecEncodeFinish(avifCodec * codec, avifCodecEncodeOutput * output)
+{
+    // Nothing is buffered, samples leave encodeImage immediately
+    (void)codec;
+    (void)output;
+    return AVIF_TRUE;
+}
+
+const char * avifCodecVersionMaroontree(void)
+{
+    return "avifweaver";
+}
+
+avifCodec * avifCodecCreateMaroontree(void)
+{
+    avifCodec * codec = (avifCodec *)avifAlloc(sizeof(avifCodec));
+    if (codec == NULL) {
+        return NULL;
+    }
+    memset(codec, 0, sizeof(struct avifCodec));
+    codec->encodeImage = maroontreeCodecEncodeImage;
+    codec->encodeFinish = maroontreeCodecEncodeFinish;
+    return codec;
+}
@@ -591,6 +591,11 @@ typedef struct avifCodec
     uint32_t imageSizeLimit; // See avifDecoder::imageSizeLimit.
     uint8_t operatingPoint;  // Operating point, defaults to 0.
     avifBool allLayers;      // if true, the underlying codec must decode all layers, not just the best layer
+    uint32_t maxFrameDelay;  // See avifDecoder::maxFrameDelay. Only read when the codec is first used.
+    // Already read samples following the one passed to getNextImage, a frame threading codec may
+    // send them ahead. Valid only during the getNextImage call, the data they point to is persistent.
+    const avifDecodeSample * lookaheadSamples;
+    uint32_t lookaheadCount;
 
     avifCodecGetNextImageFunc getNextImage;
     avifCodecEncodeImageFunc encodeImage;
@@ -613,6 +618,8 @@ AVIF_NODISCARD avifCodec * avifCodecCreateSvt(void);   // requires AVIF_CODEC_SV
 const char * avifCodecVersionSvt(void);                // requires AVIF_CODEC_SVT (codec_svt.c)
 AVIF_NODISCARD avifCodec * avifCodecCreateAVM(void);   // requires AVIF_CODEC_AVM (codec_avm.c)
 const char * avifCodecVersionAVM(void);                // requires AVIF_CODEC_AVM (codec_avm.c)
+AVIF_NODISCARD avifCodec * avifCodecCreateMaroontree(void); // requires AVIF_CODEC_MAROONTREE (codec_maroontree.c)
+const char * avifCodecVersionMaroontree(void);              // requires AVIF_CODEC_MAROONTREE (codec_maroontree.c)
 
 // ---------------------------------------------------------------------------
 // avifDiagnostics
@@ -4630,6 +4630,7 @@ avifDecoder * avifDecoderCreate(void)
     }
     memset(decoder, 0, sizeof(avifDecoder));
     decoder->maxThreads = 1;
+    decoder->maxFrameDelay = 1;
     decoder->imageSizeLimit = AVIF_DEFAULT_IMAGE_SIZE_LIMIT;
     decoder->imageDimensionLimit = AVIF_DEFAULT_IMAGE_DIMENSION_LIMIT;
     decoder->imageCountLimit = AVIF_DEFAULT_IMAGE_COUNT_LIMIT;
@@ -6114,6 +6115,26 @@ static avifResult avifDecoderDecodeTiles(avifDecoder * decoder, uint32_t nextIma
         avifBool isLimitedRangeAlpha = AVIF_FALSE;
         tile->codec->maxThreads = decoder->maxThreads;
         tile->codec->imageSizeLimit = decoder->imageSizeLimit;
+        tile->codec->maxFrameDelay = 1;
+        tile->codec->lookaheadSamples = NULL;
+        tile->codec->lookaheadCount = 0;
+        if ((decoder->maxFrameDelay > 1) && (decoder->data->source == AVIF_DECODER_SOURCE_TRACKS) && (info->tileCount == 1) &&
+            decoder->io->persistent && !decoder->allowIncremental && !tile->input->allLayers) {
+            // Samples sent ahead must stay readable until their pictures are returned, which holds
+            // for persistent IO where the sample data points directly into the IO buffer.
+            uint32_t lookaheadCount = 0;
+            while ((lookaheadCount + 1 < decoder->maxFrameDelay) && (nextImageIndex + lookaheadCount + 1 < tile->input->samples.count)) {
+                avifDecodeSample * lookaheadSample = &tile->input->samples.sample[nextImageIndex + lookaheadCount + 1];
+                if ((avifDecoderPrepareSample(decoder, lookaheadSample, 0) != AVIF_RESULT_OK) ||
+                    (lookaheadSample->data.size < lookaheadSample->size)) {
+                    break;
+                }
+                ++lookaheadCount;
+            }
+            tile->codec->maxFrameDelay = decoder->maxFrameDelay;
+            tile->codec->lookaheadSamples = sample + 1;
+            tile->codec->lookaheadCount = lookaheadCount;
+        }
         if (!tile->codec->getNextImage(tile->codec, sample, avifIsAlpha(tile->input->itemCategory), &isLimitedRangeAlpha, tile->image)) {
             avifDiagnosticsPrintf(&decoder->diag, "tile->codec->getNextImage() failed");
             return avifGetErrorForItemCategory(tile->input->itemCategory);
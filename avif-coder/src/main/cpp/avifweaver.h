@@ -5,7 +5,15 @@
 #include <cstdlib>
 #include <ostream>
 #include <new>
+
+// JNI entry points are declared with opaque handles when the includer has no jni.h
+#if defined(AVIFWEAVER_NO_JNI)
+typedef void JNIEnv;
+typedef void *jobject;
+typedef jobject jbyteArray;
+#else
 #include <jni.h>
+#endif
 
 enum class AvEncodingSpeed {
   Slow,
@@ -13,6 +21,14 @@ enum class AvEncodingSpeed {
   Fast,
 };
 
+/// Pixel layout of a caller owned image handed to the `*_buffer` encoders.
+enum class WeavePixelFormat {
+  Rgba8888,
+  Rgb565,
+  RgbaF16,
+  Rgba1010102,
+};
+
 enum class WeaveScaleMode {
   JustResize,
   ScaleToFill,
@@ -139,6 +155,103 @@ struct HevcEncodingOptions {
   bool lossless_ycbcr;
 };
 
+struct WeaveImageBuffer {
+  const uint8_t *data;
+  uint32_t stride;
+  uint32_t width;
+  uint32_t height;
+  WeavePixelFormat format;
+  bool premultiplied;
+};
+
+/// Caller owned YUV image handed to `weave_av1_encode_yuv` and `weave_hevc_encode_yuv`.
+/// Samples are `u8` for 8 bit images and native endian `u16` otherwise,
+/// strides are in bytes. `u` and `v` are ignored for 4:0:0.
+struct WeaveYuvImage {
+  const uint8_t *y;
+  uint32_t y_stride;
+  const uint8_t *u;
+  uint32_t u_stride;
+  const uint8_t *v;
+  uint32_t v_stride;
+  /// Null when the image has no alpha
+  const uint8_t *a;
+  uint32_t a_stride;
+  uint32_t width;
+  uint32_t height;
+  /// 8 or 10
+  uint32_t bit_depth;
+  /// Same codes as [AvifEncodingOptions::chroma_subsampling_code]
+  int32_t chroma_subsampling_code;
+  uint16_t color_primaries;
+  uint16_t transfer_characteristics;
+  uint16_t matrix_coefficients;
+  bool full_range;
+  /// Distance in samples between two chroma samples of a row. 2 reads
+  /// interleaved chroma (NV12, NV21, P010) where `u` and `v` point into
+  /// the same rows; 0 is treated as 1.
+  uint32_t chroma_pixel_stride;
+  /// `u16` samples keep their bits at the top, as in P010
+  bool msb_aligned;
+};
+
+/// Encoded bitstream produced by the `*_buffer` encoders.
+/// Exactly one of `data` and `error` is set, both are released with
+/// [weave_encoded_image_free].
+struct EncodedImage {
+  uint8_t *data;
+  uintptr_t length;
+  uintptr_t capacity;
+  char *error;
+};
+
+/// AV1 planes converted by `weave_av1_prepare`, opaque to callers.
+/// Released with [weave_av1_prepared_free].
+struct WeaveAv1Prepared;
+
+/// Outcome of `weave_av1_prepare`. Exactly one of `prepared` and `error` is set,
+/// the error is released with [weave_av1_prepare_error_free].
+struct WeaveAv1PrepareResult {
+  WeaveAv1Prepared *prepared;
+  char *error;
+};
+
+/// What an AVIF file has to carry next to the planes of a transcoded HEIC.
+/// Pointers are borrowed from the [WeaveHeicTranscode] they were read from.
+struct WeaveHeicMetadata {
+  /// Null when the file has no ICC profile
+  const uint8_t *icc;
+  uintptr_t icc_length;
+  /// TIFF header first, null when the file has no Exif
+  const uint8_t *exif;
+  uintptr_t exif_length;
+  /// ITU-T H.273 code points of the planes
+  uint16_t color_primaries;
+  uint16_t transfer_characteristics;
+  uint16_t matrix_coefficients;
+  /// `irot` angle in anticlockwise quarter turns
+  uint8_t rotation;
+  /// `imir` axis, 0 exchanges top and bottom, 1 left and right, -1 doesn't mirror
+  int8_t mirror;
+  bool has_clean_aperture;
+  /// `clap` fractions as numerator, denominator pairs: width, height,
+  /// horizontal offset, vertical offset. Offsets are signed.
+  uint32_t clean_aperture[8];
+  /// Planes went through RGB, crop and orientation are already applied
+  bool converted;
+};
+
+/// HEIC decoded by `weave_heic_transcode_prepare`, opaque to callers.
+/// Released with [weave_heic_transcode_free].
+struct WeaveHeicTranscode;
+
+/// Outcome of `weave_heic_transcode_prepare`. Exactly one of `transcode` and
+/// `error` is set, the error is released with [weave_av1_prepare_error_free].
+struct WeaveHeicTranscodeResult {
+  WeaveHeicTranscode *transcode;
+  char *error;
+};
+
 struct FfiProfileData {
   uint8_t *data;
   uintptr_t size;
@@ -170,6 +283,55 @@ jbyteArray encode_avif_av1_file(JNIEnv *env,
                                 jobject exif,
                                 AvifEncodingOptions options);
 
+/// JNI free counterpart of [encode_avif_av1_file] encoding a caller owned
+/// pixel buffer. Errors and panics are reported in [EncodedImage::error].
+EncodedImage encode_avif_av1_buffer(WeaveImageBuffer image,
+                                    const uint8_t *exif,
+                                    uintptr_t exif_length,
+                                    AvifEncodingOptions options);
+
+/// Converts a caller owned pixel buffer into AV1 planes without encoding them.
+/// Only the colour settings of `options` are used here: colour space, chroma
+/// subsampling and lossless. The pixels may be released once this returns.
+WeaveAv1PrepareResult weave_av1_prepare(WeaveImageBuffer image, AvifEncodingOptions options);
+
+/// Encodes planes from [weave_av1_prepare] with `threads` encoder threads, 0 uses
+/// every core. Quality, speed and screen content come from `options`, its colour
+/// settings are ignored. `prepared` stays owned by the caller and may be encoded again.
+EncodedImage weave_av1_encode_prepared(const WeaveAv1Prepared *prepared,
+                                       const uint8_t *exif,
+                                       uintptr_t exif_length,
+                                       AvifEncodingOptions options,
+                                       uint32_t threads);
+
+/// Describes the planes held by `prepared` without copying them, alpha is null
+/// when the image is opaque. Pointers stay valid until the prepared image is
+/// released, strides are in bytes.
+WeaveYuvImage weave_av1_prepared_planes(const WeaveAv1Prepared *prepared);
+
+/// Alpha sample every pixel of `prepared` has at its bit depth when
+/// [weave_av1_prepared_planes] reports no alpha plane.
+uint16_t weave_av1_prepared_constant_alpha(const WeaveAv1Prepared *prepared);
+
+/// Encodes caller owned YUV planes as is, no colour conversion happens. Quality,
+/// speed, lossless and screen content come from `options`, colour space and chroma
+/// subsampling are described by `image`. `threads` 0 uses every core.
+EncodedImage weave_av1_encode_yuv(WeaveYuvImage image,
+                                  const uint8_t *exif,
+                                  uintptr_t exif_length,
+                                  AvifEncodingOptions options,
+                                  uint32_t threads);
+
+/// Decodes a HEIC file for AVIF without leaving YUV: the HEVC planes, alpha,
+/// ICC and Exif are kept, orientation and clean aperture become AVIF transforms.
+/// Only planes AV1 can't carry as they are go through RGB, `through_rgb` forces
+/// that for callers that can't mux the transforms. Lossless comes from `options`,
+/// its colour space and chroma subsampling are ignored.
+WeaveHeicTranscodeResult weave_heic_transcode_prepare(const uint8_t *data,
+                                                      uintptr_t length,
+                                                      AvifEncodingOptions options,
+                                                      bool through_rgb);
+
 jobject decode_av2_file(JNIEnv *env,
                         const uint8_t *data,
                         uintptr_t length,
@@ -185,6 +347,20 @@ jbyteArray encode_avif_av2_file(JNIEnv *env,
                                 jobject exif,
                                 AvifEncodingOptions options);
 
+void weave_encoded_image_free(EncodedImage image);
+
+void weave_av1_prepared_free(WeaveAv1Prepared *prepared);
+
+void weave_av1_prepare_error_free(char *error);
+
+/// Planes of `transcode` for `weave_av1_prepared_planes` and
+/// `weave_av1_encode_prepared`, owned by `transcode`.
+const WeaveAv1Prepared *weave_heic_transcode_prepared(const WeaveHeicTranscode *transcode);
+
+WeaveHeicMetadata weave_heic_transcode_metadata(const WeaveHeicTranscode *transcode);
+
+void weave_heic_transcode_free(WeaveHeicTranscode *transcode);
+
 bool is_heic_image(const uint8_t *data, uintptr_t len);
 
 bool is_avif_image(const uint8_t *data, uintptr_t len);
@@ -242,6 +418,22 @@ HeicInfo read_heic_file_info(const uint8_t *data, uintptr_t length);
 
 jbyteArray encode_heic_file(JNIEnv *env, jobject image, jobject exif, HevcEncodingOptions options);
 
+/// JNI free counterpart of [encode_heic_file] encoding a caller owned
+/// pixel buffer. Errors and panics are reported in [EncodedImage::error].
+EncodedImage encode_heic_buffer(WeaveImageBuffer image,
+                                const uint8_t *exif,
+                                uintptr_t exif_length,
+                                HevcEncodingOptions options);
+
+/// Encodes caller owned YUV planes as HEIC, no colour conversion happens. Colour
+/// space and chroma subsampling are described by `image`, the rest comes from
+/// `options`. `threads` 0 uses every core.
+EncodedImage weave_hevc_encode_yuv(WeaveYuvImage image,
+                                   const uint8_t *exif,
+                                   uintptr_t exif_length,
+                                   HevcEncodingOptions options,
+                                   uint32_t threads);
+
 void apply_icc_rgba8(const uint8_t *src_image,
                      uint32_t src_stride,
                      uint8_t *dst_image,
@@ -313,6 +505,44 @@ ScalingResultU16 weave_scale_u16(const uint16_t *src,
                                  bool premultiply_alpha,
                                  WeaveScaleMode scale_mode);
 
+/// Size [weave_scale_u8_into] and [weave_scale_u16_into] produce for these
+/// arguments, so callers can size the destination first. False for an empty source.
+bool weave_scaled_size(uint32_t width,
+                       uint32_t height,
+                       int32_t new_width,
+                       int32_t new_height,
+                       WeaveScaleMode scale_mode,
+                       uint32_t *scaled_width,
+                       uint32_t *scaled_height);
+
+/// Same as [weave_scale_u8] but writes into caller owned `dst` of `dst_stride`
+/// bytes per row, sized by [weave_scaled_size]. Returns false when scaling fails.
+bool weave_scale_u8_into(const uint8_t *src,
+                         uint32_t src_stride,
+                         uint32_t width,
+                         uint32_t height,
+                         int32_t new_width,
+                         int32_t new_height,
+                         bool premultiply_alpha,
+                         WeaveScaleMode scale_mode,
+                         uint8_t *dst,
+                         uint32_t dst_stride);
+
+/// Same as [weave_scale_u16] but writes into caller owned `dst` of `dst_stride`
+/// bytes per row, sized by [weave_scaled_size]. `dst` has to be aligned to u16.
+/// Returns false when scaling fails.
+bool weave_scale_u16_into(const uint16_t *src,
+                          uintptr_t src_stride,
+                          uint32_t width,
+                          uint32_t height,
+                          int32_t new_width,
+                          int32_t new_height,
+                          uintptr_t bit_depth,
+                          bool premultiply_alpha,
+                          WeaveScaleMode scale_mode,
+                          uint16_t *dst,
+                          uintptr_t dst_stride);
+
 void weave_scale_f16(const uint16_t *src,
                      uintptr_t src_stride,
                      uint32_t width,
@@ -359,6 +589,34 @@ jbyteArray encode_avif_av1_file(JNIEnv *env,
                                 jobject _exif,
                                 AvifEncodingOptions _options);
 
+EncodedImage encode_avif_av1_buffer(WeaveImageBuffer _image,
+                                    const uint8_t *_exif,
+                                    uintptr_t _exif_length,
+                                    AvifEncodingOptions _options);
+
+WeaveAv1PrepareResult weave_av1_prepare(WeaveImageBuffer _image, AvifEncodingOptions _options);
+
+EncodedImage weave_av1_encode_prepared(const WeaveAv1Prepared *_prepared,
+                                       const uint8_t *_exif,
+                                       uintptr_t _exif_length,
+                                       AvifEncodingOptions _options,
+                                       uint32_t _threads);
+
+WeaveYuvImage weave_av1_prepared_planes(const WeaveAv1Prepared *_prepared);
+
+uint16_t weave_av1_prepared_constant_alpha(const WeaveAv1Prepared *_prepared);
+
+EncodedImage weave_av1_encode_yuv(WeaveYuvImage _image,
+                                  const uint8_t *_exif,
+                                  uintptr_t _exif_length,
+                                  AvifEncodingOptions _options,
+                                  uint32_t _threads);
+
+WeaveHeicTranscodeResult weave_heic_transcode_prepare(const uint8_t *_data,
+                                                      uintptr_t _length,
+                                                      AvifEncodingOptions _options,
+                                                      bool _through_rgb);
+
 jbyteArray encode_avif_av2_file(JNIEnv *env,
                                 jobject _image,
                                 jobject _exif,
@@ -369,6 +627,17 @@ jbyteArray encode_heic_file(JNIEnv *env,
                             jobject _exif,
                             HevcEncodingOptions _options);
 
+EncodedImage encode_heic_buffer(WeaveImageBuffer _image,
+                                const uint8_t *_exif,
+                                uintptr_t _exif_length,
+                                HevcEncodingOptions _options);
+
+EncodedImage weave_hevc_encode_yuv(WeaveYuvImage _image,
+                                   const uint8_t *_exif,
+                                   uintptr_t _exif_length,
+                                   HevcEncodingOptions _options,
+                                   uint32_t _threads);
+
 jobject decode_heic_file(JNIEnv *env,
                          const uint8_t *_data,
                          uintptr_t _length,
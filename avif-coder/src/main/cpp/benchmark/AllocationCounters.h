@@ -0,0 +1,50 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_BENCHMARK_ALLOCATIONCOUNTERS_H_
+#define AVIF_CODER_SRC_MAIN_CPP_BENCHMARK_ALLOCATIONCOUNTERS_H_
+
+#include <cstdint>
+
+namespace coder::benchmark {
+
+struct AllocationCounters {
+  uint64_t allocations;
+  uint64_t allocatedBytes;
+};
+
+/**
+ * Totals of malloc family calls made from code linked statically into the
+ * load generator: libavif, avifweaver and the coder sources.
+ * Requires linking with -Wl,--wrap for every wrapped symbol.
+ */
+AllocationCounters ReadAllocationCounters() noexcept;
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_BENCHMARK_ALLOCATIONCOUNTERS_H_
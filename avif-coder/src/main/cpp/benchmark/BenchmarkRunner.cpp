@@ -0,0 +1,249 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "BenchmarkRunner.h"
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <thread>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h>
+#endif
+
+namespace {
+
+using namespace coder::benchmark;
+
+std::vector<BenchmarkDefinition> &registry() {
+  static std::vector<BenchmarkDefinition> benchmarks;
+  return benchmarks;
+}
+
+struct RunnerOptions {
+  std::string filter;
+  double minTime = 0.5;
+  std::vector<uint32_t> threads;
+  std::vector<BenchmarkShape> shapes;
+  std::vector<uint32_t> paddings;
+};
+
+struct Measurement {
+  uint64_t iterations;
+  double seconds;
+  uint64_t cycles;
+};
+
+// Invariant TSC on x86, zero elsewhere so bytes/cycle is reported as unavailable
+uint64_t readCycles() {
+#if defined(__x86_64__) || defined(__i386__)
+  return __rdtsc();
+#else
+  return 0;
+#endif
+}
+
+std::vector<std::string> split(const std::string &value, char separator) {
+  std::vector<std::string> parts;
+  size_t start = 0;
+  while (start <= value.size()) {
+    size_t end = value.find(separator, start);
+    if (end == std::string::npos) {
+      end = value.size();
+    }
+    if (end > start) {
+      parts.push_back(value.substr(start, end - start));
+    }
+    start = end + 1;
+  }
+  return parts;
+}
+
+bool parseOptions(int argc, char **argv, RunnerOptions *options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    auto valueOf = [&](const char *prefix) -> const char * {
+      size_t length = std::strlen(prefix);
+      return arg.compare(0, length, prefix) == 0 ? argv[i] + length : nullptr;
+    };
+    if (auto value = valueOf("--filter=")) {
+      options->filter = value;
+    } else if (auto value = valueOf("--min-time=")) {
+      options->minTime = std::max(0.01, std::atof(value));
+    } else if (auto value = valueOf("--threads=")) {
+      options->threads.clear();
+      for (const auto &part: split(value, ',')) {
+        options->threads.push_back(std::max(1, std::atoi(part.c_str())));
+      }
+    } else if (auto value = valueOf("--sizes=")) {
+      options->shapes.clear();
+      for (const auto &part: split(value, ',')) {
+        uint32_t width = 0, height = 0;
+        if (std::sscanf(part.c_str(), "%ux%u", &width, &height) != 2 || !width || !height) {
+          std::fprintf(stderr, "Invalid size: %s\n", part.c_str());
+          return false;
+        }
+        options->shapes.push_back({.width = width, .height = height, .stridePadding = 0});
+      }
+    } else if (auto value = valueOf("--paddings=")) {
+      options->paddings.clear();
+      for (const auto &part: split(value, ',')) {
+        options->paddings.push_back(static_cast<uint32_t>(std::atoi(part.c_str())));
+      }
+    } else {
+      std::fprintf(stderr,
+                   "Usage: %s [--filter=substring] [--min-time=seconds]"
+                   " [--threads=1,4] [--sizes=1920x1080,...] [--paddings=0,40]\n",
+                   argv[0]);
+      return false;
+    }
+  }
+  return true;
+}
+
+Measurement runBatch(std::vector<std::unique_ptr<BenchmarkFixture>> &fixtures,
+                     uint64_t iterations) {
+  std::vector<std::thread> workers;
+  auto worker = [iterations](BenchmarkFixture *fixture) {
+    for (uint64_t i = 0; i < iterations; ++i) {
+      fixture->run();
+    }
+  };
+  const auto start = std::chrono::steady_clock::now();
+  const uint64_t cyclesStart = readCycles();
+  for (size_t i = 1; i < fixtures.size(); ++i) {
+    workers.emplace_back(worker, fixtures[i].get());
+  }
+  worker(fixtures[0].get());
+  for (auto &thread: workers) {
+    thread.join();
+  }
+  const uint64_t cyclesEnd = readCycles();
+  const auto end = std::chrono::steady_clock::now();
+  return {
+      .iterations = iterations,
+      .seconds = std::chrono::duration<double>(end - start).count(),
+      .cycles = cyclesEnd - cyclesStart,
+  };
+}
+
+Measurement measure(const BenchmarkDefinition &definition, const BenchmarkShape &shape,
+                    uint32_t threads, double minTime) {
+  std::vector<std::unique_ptr<BenchmarkFixture>> fixtures;
+  for (uint32_t i = 0; i < threads; ++i) {
+    fixtures.push_back(definition.factory(shape));
+  }
+  // Warm up caches and page in buffers
+  runBatch(fixtures, 1);
+
+  uint64_t iterations = 1;
+  for (;;) {
+    Measurement measurement = runBatch(fixtures, iterations);
+    if (measurement.seconds >= minTime || iterations >= (1ull << 30)) {
+      return measurement;
+    }
+    // Aim a bit above the minimum so the next batch is usually the last one
+    double scale = measurement.seconds > 0 ? (minTime * 1.4) / measurement.seconds : 10.0;
+    iterations = std::max(iterations + 1,
+                          static_cast<uint64_t>(static_cast<double>(iterations)
+                                                    * std::min(scale, 10.0)));
+  }
+}
+
+}
+
+namespace coder::benchmark {
+
+void RegisterBenchmark(std::string name, uint32_t bytesPerPixel, FixtureFactory factory) {
+  registry().push_back({
+                           .name = std::move(name),
+                           .bytesPerPixel = bytesPerPixel,
+                           .factory = std::move(factory),
+                       });
+}
+
+}
+
+int main(int argc, char **argv) {
+  RunnerOptions options;
+  options.threads = {1, std::max(1u, std::thread::hardware_concurrency())};
+  options.shapes = {
+      {.width = 256, .height = 256, .stridePadding = 0},
+      {.width = 1920, .height = 1080, .stridePadding = 0},
+      {.width = 4032, .height = 3024, .stridePadding = 0},
+  };
+  // 40 bytes keeps rows element aligned while breaking 16/32/64 byte alignment
+  options.paddings = {0, 40};
+  if (!parseOptions(argc, argv, &options)) {
+    return 1;
+  }
+  if (options.threads.size() == 2 && options.threads[0] == options.threads[1]) {
+    options.threads.pop_back();
+  }
+
+  RegisterKernelBenchmarks();
+#if AVIF_BENCHMARK_WEAVER
+  RegisterWeaveBenchmarks();
+#endif
+
+  std::printf("%-64s %14s %12s %10s %12s\n", "Benchmark", "Time/iter", "Iterations", "MP/s",
+              "Bytes/cycle");
+  for (const auto &definition: registry()) {
+    if (!options.filter.empty() && definition.name.find(options.filter) == std::string::npos) {
+      continue;
+    }
+    for (auto shape: options.shapes) {
+      for (uint32_t padding: options.paddings) {
+        shape.stridePadding = padding;
+        for (uint32_t threads: options.threads) {
+          Measurement measurement = measure(definition, shape, threads, options.minTime);
+          const double pixels = static_cast<double>(shape.width) * shape.height
+              * static_cast<double>(measurement.iterations) * threads;
+          const double megapixelsPerSecond = pixels / measurement.seconds / 1e6;
+          const double timePerIteration =
+              measurement.seconds / static_cast<double>(measurement.iterations) * 1e3;
+
+          char name[256];
+          std::snprintf(name, sizeof(name), "%s/%ux%u/pad:%u/threads:%u",
+                        definition.name.c_str(), shape.width, shape.height, padding, threads);
+          char bytesPerCycle[32] = "n/a";
+          if (measurement.cycles > 0) {
+            std::snprintf(bytesPerCycle, sizeof(bytesPerCycle), "%.3f",
+                          pixels * definition.bytesPerPixel
+                              / static_cast<double>(measurement.cycles));
+          }
+          std::printf("%-64s %11.3f ms %12llu %10.1f %12s\n", name, timePerIteration,
+                      static_cast<unsigned long long>(measurement.iterations),
+                      megapixelsPerSecond, bytesPerCycle);
+          std::fflush(stdout);
+        }
+      }
+    }
+  }
+  return 0;
+}
@@ -0,0 +1,146 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_BENCHMARK_BENCHMARKRUNNER_H_
+#define AVIF_CODER_SRC_MAIN_CPP_BENCHMARK_BENCHMARKRUNNER_H_
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "definitions.h"
+
+namespace coder::benchmark {
+
+struct BenchmarkShape {
+  uint32_t width;
+  uint32_t height;
+  // Extra bytes appended to every row of every buffer
+  uint32_t stridePadding;
+};
+
+/**
+ * Owns buffers of a single benchmark instance. Every worker thread
+ * gets its own fixture, so run() never shares memory between threads.
+ */
+class BenchmarkFixture {
+ public:
+  virtual ~BenchmarkFixture() = default;
+  virtual void run() = 0;
+};
+
+using FixtureFactory = std::function<std::unique_ptr<BenchmarkFixture>(const BenchmarkShape &)>;
+
+struct BenchmarkDefinition {
+  std::string name;
+  // Source and destination bytes touched per pixel, used for bytes/cycle
+  uint32_t bytesPerPixel;
+  FixtureFactory factory;
+};
+
+void RegisterBenchmark(std::string name, uint32_t bytesPerPixel, FixtureFactory factory);
+
+void RegisterKernelBenchmarks();
+#if AVIF_BENCHMARK_WEAVER
+void RegisterWeaveBenchmarks();
+#endif
+
+/**
+ * Strided image filled with deterministic noise in [0, maxValue]
+ */
+template<typename T>
+class BenchmarkImage {
+ public:
+  BenchmarkImage(uint32_t width, uint32_t height, uint32_t channels,
+                 uint32_t padding, uint32_t maxValue)
+      : rowBytes(width * channels * sizeof(T) + padding),
+        store(static_cast<size_t>(rowBytes) * height) {
+    uint32_t state = 0x9E3779B9u ^ (width * 31 + height);
+    for (uint32_t y = 0; y < height; ++y) {
+      auto row = reinterpret_cast<T *>(store.data() + static_cast<size_t>(y) * rowBytes);
+      for (uint32_t x = 0; x < width * channels; ++x) {
+        state = state * 1664525u + 1013904223u;
+        row[x] = static_cast<T>((state >> 8) % (maxValue + 1));
+      }
+    }
+  }
+
+  T *data() { return reinterpret_cast<T *>(store.data()); }
+  [[nodiscard]] uint32_t stride() const { return rowBytes; }
+
+ private:
+  uint32_t rowBytes;
+  aligned_uint8_vector store;
+};
+
+/**
+ * Source to destination kernel with strides in bytes, covers most of imagebits
+ */
+template<typename Src, typename Dst>
+class ImageKernelFixture : public BenchmarkFixture {
+ public:
+  using Kernel = std::function<void(Src *, uint32_t, Dst *, uint32_t, uint32_t, uint32_t)>;
+
+  ImageKernelFixture(const BenchmarkShape &shape,
+                     uint32_t srcChannels, uint32_t srcMaxValue,
+                     uint32_t dstChannels, Kernel kernel)
+      : shape(shape),
+        source(shape.width, shape.height, srcChannels, shape.stridePadding, srcMaxValue),
+        destination(shape.width, shape.height, dstChannels, shape.stridePadding, 0),
+        kernel(std::move(kernel)) {}
+
+  void run() override {
+    kernel(source.data(), source.stride(), destination.data(), destination.stride(),
+           shape.width, shape.height);
+  }
+
+ private:
+  BenchmarkShape shape;
+  BenchmarkImage<Src> source;
+  BenchmarkImage<Dst> destination;
+  Kernel kernel;
+};
+
+template<typename Src, typename Dst>
+void RegisterImageKernel(const std::string &name,
+                         uint32_t srcChannels, uint32_t srcMaxValue,
+                         uint32_t dstChannels,
+                         typename ImageKernelFixture<Src, Dst>::Kernel kernel) {
+  const auto bytesPerPixel =
+      static_cast<uint32_t>(srcChannels * sizeof(Src) + dstChannels * sizeof(Dst));
+  RegisterBenchmark(name, bytesPerPixel,
+                    [=](const BenchmarkShape &shape) -> std::unique_ptr<BenchmarkFixture> {
+                      return std::make_unique<ImageKernelFixture<Src, Dst>>(
+                          shape, srcChannels, srcMaxValue, dstChannels, kernel);
+                    });
+}
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_BENCHMARK_BENCHMARKRUNNER_H_
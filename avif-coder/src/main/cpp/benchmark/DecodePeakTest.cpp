@@ -0,0 +1,74 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+
+// Decodes a fixture at source size inside a DecodeAllocationScope and fails when the
+// tracked peak exceeds two full RGBA frames. Needs CODER_TRACK_ALLOCATIONS.
+//   coder_decode_peak_test [image.avif]
+
+#include <cstdio>
+#include <exception>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <vector>
+#include "AllocationTracker.h"
+#include "CoderCore.h"
+
+namespace {
+constexpr double kMaxPeakFullFrames = 2.0;
+}
+
+int main(int argc, char **argv) {
+  const std::string path = argc > 1 ? argv[1] : AVIF_DECODE_PEAK_FIXTURE;
+  std::ifstream stream(path, std::ios::binary);
+  std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)),
+                            std::istreambuf_iterator<char>());
+  if (data.empty()) {
+    std::fprintf(stderr, "Can't read %s\n", path.c_str());
+    return 1;
+  }
+
+  try {
+    coder::DecodeAllocationScope allocationScope;
+    coder::DecodedImage image = coder::DecodeImage(data.data(), data.size(), {});
+    const coder::AllocationReport &report = allocationScope.report();
+    if (report.fullFrameBytes == 0 || report.peakBytes == 0) {
+      throw std::runtime_error("Decode allocations were not tracked");
+    }
+    allocationScope.expectPeakWithinFullFrames(kMaxPeakFullFrames);
+    std::printf("%s %ux%u peak %.2f full frames\n", path.c_str(), image.width, image.height,
+                static_cast<double>(report.peakBytes)
+                    / static_cast<double>(report.fullFrameBytes));
+  } catch (std::exception &e) {
+    std::fprintf(stderr, "%s: %s\n", path.c_str(), e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+// Encodes an RgbaF16 grid whose left cells share a constant half transparent alpha
+// while the right column varies, and fails when the constant cells decode opaque.
+//   coder_grid_alpha_test
+
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <vector>
+#include "CoderCore.h"
+
+namespace {
+constexpr uint32_t kTileSize = 64;
+constexpr uint32_t kWidth = kTileSize * 3;
+constexpr uint32_t kHeight = kTileSize * 2;
+// Halfs of 0.25, 0.5 and 1.0
+constexpr uint16_t kQuarter = 0x3400;
+constexpr uint16_t kHalf = 0x3800;
+constexpr uint16_t kOne = 0x3C00;
+
+uint8_t alphaAt(const coder::DecodedImage &image, uint32_t x, uint32_t y) {
+  return image.pixels[static_cast<size_t>(y) * image.stride + static_cast<size_t>(x) * 4 + 3];
+}
+}
+
+int main() {
+  std::vector<uint16_t> pixels(static_cast<size_t>(kWidth) * kHeight * 4);
+  for (uint32_t y = 0; y < kHeight; ++y) {
+    for (uint32_t x = 0; x < kWidth; ++x) {
+      uint16_t *pixel = pixels.data() + (static_cast<size_t>(y) * kWidth + x) * 4;
+      pixel[0] = pixel[1] = pixel[2] = kHalf;
+      // Only the right column of cells has alpha changing within a cell
+      pixel[3] = x < kTileSize * 2 ? kHalf : (y % 2 == 0 ? kQuarter : kOne);
+    }
+  }
+
+  try {
+    const coder::ImageView view{
+        .pixels = reinterpret_cast<const uint8_t *>(pixels.data()),
+        .width = kWidth,
+        .height = kHeight,
+        .stride = kWidth * 4 * static_cast<uint32_t>(sizeof(uint16_t)),
+        .format = coder::PixelFormat::RgbaF16,
+        .premultiplied = false,
+    };
+    const std::vector<uint8_t> encoded = coder::EncodeImageGrid(view, {
+        .lossless = true,
+        // 4:4:4
+        .chromaSubsampling = 3,
+        .speed = coder::EncodeSpeed::Fast,
+    }, kTileSize);
+    const coder::DecodedImage decoded = coder::DecodeImage(encoded.data(), encoded.size(), {
+        .colorConfig = Rgba_8888,
+    });
+    if (!decoded.hasAlpha || decoded.format != coder::PixelFormat::Rgba8888) {
+      throw std::runtime_error("Grid decoded without alpha");
+    }
+    for (uint32_t y : {0u, kHeight - 1}) {
+      for (uint32_t x : {0u, kTileSize, kTileSize * 2 - 1}) {
+        const uint8_t alpha = alphaAt(decoded, x, y);
+        if (std::abs(alpha - 128) > 2) {
+          std::fprintf(stderr, "Constant cell alpha at %u,%u is %u, expected 128\n", x, y,
+                       alpha);
+          return 1;
+        }
+      }
+    }
+    if (alphaAt(decoded, kTileSize * 2, 0) > 70 || alphaAt(decoded, kTileSize * 2, 1) < 250) {
+      throw std::runtime_error("Varying cell alpha was not kept");
+    }
+    std::printf("F16 grid %ux%u keeps constant cell alpha\n", decoded.width, decoded.height);
+  } catch (std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "BenchmarkRunner.h"
+#include "imagebits/CopyUnalignedRGBA.h"
+#include "imagebits/RGBAlpha.h"
+#include "imagebits/Rgb1010102.h"
+#include "imagebits/Rgb565.h"
+#include "imagebits/Rgba16.h"
+#include "imagebits/Rgba8ToF16.h"
+#include "imagebits/RgbaF16bitToNBitU16.h"
+
+namespace {
+// Half float 1.0, keeps F16 sources finite and in the display range
+constexpr uint32_t kHalfOne = 0x3C00;
+}
+
+namespace coder::benchmark {
+
+void RegisterKernelBenchmarks() {
+  RegisterImageKernel<uint8_t, uint8_t>(
+      "CopyUnaligned<u8>", 4, 255, 4,
+      [](uint8_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::CopyUnaligned(src, srcStride, dst, dstStride, width * 4, height);
+      });
+  RegisterImageKernel<uint16_t, uint16_t>(
+      "CopyUnaligned<u16>", 4, 65535, 4,
+      [](uint16_t *src, uint32_t srcStride, uint16_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::CopyUnaligned(src, srcStride, dst, dstStride, width * 4, height);
+      });
+  RegisterImageKernel<uint32_t, uint32_t>(
+      "CopyUnaligned<u32>", 1, 0xFFFFFFFFu, 1,
+      [](uint32_t *src, uint32_t srcStride, uint32_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::CopyUnaligned(src, srcStride, dst, dstStride, width, height);
+      });
+
+  RegisterImageKernel<uint8_t, uint8_t>(
+      "AssociateAlphaRgba8", 4, 255, 4,
+      [](uint8_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::AssociateAlphaRgba8(src, srcStride, dst, dstStride, width, height);
+      });
+  RegisterImageKernel<uint8_t, uint8_t>(
+      "UnassociateRgba8", 4, 255, 4,
+      [](uint8_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::UnassociateRgba8(src, srcStride, dst, dstStride, width, height);
+      });
+  RegisterImageKernel<uint16_t, uint16_t>(
+      "AssociateAlphaRgba16/10bit", 4, 1023, 4,
+      [](uint16_t *src, uint32_t srcStride, uint16_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::AssociateAlphaRgba16(src, srcStride, dst, dstStride, width, height, 10);
+      });
+
+  RegisterImageKernel<uint8_t, uint16_t>(
+      "Rgba8To565", 4, 255, 1,
+      [](uint8_t *src, uint32_t srcStride, uint16_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::Rgba8To565(src, srcStride, dst, dstStride, width, height, true);
+      });
+  RegisterImageKernel<uint16_t, uint16_t>(
+      "Rgba16To565/10bit", 4, 1023, 1,
+      [](uint16_t *src, uint32_t srcStride, uint16_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::Rgba16To565(src, srcStride, dst, dstStride, width, height, 10);
+      });
+  RegisterImageKernel<uint16_t, uint8_t>(
+      "Rgba16ToRgba8/10bit", 4, 1023, 4,
+      [](uint16_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::Rgba16ToRgba8(src, srcStride, dst, dstStride, width, height, 10);
+      });
+
+  RegisterImageKernel<uint8_t, uint8_t>(
+      "Rgba8ToRGBA1010102", 4, 255, 4,
+      [](uint8_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::Rgba8ToRGBA1010102(src, srcStride, dst, dstStride, width, height, true);
+      });
+  RegisterImageKernel<uint16_t, uint8_t>(
+      "Rgba16ToRGBA1010102/10bit", 4, 1023, 4,
+      [](uint16_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::Rgba16ToRGBA1010102(src, srcStride, dst, dstStride, width, height, 10);
+      });
+  RegisterImageKernel<uint16_t, uint8_t>(
+      "F16ToRGBA1010102", 4, kHalfOne, 4,
+      [](uint16_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::F16ToRGBA1010102(src, srcStride, dst, dstStride, width, height);
+      });
+  RegisterImageKernel<uint8_t, uint8_t>(
+      "RGBA1010102ToUnsigned<u8>", 4, 255, 4,
+      [](uint8_t *src, uint32_t srcStride, uint8_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::RGBA1010102ToUnsigned(src, srcStride, dst, dstStride, width, height, 8);
+      });
+  RegisterImageKernel<uint8_t, uint16_t>(
+      "RGBA1010102ToUnsigned<u16>", 4, 255, 4,
+      [](uint8_t *src, uint32_t srcStride, uint16_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::RGBA1010102ToUnsigned(src, srcStride, dst, dstStride, width, height, 10);
+      });
+
+  RegisterImageKernel<uint16_t, uint16_t>(
+      "RGBAF16BitToNBitU16/10bit", 4, kHalfOne, 4,
+      [](uint16_t *src, uint32_t srcStride, uint16_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::RGBAF16BitToNBitU16(src, srcStride, dst, dstStride, width, height, 10);
+      });
+  RegisterImageKernel<uint8_t, uint16_t>(
+      "Rgba8ToF16", 4, 255, 4,
+      [](uint8_t *src, uint32_t srcStride, uint16_t *dst, uint32_t dstStride,
+         uint32_t width, uint32_t height) {
+        coder::Rgba8ToF16(src, srcStride, dst, dstStride, width, height, true);
+      });
+}
+
+}
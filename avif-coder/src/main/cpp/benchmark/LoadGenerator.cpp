@@ -0,0 +1,342 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+#include "AllocationCounters.h"
+#include "AllocationTracker.h"
+#include "CoderCore.h"
+#include "DecodeAdmission.h"
+#include "DecodeStats.h"
+#include "avifweaver.h"
+
+namespace {
+
+using namespace coder::benchmark;
+
+struct CorpusEntry {
+  std::string name;
+  std::vector<uint8_t> data;
+};
+
+struct DecodeTarget {
+  int32_t width;
+  int32_t height;
+  ScaleMode scaleMode;
+  PreferredColorConfig colorConfig;
+};
+
+// Mix of what apps actually ask for: full size, screen sized, grid cells and thumbnails
+constexpr DecodeTarget kTargets[] = {
+    {.width = 0, .height = 0, .scaleMode = Fit, .colorConfig = Default},
+    {.width = 1920, .height = 1080, .scaleMode = Fit, .colorConfig = Rgba_8888},
+    {.width = 1080, .height = 1080, .scaleMode = Fill, .colorConfig = Default},
+    {.width = 512, .height = 512, .scaleMode = Fill, .colorConfig = Rgba_F16},
+    {.width = 256, .height = 256, .scaleMode = Fit, .colorConfig = Rgb_565},
+    {.width = 720, .height = 720, .scaleMode = Resize, .colorConfig = Rgba_1010102},
+};
+constexpr size_t kTargetsCount = sizeof(kTargets) / sizeof(kTargets[0]);
+
+struct LoadOptions {
+  std::string corpus = AVIF_LOADGEN_DEFAULT_CORPUS;
+  std::vector<uint32_t> clients = {1, 2, 4, 8};
+  double duration = 10.0;
+  uint64_t requests = 0;
+  uint64_t budgetBytes = 0;
+};
+
+struct ClientResult {
+  std::vector<uint64_t> latencies;
+  uint64_t failures = 0;
+  coder::DecodeStats stages;
+  // Worst tracked decode peak in source RGBA frames, needs CODER_TRACK_ALLOCATIONS
+  double peakFullFrames = 0;
+};
+
+struct LevelResult {
+  uint32_t clients;
+  double seconds;
+  std::vector<uint64_t> latencies;
+  uint64_t failures;
+  uint64_t peakRssBytes;
+  AllocationCounters allocations;
+  coder::DecodeStats stages;
+  double peakFullFrames;
+};
+
+std::vector<CorpusEntry> loadCorpus(const std::string &directory, uint64_t *skipped) {
+  std::vector<CorpusEntry> corpus;
+  *skipped = 0;
+  std::error_code error;
+  for (const auto &entry: std::filesystem::recursive_directory_iterator(directory, error)) {
+    if (!entry.is_regular_file()) {
+      continue;
+    }
+    std::ifstream stream(entry.path(), std::ios::binary);
+    std::vector<uint8_t> data((std::istreambuf_iterator<char>(stream)),
+                              std::istreambuf_iterator<char>());
+    // HEIC and AV2 go through the Android only avifweaver decoders
+    if (data.empty() || !is_avif_image(data.data(), data.size())) {
+      if (!data.empty() && is_heic_image(data.data(), data.size())) {
+        *skipped += 1;
+      }
+      continue;
+    }
+    corpus.push_back({.name = entry.path().filename().string(), .data = std::move(data)});
+  }
+  std::sort(corpus.begin(), corpus.end(), [](const CorpusEntry &a, const CorpusEntry &b) {
+    return a.name < b.name;
+  });
+  return corpus;
+}
+
+uint64_t residentBytes() {
+  long pageSize = sysconf(_SC_PAGE_SIZE);
+  FILE *statm = std::fopen("/proc/self/statm", "r");
+  if (!statm) {
+    return 0;
+  }
+  unsigned long long size = 0, resident = 0;
+  int read = std::fscanf(statm, "%llu %llu", &size, &resident);
+  std::fclose(statm);
+  return read == 2 ? resident * static_cast<uint64_t>(pageSize) : 0;
+}
+
+void runClient(const std::vector<CorpusEntry> &corpus, uint32_t client, uint32_t clients,
+               std::chrono::steady_clock::time_point deadline, uint64_t requestsPerClient,
+               ClientResult *result) {
+  for (uint64_t i = 0;; ++i) {
+    if (requestsPerClient ? i >= requestsPerClient
+                          : std::chrono::steady_clock::now() >= deadline) {
+      break;
+    }
+    const uint64_t sequence = i * clients + client;
+    const CorpusEntry &entry = corpus[sequence % corpus.size()];
+    const DecodeTarget &target = kTargets[(sequence / corpus.size() + client) % kTargetsCount];
+
+    const auto start = std::chrono::steady_clock::now();
+    try {
+      coder::DecodeAllocationScope allocationScope;
+      coder::DecodedImage image = coder::DecodeImage(entry.data.data(), entry.data.size(), {
+          .scaledWidth = target.width,
+          .scaledHeight = target.height,
+          .scaleMode = target.scaleMode,
+          .colorConfig = target.colorConfig,
+          .scalingQuality = 3,
+          .stats = &result->stages,
+      });
+      const coder::AllocationReport &report = allocationScope.report();
+      if (report.fullFrameBytes) {
+        result->peakFullFrames = std::max(result->peakFullFrames,
+                                          static_cast<double>(report.peakBytes)
+                                              / static_cast<double>(report.fullFrameBytes));
+      }
+    } catch (std::exception &) {
+      result->failures += 1;
+      continue;
+    }
+    const auto end = std::chrono::steady_clock::now();
+    result->latencies.push_back(static_cast<uint64_t>(
+                                    std::chrono::duration_cast<std::chrono::nanoseconds>(
+                                        end - start).count()));
+  }
+}
+
+LevelResult runLevel(const std::vector<CorpusEntry> &corpus, uint32_t clients,
+                     const LoadOptions &options) {
+  std::atomic_bool sampling{true};
+  std::atomic<uint64_t> peakRss{residentBytes()};
+  std::thread sampler([&] {
+    while (sampling.load(std::memory_order_relaxed)) {
+      uint64_t current = residentBytes();
+      uint64_t previous = peakRss.load(std::memory_order_relaxed);
+      while (current > previous
+          && !peakRss.compare_exchange_weak(previous, current, std::memory_order_relaxed)) {
+      }
+      std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+  });
+
+  std::vector<ClientResult> results(clients);
+  const uint64_t requestsPerClient =
+      options.requests ? std::max<uint64_t>(1, options.requests / clients) : 0;
+  const AllocationCounters allocationsBefore = ReadAllocationCounters();
+  const auto start = std::chrono::steady_clock::now();
+  const auto deadline = start + std::chrono::duration_cast<std::chrono::steady_clock::duration>(
+      std::chrono::duration<double>(options.duration));
+
+  std::vector<std::thread> workers;
+  for (uint32_t client = 0; client < clients; ++client) {
+    workers.emplace_back(runClient, std::cref(corpus), client, clients, deadline,
+                         requestsPerClient, &results[client]);
+  }
+  for (auto &worker: workers) {
+    worker.join();
+  }
+  const auto end = std::chrono::steady_clock::now();
+  const AllocationCounters allocationsAfter = ReadAllocationCounters();
+  sampling.store(false);
+  sampler.join();
+
+  LevelResult level = {
+      .clients = clients,
+      .seconds = std::chrono::duration<double>(end - start).count(),
+      .latencies = {},
+      .failures = 0,
+      .peakRssBytes = peakRss.load(),
+      .allocations = {
+          .allocations = allocationsAfter.allocations - allocationsBefore.allocations,
+          .allocatedBytes = allocationsAfter.allocatedBytes - allocationsBefore.allocatedBytes,
+      },
+      .stages = {},
+      .peakFullFrames = 0,
+  };
+  for (auto &result: results) {
+    level.latencies.insert(level.latencies.end(), result.latencies.begin(),
+                           result.latencies.end());
+    level.failures += result.failures;
+    level.peakFullFrames = std::max(level.peakFullFrames, result.peakFullFrames);
+    for (uint32_t i = 0; i < static_cast<uint32_t>(coder::DecodeStage::Count); ++i) {
+      level.stages.stages[i].wallNanos += result.stages.stages[i].wallNanos;
+      level.stages.stages[i].estimatedAllocatedBytes +=
+          result.stages.stages[i].estimatedAllocatedBytes;
+    }
+  }
+  std::sort(level.latencies.begin(), level.latencies.end());
+  return level;
+}
+
+double percentileMs(const std::vector<uint64_t> &sorted, double percentile) {
+  if (sorted.empty()) {
+    return 0;
+  }
+  // Nearest rank
+  auto rank = static_cast<size_t>(std::ceil(percentile / 100.0 * sorted.size()));
+  rank = std::clamp<size_t>(rank, 1, sorted.size());
+  return static_cast<double>(sorted[rank - 1]) / 1e6;
+}
+
+void printLevel(const LevelResult &level) {
+  const double images = static_cast<double>(level.latencies.size());
+  const double perImage = images > 0 ? images : 1;
+  std::printf("clients=%u requests=%zu failures=%llu\n", level.clients, level.latencies.size(),
+              static_cast<unsigned long long>(level.failures));
+  std::printf("  throughput  %.1f images/s\n", images / level.seconds);
+  std::printf("  latency     p50 %.2f ms, p95 %.2f ms, p99 %.2f ms, max %.2f ms\n",
+              percentileMs(level.latencies, 50), percentileMs(level.latencies, 95),
+              percentileMs(level.latencies, 99), percentileMs(level.latencies, 100));
+  std::printf("  memory      peak RSS %.1f MB, %.1f allocations/image, %.2f MB allocated/image\n",
+              static_cast<double>(level.peakRssBytes) / 1048576.0,
+              static_cast<double>(level.allocations.allocations) / perImage,
+              static_cast<double>(level.allocations.allocatedBytes) / 1048576.0 / perImage);
+#if AVIF_CODER_TRACK_ALLOCATIONS
+  std::printf("  decode peak %.2f full frames at worst\n", level.peakFullFrames);
+#endif
+
+  static const char *stageNames[] = {"sniff", "parse", "decode", "yuv", "rescale", "color",
+                                     "reformat", "copy"};
+  std::printf("  stages ms  ");
+  for (uint32_t i = 0; i < static_cast<uint32_t>(coder::DecodeStage::BitmapCopy); ++i) {
+    std::printf(" %s %.2f", stageNames[i],
+                static_cast<double>(level.stages.stages[i].wallNanos) / 1e6 / perImage);
+  }
+  std::printf("\n");
+  std::fflush(stdout);
+}
+
+bool parseOptions(int argc, char **argv, LoadOptions *options) {
+  for (int i = 1; i < argc; ++i) {
+    std::string arg(argv[i]);
+    auto valueOf = [&](const char *prefix) -> const char * {
+      size_t length = std::strlen(prefix);
+      return arg.compare(0, length, prefix) == 0 ? argv[i] + length : nullptr;
+    };
+    if (auto value = valueOf("--corpus=")) {
+      options->corpus = value;
+    } else if (auto value = valueOf("--clients=")) {
+      options->clients.clear();
+      std::string list(value);
+      size_t start = 0;
+      while (start < list.size()) {
+        size_t end = list.find(',', start);
+        end = end == std::string::npos ? list.size() : end;
+        options->clients.push_back(std::max(1, std::atoi(list.substr(start, end - start).c_str())));
+        start = end + 1;
+      }
+    } else if (auto value = valueOf("--duration=")) {
+      options->duration = std::max(0.1, std::atof(value));
+    } else if (auto value = valueOf("--requests=")) {
+      options->requests = std::strtoull(value, nullptr, 10);
+    } else if (auto value = valueOf("--budget-mb=")) {
+      options->budgetBytes = std::strtoull(value, nullptr, 10) * 1024ull * 1024ull;
+    } else {
+      std::fprintf(stderr,
+                   "Usage: %s [--corpus=dir] [--clients=1,2,4,8] [--duration=seconds]"
+                   " [--requests=count] [--budget-mb=megabytes]\n", argv[0]);
+      return false;
+    }
+  }
+  return !options->clients.empty();
+}
+
+}
+
+int main(int argc, char **argv) {
+  LoadOptions options;
+  if (!parseOptions(argc, argv, &options)) {
+    return 1;
+  }
+  coder::SetDecodeMemoryBudget(options.budgetBytes);
+
+  uint64_t skipped = 0;
+  std::vector<CorpusEntry> corpus = loadCorpus(options.corpus, &skipped);
+  if (corpus.empty()) {
+    std::fprintf(stderr, "No AVIF images found in %s\n", options.corpus.c_str());
+    return 1;
+  }
+  std::printf("corpus %zu images from %s, %llu HEIC skipped, decode budget %.0f MB\n",
+              corpus.size(), options.corpus.c_str(), static_cast<unsigned long long>(skipped),
+              static_cast<double>(coder::GetDecodeMemoryBudget()) / 1048576.0);
+
+  for (uint32_t clients: options.clients) {
+    printLevel(runLevel(corpus, clients, options));
+  }
+  return 0;
+}
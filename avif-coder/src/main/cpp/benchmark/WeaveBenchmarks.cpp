@@ -0,0 +1,188 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "BenchmarkRunner.h"
+#include "avifweaver.h"
+
+namespace {
+
+using namespace coder::benchmark;
+
+uint32_t chromaWidth(uint32_t width, YuvType type) {
+  return type == YuvType::Yuv444 ? width : (width + 1) / 2;
+}
+
+uint32_t chromaHeight(uint32_t height, YuvType type) {
+  return type == YuvType::Yuv420 ? (height + 1) / 2 : height;
+}
+
+template<typename T>
+struct YuvPlanes {
+  const T *y;
+  uint32_t yStride;
+  const T *u;
+  uint32_t uStride;
+  const T *v;
+  uint32_t vStride;
+  const T *a;
+  uint32_t aStride;
+  T *rgba;
+  uint32_t rgbaStride;
+  uint32_t width;
+  uint32_t height;
+};
+
+/**
+ * Planar source matching dav1d output layout and an interleaved RGBA target
+ */
+template<typename T>
+class YuvFixture : public BenchmarkFixture {
+ public:
+  using Kernel = std::function<void(const YuvPlanes<T> &)>;
+
+  YuvFixture(const BenchmarkShape &shape, YuvType type, bool monochrome,
+             bool withAlpha, uint32_t bitDepth, Kernel kernel)
+      : shape(shape),
+        luma(shape.width, shape.height, 1, shape.stridePadding, (1u << bitDepth) - 1),
+        u(monochrome ? 1 : chromaWidth(shape.width, type),
+          monochrome ? 1 : chromaHeight(shape.height, type), 1, shape.stridePadding,
+          (1u << bitDepth) - 1),
+        v(monochrome ? 1 : chromaWidth(shape.width, type),
+          monochrome ? 1 : chromaHeight(shape.height, type), 1, shape.stridePadding,
+          (1u << bitDepth) - 1),
+        alpha(withAlpha ? shape.width : 1, withAlpha ? shape.height : 1, 1,
+              shape.stridePadding, (1u << bitDepth) - 1),
+        rgba(shape.width, shape.height, 4, shape.stridePadding, 0),
+        kernel(std::move(kernel)) {}
+
+  void run() override {
+    kernel({
+               .y = luma.data(), .yStride = luma.stride(),
+               .u = u.data(), .uStride = u.stride(),
+               .v = v.data(), .vStride = v.stride(),
+               .a = alpha.data(), .aStride = alpha.stride(),
+               .rgba = rgba.data(), .rgbaStride = rgba.stride(),
+               .width = shape.width, .height = shape.height,
+           });
+  }
+
+ private:
+  BenchmarkShape shape;
+  BenchmarkImage<T> luma;
+  BenchmarkImage<T> u;
+  BenchmarkImage<T> v;
+  BenchmarkImage<T> alpha;
+  BenchmarkImage<T> rgba;
+  Kernel kernel;
+};
+
+const char *yuvTypeName(YuvType type) {
+  switch (type) {
+    case YuvType::Yuv420:return "420";
+    case YuvType::Yuv422:return "422";
+    default:return "444";
+  }
+}
+
+template<typename T>
+void registerYuv(const std::string &name, YuvType type, bool monochrome, bool withAlpha,
+                 uint32_t bitDepth, typename YuvFixture<T>::Kernel kernel) {
+  // Average bytes per pixel over all planes plus the RGBA write
+  double planes = 1.0 + (withAlpha ? 1.0 : 0.0);
+  if (!monochrome) {
+    planes += type == YuvType::Yuv444 ? 2.0 : (type == YuvType::Yuv422 ? 1.0 : 0.5);
+  }
+  const auto bytesPerPixel = static_cast<uint32_t>((planes + 4.0) * sizeof(T) + 0.5);
+  RegisterBenchmark(name, bytesPerPixel,
+                    [=](const BenchmarkShape &shape) -> std::unique_ptr<BenchmarkFixture> {
+                      return std::make_unique<YuvFixture<T>>(shape, type, monochrome, withAlpha,
+                                                             bitDepth, kernel);
+                    });
+}
+
+}
+
+namespace coder::benchmark {
+
+void RegisterWeaveBenchmarks() {
+  for (YuvType type: {YuvType::Yuv420, YuvType::Yuv422, YuvType::Yuv444}) {
+    const std::string layout = yuvTypeName(type);
+    registerYuv<uint8_t>(
+        "weave_yuv8_to_rgba8/" + layout, type, false, false, 8,
+        [type](const YuvPlanes<uint8_t> &p) {
+          weave_yuv8_to_rgba8(p.y, p.yStride, p.u, p.uStride, p.v, p.vStride,
+                              p.rgba, p.rgbaStride, p.width, p.height,
+                              YuvRange::Tv, YuvMatrix::Bt709, type);
+        });
+    registerYuv<uint8_t>(
+        "weave_yuv8_with_alpha_to_rgba8/" + layout, type, false, true, 8,
+        [type](const YuvPlanes<uint8_t> &p) {
+          weave_yuv8_with_alpha_to_rgba8(p.y, p.yStride, p.u, p.uStride, p.v, p.vStride,
+                                         p.a, p.aStride, p.rgba, p.rgbaStride,
+                                         p.width, p.height,
+                                         YuvRange::Tv, YuvMatrix::Bt709, type);
+        });
+    registerYuv<uint16_t>(
+        "weave_yuv16_to_rgba16/10bit/" + layout, type, false, false, 10,
+        [type](const YuvPlanes<uint16_t> &p) {
+          weave_yuv16_to_rgba16(p.y, p.yStride, p.u, p.uStride, p.v, p.vStride,
+                                p.rgba, p.rgbaStride, 10, p.width, p.height,
+                                YuvRange::Tv, YuvMatrix::Bt2020, type);
+        });
+    registerYuv<uint16_t>(
+        "weave_yuv16_with_alpha_to_rgba16/10bit/" + layout, type, false, true, 10,
+        [type](const YuvPlanes<uint16_t> &p) {
+          weave_yuv16_with_alpha_to_rgba16(p.y, p.yStride, p.u, p.uStride, p.v, p.vStride,
+                                           p.a, p.aStride, p.rgba, p.rgbaStride, 10,
+                                           p.width, p.height,
+                                           YuvRange::Tv, YuvMatrix::Bt2020, type);
+        });
+  }
+
+  registerYuv<uint8_t>(
+      "weave_yuv400_to_rgba8", YuvType::Yuv444, true, false, 8,
+      [](const YuvPlanes<uint8_t> &p) {
+        weave_yuv400_to_rgba8(p.y, p.yStride, p.rgba, p.rgbaStride, p.width, p.height,
+                              YuvRange::Tv, YuvMatrix::Bt709);
+      });
+  registerYuv<uint8_t>(
+      "weave_yuv400_with_alpha_to_rgba8", YuvType::Yuv444, true, true, 8,
+      [](const YuvPlanes<uint8_t> &p) {
+        weave_yuv400_with_alpha_to_rgba8(p.y, p.yStride, p.a, p.aStride,
+                                         p.rgba, p.rgbaStride, p.width, p.height,
+                                         YuvRange::Tv, YuvMatrix::Bt709);
+      });
+  registerYuv<uint16_t>(
+      "weave_yuv400_p16_to_rgba16/10bit", YuvType::Yuv444, true, false, 10,
+      [](const YuvPlanes<uint16_t> &p) {
+        weave_yuv400_p16_to_rgba16(p.y, p.yStride, p.rgba, p.rgbaStride, 10,
+                                   p.width, p.height, YuvRange::Tv, YuvMatrix::Bt709);
+      });
+}
+
+}
@@ -30,7 +30,6 @@
 #include <cmath>
 #include <vector>
 #include <thread>
-#include <android/log.h>
 #include "concurrency.hpp"
 #include "avifweaver.h"
 
@@ -29,6 +29,7 @@
 #ifndef AVIF_COPYUNALIGNEDRGBA_H
 #define AVIF_COPYUNALIGNEDRGBA_H
 
+#include <cstdint>
 #include <vector>
 
 namespace coder {
@@ -0,0 +1,128 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#include "FrameDiff.h"
+#include <algorithm>
+#include <cstring>
+
+#if HAVE_NEON
+#include "arm_neon.h"
+#endif
+
+namespace {
+constexpr uint32_t kDiffBandHeight = 32;
+
+#if HAVE_NEON && defined(__aarch64__)
+bool chunkDiffers(const uint8_t *a, const uint8_t *b) {
+  return vmaxvq_u8(veorq_u8(vld1q_u8(a), vld1q_u8(b))) != 0;
+}
+constexpr size_t kChunk = 16;
+#else
+bool chunkDiffers(const uint8_t *a, const uint8_t *b) {
+  uint64_t left, right;
+  std::memcpy(&left, a, sizeof(uint64_t));
+  std::memcpy(&right, b, sizeof(uint64_t));
+  return left != right;
+}
+constexpr size_t kChunk = sizeof(uint64_t);
+#endif
+
+// First differing byte, length when rows are equal
+size_t firstDifference(const uint8_t *a, const uint8_t *b, size_t length) {
+  size_t i = 0;
+  while (i + kChunk <= length && !chunkDiffers(a + i, b + i)) {
+    i += kChunk;
+  }
+  while (i < length && a[i] == b[i]) {
+    ++i;
+  }
+  return i;
+}
+
+// One past the last differing byte, the row is known to differ at or after from
+size_t lastDifference(const uint8_t *a, const uint8_t *b, size_t from, size_t length) {
+  size_t end = length;
+  while (end >= from + kChunk && !chunkDiffers(a + end - kChunk, b + end - kChunk)) {
+    end -= kChunk;
+  }
+  while (end > from && a[end - 1] == b[end - 1]) {
+    --end;
+  }
+  return end;
+}
+}
+
+namespace coder {
+
+std::vector<DirtyRect> DiffFrames(const uint8_t *previous, const uint8_t *current,
+                                  uint32_t stride, uint32_t width, uint32_t height,
+                                  uint32_t pixelSize) {
+  std::vector<DirtyRect> rects;
+  const size_t rowLength = static_cast<size_t>(width) * pixelSize;
+
+  for (uint32_t bandTop = 0; bandTop < height; bandTop += kDiffBandHeight) {
+    const uint32_t bandBottom = std::min(bandTop + kDiffBandHeight, height);
+    uint32_t left = width, right = 0, top = bandBottom, bottom = bandTop;
+
+    for (uint32_t y = bandTop; y < bandBottom; ++y) {
+      const uint8_t *previousRow = previous + static_cast<size_t>(y) * stride;
+      const uint8_t *currentRow = current + static_cast<size_t>(y) * stride;
+      const size_t first = firstDifference(previousRow, currentRow, rowLength);
+      if (first == rowLength) {
+        continue;
+      }
+      const size_t last = lastDifference(previousRow, currentRow, first, rowLength);
+      left = std::min(left, static_cast<uint32_t>(first / pixelSize));
+      right = std::max(right, static_cast<uint32_t>((last + pixelSize - 1) / pixelSize));
+      top = std::min(top, y);
+      bottom = y + 1;
+    }
+
+    if (left >= right) {
+      continue;
+    }
+    if (!rects.empty()) {
+      DirtyRect &above = rects.back();
+      if (above.bottom == top && above.left < right && left < above.right) {
+        above.left = std::min(above.left, left);
+        above.right = std::max(above.right, right);
+        above.bottom = bottom;
+        continue;
+      }
+    }
+    rects.push_back({
+                        .left = left,
+                        .top = top,
+                        .right = right,
+                        .bottom = bottom,
+                    });
+  }
+  return rects;
+}
+
+}
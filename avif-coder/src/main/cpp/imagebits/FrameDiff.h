@@ -0,0 +1,56 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+#ifndef AVIF_CODER_SRC_MAIN_CPP_IMAGEBITS_FRAMEDIFF_H_
+#define AVIF_CODER_SRC_MAIN_CPP_IMAGEBITS_FRAMEDIFF_H_
+
+#include <cstdint>
+#include <vector>
+
+namespace coder {
+
+// Right and bottom are exclusive
+struct DirtyRect {
+  uint32_t left;
+  uint32_t top;
+  uint32_t right;
+  uint32_t bottom;
+};
+
+/**
+ * Bounding rectangles of pixels that differ between two frames of the same layout.
+ * Rows are compared in bands, vertically adjacent dirty bands with overlapping
+ * columns are merged. Identical frames produce no rectangles.
+ */
+std::vector<DirtyRect> DiffFrames(const uint8_t *previous, const uint8_t *current,
+                                  uint32_t stride, uint32_t width, uint32_t height,
+                                  uint32_t pixelSize);
+
+}
+
+#endif //AVIF_CODER_SRC_MAIN_CPP_IMAGEBITS_FRAMEDIFF_H_
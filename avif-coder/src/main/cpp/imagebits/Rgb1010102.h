@@ -29,6 +29,7 @@
 #ifndef AVIF_RGB1010102_H
 #define AVIF_RGB1010102_H
 
+#include <cstdint>
 #include <vector>
 
 namespace coder {
@@ -29,6 +29,7 @@
 #include "RgbaF16bitToNBitU16.h"
 #include "half.hpp"
 #include <algorithm>
+#include <cmath>
 #include "concurrency.hpp"
 #if HAVE_NEON
 #include "arm_neon.h"
@@ -49,7 +50,7 @@ RGBAF16BitToNBitU16(const uint16_t *sourceData,
   auto srcData = reinterpret_cast<const uint8_t *>(sourceData);
   auto data64Ptr = reinterpret_cast<uint8_t *>(dst);
   const float scale = 1.0f / float((1 << bitDepth) - 1);
-  const float maxColors = (float) std::powf(2.0f, static_cast<float>(bitDepth)) - 1.f;
+  const float maxColors = (float) std::pow(2.0f, static_cast<float>(bitDepth)) - 1.f;
 
   for (uint32_t y = 0; y < height; ++y) {
 
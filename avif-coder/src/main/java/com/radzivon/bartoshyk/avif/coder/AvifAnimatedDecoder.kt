@@ -30,11 +30,15 @@ package com.radzivon.bartoshyk.avif.coder
 
 import android.annotation.SuppressLint
 import android.graphics.Bitmap
+import android.graphics.Rect
 import android.os.Build
 import android.util.Size
 import androidx.annotation.Keep
 import java.io.Closeable
 import java.nio.ByteBuffer
+import java.util.concurrent.locks.ReentrantReadWriteLock
+import kotlin.concurrent.read
+import kotlin.concurrent.write
 
 /**
  * Class that manages animation avif decoding.
@@ -64,9 +68,19 @@ class AvifAnimatedDecoder : Closeable {
 
     var toneMapper: ToneMapper = ToneMapper.REC2408
 
+    /**
+     * Receives per-stage timings and allocations of every decoded frame
+     */
+    @Volatile
+    var decodeStatsListener: DecodeStatsListener? = null
+
     private var nativeController: Long = -1
     private val lock = Any()
 
+    // Calls the native controller handles concurrently share this lock, so metadata
+    // getters and frame decodes don't queue behind each other; only close() excludes them
+    private val sharedAccess = ReentrantReadWriteLock()
+
     fun getScaledFrame(
         frame: Int, scaledWidth: Int,
         scaledHeight: Int,
@@ -74,7 +88,7 @@ class AvifAnimatedDecoder : Closeable {
         scaleMode: ScaleMode = ScaleMode.FIT,
         scaleQuality: ScalingQuality = ScalingQuality.DEFAULT,
     ): Bitmap {
-        synchronized(lock) {
+        sharedAccess.read {
             if (nativeController == -1L) {
                 throw IllegalStateException("Animated decoder wasn't properly initialized")
             }
@@ -86,11 +100,76 @@ class AvifAnimatedDecoder : Closeable {
                 preferredColorConfig.value,
                 scaleMode.value,
                 scaleQuality.level,
-                toneMapper.value
+                toneMapper.value,
+                decodeStatsListener,
+            )
+        }
+    }
+
+    /**
+     * Decodes [frame] into the mutable [target] instead of allocating a new bitmap.
+     * [target] keeps its config and its size is used as the scale target, so [scaleMode]
+     * has to fill it exactly. Native frame buffers are pooled as well, so playing an
+     * animation into the same bitmap allocates nothing once the first frames are decoded.
+     */
+    fun getFrameInto(
+        frame: Int,
+        target: Bitmap,
+        scaleMode: ScaleMode = ScaleMode.RESIZE,
+        scaleQuality: ScalingQuality = ScalingQuality.DEFAULT,
+    ) {
+        require(target.isMutable) { "Target bitmap must be mutable" }
+        sharedAccess.read {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            getFrameIntoImpl(
+                nativeController,
+                frame,
+                target,
+                scaleMode.value,
+                scaleQuality.level,
+            )
+        }
+    }
+
+    /**
+     * Decodes [frame] into the mutable [target], converting and writing only the areas that
+     * changed since the previous frame written this way. [target] keeps its config and its
+     * size is used as the scale target, so [scaleMode] has to fill it exactly.
+     * Returns the rectangles that were updated, the whole frame on the first call.
+     * Call [resetDirtyTracking] before switching to another target.
+     */
+    fun updateFrame(
+        frame: Int,
+        target: Bitmap,
+        scaleMode: ScaleMode = ScaleMode.RESIZE,
+        scaleQuality: ScalingQuality = ScalingQuality.DEFAULT,
+    ): Array<Rect> {
+        require(target.isMutable) { "Target bitmap must be mutable" }
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return updateFrameImpl(
+                nativeController,
+                frame,
+                target,
+                scaleMode.value,
+                scaleQuality.level,
             )
         }
     }
 
+    fun resetDirtyTracking() {
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            resetDirtyTrackingImpl(nativeController)
+        }
+    }
+
     fun getFrame(
         frame: Int,
         preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
@@ -105,8 +184,88 @@ class AvifAnimatedDecoder : Closeable {
         )
     }
 
-    fun getImageSize(): Size {
+    /**
+     * Decodes frames in [from] until [to] and delivers them to [callback] in order.
+     * The range is split at keyframes and independent segments decode in parallel
+     * on up to [maxWorkers] decoders, 0 uses every available core.
+     */
+    fun decodeRange(
+        from: Int,
+        to: Int,
+        callback: AnimatedFrameCallback,
+        scaledWidth: Int = 0,
+        scaledHeight: Int = 0,
+        preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
+        scaleMode: ScaleMode = ScaleMode.FIT,
+        scaleQuality: ScalingQuality = ScalingQuality.DEFAULT,
+        maxWorkers: Int = 0,
+    ) {
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            decodeRangeImpl(
+                nativeController,
+                from,
+                to,
+                scaledWidth,
+                scaledHeight,
+                preferredColorConfig.value,
+                scaleMode.value,
+                scaleQuality.level,
+                maxWorkers,
+                callback,
+            )
+        }
+    }
+
+    /**
+     * Keyframes shown at [count] evenly spaced timestamps starting at 0,
+     * neighbouring entries repeat when a keyframe covers several timestamps
+     */
+    fun getThumbnailFrames(count: Int): IntArray {
+        require(count >= 0) { "Thumbnails count must not be negative" }
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return getThumbnailFramesImpl(nativeController, count)
+        }
+    }
+
+    /**
+     * Poster and scrubber strip frames for [count] evenly spaced timestamps.
+     * Only keyframes from [getThumbnailFrames] are decoded, each of them once and
+     * scaled down to [scaledWidth] x [scaledHeight] before color conversion.
+     * Cells snapped to the same keyframe share the same [Bitmap].
+     */
+    fun getThumbnails(
+        count: Int,
+        scaledWidth: Int,
+        scaledHeight: Int,
+        preferredColorConfig: PreferredColorConfig = PreferredColorConfig.DEFAULT,
+        scaleMode: ScaleMode = ScaleMode.FIT,
+        scaleQuality: ScalingQuality = ScalingQuality.DEFAULT,
+    ): Array<Bitmap> {
+        require(count >= 0) { "Thumbnails count must not be negative" }
         synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return getThumbnailsImpl(
+                nativeController,
+                count,
+                scaledWidth,
+                scaledHeight,
+                preferredColorConfig.value,
+                scaleMode.value,
+                scaleQuality.level,
+            )
+        }
+    }
+
+    fun getImageSize(): Size {
+        sharedAccess.read {
             if (nativeController == -1L) {
                 throw IllegalStateException("Animated decoder wasn't properly initialized")
             }
@@ -115,7 +274,7 @@ class AvifAnimatedDecoder : Closeable {
     }
 
     fun getFramesCount(): Int {
-        synchronized(lock) {
+        sharedAccess.read {
             if (nativeController == -1L) {
                 throw IllegalStateException("Animated decoder wasn't properly initialized")
             }
@@ -124,7 +283,7 @@ class AvifAnimatedDecoder : Closeable {
     }
 
     fun getLoopsCount(): Int {
-        synchronized(lock) {
+        sharedAccess.read {
             if (nativeController == -1L) {
                 throw IllegalStateException("Animated decoder wasn't properly initialized")
             }
@@ -133,7 +292,7 @@ class AvifAnimatedDecoder : Closeable {
     }
 
     fun getTotalDuration(): Int {
-        synchronized(lock) {
+        sharedAccess.read {
             if (nativeController == -1L) {
                 throw IllegalStateException("Animated decoder wasn't properly initialized")
             }
@@ -142,7 +301,7 @@ class AvifAnimatedDecoder : Closeable {
     }
 
     fun getFrameDuration(frame: Int): Int {
-        synchronized(lock) {
+        sharedAccess.read {
             if (nativeController == -1L) {
                 throw IllegalStateException("Animated decoder wasn't properly initialized")
             }
@@ -150,6 +309,107 @@ class AvifAnimatedDecoder : Closeable {
         }
     }
 
+    /**
+     * Frame shown at [timeMillis] from the start of the animation, timestamps past
+     * the end wrap around the loop. Resolved from precomputed timings without decoding
+     */
+    fun frameAtTime(timeMillis: Long): Int {
+        sharedAccess.read {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return frameAtTimeImpl(nativeController, timeMillis)
+        }
+    }
+
+    fun isKeyframe(frame: Int): Boolean {
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return isKeyframeImpl(nativeController, frame)
+        }
+    }
+
+    /**
+     * Closest keyframe at or before [frame], decoding of [frame] has to start from it
+     */
+    fun nearestKeyframe(frame: Int): Int {
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return nearestKeyframeImpl(nativeController, frame)
+        }
+    }
+
+    /**
+     * Number of frames that have to be decoded to present [frame] from the current decoder state
+     */
+    fun seekCost(frame: Int): Int {
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return seekCostImpl(nativeController, frame)
+        }
+    }
+
+    /**
+     * Keeps up to [count] decoder states parked at previously decoded positions,
+     * so seeking back into a long GOP resumes from them instead of the keyframe.
+     * Each parked state holds its own reference frames, 0 releases them.
+     */
+    fun setSeekSnapshots(count: Int) {
+        require(count >= 0) { "Snapshots count must not be negative" }
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            setSeekSnapshotsImpl(nativeController, count)
+        }
+    }
+
+    /**
+     * Lets the decoder work on up to [frames] consecutive frames in parallel during
+     * sequential playback. Helps small animations that can't keep tile threads busy,
+     * a seek restarting from a keyframe discards the frames in flight. 1 disables it.
+     */
+    fun setFrameDelay(frames: Int) {
+        require(frames >= 1) { "Frame delay must be at least 1" }
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            setFrameDelayImpl(nativeController, frames)
+        }
+    }
+
+    /**
+     * Allows up to [count] frame decodes of this animation to run at the same time, for
+     * example two views showing it at different sizes. Extra decodes use additional
+     * decoder instances over the same compressed data, each keeping its own AV1 state.
+     * Defaults to 1, every decode waits for the previous one.
+     */
+    fun setMaxDecoders(count: Int) {
+        require(count > 0) { "Decoders count must be positive" }
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            setMaxDecodersImpl(nativeController, count)
+        }
+    }
+
+    internal fun <T> withNativeController(block: (Long) -> T): T {
+        synchronized(lock) {
+            if (nativeController == -1L) {
+                throw IllegalStateException("Animated decoder wasn't properly initialized")
+            }
+            return block(nativeController)
+        }
+    }
+
     protected fun finalize() {
         synchronized(lock) {
             if (nativeController != -1L) {
@@ -161,9 +421,11 @@ class AvifAnimatedDecoder : Closeable {
 
     override fun close() {
         synchronized(lock) {
-            if (nativeController != -1L) {
-                destroy(nativeController)
-                nativeController = -1L
+            sharedAccess.write {
+                if (nativeController != -1L) {
+                    destroy(nativeController)
+                    nativeController = -1L
+                }
             }
         }
     }
@@ -176,6 +438,50 @@ class AvifAnimatedDecoder : Closeable {
     private external fun getTotalDurationImpl(ptr: Long): Int
     private external fun getFrameDurationImpl(ptr: Long, frame: Int): Int
     private external fun getSizeImpl(ptr: Long): Size
+    private external fun frameAtTimeImpl(ptr: Long, timeMs: Long): Int
+    private external fun isKeyframeImpl(ptr: Long, frame: Int): Boolean
+    private external fun nearestKeyframeImpl(ptr: Long, frame: Int): Int
+    private external fun seekCostImpl(ptr: Long, frame: Int): Int
+    private external fun setSeekSnapshotsImpl(ptr: Long, count: Int)
+    private external fun setFrameDelayImpl(ptr: Long, frames: Int)
+    private external fun setMaxDecodersImpl(ptr: Long, count: Int)
+    private external fun getFrameIntoImpl(
+        ptr: Long,
+        frame: Int,
+        target: Bitmap,
+        scaleMode: Int,
+        scaleQuality: Int,
+    )
+    private external fun updateFrameImpl(
+        ptr: Long,
+        frame: Int,
+        target: Bitmap,
+        scaleMode: Int,
+        scaleQuality: Int,
+    ): Array<Rect>
+    private external fun resetDirtyTrackingImpl(ptr: Long)
+    private external fun getThumbnailFramesImpl(ptr: Long, count: Int): IntArray
+    private external fun getThumbnailsImpl(
+        ptr: Long,
+        count: Int,
+        scaledWidth: Int,
+        scaledHeight: Int,
+        preferredColorConfig: Int,
+        scaleMode: Int,
+        scaleQuality: Int,
+    ): Array<Bitmap>
+    private external fun decodeRangeImpl(
+        ptr: Long,
+        from: Int,
+        to: Int,
+        scaledWidth: Int,
+        scaledHeight: Int,
+        preferredColorConfig: Int,
+        scaleMode: Int,
+        scaleQuality: Int,
+        maxWorkers: Int,
+        callback: AnimatedFrameCallback,
+    )
     private external fun getFrameImpl(
         ptr: Long,
         frame: Int, scaledWidth: Int,
@@ -184,6 +490,7 @@ class AvifAnimatedDecoder : Closeable {
         scaleMode: Int,
         scaleQuality: Int,
         toneMapper: Int,
+        statsListener: DecodeStatsListener?,
     ): Bitmap
 
 }
\ No newline at end of file
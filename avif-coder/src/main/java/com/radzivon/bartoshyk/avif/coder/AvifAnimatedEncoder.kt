@@ -0,0 +1,149 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.radzivon.bartoshyk.avif.coder
+
+import android.annotation.SuppressLint
+import android.graphics.Bitmap
+import android.os.Build
+import androidx.annotation.IntRange
+import androidx.annotation.Keep
+import java.io.Closeable
+import java.io.OutputStream
+
+/**
+ * Encodes an AVIF image sequence from frames added one by one. Every frame is converted
+ * to YUV as it arrives and encoded on a native thread while the next one is prepared,
+ * only a few uncompressed frames are ever held, so long captures don't need the whole
+ * clip in memory. Every frame is stored as a keyframe.
+ *
+ * The encoder is not thread safe. It has to be finished once, then closed.
+ *
+ * @param threads encoder threads, 0 uses every core
+ * @param repetitionCount plays after the first one, -1 loops forever
+ * @param keepAlpha encodes the alpha of the frames, otherwise they are treated as opaque
+ */
+@Keep
+@SuppressLint("ObsoleteSdkInt")
+class AvifAnimatedEncoder(
+    width: Int,
+    height: Int,
+    options: AvifEncodingOptions = AvifEncodingOptions(),
+    @IntRange(from = 0) threads: Int = 0,
+    repetitionCount: Int = -1,
+    keepAlpha: Boolean = true,
+) : Closeable {
+
+    init {
+        if (Build.VERSION.SDK_INT >= 24) {
+            System.loadLibrary("coder")
+        }
+        require(options.avKind == AvKind.AV1) {
+            "Animations are encoded with AV1 only"
+        }
+    }
+
+    private val lock = Any()
+
+    private var nativeEncoder: Long = createEncoder(
+        width,
+        height,
+        if (options.isLossless()) 100 else options.quality,
+        options.chromaSubsampling.value,
+        options.speed.value,
+        threads,
+        repetitionCount,
+        keepAlpha,
+    )
+
+    /**
+     * Appends [frame] shown for [durationMs]. [frame] must be ARGB_8888 of the animation size
+     * and is no longer read once the call returns.
+     */
+    fun addFrame(frame: Bitmap, @IntRange(from = 1) durationMs: Int) {
+        synchronized(lock) {
+            if (nativeEncoder == -1L) {
+                throw IllegalStateException("Animated encoder was already closed")
+            }
+            addFrameImpl(nativeEncoder, frame, durationMs)
+        }
+    }
+
+    /**
+     * Encodes the remaining frames and returns the AVIF file
+     */
+    fun finish(): ByteArray {
+        synchronized(lock) {
+            if (nativeEncoder == -1L) {
+                throw IllegalStateException("Animated encoder was already closed")
+            }
+            return finishImpl(nativeEncoder)
+        }
+    }
+
+    /**
+     * Encodes the remaining frames and writes the AVIF file into [output], which stays open
+     */
+    fun finish(output: OutputStream) {
+        synchronized(lock) {
+            if (nativeEncoder == -1L) {
+                throw IllegalStateException("Animated encoder was already closed")
+            }
+            finishToStreamImpl(nativeEncoder, output)
+        }
+    }
+
+    protected fun finalize() {
+        close()
+    }
+
+    override fun close() {
+        synchronized(lock) {
+            if (nativeEncoder != -1L) {
+                destroy(nativeEncoder)
+                nativeEncoder = -1L
+            }
+        }
+    }
+
+    private external fun createEncoder(
+        width: Int,
+        height: Int,
+        quality: Int,
+        chromaSubsampling: Int,
+        speed: Int,
+        threads: Int,
+        repetitionCount: Int,
+        keepAlpha: Boolean,
+    ): Long
+
+    private external fun destroy(ptr: Long)
+    private external fun addFrameImpl(ptr: Long, bitmap: Bitmap, durationMs: Int)
+    private external fun finishImpl(ptr: Long): ByteArray
+    private external fun finishToStreamImpl(ptr: Long, output: OutputStream)
+}
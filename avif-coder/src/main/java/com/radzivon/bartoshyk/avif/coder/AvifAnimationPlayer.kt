@@ -0,0 +1,133 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.radzivon.bartoshyk.avif.coder
+
+import android.annotation.SuppressLint
+import android.graphics.Bitmap
+import android.os.Build
+import androidx.annotation.Keep
+import java.io.Closeable
+
+/**
+ * Plays an animation from [decoder] on a native decode thread that stays ahead of the
+ * timeline given by frame durations. The player works on its own copy of the source,
+ * so [decoder] remains usable and may be closed independently.
+ *
+ * [renderFrame] never waits for decoding: it is meant to be called from the render
+ * thread on every vsync, together with [close] on that same thread.
+ */
+@Keep
+@SuppressLint("ObsoleteSdkInt")
+class AvifAnimationPlayer(
+    decoder: AvifAnimatedDecoder,
+    scaledWidth: Int = 0,
+    scaledHeight: Int = 0,
+    preferredColorConfig: PreferredColorConfig = PreferredColorConfig.RGBA_8888,
+    scaleMode: ScaleMode = ScaleMode.FIT,
+    scaleQuality: ScalingQuality = ScalingQuality.DEFAULT,
+    bufferedFrames: Int = 3,
+) : Closeable {
+
+    init {
+        if (Build.VERSION.SDK_INT >= 24) {
+            System.loadLibrary("coder")
+        }
+    }
+
+    private var nativePlayer: Long = decoder.withNativeController {
+        createPlayer(
+            it,
+            scaledWidth,
+            scaledHeight,
+            preferredColorConfig.value,
+            scaleMode.value,
+            scaleQuality.level,
+            bufferedFrames,
+        )
+    }
+
+    /**
+     * Length of one loop of the animation in milliseconds
+     */
+    val loopDuration: Long
+        get() {
+            if (nativePlayer == -1L) {
+                throw IllegalStateException("Animation player was already closed")
+            }
+            return getLoopDurationImpl(nativePlayer)
+        }
+
+    /**
+     * Starts decoding ahead, may be called once
+     */
+    fun start() {
+        if (nativePlayer == -1L) {
+            throw IllegalStateException("Animation player was already closed")
+        }
+        startImpl(nativePlayer)
+    }
+
+    /**
+     * Copies the frame due at [timestampMs], counted from the start of playback, into [target].
+     * Returns the frame index that was written, or -1 when [target] already shows the due frame
+     * or it isn't decoded yet. [target] must be mutable and match the frames size and config.
+     */
+    fun renderFrame(timestampMs: Long, target: Bitmap): Int {
+        if (nativePlayer == -1L) {
+            throw IllegalStateException("Animation player was already closed")
+        }
+        return renderFrameImpl(nativePlayer, timestampMs, target)
+    }
+
+    protected fun finalize() {
+        close()
+    }
+
+    override fun close() {
+        if (nativePlayer != -1L) {
+            destroy(nativePlayer)
+            nativePlayer = -1L
+        }
+    }
+
+    private external fun createPlayer(
+        controller: Long,
+        scaledWidth: Int,
+        scaledHeight: Int,
+        preferredColorConfig: Int,
+        scaleMode: Int,
+        scaleQuality: Int,
+        bufferedFrames: Int,
+    ): Long
+
+    private external fun destroy(ptr: Long)
+    private external fun startImpl(ptr: Long)
+    private external fun getLoopDurationImpl(ptr: Long): Long
+    private external fun renderFrameImpl(ptr: Long, timestampMs: Long, target: Bitmap): Int
+}
@@ -32,14 +32,25 @@ package com.radzivon.bartoshyk.avif.coder
 
 import android.annotation.SuppressLint
 import android.graphics.Bitmap
+import android.hardware.HardwareBuffer
 import android.os.Build
+import android.os.ParcelFileDescriptor
 import android.util.Size
 import androidx.annotation.Keep
+import androidx.annotation.RequiresApi
+import java.io.File
 import java.nio.ByteBuffer
 
 @Keep
 class Coder {
 
+    /**
+     * Receives per-stage timings and allocations of every decode made by this instance.
+     * Measurements are taken only while a listener is set.
+     */
+    @Volatile
+    var decodeStatsListener: DecodeStatsListener? = null
+
     fun isAvif(byteArray: ByteArray): Boolean {
         return isAvifImageImpl(byteArray)
     }
@@ -71,6 +82,7 @@ class Coder {
             preferredColorConfig.value,
             ScaleMode.FIT.value,
             ScalingQuality.DEFAULT.level,
+            decodeStatsListener,
         )
     }
 
@@ -89,6 +101,7 @@ class Coder {
             preferredColorConfig.value,
             scaleMode.value,
             scaleQuality.level,
+            decodeStatsListener,
         )
     }
 
@@ -107,6 +120,7 @@ class Coder {
             preferredColorConfig.value,
             scaleMode.value,
             scaleQuality.level,
+            decodeStatsListener,
         )
     }
 
@@ -125,7 +139,62 @@ class Coder {
         } else {
             -1
         }
-        return encodeAvifImpl(bitmap, exif, dataSpace, options)
+        return encodeAvifImpl(bitmap, exif?.let(::exifBytes), dataSpace, options)
+    }
+
+    /**
+     * Encodes bitmaps with the same options in one call, results come in the order of bitmaps.
+     * RGB to YUV conversion of the next bitmap runs while the previous one is being encoded,
+     * so the cores stay busy between images.
+     *
+     * @param exif optional EXIF of every bitmap, has to be as long as bitmaps when set
+     */
+    fun encodeAvifBatch(
+        bitmaps: List<Bitmap>,
+        exif: List<ByteBuffer?>? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): List<ByteArray> {
+        require(exif == null || exif.size == bitmaps.size) {
+            "Every bitmap of the batch needs its own EXIF entry"
+        }
+        val dataSpaces = IntArray(bitmaps.size) { index ->
+            if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+                bitmaps[index].colorSpace?.dataSpace ?: -1
+            } else {
+                -1
+            }
+        }
+        val exifArrays = exif?.map { buffer -> buffer?.let(::exifBytes) }?.toTypedArray()
+        return encodeAvifBatchImpl(bitmaps.toTypedArray(), exifArrays, dataSpaces, options).toList()
+    }
+
+    /**
+     * Encodes a large image as an AVIF grid of square cells. Cells are converted and encoded
+     * concurrently on every core, only the cells in flight keep their YUV planes, and the
+     * result decodes in parallel later. Images that fit a single cell, or whose odd size
+     * can't be split with the chosen chroma subsampling, are encoded as a single image.
+     *
+     * @param tileSize cell side in pixels, rounded down to even and raised to 64
+     * @param options AVIF encoder configuration, only AV1 is supported
+     */
+    fun encodeAvifGrid(
+        bitmap: Bitmap,
+        tileSize: Int = 1024,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): ByteArray {
+        require(options.avKind == AvKind.AV1) {
+            "Grid encoding is available only for AV1"
+        }
+        require(tileSize > 0) {
+            "Tile size must be positive"
+        }
+        val dataSpace = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            bitmap.colorSpace?.dataSpace ?: -1
+        } else {
+            -1
+        }
+        return encodeAvifGridImpl(bitmap, exif?.let(::exifBytes), dataSpace, tileSize, options)
     }
 
     fun encodeHeic(
@@ -141,6 +210,301 @@ class Coder {
         return encodeHeicImpl(bitmap, exif, dataSpace, options)
     }
 
+    /**
+     * Encodes an avif image at the highest quality up to [AvifEncodingOptions.quality] whose file
+     * fits in [maxBytes]. The bitmap is converted to YUV once, fast probe encodes estimate how
+     * size follows quality and usually about two full encodes settle the result.
+     *
+     * @param options AVIF encoder configuration, only lossy AV1 is supported
+     */
+    fun encodeAvifToSize(
+        bitmap: Bitmap,
+        maxBytes: Int,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): TargetSizeEncoding {
+        require(options.avKind == AvKind.AV1) {
+            "Target size encoding is available only for AV1"
+        }
+        require(!options.isLossless()) {
+            "Lossless files can't be fitted into a size"
+        }
+        require(maxBytes > 0) {
+            "Target size must be positive"
+        }
+        val dataSpace = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            bitmap.colorSpace?.dataSpace ?: -1
+        } else {
+            -1
+        }
+        return encodeAvifToSizeImpl(bitmap, exif?.let(::exifBytes), dataSpace, maxBytes, options)
+    }
+
+    /**
+     * Encodes an avif image within a time budget instead of a fixed [AvSpeed]. Speed and
+     * encoder threads are chosen from the image size, the throughput measured on previous
+     * encodes and the clock limits the CPU governors impose right now; the slowest preset
+     * expected to finish in time wins. [AvifEncodingOptions.speed] is ignored.
+     *
+     * @param deadlineMs time budget in milliseconds, Fast is used when nothing fits
+     * @param options AVIF encoder configuration, only AV1 is supported
+     */
+    fun encodeAvifWithin(
+        bitmap: Bitmap,
+        deadlineMs: Int,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): DeadlineEncoding {
+        require(options.avKind == AvKind.AV1) {
+            "Deadline encoding is available only for AV1"
+        }
+        require(deadlineMs >= 0) {
+            "Time budget can't be negative"
+        }
+        val dataSpace = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            bitmap.colorSpace?.dataSpace ?: -1
+        } else {
+            -1
+        }
+        return encodeAvifWithinImpl(bitmap, exif?.let(::exifBytes), dataSpace, deadlineMs, options)
+    }
+
+    /**
+     * Keeps the encoder throughput measured by [encodeAvifWithin] in [file], so calibration
+     * survives restarts. The file is read right away and rewritten after every such encode,
+     * a file in the app's files directory is a good fit. Null keeps it in memory only.
+     */
+    fun setEncodeCalibrationFile(file: File?) {
+        setEncodeCalibrationFileImpl(file?.absolutePath)
+    }
+
+    /**
+     * Encodes an avif image and keeps the file in native memory. Unlike [encodeAvif] returning
+     * a ByteArray, nothing is allocated on the Java heap until the result is copied out.
+     * AV2 has no native buffer path, its output is moved into native memory once.
+     */
+    fun encodeAvifNative(
+        bitmap: Bitmap,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): NativeEncodedImage {
+        val dataSpace = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            bitmap.colorSpace?.dataSpace ?: -1
+        } else {
+            -1
+        }
+        return NativeEncodedImage(
+            encodeAvifNativeImpl(bitmap, exif?.let(::exifBytes), dataSpace, options)
+        )
+    }
+
+    /**
+     * Encodes an avif image into the direct [output] at its position. The file is written and
+     * the position advanced only when it fits into the remaining space, otherwise [output] is
+     * left untouched, so an empty buffer queries the size. Querying costs a full encode, use
+     * [encodeAvifNative] to encode once and allocate afterwards.
+     *
+     * @return encoded size in bytes
+     */
+    fun encodeAvifInto(
+        bitmap: Bitmap,
+        output: ByteBuffer,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): Int {
+        require(output.isDirect) {
+            "Output has to be a direct ByteBuffer"
+        }
+        return encodeAvifNative(bitmap, exif, options).use { it.copyIfFits(output) }
+    }
+
+    /**
+     * Encodes an avif image and writes it at the current offset of [output], which stays open
+     *
+     * @return bytes written
+     */
+    fun encodeAvifInto(
+        bitmap: Bitmap,
+        output: ParcelFileDescriptor,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): Long = encodeAvifNative(bitmap, exif, options).use { it.writeTo(output) }
+
+    /**
+     * Encodes a heic image and keeps the file in native memory, see [encodeAvifNative]
+     */
+    fun encodeHeicNative(
+        bitmap: Bitmap,
+        exif: ByteBuffer? = null,
+        options: HevcEncodingOptions = HevcEncodingOptions(),
+    ): NativeEncodedImage {
+        val dataSpace = if (Build.VERSION.SDK_INT >= Build.VERSION_CODES.TIRAMISU) {
+            bitmap.colorSpace?.dataSpace ?: -1
+        } else {
+            -1
+        }
+        return NativeEncodedImage(
+            encodeHeicNativeImpl(bitmap, exif?.let(::exifBytes), dataSpace, options)
+        )
+    }
+
+    /**
+     * Encodes a heic image into the direct [output], the size query works as for [encodeAvifInto]
+     *
+     * @return encoded size in bytes
+     */
+    fun encodeHeicInto(
+        bitmap: Bitmap,
+        output: ByteBuffer,
+        exif: ByteBuffer? = null,
+        options: HevcEncodingOptions = HevcEncodingOptions(),
+    ): Int {
+        require(output.isDirect) {
+            "Output has to be a direct ByteBuffer"
+        }
+        return encodeHeicNative(bitmap, exif, options).use { it.copyIfFits(output) }
+    }
+
+    /**
+     * Encodes a heic image and writes it at the current offset of [output], which stays open
+     *
+     * @return bytes written
+     */
+    fun encodeHeicInto(
+        bitmap: Bitmap,
+        output: ParcelFileDescriptor,
+        exif: ByteBuffer? = null,
+        options: HevcEncodingOptions = HevcEncodingOptions(),
+    ): Long = encodeHeicNative(bitmap, exif, options).use { it.writeTo(output) }
+
+    /**
+     * Encodes YUV planes as they are, skipping the RGBA round trip of [encodeAvif] for a Bitmap.
+     * Chroma subsampling and colour space of [options] are ignored, [image] describes them.
+     */
+    fun encodeAvif(
+        image: YuvImage,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): ByteArray = encodeYuv(image, exif, options, heic = false)
+
+    /**
+     * Encodes YUV planes as HEIC as they are. Chroma subsampling of [options] is ignored,
+     * [image] describes it.
+     */
+    fun encodeHeic(
+        image: YuvImage,
+        exif: ByteBuffer? = null,
+        options: HevcEncodingOptions = HevcEncodingOptions(),
+    ): ByteArray = encodeYuv(image, exif, options, heic = true)
+
+    /**
+     * Encodes a CPU readable YCBCR_420_888 or YCBCR_P010 [buffer] in place, without copying it
+     * into a Bitmap first.
+     */
+    @RequiresApi(Build.VERSION_CODES.Q)
+    fun encodeAvif(
+        buffer: HardwareBuffer,
+        colorSpace: YuvColorSpace = YuvColorSpace.SRGB_JPEG,
+        exif: ByteBuffer? = null,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): ByteArray = encodeHardwareBufferImpl(
+        buffer,
+        colorSpace.colorPrimaries,
+        colorSpace.transferCharacteristics,
+        colorSpace.matrixCoefficients,
+        colorSpace.fullRange,
+        exif?.let(::exifBytes),
+        options,
+        false,
+    )
+
+    /**
+     * Encodes a CPU readable YCBCR_420_888 or YCBCR_P010 [buffer] as HEIC in place.
+     */
+    @RequiresApi(Build.VERSION_CODES.Q)
+    fun encodeHeic(
+        buffer: HardwareBuffer,
+        colorSpace: YuvColorSpace = YuvColorSpace.SRGB_JPEG,
+        exif: ByteBuffer? = null,
+        options: HevcEncodingOptions = HevcEncodingOptions(),
+    ): ByteArray = encodeHardwareBufferImpl(
+        buffer,
+        colorSpace.colorPrimaries,
+        colorSpace.transferCharacteristics,
+        colorSpace.matrixCoefficients,
+        colorSpace.fullRange,
+        exif?.let(::exifBytes),
+        options,
+        true,
+    )
+
+    /**
+     * Transcodes a HEIC file to AVIF without going through RGB: the decoded HEVC planes go to
+     * the AV1 encoder as they are, alpha, ICC profile, Exif, orientation and crop are carried
+     * over. Only GBR sources and crops AVIF can't express are converted, 12 bit sources are
+     * rounded to 10 bits. Chroma subsampling of [options] is ignored, the source keeps its own.
+     *
+     * @param options AVIF encoder configuration, only AV1 is supported
+     */
+    fun transcode(
+        input: ByteArray,
+        options: AvifEncodingOptions = AvifEncodingOptions(),
+    ): ByteArray = transcodeHeicImpl(input, options)
+
+    private fun encodeYuv(image: YuvImage, exif: ByteBuffer?, options: Any, heic: Boolean): ByteArray {
+        return encodeYuvImpl(
+            image.planes(),
+            image.rowStrides,
+            image.chromaPixelStride,
+            image.width,
+            image.height,
+            image.bitDepth,
+            image.msbAligned,
+            image.chromaSubsampling.value,
+            image.colorSpace.colorPrimaries,
+            image.colorSpace.transferCharacteristics,
+            image.colorSpace.matrixCoefficients,
+            image.colorSpace.fullRange,
+            exif?.let(::exifBytes),
+            options,
+            heic,
+        )
+    }
+
+    private fun NativeEncodedImage.copyIfFits(output: ByteBuffer): Int {
+        val length = size
+        if (length > Int.MAX_VALUE) {
+            throw IllegalStateException("Encoded image of $length bytes doesn't fit a ByteBuffer")
+        }
+        if (length <= output.remaining()) {
+            copyTo(output)
+        }
+        return length.toInt()
+    }
+
+    private fun exifBytes(buffer: ByteBuffer): ByteArray {
+        val copy = buffer.duplicate()
+        return ByteArray(copy.remaining()).also { copy.get(it) }
+    }
+
+    /**
+     * Limits native memory shared by all in-flight decodes in the process.
+     * Decodes above the budget wait for others to finish, or are downscaled in YUV
+     * when a smaller target size was requested.
+     *
+     * @param bytes budget in bytes, 0 restores the default of a quarter of physical memory
+     */
+    fun setDecodeMemoryBudget(bytes: Long) {
+        require(bytes >= 0) {
+            "Memory budget can't be negative"
+        }
+        setDecodeMemoryBudgetImpl(bytes)
+    }
+
+    fun getDecodeMemoryBudget(): Long {
+        return getDecodeMemoryBudgetImpl()
+    }
+
     fun detectContainer(byteBuffer: ByteBuffer): HeifContainerInnerType? {
         val value = detectContainerImpl(byteBuffer)
         return when (value) {
@@ -165,6 +529,8 @@ class Coder {
     }
 
     private external fun getSizeImpl(byteArray: ByteArray): Size
+    private external fun setDecodeMemoryBudgetImpl(bytes: Long)
+    private external fun getDecodeMemoryBudgetImpl(): Long
     private external fun isHeifImageImpl(byteArray: ByteArray): Boolean
     private external fun isAvifImageImpl(byteArray: ByteArray): Boolean
     private external fun isSupportedImageImpl(byteArray: ByteArray): Boolean
@@ -177,6 +543,7 @@ class Coder {
         clrConfig: Int,
         scaleMode: Int,
         scaleQuality: Int,
+        statsListener: DecodeStatsListener?,
     ): Bitmap
 
     private external fun decodeByteBufferImpl(
@@ -186,15 +553,63 @@ class Coder {
         clrConfig: Int,
         scaleMode: Int,
         scaleQuality: Int,
+        statsListener: DecodeStatsListener?,
     ): Bitmap
 
     private external fun encodeAvifImpl(
         bitmap: Bitmap,
-        exif: ByteBuffer?,
+        exif: ByteArray?,
+        dataSpace: Int,
+        options: AvifEncodingOptions,
+    ): ByteArray
+
+    private external fun encodeAvifBatchImpl(
+        bitmaps: Array<Bitmap>,
+        exif: Array<ByteArray?>?,
+        dataSpaces: IntArray,
+        options: AvifEncodingOptions,
+    ): Array<ByteArray>
+
+    private external fun encodeAvifGridImpl(
+        bitmap: Bitmap,
+        exif: ByteArray?,
         dataSpace: Int,
+        tileSize: Int,
         options: AvifEncodingOptions,
     ): ByteArray
 
+    private external fun encodeAvifToSizeImpl(
+        bitmap: Bitmap,
+        exif: ByteArray?,
+        dataSpace: Int,
+        maxBytes: Int,
+        options: AvifEncodingOptions,
+    ): TargetSizeEncoding
+
+    private external fun encodeAvifWithinImpl(
+        bitmap: Bitmap,
+        exif: ByteArray?,
+        dataSpace: Int,
+        deadlineMs: Int,
+        options: AvifEncodingOptions,
+    ): DeadlineEncoding
+
+    private external fun setEncodeCalibrationFileImpl(path: String?)
+
+    private external fun encodeAvifNativeImpl(
+        bitmap: Bitmap,
+        exif: ByteArray?,
+        dataSpace: Int,
+        options: AvifEncodingOptions,
+    ): Long
+
+    private external fun encodeHeicNativeImpl(
+        bitmap: Bitmap,
+        exif: ByteArray?,
+        dataSpace: Int,
+        options: HevcEncodingOptions,
+    ): Long
+
     private external fun encodeHeicImpl(
         bitmap: Bitmap,
         exif: ByteBuffer?,
@@ -202,6 +617,40 @@ class Coder {
         options: HevcEncodingOptions,
     ): ByteArray
 
+    private external fun encodeYuvImpl(
+        planes: Array<ByteBuffer>,
+        rowStrides: IntArray,
+        chromaPixelStride: Int,
+        width: Int,
+        height: Int,
+        bitDepth: Int,
+        msbAligned: Boolean,
+        chromaSubsampling: Int,
+        colorPrimaries: Int,
+        transferCharacteristics: Int,
+        matrixCoefficients: Int,
+        fullRange: Boolean,
+        exif: ByteArray?,
+        options: Any,
+        heic: Boolean,
+    ): ByteArray
+
+    private external fun transcodeHeicImpl(
+        input: ByteArray,
+        options: AvifEncodingOptions,
+    ): ByteArray
+
+    private external fun encodeHardwareBufferImpl(
+        buffer: HardwareBuffer,
+        colorPrimaries: Int,
+        transferCharacteristics: Int,
+        matrixCoefficients: Int,
+        fullRange: Boolean,
+        exif: ByteArray?,
+        options: Any,
+        heic: Boolean,
+    ): ByteArray
+
     @SuppressLint("ObsoleteSdkInt")
     companion object {
         init {
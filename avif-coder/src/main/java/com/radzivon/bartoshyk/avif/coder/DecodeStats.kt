@@ -0,0 +1,81 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 18/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.radzivon.bartoshyk.avif.coder
+
+import androidx.annotation.Keep
+
+/**
+ * Per-stage measurements of a single decode.
+ *
+ * CPU time is measured on the decoding thread, so concurrent decodes don't inflate it.
+ * Work the AV1 decoder runs on its own worker threads is not included.
+ * Allocated bytes are estimated from the sizes of buffers the pipeline requests,
+ * allocator overhead and codec internals are not included.
+ *
+ * @param colorObuSize size of the compressed color payload in bytes
+ * @param alphaObuSize size of the compressed alpha payload in bytes
+ * @param decoderThreads threads made available to the AV1 decoder
+ * @param conversionThreads threads that ran color conversion, scaling and color management
+ */
+@Keep
+class DecodeStats(
+    private val wallNanos: LongArray,
+    private val cpuNanos: LongArray,
+    private val estimatedAllocatedBytes: LongArray,
+    val colorObuSize: Long,
+    val alphaObuSize: Long,
+    val decoderThreads: Int,
+    val conversionThreads: Int,
+) {
+
+    fun wallTimeNanos(stage: DecodeStage): Long = wallNanos[stage.ordinal]
+
+    fun cpuTimeNanos(stage: DecodeStage): Long = cpuNanos[stage.ordinal]
+
+    fun estimatedAllocatedBytes(stage: DecodeStage): Long = estimatedAllocatedBytes[stage.ordinal]
+
+    val totalWallTimeNanos: Long
+        get() = wallNanos.sum()
+
+    val totalCpuTimeNanos: Long
+        get() = cpuNanos.sum()
+
+    val totalEstimatedAllocatedBytes: Long
+        get() = estimatedAllocatedBytes.sum()
+
+    override fun toString(): String {
+        val stages = DecodeStage.entries.joinToString(", ") {
+            "$it(wall=${wallTimeNanos(it)}ns, cpu=${cpuTimeNanos(it)}ns, " +
+                    "estimatedBytes=${estimatedAllocatedBytes(it)})"
+        }
+        return "DecodeStats(stages=[$stages], colorObuSize=$colorObuSize, " +
+                "alphaObuSize=$alphaObuSize, decoderThreads=$decoderThreads, " +
+                "conversionThreads=$conversionThreads)"
+    }
+}
@@ -0,0 +1,117 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.radzivon.bartoshyk.avif.coder
+
+import android.os.ParcelFileDescriptor
+import androidx.annotation.Keep
+import java.io.Closeable
+import java.nio.ByteBuffer
+
+/**
+ * Encoded file held in native memory, returned by [Coder.encodeAvifNative] and
+ * [Coder.encodeHeicNative]. It can be copied into a direct [ByteBuffer] or written to a
+ * file descriptor without a Java heap copy, the native memory is released by [close].
+ */
+@Keep
+class NativeEncodedImage internal constructor(private var nativeImage: Long) : Closeable {
+
+    private val lock = Any()
+
+    /**
+     * Encoded size in bytes
+     */
+    val size: Long
+        get() = synchronized(lock) {
+            sizeImpl(checkOpen())
+        }
+
+    /**
+     * Copies the file into the direct [output] at its position and advances the position.
+     * [output] has to have at least [size] bytes remaining.
+     */
+    fun copyTo(output: ByteBuffer) {
+        require(output.isDirect) {
+            "Output has to be a direct ByteBuffer"
+        }
+        synchronized(lock) {
+            val ptr = checkOpen()
+            val length = sizeImpl(ptr)
+            require(output.remaining() >= length) {
+                "Output has ${output.remaining()} bytes left, the image needs $length"
+            }
+            copyToImpl(ptr, output, output.position())
+            output.position(output.position() + length.toInt())
+        }
+    }
+
+    /**
+     * Writes the file at the current offset of [fd], which stays open
+     *
+     * @return bytes written
+     */
+    fun writeTo(fd: ParcelFileDescriptor): Long {
+        synchronized(lock) {
+            val ptr = checkOpen()
+            writeToImpl(ptr, fd.fd)
+            return sizeImpl(ptr)
+        }
+    }
+
+    fun toByteArray(): ByteArray {
+        synchronized(lock) {
+            return toByteArrayImpl(checkOpen())
+        }
+    }
+
+    private fun checkOpen(): Long {
+        if (nativeImage == -1L) {
+            throw IllegalStateException("Encoded image was already closed")
+        }
+        return nativeImage
+    }
+
+    protected fun finalize() {
+        close()
+    }
+
+    override fun close() {
+        synchronized(lock) {
+            if (nativeImage != -1L) {
+                destroy(nativeImage)
+                nativeImage = -1L
+            }
+        }
+    }
+
+    private external fun destroy(ptr: Long)
+    private external fun sizeImpl(ptr: Long): Long
+    private external fun copyToImpl(ptr: Long, buffer: ByteBuffer, position: Int)
+    private external fun writeToImpl(ptr: Long, fd: Int)
+    private external fun toByteArrayImpl(ptr: Long): ByteArray
+}
@@ -0,0 +1,69 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.radzivon.bartoshyk.avif.coder
+
+import androidx.annotation.Keep
+
+/**
+ * Colour description of YUV planes as ITU-T H.273 code points, written into the
+ * encoded image as is. Nothing is converted, the planes must already be in this space.
+ */
+@Keep
+data class YuvColorSpace(
+    val colorPrimaries: Int,
+    val transferCharacteristics: Int,
+    val matrixCoefficients: Int,
+    val fullRange: Boolean,
+) {
+    companion object {
+        /**
+         * Camera JPEG style: BT.709 primaries, sRGB transfer, BT.601 matrix, full range
+         */
+        @JvmField
+        val SRGB_JPEG = YuvColorSpace(1, 13, 6, true)
+
+        /**
+         * BT.709 video, limited range
+         */
+        @JvmField
+        val BT709 = YuvColorSpace(1, 1, 1, false)
+
+        /**
+         * BT.2020 HLG video, limited range, as recorded by HDR cameras into P010
+         */
+        @JvmField
+        val BT2020_HLG = YuvColorSpace(9, 18, 9, false)
+
+        /**
+         * BT.2020 PQ video, limited range
+         */
+        @JvmField
+        val BT2020_PQ = YuvColorSpace(9, 16, 9, false)
+    }
+}
@@ -0,0 +1,110 @@
+/*
+ * MIT License
+ *
+ * Copyright (c) 2026 Radzivon Bartoshyk
+ * avif-coder [https://github.com/awxkee/avif-coder]
+ *
+ * Created by Radzivon Bartoshyk on 19/10/2026
+ *
+ * Permission is hereby granted, free of charge, to any person obtaining a copy
+ * of this software and associated documentation files (the "Software"), to deal
+ * in the Software without restriction, including without limitation the rights
+ * to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+ * copies of the Software, and to permit persons to whom the Software is
+ * furnished to do so, subject to the following conditions:
+ *
+ * The above copyright notice and this permission notice shall be included in all
+ * copies or substantial portions of the Software.
+ *
+ * THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+ * IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+ * FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+ * AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+ * LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+ * OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+ * SOFTWARE.
+ *
+ */
+
+package com.radzivon.bartoshyk.avif.coder
+
+import android.graphics.ImageFormat
+import android.media.Image
+import androidx.annotation.Keep
+import java.nio.ByteBuffer
+
+/**
+ * YUV planes encoded without going through RGBA. Planes are direct buffers read from
+ * their current position; 8 bit samples are bytes, 10 bit samples are native endian
+ * shorts. Interleaved chroma (NV12, NV21, P010) sets [chromaPixelStride] to 2 with
+ * [u] and [v] pointing at their first sample inside the shared rows.
+ *
+ * @param rowStrides row strides in bytes of Y, U, V and A when present
+ * @param msbAligned 10 bit samples keep their bits at the top of the short, as in P010
+ * @param chromaSubsampling layout of U and V, AUTO and LOSELESS are not accepted
+ */
+@Keep
+class YuvImage(
+    val width: Int,
+    val height: Int,
+    val y: ByteBuffer,
+    val u: ByteBuffer,
+    val v: ByteBuffer,
+    val rowStrides: IntArray,
+    val chromaPixelStride: Int = 1,
+    val chromaSubsampling: AvifChromaSubsampling = AvifChromaSubsampling.YUV420,
+    val bitDepth: Int = 8,
+    val msbAligned: Boolean = false,
+    val colorSpace: YuvColorSpace = YuvColorSpace.SRGB_JPEG,
+    val alpha: ByteBuffer? = null,
+) {
+    init {
+        require(width > 0 && height > 0) { "YUV image size must be positive" }
+        require(bitDepth == 8 || bitDepth == 10) { "YUV bit depth has to be 8 or 10" }
+        require(chromaSubsampling != AvifChromaSubsampling.AUTO && chromaSubsampling != AvifChromaSubsampling.LOSELESS) {
+            "YUV image needs an explicit chroma subsampling"
+        }
+        require(rowStrides.size == if (alpha != null) 4 else 3) {
+            "Every plane needs its row stride"
+        }
+        require(y.isDirect && u.isDirect && v.isDirect && (alpha?.isDirect ?: true)) {
+            "YUV planes must be direct ByteBuffers"
+        }
+    }
+
+    internal fun planes(): Array<ByteBuffer> =
+        listOfNotNull(y, u, v, alpha).map { it.slice() }.toTypedArray()
+
+    companion object {
+        /**
+         * Wraps the planes of a YUV_420_888 or YCBCR_P010 [Image], typically from a camera
+         * ImageReader. The image must stay open until encoding returns.
+         */
+        @JvmStatic
+        fun fromImage(image: Image, colorSpace: YuvColorSpace = YuvColorSpace.SRGB_JPEG): YuvImage {
+            val bitDepth = when (image.format) {
+                ImageFormat.YUV_420_888 -> 8
+                ImageFormat.YCBCR_P010 -> 10
+                else -> throw IllegalArgumentException("Image has to be YUV_420_888 or YCBCR_P010")
+            }
+            val sampleSize = if (bitDepth > 8) 2 else 1
+            val planes = image.planes
+            require(planes[0].pixelStride == sampleSize && planes[1].pixelStride == planes[2].pixelStride) {
+                "Image plane layout is not supported"
+            }
+            return YuvImage(
+                width = image.width,
+                height = image.height,
+                y = planes[0].buffer,
+                u = planes[1].buffer,
+                v = planes[2].buffer,
+                rowStrides = intArrayOf(planes[0].rowStride, planes[1].rowStride, planes[2].rowStride),
+                chromaPixelStride = planes[1].pixelStride / sampleSize,
+                chromaSubsampling = AvifChromaSubsampling.YUV420,
+                bitDepth = bitDepth,
+                msbAligned = bitDepth > 8,
+                colorSpace = colorSpace,
+            )
+        }
+    }
+}
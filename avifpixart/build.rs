@@ -35,7 +35,16 @@ fn main() {
     cbindgen::Builder::new()
         .with_crate(crate_dir)
         .with_pragma_once(true)
-        .with_sys_include("jni.h")
+        .with_after_include(
+            "\n// JNI entry points are declared with opaque handles when the includer has no jni.h\n\
+             #if defined(AVIFWEAVER_NO_JNI)\n\
+             typedef void JNIEnv;\n\
+             typedef void *jobject;\n\
+             typedef jobject jbyteArray;\n\
+             #else\n\
+             #include <jni.h>\n\
+             #endif",
+        )
         .generate()
         .expect("Unable to generate bindings")
         .write_to_file("include/avifweaver.h");
@@ -26,27 +26,38 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
-use crate::cvt::{ar30_bytes_to_rgba10, f16_bytes_to_rgba10, rgb565_bytes_to_rgba8888};
-use crate::encoding_options::{AvEncodingSpeed, AvifEncodingOptions};
-use crate::ffi::{BitmapData, BitmapPixelFormat, get_bitmap_data};
+use crate::cvt::{ar30_row_to_rgba10, f16_rows_to_rgba10, rgb565_row_to_rgba8888};
+use crate::data_space::ADataSpace;
+use crate::encoding_options::{
+    AvEncodingSpeed, AvifEncodingOptions, EncodedImage, WeaveAv1PrepareResult, WeaveAv1Prepared,
+    WeaveImageBuffer, WeaveYuvImage,
+};
+#[cfg(target_os = "android")]
+use crate::ffi::LockedBitmap;
+use crate::ffi::{BitmapPixelFormat, BitmapView, view_image_buffer};
+use crate::support::{dbg_log, init_logging, panic_payload_to_string, try_vec};
+#[cfg(target_os = "android")]
 use crate::support::{
-    dbg_log, has_non_constant_alpha, init_logging, optional_bytebuffer_to_vec,
-    panic_payload_to_string, throw_runtime_exception, throw_runtime_exception_raw,
+    optional_bytebuffer_to_vec, throw_runtime_exception, throw_runtime_exception_raw,
 };
 use crate::weaver_error::WeaverError;
-use jni::objects::JObject;
-use jni::sys::{jbyteArray, jobject};
-use jni::{EnvUnowned, Outcome};
+use core::f16;
+#[cfg(target_os = "android")]
+use jni::{
+    EnvUnowned, Outcome,
+    objects::JObject,
+    sys::{jbyteArray, jobject},
+};
 use maroontree::{
     BitDepth, ChromaFormat, ChromaSamplePosition, Cicp, MatrixCoefficients, PlanarImage, Primaries,
     TransferFunction,
 };
-use ndk_sys::ADataSpace;
 use std::num::NonZero;
+#[cfg(target_os = "android")]
 use std::ptr::null_mut;
 use std::thread::available_parallelism;
 use yuv::{
-    YuvChromaSubsampling, YuvConversionMode, YuvGrayImageMut, YuvPlanarImageMut, YuvRange,
+    BufferStoreMut, YuvConversionMode, YuvGrayImageMut, YuvPlanarImageMut, YuvRange,
     YuvStandardMatrix, rgba_to_ycgco420, rgba_to_ycgco422, rgba_to_ycgco444, rgba_to_yuv400,
     rgba_to_yuv420, rgba_to_yuv422, rgba_to_yuv444, rgba10_to_i010, rgba10_to_i210, rgba10_to_i410,
     rgba10_to_icgc010, rgba10_to_icgc210, rgba10_to_icgc410, rgba10_to_y010,
@@ -196,51 +207,46 @@ pub(crate) fn resolve_cicp_maroontree(color_space: i32) -> Cicp {
     Cicp::unspecified()
 }
 
-fn encode_avif_inner_mono_u16(
-    hd_data: &[u16],
-    bitmap_data: &BitmapData,
-    config: &AvEncodingConfig,
-    has_real_alpha: bool,
-) -> Result<Vec<u8>, anyhow::Error> {
-    let cicp = config.cicp;
-    let quality = config.quality;
-    let lossless = config.lossless;
-    let exif = config.exif.as_ref();
-    dbg_log!(
-        debug,
-        "encode_avif_inner_mono_u8: {}x{} pixels={} quality={} lossless={} exif={}",
-        bitmap_data.width,
-        bitmap_data.height,
-        bitmap_data.data.len(),
-        quality,
-        lossless,
-        exif.map_or_else(|| "none".to_string(), |e| format!("{} bytes", e.len()))
-    );
+/// RGB → YUV converted image ready for maroontree. Conversion depends only on
+/// the colour settings, so quality, speed, threads and exif are applied later
+/// in [encode_prepared_av1] and a prepared image can be encoded more than once.
+pub(crate) struct PreparedAv1Image {
+    pub(crate) planes: PreparedPlanes,
+    pub(crate) cicp: Cicp,
+    pub(crate) chroma: ChromaFormat,
+    pub(crate) has_alpha: bool,
+    /// Alpha of every pixel at the depth of `planes` when `has_alpha` is false.
+    pub(crate) constant_alpha: u16,
+    pub(crate) lossless: bool,
+}
 
-    let mut local_cicp = cicp;
-    dbg_log!(
-        debug,
-        "cicp: primaries={:?} transfer={:?} matrix={:?} full_range={}",
-        cicp.primaries,
-        cicp.transfer,
-        cicp.matrix,
-        cicp.full_range
-    );
-    dbg_log!(debug, "has_real_alpha={has_real_alpha}");
+pub(crate) enum PreparedPlanes {
+    Eight(PlanarImage<u8>),
+    Ten(PlanarImage<u16>),
+}
 
-    if lossless && !local_cicp.full_range {
-        dbg_log!(
-            warn,
-            "lossless AV1 monochrome encode requires full range; overriding CICP range to full"
-        );
-        local_cicp.full_range = true;
+impl PreparedPlanes {
+    /// Largest alpha sample at the depth of the planes.
+    pub(crate) fn opaque_alpha(&self) -> u16 {
+        match self {
+            PreparedPlanes::Eight(_) => 255,
+            PreparedPlanes::Ten(_) => 1023,
+        }
+    }
+}
+
+impl PreparedAv1Image {
+    #[allow(unused)]
+    fn pixels(&self) -> usize {
+        match &self.planes {
+            PreparedPlanes::Eight(image) => image.width * image.height,
+            PreparedPlanes::Ten(image) => image.width * image.height,
+        }
     }
+}
 
-    let yuv_range = match local_cicp.full_range {
-        true => YuvRange::Full,
-        false => YuvRange::Limited,
-    };
-    let yuv_matrix = match local_cicp.matrix {
+fn yuv_matrix_for(matrix: MatrixCoefficients) -> YuvStandardMatrix {
+    match matrix {
         MatrixCoefficients::Bt709 => YuvStandardMatrix::Bt709,
         MatrixCoefficients::Unspecified => YuvStandardMatrix::Bt601,
         MatrixCoefficients::Fcc => YuvStandardMatrix::Fcc,
@@ -249,865 +255,789 @@ fn encode_avif_inner_mono_u16(
         _other => {
             dbg_log!(
                 warn,
-                "encode_avif_inner_mono_u8: unhandled matrix={:?} — falling back to Bt601",
+                "unhandled matrix={:?} — falling back to Bt601",
                 _other
             );
             YuvStandardMatrix::Bt601
         }
-    };
-    dbg_log!(debug, "yuv_range={yuv_range:?} yuv_matrix={yuv_matrix:?}");
+    }
+}
 
-    let mut planar_image =
-        YuvGrayImageMut::alloc(bitmap_data.width as u32, bitmap_data.height as u32);
-    dbg_log!(
-        debug,
-        "allocated monochrome plane: {}x{} y={} samples",
-        planar_image.width,
-        planar_image.height,
-        planar_image.y_plane.borrow().len()
-    );
+/// Rows converted per pass. Even so 4:2:0 chroma rows never straddle two
+/// strips, and small enough that an unpacked strip stays a sliver of a frame.
+const PREPARE_STRIP_ROWS: usize = 64;
+
+/// Colour settings resolved once and applied to every strip.
+#[derive(Debug, Clone, Copy)]
+struct StripConversion {
+    chroma: ChromaFormat,
+    range: YuvRange,
+    matrix: YuvStandardMatrix,
+    lossless: bool,
+}
 
-    rgba10_to_y010(
-        &mut planar_image,
-        hd_data,
-        bitmap_data.width as u32 * 4,
-        yuv_range,
-        yuv_matrix,
-    )
-    .map_err(|x| {
-        dbg_log!(error, "rgba_to_yuv400 failed: {x}");
-        anyhow::anyhow!(x)
-    })?;
+impl StripConversion {
+    /// Chroma plane size of `width` x `rows` luma samples.
+    fn chroma_size(&self, width: usize, rows: usize) -> (usize, usize) {
+        match self.chroma {
+            ChromaFormat::Yuv420 => (width.div_ceil(2), rows.div_ceil(2)),
+            ChromaFormat::Yuv422 => (width.div_ceil(2), rows),
+            ChromaFormat::Yuv444 => (width, rows),
+            ChromaFormat::Monochrome => (0, 0),
+        }
+    }
 
-    let threads = available_parallelism()
-        .unwrap_or(NonZero::new(1).unwrap())
-        .get();
-    dbg_log!(debug, "encoder threads={threads}");
+    /// First chroma row of the strip starting at luma row `y`.
+    fn chroma_row(&self, y: usize) -> usize {
+        match self.chroma {
+            ChromaFormat::Yuv420 => y / 2,
+            _ => y,
+        }
+    }
+}
 
-    let mut config = maroontree::EncodeConfig::new()
-        .with_cicp(local_cicp)
-        .with_quality(quality as u8)
-        .with_threads(threads)
-        .with_chroma(ChromaFormat::Monochrome)
-        .with_speed(config.speed.to_maroontree())
-        .with_screen_content(config.screen_content_coding)
-        .with_intrabc(config.screen_content_coding);
+/// Hands a bitmap out strip by strip as interleaved RGBA. RGBA8888 is read in
+/// place, packed formats are unpacked into a scratch holding a single strip.
+trait RgbaStrips<T> {
+    /// RGBA of rows `[y, y + rows)` with its row stride in elements.
+    fn strip(&mut self, y: usize, rows: usize) -> Result<(&[T], usize), anyhow::Error>;
+}
 
-    if let Some(exif) = exif {
-        dbg_log!(debug, "attaching exif: {} bytes", exif.len());
-        config = config.with_exif(exif.to_vec());
+struct Rgba8888Strips<'a> {
+    view: &'a BitmapView<'a>,
+    tail: Vec<u8>,
+}
+
+impl<'a> Rgba8888Strips<'a> {
+    fn new(view: &'a BitmapView<'a>) -> Self {
+        Self { view, tail: vec![] }
     }
+}
 
-    if has_real_alpha {
-        dbg_log!(debug, "monochrome+alpha: extracting alpha plane");
-        let alpha = hd_data
-            .as_chunks::<4>()
-            .0
-            .iter()
-            .map(|x| x[3])
-            .collect::<Vec<_>>();
-        dbg_log!(debug, "alpha plane: {} samples", alpha.len());
-
-        let av1_planar_image = PlanarImage {
-            width: bitmap_data.width,
-            height: bitmap_data.height,
-            planes: [
-                planar_image.y_plane.borrow().to_vec(),
-                alpha,
-                vec![],
-                vec![],
-            ],
-            bit_depth: BitDepth::Ten,
-        };
-        let result = if lossless {
-            maroontree::encode_lossless_gray_alpha(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_gray_alpha8 failed: {x}");
-                anyhow::anyhow!(x)
-            })?
-        } else {
-            maroontree::encode_gray_alpha10(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_gray_alpha8 failed: {x}");
-                anyhow::anyhow!(x)
-            })?
-        };
-        dbg_log!(debug, "encoded monochrome+alpha: {} bytes", result.len());
-        return Ok(result);
+impl RgbaStrips<u8> for Rgba8888Strips<'_> {
+    fn strip(&mut self, y: usize, rows: usize) -> Result<(&[u8], usize), anyhow::Error> {
+        if let Some(pixels) = self.view.padded_rows(y, rows) {
+            return Ok((pixels, self.view.stride));
+        }
+        // Padding after the last row may be missing, that strip is repacked
+        let row_bytes = self.view.row_bytes();
+        self.tail = try_vec![0u8; row_bytes * rows];
+        for (row, dst) in self.tail.chunks_exact_mut(row_bytes).enumerate() {
+            dst.copy_from_slice(self.view.row(y + row));
+        }
+        Ok((&self.tail, row_bytes))
     }
+}
 
-    let av1_planar_image = PlanarImage {
-        width: bitmap_data.width,
-        height: bitmap_data.height,
-        planes: [
-            planar_image.y_plane.borrow().to_vec(),
-            vec![],
-            vec![],
-            vec![],
-        ],
-        bit_depth: BitDepth::Ten,
-    };
-    let result = if lossless {
-        maroontree::encode_lossless_gray(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_gray8 failed: {x}");
-            anyhow::anyhow!(x)
-        })?
-    } else {
-        maroontree::encode_gray10(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_gray8 failed: {x}");
-            anyhow::anyhow!(x)
-        })?
-    };
-    dbg_log!(
-        debug,
-        "encoded monochrome: {} bytes ({:.2} bpp)",
-        result.len(),
-        (result.len() * 8) as f64 / (bitmap_data.width * bitmap_data.height) as f64
-    );
-    Ok(result)
+struct Rgb565Strips<'a> {
+    view: &'a BitmapView<'a>,
+    scratch: Vec<u8>,
 }
 
-fn encode_avif_inner_mono_u8(
-    bitmap_data: &BitmapData,
-    config: &AvEncodingConfig,
-    has_real_alpha: bool,
-) -> Result<Vec<u8>, anyhow::Error> {
-    let cicp = config.cicp;
-    let quality = config.quality;
-    let lossless = config.lossless;
-    let exif = config.exif.as_ref();
-    dbg_log!(
-        debug,
-        "encode_avif_inner_mono_u8: {}x{} pixels={} quality={} lossless={} exif={}",
-        bitmap_data.width,
-        bitmap_data.height,
-        bitmap_data.data.len(),
-        quality,
-        lossless,
-        exif.map_or_else(|| "none".to_string(), |e| format!("{} bytes", e.len()))
-    );
+impl<'a> Rgb565Strips<'a> {
+    fn new(view: &'a BitmapView<'a>) -> Result<Self, anyhow::Error> {
+        let scratch = try_vec![0u8; view.width * 4 * PREPARE_STRIP_ROWS.min(view.height)];
+        Ok(Self { view, scratch })
+    }
+}
 
-    let mut local_cicp = cicp;
-    dbg_log!(
-        debug,
-        "cicp: primaries={:?} transfer={:?} matrix={:?} full_range={}",
-        cicp.primaries,
-        cicp.transfer,
-        cicp.matrix,
-        cicp.full_range
-    );
-    dbg_log!(debug, "has_real_alpha={has_real_alpha}");
+impl RgbaStrips<u8> for Rgb565Strips<'_> {
+    fn strip(&mut self, y: usize, rows: usize) -> Result<(&[u8], usize), anyhow::Error> {
+        let stride = self.view.width * 4;
+        for (row, dst) in self.scratch.chunks_exact_mut(stride).take(rows).enumerate() {
+            rgb565_row_to_rgba8888(self.view.row(y + row), dst);
+        }
+        Ok((&self.scratch[..stride * rows], stride))
+    }
+}
 
-    if lossless && !local_cicp.full_range {
-        dbg_log!(
-            warn,
-            "lossless AV1 monochrome10 encode requires full range; overriding CICP range to full"
-        );
-        local_cicp.full_range = true;
+struct Ar30Strips<'a> {
+    view: &'a BitmapView<'a>,
+    scratch: Vec<u16>,
+}
+
+impl<'a> Ar30Strips<'a> {
+    fn new(view: &'a BitmapView<'a>) -> Result<Self, anyhow::Error> {
+        let scratch = try_vec![0u16; view.width * 4 * PREPARE_STRIP_ROWS.min(view.height)];
+        Ok(Self { view, scratch })
     }
+}
 
-    let yuv_range = match local_cicp.full_range {
-        true => YuvRange::Full,
-        false => YuvRange::Limited,
-    };
-    let yuv_matrix = match local_cicp.matrix {
-        MatrixCoefficients::Bt709 => YuvStandardMatrix::Bt709,
-        MatrixCoefficients::Unspecified => YuvStandardMatrix::Bt601,
-        MatrixCoefficients::Fcc => YuvStandardMatrix::Fcc,
-        MatrixCoefficients::Smpte170m => YuvStandardMatrix::Bt601,
-        MatrixCoefficients::Bt2020Ncl => YuvStandardMatrix::Bt2020,
-        _other => {
-            dbg_log!(
-                warn,
-                "encode_avif_inner_mono_u8: unhandled matrix={:?} — falling back to Bt601",
-                _other
-            );
-            YuvStandardMatrix::Bt601
+impl RgbaStrips<u16> for Ar30Strips<'_> {
+    fn strip(&mut self, y: usize, rows: usize) -> Result<(&[u16], usize), anyhow::Error> {
+        let stride = self.view.width * 4;
+        for (row, dst) in self.scratch.chunks_exact_mut(stride).take(rows).enumerate() {
+            ar30_row_to_rgba10(self.view.row(y + row), dst);
         }
-    };
-    dbg_log!(debug, "yuv_range={yuv_range:?} yuv_matrix={yuv_matrix:?}");
+        Ok((&self.scratch[..stride * rows], stride))
+    }
+}
 
-    let mut planar_image =
-        YuvGrayImageMut::alloc(bitmap_data.width as u32, bitmap_data.height as u32);
-    dbg_log!(
-        debug,
-        "allocated monochrome plane: {}x{} y={} samples",
-        planar_image.width,
-        planar_image.height,
-        planar_image.y_plane.borrow().len()
-    );
+struct F16Strips<'a> {
+    view: &'a BitmapView<'a>,
+    halfs: Vec<f16>,
+    scratch: Vec<u16>,
+}
 
-    rgba_to_yuv400(
-        &mut planar_image,
-        &bitmap_data.data,
-        bitmap_data.width as u32 * 4,
-        yuv_range,
-        yuv_matrix,
-    )
-    .map_err(|x| {
-        dbg_log!(error, "rgba_to_yuv400 failed: {x}");
-        anyhow::anyhow!(x)
-    })?;
+impl<'a> F16Strips<'a> {
+    fn new(view: &'a BitmapView<'a>) -> Result<Self, anyhow::Error> {
+        let samples = view.width * 4 * PREPARE_STRIP_ROWS.min(view.height);
+        let halfs = try_vec![0f16; samples];
+        let scratch = try_vec![0u16; samples];
+        Ok(Self {
+            view,
+            halfs,
+            scratch,
+        })
+    }
+}
 
-    let threads = available_parallelism()
-        .unwrap_or(NonZero::new(1).unwrap())
-        .get();
-    dbg_log!(debug, "encoder threads={threads}");
+impl RgbaStrips<u16> for F16Strips<'_> {
+    fn strip(&mut self, y: usize, rows: usize) -> Result<(&[u16], usize), anyhow::Error> {
+        let stride = self.view.width * 4;
+        f16_rows_to_rgba10(
+            self.view.rows(y, rows),
+            self.view.stride,
+            self.view.width,
+            rows,
+            &mut self.halfs,
+            &mut self.scratch,
+        )
+        .map_err(|x| {
+            dbg_log!(error, "f16_rows_to_rgba10 failed: {x}");
+            x
+        })?;
+        Ok((&self.scratch[..stride * rows], stride))
+    }
+}
 
-    let mut config = maroontree::EncodeConfig::new()
-        .with_cicp(local_cicp)
-        .with_quality(quality as u8)
-        .with_threads(threads)
-        .with_chroma(ChromaFormat::Monochrome)
-        .with_speed(config.speed.to_maroontree())
-        .with_screen_content(config.screen_content_coding)
-        .with_intrabc(config.screen_content_coding);
+/// Tightly packed RGBA already in memory, read in place unless `shift` has to
+/// narrow the samples first.
+struct PackedRgbaStrips<'a, T> {
+    data: &'a [T],
+    width: usize,
+    shift: u32,
+    scratch: Vec<T>,
+}
 
-    if let Some(exif) = exif {
-        dbg_log!(debug, "attaching exif: {} bytes", exif.len());
-        config = config.with_exif(exif.to_vec());
+impl<'a, T> PackedRgbaStrips<'a, T> {
+    fn new(data: &'a [T], width: usize, shift: u32) -> Self {
+        Self {
+            data,
+            width,
+            shift,
+            scratch: vec![],
+        }
     }
+}
 
-    if has_real_alpha {
-        dbg_log!(debug, "monochrome+alpha: extracting alpha plane");
-        let alpha = bitmap_data
-            .data
-            .as_chunks::<4>()
-            .0
-            .iter()
-            .map(|x| x[3])
-            .collect::<Vec<_>>();
-        dbg_log!(debug, "alpha plane: {} samples", alpha.len());
-
-        let av1_planar_image = PlanarImage {
-            width: bitmap_data.width,
-            height: bitmap_data.height,
-            planes: [
-                planar_image.y_plane.borrow().to_vec(),
-                alpha,
-                vec![],
-                vec![],
-            ],
-            bit_depth: BitDepth::Eight,
+impl RgbaStrips<u8> for PackedRgbaStrips<'_, u8> {
+    fn strip(&mut self, y: usize, rows: usize) -> Result<(&[u8], usize), anyhow::Error> {
+        let stride = self.width * 4;
+        Ok((&self.data[y * stride..(y + rows) * stride], stride))
+    }
+}
+
+impl RgbaStrips<u16> for PackedRgbaStrips<'_, u16> {
+    fn strip(&mut self, y: usize, rows: usize) -> Result<(&[u16], usize), anyhow::Error> {
+        let stride = self.width * 4;
+        let src = &self.data[y * stride..(y + rows) * stride];
+        if self.shift == 0 {
+            return Ok((src, stride));
+        }
+        if self.scratch.len() < src.len() {
+            self.scratch = try_vec![0u16; src.len()];
+        }
+        for (dst, &src) in self.scratch.iter_mut().zip(src.iter()) {
+            *dst = src >> self.shift;
+        }
+        Ok((&self.scratch[..src.len()], stride))
+    }
+}
+
+/// Converts one RGBA strip into the matching rows of `y`, `u` and `v`.
+type StripConverter<T> = fn(
+    &StripConversion,
+    &[T],
+    usize,
+    usize,
+    usize,
+    &mut [T],
+    &mut [T],
+    &mut [T],
+) -> Result<(), anyhow::Error>;
+
+#[allow(clippy::too_many_arguments)]
+fn convert_strip_u8(
+    conversion: &StripConversion,
+    rgba: &[u8],
+    rgba_stride: usize,
+    width: usize,
+    rows: usize,
+    y: &mut [u8],
+    u: &mut [u8],
+    v: &mut [u8],
+) -> Result<(), anyhow::Error> {
+    if conversion.chroma == ChromaFormat::Monochrome {
+        let mut gray = YuvGrayImageMut {
+            y_plane: BufferStoreMut::Borrowed(y),
+            y_stride: width as u32,
+            width: width as u32,
+            height: rows as u32,
         };
-        let result = if lossless {
-            maroontree::encode_lossless_gray_alpha(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_gray_alpha8 failed: {x}");
-                anyhow::anyhow!(x)
-            })?
-        } else {
-            maroontree::encode_gray_alpha8(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_gray_alpha8 failed: {x}");
-                anyhow::anyhow!(x)
-            })?
+        return rgba_to_yuv400(
+            &mut gray,
+            rgba,
+            rgba_stride as u32,
+            conversion.range,
+            conversion.matrix,
+        )
+        .map_err(|x| {
+            dbg_log!(error, "rgba_to_yuv400 failed: {x}");
+            anyhow::anyhow!(x)
+        });
+    }
+    let (chroma_width, _) = conversion.chroma_size(width, rows);
+    let mut planar = YuvPlanarImageMut {
+        y_plane: BufferStoreMut::Borrowed(y),
+        y_stride: width as u32,
+        u_plane: BufferStoreMut::Borrowed(u),
+        u_stride: chroma_width as u32,
+        v_plane: BufferStoreMut::Borrowed(v),
+        v_stride: chroma_width as u32,
+        width: width as u32,
+        height: rows as u32,
+    };
+    if conversion.lossless {
+        let f = match conversion.chroma {
+            ChromaFormat::Yuv420 => rgba_to_ycgco420,
+            ChromaFormat::Yuv422 => rgba_to_ycgco422,
+            ChromaFormat::Yuv444 => rgba_to_ycgco444,
+            ChromaFormat::Monochrome => unreachable!(),
+        };
+        f(&mut planar, rgba, rgba_stride as u32, conversion.range).map_err(|x| {
+            dbg_log!(error, "rgba_to_ycgco{:?} failed: {x}", conversion.chroma);
+            anyhow::anyhow!(x)
+        })
+    } else {
+        let f = match conversion.chroma {
+            ChromaFormat::Yuv420 => rgba_to_yuv420,
+            ChromaFormat::Yuv422 => rgba_to_yuv422,
+            ChromaFormat::Yuv444 => rgba_to_yuv444,
+            ChromaFormat::Monochrome => unreachable!(),
         };
-        dbg_log!(debug, "encoded monochrome+alpha: {} bytes", result.len());
-        return Ok(result);
+        f(
+            &mut planar,
+            rgba,
+            rgba_stride as u32,
+            conversion.range,
+            conversion.matrix,
+            YuvConversionMode::Balanced,
+        )
+        .map_err(|x| {
+            dbg_log!(error, "rgba_to_yuv{:?} failed: {x}", conversion.chroma);
+            anyhow::anyhow!(x)
+        })
     }
+}
 
-    let av1_planar_image = PlanarImage {
-        width: bitmap_data.width,
-        height: bitmap_data.height,
-        planes: [
-            planar_image.y_plane.borrow().to_vec(),
-            vec![],
-            vec![],
-            vec![],
-        ],
-        bit_depth: BitDepth::Eight,
+#[allow(clippy::too_many_arguments)]
+fn convert_strip_u16(
+    conversion: &StripConversion,
+    rgba: &[u16],
+    rgba_stride: usize,
+    width: usize,
+    rows: usize,
+    y: &mut [u16],
+    u: &mut [u16],
+    v: &mut [u16],
+) -> Result<(), anyhow::Error> {
+    if conversion.chroma == ChromaFormat::Monochrome {
+        let mut gray = YuvGrayImageMut {
+            y_plane: BufferStoreMut::Borrowed(y),
+            y_stride: width as u32,
+            width: width as u32,
+            height: rows as u32,
+        };
+        return rgba10_to_y010(
+            &mut gray,
+            rgba,
+            rgba_stride as u32,
+            conversion.range,
+            conversion.matrix,
+        )
+        .map_err(|x| {
+            dbg_log!(error, "rgba10_to_y010 failed: {x}");
+            anyhow::anyhow!(x)
+        });
+    }
+    let (chroma_width, _) = conversion.chroma_size(width, rows);
+    let mut planar = YuvPlanarImageMut {
+        y_plane: BufferStoreMut::Borrowed(y),
+        y_stride: width as u32,
+        u_plane: BufferStoreMut::Borrowed(u),
+        u_stride: chroma_width as u32,
+        v_plane: BufferStoreMut::Borrowed(v),
+        v_stride: chroma_width as u32,
+        width: width as u32,
+        height: rows as u32,
     };
-    let result = if lossless {
-        maroontree::encode_lossless_gray(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_gray8 failed: {x}");
+    if conversion.lossless {
+        let f = match conversion.chroma {
+            ChromaFormat::Yuv420 => rgba10_to_icgc010,
+            ChromaFormat::Yuv422 => rgba10_to_icgc210,
+            ChromaFormat::Yuv444 => rgba10_to_icgc410,
+            ChromaFormat::Monochrome => unreachable!(),
+        };
+        f(&mut planar, rgba, rgba_stride as u32, conversion.range).map_err(|x| {
+            dbg_log!(
+                error,
+                "rgba10_to_icgco{:?}_10bit failed: {x}",
+                conversion.chroma
+            );
             anyhow::anyhow!(x)
-        })?
+        })
     } else {
-        maroontree::encode_gray8(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_gray8 failed: {x}");
+        let f = match conversion.chroma {
+            ChromaFormat::Yuv420 => rgba10_to_i010,
+            ChromaFormat::Yuv422 => rgba10_to_i210,
+            ChromaFormat::Yuv444 => rgba10_to_i410,
+            ChromaFormat::Monochrome => unreachable!(),
+        };
+        f(
+            &mut planar,
+            rgba,
+            rgba_stride as u32,
+            conversion.range,
+            conversion.matrix,
+        )
+        .map_err(|x| {
+            dbg_log!(
+                error,
+                "rgba10_to_i{:?}_10bit failed: {x}",
+                conversion.chroma
+            );
             anyhow::anyhow!(x)
-        })?
-    };
-    dbg_log!(
-        debug,
-        "encoded monochrome: {} bytes ({:.2} bpp)",
-        result.len(),
-        (result.len() * 8) as f64 / (bitmap_data.width * bitmap_data.height) as f64
-    );
-    Ok(result)
+        })
+    }
 }
 
-fn encode_av1_inner_u8(
-    bitmap_data: &BitmapData,
-    config: &AvEncodingConfig,
-    has_real_alpha: bool,
-) -> Result<Vec<u8>, anyhow::Error> {
-    let cicp = config.cicp;
-    let quality = config.quality;
-    let lossless = config.lossless;
-    let requested_chroma_subsampling = config.chroma;
-    let exif = config.exif.as_ref();
+/// Converts the whole bitmap strip by strip straight into the planes handed
+/// to maroontree, in the order a [PlanarImage] holds them: Y, U, V, alpha,
+/// or Y, alpha for monochrome. Only one strip of unpacked RGBA is alive at a
+/// time, and the locked pixels are never copied as a whole. Alpha of the first
+/// pixel comes back alongside, it is the alpha of all of them without a plane.
+fn convert_strips<T: Copy + Default>(
+    width: usize,
+    height: usize,
+    source: &mut dyn RgbaStrips<T>,
+    conversion: &StripConversion,
+    has_alpha: bool,
+    convert: StripConverter<T>,
+) -> Result<([Vec<T>; 4], T), anyhow::Error> {
+    let (chroma_width, chroma_height) = conversion.chroma_size(width, height);
+
+    let mut y_plane = try_vec![T::default(); width * height];
+    let mut u_plane = try_vec![T::default(); chroma_width * chroma_height];
+    let mut v_plane = try_vec![T::default(); chroma_width * chroma_height];
+    let mut alpha = if has_alpha {
+        try_vec![T::default(); width * height]
+    } else {
+        vec![]
+    };
     dbg_log!(
         debug,
-        "encode_av1_inner_u8: {}x{} pixels={} quality={} lossless={} \
-         chroma={:?} exif={}",
-        bitmap_data.width,
-        bitmap_data.height,
-        bitmap_data.data.len(),
-        quality,
-        lossless,
-        requested_chroma_subsampling,
-        exif.map_or_else(|| "none".to_string(), |e| format!("{} bytes", e.len()))
+        "allocated {:?} planes: {}x{} (y={} u={} v={} a={} samples), strip={} rows",
+        conversion.chroma,
+        width,
+        height,
+        y_plane.len(),
+        u_plane.len(),
+        v_plane.len(),
+        alpha.len(),
+        PREPARE_STRIP_ROWS
     );
 
-    let mut local_cicp = cicp;
+    let mut first_alpha = T::default();
+    for y in (0..height).step_by(PREPARE_STRIP_ROWS) {
+        let rows = PREPARE_STRIP_ROWS.min(height - y);
+        let (rgba, rgba_stride) = source.strip(y, rows)?;
+        if y == 0 && width > 0 {
+            first_alpha = rgba[3];
+        }
+        let chroma_y = conversion.chroma_row(y);
+        let (_, chroma_rows) = conversion.chroma_size(width, rows);
+        convert(
+            conversion,
+            rgba,
+            rgba_stride,
+            width,
+            rows,
+            &mut y_plane[y * width..(y + rows) * width],
+            &mut u_plane[chroma_y * chroma_width..(chroma_y + chroma_rows) * chroma_width],
+            &mut v_plane[chroma_y * chroma_width..(chroma_y + chroma_rows) * chroma_width],
+        )?;
+        if has_alpha {
+            for (row, dst) in alpha[y * width..(y + rows) * width]
+                .chunks_exact_mut(width)
+                .enumerate()
+            {
+                let src = &rgba[row * rgba_stride..row * rgba_stride + width * 4];
+                for (dst, px) in dst.iter_mut().zip(src.as_chunks::<4>().0.iter()) {
+                    *dst = px[3];
+                }
+            }
+        }
+    }
+
+    let planes = if conversion.chroma == ChromaFormat::Monochrome {
+        [y_plane, alpha, vec![], vec![]]
+    } else {
+        [y_plane, u_plane, v_plane, alpha]
+    };
+    Ok((planes, first_alpha))
+}
+
+/// Resolves chroma, range and matrix of `config` the way AV1 lossless needs
+/// them: 4:4:4 unless monochrome, full range, and YCgCo for colour.
+fn strip_conversion(config: &AvEncodingConfig) -> (StripConversion, Cicp) {
+    let mut local_cicp = config.cicp;
     dbg_log!(
         debug,
         "cicp in: primaries={:?} transfer={:?} matrix={:?} full_range={}",
-        cicp.primaries,
-        cicp.transfer,
-        cicp.matrix,
-        cicp.full_range
+        local_cicp.primaries,
+        local_cicp.transfer,
+        local_cicp.matrix,
+        local_cicp.full_range
     );
-    dbg_log!(debug, "has_real_alpha={has_real_alpha}");
-
-    if requested_chroma_subsampling == ChromaFormat::Monochrome {
-        dbg_log!(debug, "delegating to monochrome path");
-        return encode_avif_inner_mono_u8(bitmap_data, config, has_real_alpha);
-    }
 
-    let chroma_subsampling = if lossless {
-        if requested_chroma_subsampling != ChromaFormat::Yuv444 {
+    let requested_chroma = config.chroma;
+    let chroma = if config.lossless && requested_chroma != ChromaFormat::Monochrome {
+        if requested_chroma != ChromaFormat::Yuv444 {
             dbg_log!(
                 warn,
                 "lossless AV1 RGB encode requires 4:4:4; overriding requested chroma={:?} to Yuv444",
-                requested_chroma_subsampling
+                requested_chroma
             );
         }
         ChromaFormat::Yuv444
     } else {
-        requested_chroma_subsampling
+        requested_chroma
     };
 
-    if lossless && !local_cicp.full_range {
+    if config.lossless && !local_cicp.full_range {
         dbg_log!(
             warn,
-            "lossless AV1 RGB encode requires full range; overriding CICP range to full"
+            "lossless AV1 encode requires full range; overriding CICP range to full"
         );
         local_cicp.full_range = true;
     }
 
-    let yuv_range = match local_cicp.full_range {
+    let range = match local_cicp.full_range {
         true => YuvRange::Full,
         false => YuvRange::Limited,
     };
-    let yuv_matrix = match local_cicp.matrix {
-        MatrixCoefficients::Bt709 => YuvStandardMatrix::Bt709,
-        MatrixCoefficients::Unspecified => YuvStandardMatrix::Bt601,
-        MatrixCoefficients::Fcc => YuvStandardMatrix::Fcc,
-        MatrixCoefficients::Smpte170m => YuvStandardMatrix::Bt601,
-        MatrixCoefficients::Bt2020Ncl => YuvStandardMatrix::Bt2020,
-        _other => {
-            dbg_log!(
-                warn,
-                "encode_av1_inner_u8: unhandled matrix={:?} — falling back to Bt601",
-                _other
-            );
-            YuvStandardMatrix::Bt601
-        }
-    };
-    dbg_log!(debug, "yuv_range={yuv_range:?} yuv_matrix={yuv_matrix:?}");
-
-    let mut planar_image = YuvPlanarImageMut::alloc(
-        bitmap_data.width as u32,
-        bitmap_data.height as u32,
-        match chroma_subsampling {
-            ChromaFormat::Yuv420 => YuvChromaSubsampling::Yuv420,
-            ChromaFormat::Yuv422 => YuvChromaSubsampling::Yuv422,
-            ChromaFormat::Yuv444 => YuvChromaSubsampling::Yuv444,
-            ChromaFormat::Monochrome => unreachable!(),
-        },
-    );
+    let matrix = yuv_matrix_for(local_cicp.matrix);
+    if config.lossless && chroma != ChromaFormat::Monochrome {
+        dbg_log!(debug, "lossless RGB→YUV path: overriding matrix to YCgCo");
+        local_cicp.matrix = MatrixCoefficients::YCgCo;
+    }
     dbg_log!(
         debug,
-        "allocated {:?} planes: {}x{} (y={} u={} v={} samples)",
-        chroma_subsampling,
-        planar_image.width,
-        planar_image.height,
-        planar_image.y_plane.borrow().len(),
-        planar_image.u_plane.borrow().len(),
-        planar_image.v_plane.borrow().len(),
+        "yuv_range={range:?} yuv_matrix={matrix:?} chroma={chroma:?} lossless={}",
+        config.lossless
     );
 
-    if !lossless {
-        dbg_log!(
-            debug,
-            "RGB→YUV path: standard YUV balanced (lossy), subsampling={:?}",
-            chroma_subsampling
-        );
-        let f = match chroma_subsampling {
-            ChromaFormat::Yuv420 => rgba_to_yuv420,
-            ChromaFormat::Yuv422 => rgba_to_yuv422,
-            ChromaFormat::Yuv444 => rgba_to_yuv444,
-            ChromaFormat::Monochrome => unreachable!(),
-        };
-        f(
-            &mut planar_image,
-            &bitmap_data.data,
-            bitmap_data.width as u32 * 4,
-            yuv_range,
-            yuv_matrix,
-            YuvConversionMode::Balanced,
-        )
-        .map_err(|x| {
-            dbg_log!(error, "rgba_to_yuv{:?} failed: {x}", chroma_subsampling);
-            anyhow::anyhow!(x)
-        })?;
-    } else {
-        dbg_log!(
-            debug,
-            "RGB→YUV path: YCgCo (lossless), subsampling={:?} — overriding matrix to YCgCo",
-            chroma_subsampling
-        );
-        local_cicp.matrix = MatrixCoefficients::YCgCo;
-        let f = match chroma_subsampling {
-            ChromaFormat::Yuv420 => rgba_to_ycgco420,
-            ChromaFormat::Yuv422 => rgba_to_ycgco422,
-            ChromaFormat::Yuv444 => rgba_to_ycgco444,
-            ChromaFormat::Monochrome => unreachable!(),
-        };
-        f(
-            &mut planar_image,
-            &bitmap_data.data,
-            bitmap_data.width as u32 * 4,
-            yuv_range,
-        )
-        .map_err(|x| {
-            dbg_log!(error, "rgba_to_ycgco{:?} failed: {x}", chroma_subsampling);
-            anyhow::anyhow!(x)
-        })?;
-    }
+    (
+        StripConversion {
+            chroma,
+            range,
+            matrix,
+            lossless: config.lossless,
+        },
+        local_cicp,
+    )
+}
 
+fn prepare_av1_u8(
+    width: usize,
+    height: usize,
+    source: &mut dyn RgbaStrips<u8>,
+    config: &AvEncodingConfig,
+    has_real_alpha: bool,
+) -> Result<PreparedAv1Image, anyhow::Error> {
     dbg_log!(
         debug,
-        "cicp after conversion: primaries={:?} transfer={:?} matrix={:?} full_range={}",
-        local_cicp.primaries,
-        local_cicp.transfer,
-        local_cicp.matrix,
-        local_cicp.full_range
+        "prepare_av1_u8: {width}x{height} has_real_alpha={has_real_alpha}"
     );
+    let (conversion, cicp) = strip_conversion(config);
+    let (planes, first_alpha) = convert_strips(
+        width,
+        height,
+        source,
+        &conversion,
+        has_real_alpha,
+        convert_strip_u8,
+    )?;
+
+    Ok(PreparedAv1Image {
+        planes: PreparedPlanes::Eight(PlanarImage {
+            width,
+            height,
+            planes,
+            bit_depth: BitDepth::Eight,
+        }),
+        cicp,
+        chroma: conversion.chroma,
+        has_alpha: has_real_alpha,
+        constant_alpha: first_alpha.into(),
+        lossless: conversion.lossless,
+    })
+}
+
+fn prepare_av1_u16_10_bit(
+    width: usize,
+    height: usize,
+    source: &mut dyn RgbaStrips<u16>,
+    config: &AvEncodingConfig,
+    has_real_alpha: bool,
+) -> Result<PreparedAv1Image, anyhow::Error> {
     dbg_log!(
         debug,
-        "yuv planes: y={} cb={} cr={} samples",
-        planar_image.y_plane.borrow().len(),
-        planar_image.u_plane.borrow().len(),
-        planar_image.v_plane.borrow().len()
+        "prepare_av1_u16_10_bit: {width}x{height} has_real_alpha={has_real_alpha}"
     );
+    let (conversion, cicp) = strip_conversion(config);
+    let (planes, first_alpha) = convert_strips(
+        width,
+        height,
+        source,
+        &conversion,
+        has_real_alpha,
+        convert_strip_u16,
+    )?;
+
+    Ok(PreparedAv1Image {
+        planes: PreparedPlanes::Ten(PlanarImage {
+            width,
+            height,
+            planes,
+            bit_depth: BitDepth::Ten,
+        }),
+        cicp,
+        chroma: conversion.chroma,
+        has_alpha: has_real_alpha,
+        constant_alpha: first_alpha,
+        lossless: conversion.lossless,
+    })
+}
 
-    let threads = available_parallelism()
-        .unwrap_or(NonZero::new(1).unwrap())
-        .get();
-    dbg_log!(debug, "encoder threads={threads}");
-
-    let mut config = maroontree::EncodeConfig::new()
-        .with_cicp(local_cicp)
-        .with_quality(quality as u8)
-        .with_threads(threads)
-        .with_chroma(chroma_subsampling)
-        .with_speed(config.speed.to_maroontree())
-        .with_screen_content(config.screen_content_coding)
-        .with_intrabc(config.screen_content_coding);
-
-    if let Some(exif) = exif {
-        dbg_log!(debug, "attaching exif: {} bytes", exif.len());
-        config = config.with_exif(exif.to_vec());
+/// Same as [crate::support::has_non_constant_alpha] for rows read in place,
+/// `alpha` picks the alpha bits out of a pixel of `N` bytes.
+fn view_has_varying_alpha<const N: usize, A: PartialEq>(
+    view: &BitmapView,
+    alpha: impl Fn(&[u8; N]) -> A,
+) -> bool {
+    if view.width == 0 || view.height == 0 {
+        return false;
     }
-
-    if has_real_alpha {
-        dbg_log!(debug, "encoding {:?} with alpha plane", chroma_subsampling);
-        let alpha = bitmap_data
-            .data
-            .as_chunks::<4>()
+    let first = alpha(&view.row(0).as_chunks::<N>().0[0]);
+    (0..view.height).any(|y| {
+        view.row(y)
+            .as_chunks::<N>()
             .0
             .iter()
-            .map(|x| x[3])
-            .collect::<Vec<_>>();
-        dbg_log!(debug, "alpha plane: {} samples", alpha.len());
-
-        let av1_planar_image = PlanarImage {
-            width: bitmap_data.width,
-            height: bitmap_data.height,
-            planes: [
-                planar_image.y_plane.borrow().to_vec(),
-                planar_image.u_plane.borrow().to_vec(),
-                planar_image.v_plane.borrow().to_vec(),
-                alpha,
-            ],
-            bit_depth: BitDepth::Eight,
-        };
-        let result = if lossless {
-            maroontree::encode_lossless_with_alpha(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_yuva8_with_alpha failed: {x}");
-                anyhow::anyhow!(x)
-            })?
-        } else {
-            maroontree::encode_yuva8_with_alpha(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_yuva8_with_alpha failed: {x}");
-                anyhow::anyhow!(x)
-            })?
-        };
-        dbg_log!(
-            debug,
-            "encoded {:?}+alpha: {} bytes",
-            chroma_subsampling,
-            result.len()
-        );
-        return Ok(result);
-    }
-
-    let av1_planar_image = PlanarImage {
-        width: bitmap_data.width,
-        height: bitmap_data.height,
-        planes: [
-            planar_image.y_plane.borrow().to_vec(),
-            planar_image.u_plane.borrow().to_vec(),
-            planar_image.v_plane.borrow().to_vec(),
-            vec![],
-        ],
-        bit_depth: BitDepth::Eight,
-    };
-    let result = if lossless {
-        maroontree::encode_lossless(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_yuv8 failed: {x}");
-            anyhow::anyhow!(x)
-        })?
-    } else {
-        maroontree::encode_yuv8(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_yuv8 failed: {x}");
-            anyhow::anyhow!(x)
-        })?
-    };
-    dbg_log!(
-        debug,
-        "encoded {:?}: {} bytes ({:.2} bpp)",
-        chroma_subsampling,
-        result.len(),
-        (result.len() * 8) as f64 / (bitmap_data.width * bitmap_data.height) as f64
-    );
-    Ok(result)
+            .any(|px| alpha(px) != first)
+    })
 }
 
-fn encode_av1_inner_u16_10_bit(
-    hd_plane: &[u16],
-    bitmap_data: &BitmapData,
+fn prepare_av1_inner(
+    view: &BitmapView,
     config: &AvEncodingConfig,
-    has_real_alpha: bool,
-) -> Result<Vec<u8>, anyhow::Error> {
-    let cicp = config.cicp;
-    let quality = config.quality;
-    let lossless = config.lossless;
-    let exif = config.exif.as_ref();
-    let requested_chroma_format = config.chroma;
-    if requested_chroma_format == ChromaFormat::Monochrome {
-        return encode_avif_inner_mono_u16(hd_plane, bitmap_data, config, has_real_alpha);
-    }
-    let chroma_format = if lossless {
-        if requested_chroma_format != ChromaFormat::Yuv444 {
-            dbg_log!(
-                warn,
-                "lossless AV1 RGB10 encode requires 4:4:4; overriding requested chroma={:?} to Yuv444",
-                requested_chroma_format
-            );
-        }
-        ChromaFormat::Yuv444
-    } else {
-        requested_chroma_format
-    };
-    dbg_log!(
-        debug,
-        "encode_heic_inner_u16_10_bit: {}x{} hd_pixels={} quality={} lossless={} \
-         chroma={:?} exif={}",
-        bitmap_data.width,
-        bitmap_data.height,
-        hd_plane.len(),
-        quality,
-        lossless,
-        chroma_format,
-        exif.map_or_else(|| "none".to_string(), |e| format!("{} bytes", e.len()))
-    );
-
-    let mut local_cicp = cicp;
+) -> Result<PreparedAv1Image, anyhow::Error> {
     dbg_log!(
         debug,
-        "cicp in: primaries={:?} transfer={:?} matrix={:?} full_range={}",
-        cicp.primaries,
-        cicp.transfer,
-        cicp.matrix,
-        cicp.full_range
+        "prepare_av1_inner: format={:?} chroma={:?}",
+        view.format,
+        config.chroma
     );
-    dbg_log!(debug, "has_real_alpha={has_real_alpha}");
-
-    if lossless && !local_cicp.full_range {
-        dbg_log!(
-            warn,
-            "lossless AV1 RGB10 encode requires full range; overriding CICP range to full"
-        );
-        local_cicp.full_range = true;
-    }
-
-    let yuv_range = match local_cicp.full_range {
-        true => YuvRange::Full,
-        false => YuvRange::Limited,
-    };
-    let yuv_matrix = match local_cicp.matrix {
-        MatrixCoefficients::Bt709 => YuvStandardMatrix::Bt709,
-        MatrixCoefficients::Unspecified => YuvStandardMatrix::Bt601,
-        MatrixCoefficients::Fcc => YuvStandardMatrix::Fcc,
-        MatrixCoefficients::Smpte170m => YuvStandardMatrix::Bt601,
-        MatrixCoefficients::Bt2020Ncl => YuvStandardMatrix::Bt2020,
-        _other => {
+    match view.format {
+        BitmapPixelFormat::Rgba8888 => {
+            let has_real_alpha = view_has_varying_alpha(view, |px: &[u8; 4]| px[3]);
+            prepare_av1_u8(
+                view.width,
+                view.height,
+                &mut Rgba8888Strips::new(view),
+                config,
+                has_real_alpha,
+            )
+        }
+        BitmapPixelFormat::Rgb565 => {
+            dbg_log!(debug, "prepare_av1_inner: unpacking Rgb565 strips");
+            prepare_av1_u8(
+                view.width,
+                view.height,
+                &mut Rgb565Strips::new(view)?,
+                config,
+                false,
+            )
+        }
+        BitmapPixelFormat::RgbaF16 => {
             dbg_log!(
-                warn,
-                "encode_heic_inner_u16_10_bit: unhandled matrix={:?} — falling back to Bt601",
-                _other
+                debug,
+                "prepare_av1_inner: unpacking RgbaF16 strips to RGBA10"
             );
-            YuvStandardMatrix::Bt601
+            // Halfs are compared by their bits, alpha sits in the last one
+            let has_real_alpha = view_has_varying_alpha(view, |px: &[u8; 8]| [px[6], px[7]]);
+            prepare_av1_u16_10_bit(
+                view.width,
+                view.height,
+                &mut F16Strips::new(view)?,
+                config,
+                has_real_alpha,
+            )
         }
-    };
-    dbg_log!(debug, "yuv_range={yuv_range:?} yuv_matrix={yuv_matrix:?}");
-
-    let mut planar_image = YuvPlanarImageMut::alloc(
-        bitmap_data.width as u32,
-        bitmap_data.height as u32,
-        match chroma_format {
-            ChromaFormat::Yuv420 => YuvChromaSubsampling::Yuv420,
-            ChromaFormat::Yuv422 => YuvChromaSubsampling::Yuv422,
-            ChromaFormat::Yuv444 => YuvChromaSubsampling::Yuv444,
-            ChromaFormat::Monochrome => unreachable!(),
-        },
-    );
-    dbg_log!(
-        debug,
-        "allocated 10-bit {:?} planes: {}x{} (y={} u={} v={} samples)",
-        chroma_format,
-        planar_image.width,
-        planar_image.height,
-        planar_image.y_plane.borrow().len(),
-        planar_image.u_plane.borrow().len(),
-        planar_image.v_plane.borrow().len(),
-    );
+        BitmapPixelFormat::Rgba1010102 => {
+            dbg_log!(debug, "prepare_av1_inner: unpacking AR30 strips to RGBA10");
+            // Little endian AR30 keeps its two alpha bits on top of the last byte
+            let has_real_alpha = view_has_varying_alpha(view, |px: &[u8; 4]| px[3] >> 6);
+            prepare_av1_u16_10_bit(
+                view.width,
+                view.height,
+                &mut Ar30Strips::new(view)?,
+                config,
+                has_real_alpha,
+            )
+        }
+        BitmapPixelFormat::A8 => {
+            dbg_log!(error, "prepare_av1_inner: A8 format is not supported");
+            Err(anyhow::anyhow!(WeaverError::PixelFormatIsNotSupported(
+                "BitmapPixelFormat::A8".to_string()
+            )))
+        }
+    }
+}
 
-    if !lossless {
-        dbg_log!(
-            debug,
-            "RGB10→YUV path: i010/i210/i410 balanced (lossy), chroma={:?}",
-            chroma_format
-        );
-        let f = match chroma_format {
-            ChromaFormat::Yuv420 => rgba10_to_i010,
-            ChromaFormat::Yuv422 => rgba10_to_i210,
-            ChromaFormat::Yuv444 => rgba10_to_i410,
-            ChromaFormat::Monochrome => unreachable!(),
-        };
-        f(
-            &mut planar_image,
-            hd_plane,
-            bitmap_data.width as u32 * 4,
-            yuv_range,
-            yuv_matrix,
-        )
-        .map_err(|x| {
-            dbg_log!(error, "rgba10_to_i{:?}_10bit failed: {x}", chroma_format);
-            anyhow::anyhow!(x)
-        })?;
-    } else {
-        dbg_log!(
-            debug,
-            "RGB10→YUV path: icgco010/210/410 (lossless), chroma={:?} — overriding matrix to YCgCo",
-            chroma_format
-        );
-        local_cicp.matrix = MatrixCoefficients::YCgCo;
-        let f = match chroma_format {
-            ChromaFormat::Yuv420 => rgba10_to_icgc010,
-            ChromaFormat::Yuv422 => rgba10_to_icgc210,
-            ChromaFormat::Yuv444 => rgba10_to_icgc410,
-            ChromaFormat::Monochrome => unreachable!(),
-        };
-        f(
-            &mut planar_image,
-            hd_plane,
-            bitmap_data.width as u32 * 4,
-            yuv_range,
-        )
-        .map_err(|x| {
-            dbg_log!(
-                error,
-                "rgba10_to_icgco{:?}_10bit failed: {x}",
-                chroma_format
-            );
-            anyhow::anyhow!(x)
-        })?;
+/// Same as [prepare_av1_inner] for tightly packed RGBA8888 held in memory.
+pub(crate) fn prepare_av1_packed_u8(
+    data: &[u8],
+    width: usize,
+    height: usize,
+    config: &AvEncodingConfig,
+    has_real_alpha: bool,
+) -> Result<PreparedAv1Image, anyhow::Error> {
+    let mut source = PackedRgbaStrips::new(data, width, 0);
+    prepare_av1_u8(width, height, &mut source, config, has_real_alpha)
+}
+
+/// Same as [prepare_av1_inner] for tightly packed RGBA of `bit_depth` bits
+/// held in memory, deeper samples are narrowed to 10 bits.
+pub(crate) fn prepare_av1_packed_u16(
+    data: &[u16],
+    width: usize,
+    height: usize,
+    bit_depth: u32,
+    config: &AvEncodingConfig,
+    has_real_alpha: bool,
+) -> Result<PreparedAv1Image, anyhow::Error> {
+    let mut source = PackedRgbaStrips::new(data, width, bit_depth.saturating_sub(10));
+    prepare_av1_u16_10_bit(width, height, &mut source, config, has_real_alpha)
+}
+
+fn encode_failed<E: std::fmt::Display>(_stage: &'static str) -> impl FnOnce(E) -> anyhow::Error {
+    move |x| {
+        dbg_log!(error, "{_stage} failed: {x}");
+        anyhow::anyhow!("{x}")
     }
+}
 
+/// Encodes planes produced by [prepare_av1_inner]; quality, speed, screen content
+/// and exif come from `config`, its colour settings are already baked into `prepared`.
+fn encode_prepared_av1(
+    prepared: &PreparedAv1Image,
+    config: &AvEncodingConfig,
+    threads: usize,
+) -> Result<Vec<u8>, anyhow::Error> {
+    let threads = threads.max(1);
     dbg_log!(
         debug,
-        "cicp after conversion: primaries={:?} transfer={:?} matrix={:?} full_range={}",
-        local_cicp.primaries,
-        local_cicp.transfer,
-        local_cicp.matrix,
-        local_cicp.full_range
-    );
-    dbg_log!(
-        debug,
-        "10-bit yuv planes: y={} cb={} cr={} samples",
-        planar_image.y_plane.borrow().len(),
-        planar_image.u_plane.borrow().len(),
-        planar_image.v_plane.borrow().len()
+        "encode_prepared_av1: quality={} chroma={:?} alpha={} lossless={} threads={threads}",
+        config.quality,
+        prepared.chroma,
+        prepared.has_alpha,
+        prepared.lossless
     );
 
-    let threads = available_parallelism()
-        .unwrap_or(NonZero::new(1).unwrap())
-        .get();
-    dbg_log!(debug, "encoder threads={threads}");
-
-    let mut config = maroontree::EncodeConfig::new()
-        .with_cicp(local_cicp)
-        .with_quality(quality as u8)
+    let mut encode_config = maroontree::EncodeConfig::new()
+        .with_cicp(prepared.cicp)
+        .with_quality(config.quality as u8)
         .with_threads(threads)
-        .with_chroma(chroma_format)
+        .with_chroma(prepared.chroma)
         .with_speed(config.speed.to_maroontree())
         .with_screen_content(config.screen_content_coding)
         .with_intrabc(config.screen_content_coding);
 
-    if let Some(exif) = exif {
+    if let Some(exif) = config.exif.as_ref() {
         dbg_log!(debug, "attaching exif: {} bytes", exif.len());
-        config = config.with_exif(exif.to_vec());
-    }
-
-    if has_real_alpha {
-        dbg_log!(
-            debug,
-            "encoding 10-bit {:?} with alpha plane",
-            chroma_format
-        );
-        let alpha = hd_plane
-            .as_chunks::<4>()
-            .0
-            .iter()
-            .map(|x| x[3])
-            .collect::<Vec<_>>();
-        dbg_log!(debug, "alpha plane: {} samples", alpha.len());
-
-        let av1_planar_image = PlanarImage {
-            width: bitmap_data.width,
-            height: bitmap_data.height,
-            planes: [
-                planar_image.y_plane.borrow().to_vec(),
-                planar_image.u_plane.borrow().to_vec(),
-                planar_image.v_plane.borrow().to_vec(),
-                alpha,
-            ],
-            bit_depth: BitDepth::Ten,
-        };
-        let result = if lossless {
-            maroontree::encode_lossless_with_alpha(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_yuva10_with_alpha failed: {x}");
-                anyhow::anyhow!(x)
-            })?
-        } else {
-            maroontree::encode_yuva10_with_alpha(&av1_planar_image, &config).map_err(|x| {
-                dbg_log!(error, "encode_yuva10_with_alpha failed: {x}");
-                anyhow::anyhow!(x)
-            })?
-        };
-        dbg_log!(
-            debug,
-            "encoded 10-bit {:?}+alpha: {} bytes",
-            chroma_format,
-            result.len()
-        );
-        return Ok(result);
+        encode_config = encode_config.with_exif(exif.to_vec());
     }
 
-    let av1_planar_image = PlanarImage {
-        width: bitmap_data.width,
-        height: bitmap_data.height,
-        planes: [
-            planar_image.y_plane.borrow().to_vec(),
-            planar_image.u_plane.borrow().to_vec(),
-            planar_image.v_plane.borrow().to_vec(),
-            vec![],
-        ],
-        bit_depth: BitDepth::Ten,
-    };
-    let result = if lossless {
-        maroontree::encode_lossless(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_yuv10 failed: {x}");
-            anyhow::anyhow!(x)
-        })?
-    } else {
-        maroontree::encode_yuv10(&av1_planar_image, &config).map_err(|x| {
-            dbg_log!(error, "encode_yuv10 failed: {x}");
-            anyhow::anyhow!(x)
-        })?
+    let monochrome = prepared.chroma == ChromaFormat::Monochrome;
+    let result = match &prepared.planes {
+        PreparedPlanes::Eight(image) => match (monochrome, prepared.has_alpha, prepared.lossless) {
+            (true, true, true) => maroontree::encode_lossless_gray_alpha(image, &encode_config)
+                .map_err(encode_failed("encode_lossless_gray_alpha"))?,
+            (true, true, false) => maroontree::encode_gray_alpha8(image, &encode_config)
+                .map_err(encode_failed("encode_gray_alpha8"))?,
+            (true, false, true) => maroontree::encode_lossless_gray(image, &encode_config)
+                .map_err(encode_failed("encode_lossless_gray"))?,
+            (true, false, false) => maroontree::encode_gray8(image, &encode_config)
+                .map_err(encode_failed("encode_gray8"))?,
+            (false, true, true) => maroontree::encode_lossless_with_alpha(image, &encode_config)
+                .map_err(encode_failed("encode_lossless_with_alpha"))?,
+            (false, true, false) => maroontree::encode_yuva8_with_alpha(image, &encode_config)
+                .map_err(encode_failed("encode_yuva8_with_alpha"))?,
+            (false, false, true) => maroontree::encode_lossless(image, &encode_config)
+                .map_err(encode_failed("encode_lossless"))?,
+            (false, false, false) => maroontree::encode_yuv8(image, &encode_config)
+                .map_err(encode_failed("encode_yuv8"))?,
+        },
+        PreparedPlanes::Ten(image) => match (monochrome, prepared.has_alpha, prepared.lossless) {
+            (true, true, true) => maroontree::encode_lossless_gray_alpha(image, &encode_config)
+                .map_err(encode_failed("encode_lossless_gray_alpha"))?,
+            (true, true, false) => maroontree::encode_gray_alpha10(image, &encode_config)
+                .map_err(encode_failed("encode_gray_alpha10"))?,
+            (true, false, true) => maroontree::encode_lossless_gray(image, &encode_config)
+                .map_err(encode_failed("encode_lossless_gray"))?,
+            (true, false, false) => maroontree::encode_gray10(image, &encode_config)
+                .map_err(encode_failed("encode_gray10"))?,
+            (false, true, true) => maroontree::encode_lossless_with_alpha(image, &encode_config)
+                .map_err(encode_failed("encode_lossless_with_alpha"))?,
+            (false, true, false) => maroontree::encode_yuva10_with_alpha(image, &encode_config)
+                .map_err(encode_failed("encode_yuva10_with_alpha"))?,
+            (false, false, true) => maroontree::encode_lossless(image, &encode_config)
+                .map_err(encode_failed("encode_lossless"))?,
+            (false, false, false) => maroontree::encode_yuv10(image, &encode_config)
+                .map_err(encode_failed("encode_yuv10"))?,
+        },
     };
     dbg_log!(
         debug,
-        "encoded 10-bit {:?}: {} bytes ({:.2} bpp)",
-        chroma_format,
+        "encoded {:?}: {} bytes ({:.2} bpp)",
+        prepared.chroma,
         result.len(),
-        (result.len() * 8) as f64 / (bitmap_data.width * bitmap_data.height) as f64
+        (result.len() * 8) as f64 / prepared.pixels().max(1) as f64
     );
     Ok(result)
 }
 
 fn encode_av1_inner(
-    bitmap_data: &mut BitmapData,
+    prepared: &PreparedAv1Image,
     config: &AvEncodingConfig,
 ) -> Result<Vec<u8>, anyhow::Error> {
-    let _chroma_subsampling = config.chroma;
-    dbg_log!(
-        debug,
-        "encode_av1_inner: format={:?} chroma={:?}",
-        bitmap_data.format,
-        _chroma_subsampling
-    );
-    match bitmap_data.format {
-        BitmapPixelFormat::Rgba8888 => {
-            let has_real_alpha =
-                has_non_constant_alpha::<u8, u32, 3, 4>(&bitmap_data.data, bitmap_data.width);
-            encode_av1_inner_u8(bitmap_data, config, has_real_alpha)
-        }
-        BitmapPixelFormat::Rgb565 => {
-            dbg_log!(
-                debug,
-                "encode_av1_inner: converting Rgb565 → Rgba8888 before encode"
-            );
-            let rgba8888 = rgb565_bytes_to_rgba8888(&bitmap_data.data);
-            bitmap_data.data = rgba8888;
-            encode_av1_inner_u8(bitmap_data, config, false)
-        }
-        BitmapPixelFormat::RgbaF16 => {
-            dbg_log!(
-                debug,
-                "encode_av1_inner: converting RgbaF16 → RGBA10 before encode"
-            );
-            let hd_plane =
-                f16_bytes_to_rgba10(&bitmap_data.data, bitmap_data.width, bitmap_data.height)?;
-            encode_av1_inner_u16_10_bit(&hd_plane, bitmap_data, config, false)
-        }
-        BitmapPixelFormat::Rgba1010102 => {
-            dbg_log!(
-                debug,
-                "encode_av1_inner: unpacking AR30 → RGBA10 before encode"
-            );
-            let hd_plane = ar30_bytes_to_rgba10(&bitmap_data.data);
-            encode_av1_inner_u16_10_bit(&hd_plane, bitmap_data, config, false)
-        }
-        BitmapPixelFormat::A8 => {
-            dbg_log!(error, "encode_av1_inner: A8 format is not supported");
-            Err(anyhow::anyhow!(WeaverError::PixelFormatIsNotSupported(
-                "BitmapPixelFormat::A8".to_string()
-            )))
-        }
-    }
+    let threads = available_parallelism()
+        .unwrap_or(NonZero::new(1).unwrap())
+        .get();
+    encode_prepared_av1(prepared, config, threads)
 }
 
 #[derive(Debug, Clone)]
@@ -1131,6 +1061,16 @@ impl AvEncodingSpeed {
     }
 }
 
+fn chroma_format_from_code(code: i32) -> ChromaFormat {
+    match code {
+        2 => ChromaFormat::Yuv422,
+        3 => ChromaFormat::Yuv444,
+        4 => ChromaFormat::Monochrome,
+        _ => ChromaFormat::Yuv420,
+    }
+}
+
+#[cfg(target_os = "android")]
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn encode_avif_av1_file(
     env: *mut jni::sys::JNIEnv,
@@ -1140,12 +1080,7 @@ pub unsafe extern "C" fn encode_avif_av1_file(
 ) -> jbyteArray {
     init_logging();
 
-    let chroma_subsampling = match options.chroma_subsampling_code {
-        2 => ChromaFormat::Yuv422,
-        3 => ChromaFormat::Yuv444,
-        4 => ChromaFormat::Monochrome,
-        _ => ChromaFormat::Yuv420,
-    };
+    let chroma_subsampling = chroma_format_from_code(options.chroma_subsampling_code);
 
     dbg_log!(
         debug,
@@ -1182,21 +1117,6 @@ pub unsafe extern "C" fn encode_avif_av1_file(
                 cicp.full_range
             );
 
-            let mut bitmap_data = unsafe {
-                get_bitmap_data(env, image).map_err(|x| {
-                    dbg_log!(error, "get_bitmap_data failed: {x}");
-                    anyhow::anyhow!(x)
-                })?
-            };
-            dbg_log!(
-                debug,
-                "bitmap: {}x{} format={:?} data={} bytes",
-                bitmap_data.width,
-                bitmap_data.height,
-                bitmap_data.format,
-                bitmap_data.data.len()
-            );
-
             let exif_data = optional_bytebuffer_to_vec(env, exif).map_err(|x| {
                 dbg_log!(error, "optional_bytebuffer_to_vec failed: {x}");
                 anyhow::anyhow!(x)
@@ -1209,19 +1129,40 @@ pub unsafe extern "C" fn encode_avif_av1_file(
                     .map_or_else(|| "none".to_string(), |e| format!("{} bytes", e.len()))
             );
 
-            let encoded_data = encode_av1_inner(
-                &mut bitmap_data,
-                &AvEncodingConfig {
-                    cicp,
-                    quality,
-                    lossless: options.lossless,
-                    exif: exif_data.map(|x| x.to_vec()),
-                    chroma: chroma_subsampling,
-                    speed: options.speed,
-                    screen_content_coding: options.screen_content_coding,
-                },
-            )
-            .map_err(|x| {
+            let config = AvEncodingConfig {
+                cicp,
+                quality,
+                lossless: options.lossless,
+                exif: exif_data.map(|x| x.to_vec()),
+                chroma: chroma_subsampling,
+                speed: options.speed,
+                screen_content_coding: options.screen_content_coding,
+            };
+
+            // Pixels stay locked only while they are converted to YUV
+            let prepared = {
+                let locked = unsafe {
+                    LockedBitmap::lock(env, image).map_err(|x| {
+                        dbg_log!(error, "LockedBitmap::lock failed: {x}");
+                        anyhow::anyhow!(x)
+                    })?
+                };
+                let view = locked.view().map_err(|x| {
+                    dbg_log!(error, "LockedBitmap::view failed: {x}");
+                    anyhow::anyhow!(x)
+                })?;
+                dbg_log!(
+                    debug,
+                    "bitmap: {}x{} format={:?} stride={}",
+                    view.width,
+                    view.height,
+                    view.format,
+                    view.stride
+                );
+                prepare_av1_inner(&view, &config)?
+            };
+
+            let encoded_data = encode_av1_inner(&prepared, &config).map_err(|x| {
                 dbg_log!(error, "encode_av1_inner failed: {x:#}");
                 x
             })?;
@@ -1275,3 +1216,522 @@ pub unsafe extern "C" fn encode_avif_av1_file(
         }
     }
 }
+
+/// JNI free counterpart of [encode_avif_av1_file] encoding a caller owned
+/// pixel buffer. Errors and panics are reported in [EncodedImage::error].
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn encode_avif_av1_buffer(
+    image: WeaveImageBuffer,
+    exif: *const u8,
+    exif_length: usize,
+    options: AvifEncodingOptions,
+) -> EncodedImage {
+    init_logging();
+
+    let result = std::panic::catch_unwind(|| -> Result<Vec<u8>, anyhow::Error> {
+        let view = unsafe {
+            view_image_buffer(&image).map_err(|x| {
+                dbg_log!(error, "view_image_buffer failed: {x}");
+                anyhow::anyhow!(x)
+            })?
+        };
+        dbg_log!(
+            debug,
+            "encode_avif_av1_buffer: {}x{} format={:?}",
+            view.width,
+            view.height,
+            view.format
+        );
+
+        let exif_data = if exif.is_null() || exif_length == 0 {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(exif, exif_length) }.to_vec())
+        };
+
+        let config = AvEncodingConfig {
+            cicp: resolve_cicp_maroontree(options.color_space),
+            quality: options.quality.clamp(1, 100) as u32,
+            lossless: options.lossless,
+            exif: exif_data,
+            chroma: chroma_format_from_code(options.chroma_subsampling_code),
+            speed: options.speed,
+            screen_content_coding: options.screen_content_coding,
+        };
+        let prepared = prepare_av1_inner(&view, &config)?;
+        encode_av1_inner(&prepared, &config)
+    });
+
+    match result {
+        Ok(Ok(encoded)) => EncodedImage::from_vec(encoded),
+        Ok(Err(e)) => {
+            dbg_log!(error, "encode_avif_av1_buffer failed: {e:#}");
+            EncodedImage::from_error(format!("AVIF/AV1 encoding failed: {e:#}"))
+        }
+        Err(p) => EncodedImage::from_error(format!(
+            "panic while encoding AVIF/AV1: {}",
+            panic_payload_to_string(p.as_ref())
+        )),
+    }
+}
+
+/// Converts a caller owned pixel buffer into AV1 planes without encoding them.
+/// Only the colour settings of `options` are used here: colour space, chroma
+/// subsampling and lossless. The pixels may be released once this returns.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_prepare(
+    image: WeaveImageBuffer,
+    options: AvifEncodingOptions,
+) -> WeaveAv1PrepareResult {
+    init_logging();
+
+    let result = std::panic::catch_unwind(|| -> Result<PreparedAv1Image, anyhow::Error> {
+        let view = unsafe {
+            view_image_buffer(&image).map_err(|x| {
+                dbg_log!(error, "view_image_buffer failed: {x}");
+                anyhow::anyhow!(x)
+            })?
+        };
+        prepare_av1_inner(
+            &view,
+            &AvEncodingConfig {
+                cicp: resolve_cicp_maroontree(options.color_space),
+                quality: options.quality.clamp(1, 100) as u32,
+                lossless: options.lossless,
+                exif: None,
+                chroma: chroma_format_from_code(options.chroma_subsampling_code),
+                speed: options.speed,
+                screen_content_coding: options.screen_content_coding,
+            },
+        )
+    });
+
+    match result {
+        Ok(Ok(image)) => WeaveAv1PrepareResult::from_prepared(WeaveAv1Prepared { image }),
+        Ok(Err(e)) => {
+            dbg_log!(error, "weave_av1_prepare failed: {e:#}");
+            WeaveAv1PrepareResult::from_error(format!("AVIF/AV1 encoding failed: {e:#}"))
+        }
+        Err(p) => WeaveAv1PrepareResult::from_error(format!(
+            "panic while encoding AVIF/AV1: {}",
+            panic_payload_to_string(p.as_ref())
+        )),
+    }
+}
+
+/// Encodes planes from [weave_av1_prepare] with `threads` encoder threads, 0 uses
+/// every core. Quality, speed and screen content come from `options`, its colour
+/// settings are ignored. `prepared` stays owned by the caller and may be encoded again.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_encode_prepared(
+    prepared: *const WeaveAv1Prepared,
+    exif: *const u8,
+    exif_length: usize,
+    options: AvifEncodingOptions,
+    threads: u32,
+) -> EncodedImage {
+    init_logging();
+
+    if prepared.is_null() {
+        return EncodedImage::from_error("AVIF/AV1 encoding failed: prepared image is null");
+    }
+    let prepared = unsafe { &*prepared };
+
+    let result = std::panic::catch_unwind(|| -> Result<Vec<u8>, anyhow::Error> {
+        let exif_data = if exif.is_null() || exif_length == 0 {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(exif, exif_length) }.to_vec())
+        };
+        let threads = if threads == 0 {
+            available_parallelism()
+                .unwrap_or(NonZero::new(1).unwrap())
+                .get()
+        } else {
+            threads as usize
+        };
+        encode_prepared_av1(
+            &prepared.image,
+            &AvEncodingConfig {
+                cicp: prepared.image.cicp,
+                quality: options.quality.clamp(1, 100) as u32,
+                lossless: prepared.image.lossless,
+                exif: exif_data,
+                chroma: prepared.image.chroma,
+                speed: options.speed,
+                screen_content_coding: options.screen_content_coding,
+            },
+            threads,
+        )
+    });
+
+    match result {
+        Ok(Ok(encoded)) => EncodedImage::from_vec(encoded),
+        Ok(Err(e)) => {
+            dbg_log!(error, "weave_av1_encode_prepared failed: {e:#}");
+            EncodedImage::from_error(format!("AVIF/AV1 encoding failed: {e:#}"))
+        }
+        Err(p) => EncodedImage::from_error(format!(
+            "panic while encoding AVIF/AV1: {}",
+            panic_payload_to_string(p.as_ref())
+        )),
+    }
+}
+
+/// Describes the planes held by `prepared` without copying them, alpha is null
+/// when the image is opaque. Pointers stay valid until the prepared image is
+/// released, strides are in bytes.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_prepared_planes(
+    prepared: *const WeaveAv1Prepared,
+) -> WeaveYuvImage {
+    let mut image = WeaveYuvImage {
+        y: std::ptr::null(),
+        y_stride: 0,
+        u: std::ptr::null(),
+        u_stride: 0,
+        v: std::ptr::null(),
+        v_stride: 0,
+        a: std::ptr::null(),
+        a_stride: 0,
+        width: 0,
+        height: 0,
+        bit_depth: 0,
+        chroma_subsampling_code: 0,
+        color_primaries: 2,
+        transfer_characteristics: 2,
+        matrix_coefficients: 2,
+        full_range: false,
+        chroma_pixel_stride: 1,
+        msb_aligned: false,
+    };
+    if prepared.is_null() {
+        return image;
+    }
+    let prepared = unsafe { &(*prepared).image };
+
+    let (primaries, transfer, matrix) = cicp_codes(&prepared.cicp);
+    image.color_primaries = primaries;
+    image.transfer_characteristics = transfer;
+    image.matrix_coefficients = matrix;
+    image.full_range = prepared.cicp.full_range;
+    image.chroma_subsampling_code = match prepared.chroma {
+        ChromaFormat::Yuv422 => 2,
+        ChromaFormat::Yuv444 => 3,
+        ChromaFormat::Monochrome => 4,
+        _ => 1,
+    };
+
+    macro_rules! describe {
+        ($planar:expr, $sample_size:expr, $depth:expr) => {{
+            let planar = $planar;
+            let chroma_width = match prepared.chroma {
+                ChromaFormat::Yuv420 | ChromaFormat::Yuv422 => planar.width.div_ceil(2),
+                _ => planar.width,
+            };
+            image.width = planar.width as u32;
+            image.height = planar.height as u32;
+            image.bit_depth = $depth;
+            image.y = planar.planes[0].as_ptr() as *const u8;
+            image.y_stride = (planar.width * $sample_size) as u32;
+            // Monochrome images keep alpha right after luma
+            let alpha_index = if prepared.chroma == ChromaFormat::Monochrome {
+                1
+            } else {
+                image.u = planar.planes[1].as_ptr() as *const u8;
+                image.u_stride = (chroma_width * $sample_size) as u32;
+                image.v = planar.planes[2].as_ptr() as *const u8;
+                image.v_stride = (chroma_width * $sample_size) as u32;
+                3
+            };
+            if prepared.has_alpha && !planar.planes[alpha_index].is_empty() {
+                image.a = planar.planes[alpha_index].as_ptr() as *const u8;
+                image.a_stride = (planar.width * $sample_size) as u32;
+            }
+        }};
+    }
+
+    match &prepared.planes {
+        PreparedPlanes::Eight(planar) => describe!(planar, 1, 8),
+        PreparedPlanes::Ten(planar) => describe!(planar, 2, 10),
+    }
+    image
+}
+
+/// Alpha sample every pixel of `prepared` has at its bit depth when
+/// [weave_av1_prepared_planes] reports no alpha plane.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_prepared_constant_alpha(
+    prepared: *const WeaveAv1Prepared,
+) -> u16 {
+    if prepared.is_null() {
+        return 255;
+    }
+    unsafe { (*prepared).image.constant_alpha }
+}
+
+pub(crate) fn cicp_codes(cicp: &Cicp) -> (u16, u16, u16) {
+    let primaries = match cicp.primaries {
+        Primaries::Bt709 => 1,
+        Primaries::Bt601 => 6,
+        Primaries::Bt2020 => 9,
+        Primaries::Smpte431 => 11,
+        Primaries::Smpte432 => 12,
+        _ => 2,
+    };
+    let transfer = match cicp.transfer {
+        TransferFunction::Bt709 => 1,
+        TransferFunction::Bt601 => 6,
+        TransferFunction::Linear => 8,
+        TransferFunction::Srgb => 13,
+        TransferFunction::Bt202010bit => 14,
+        TransferFunction::Smpte2084 => 16,
+        TransferFunction::Smpte428 => 17,
+        TransferFunction::Hlg => 18,
+        _ => 2,
+    };
+    let matrix = match cicp.matrix {
+        MatrixCoefficients::Bt709 => 1,
+        MatrixCoefficients::Fcc => 4,
+        MatrixCoefficients::Smpte170m => 6,
+        MatrixCoefficients::YCgCo => 8,
+        MatrixCoefficients::Bt2020Ncl => 9,
+        _ => 2,
+    };
+    (primaries, transfer, matrix)
+}
+
+pub(crate) fn cicp_from_codes(
+    primaries: u16,
+    transfer: u16,
+    matrix: u16,
+    full_range: bool,
+) -> Cicp {
+    let mut cicp = Cicp::unspecified();
+    cicp.primaries = match primaries {
+        1 => Primaries::Bt709,
+        5 | 6 => Primaries::Bt601,
+        9 => Primaries::Bt2020,
+        11 => Primaries::Smpte431,
+        12 => Primaries::Smpte432,
+        _ => cicp.primaries,
+    };
+    cicp.transfer = match transfer {
+        1 => TransferFunction::Bt709,
+        6 => TransferFunction::Bt601,
+        8 => TransferFunction::Linear,
+        13 => TransferFunction::Srgb,
+        14 => TransferFunction::Bt202010bit,
+        16 => TransferFunction::Smpte2084,
+        17 => TransferFunction::Smpte428,
+        18 => TransferFunction::Hlg,
+        _ => cicp.transfer,
+    };
+    cicp.matrix = match matrix {
+        1 => MatrixCoefficients::Bt709,
+        4 => MatrixCoefficients::Fcc,
+        5 | 6 => MatrixCoefficients::Smpte170m,
+        8 => MatrixCoefficients::YCgCo,
+        9 => MatrixCoefficients::Bt2020Ncl,
+        _ => cicp.matrix,
+    };
+    cicp.full_range = full_range;
+    cicp
+}
+
+/// Copies `height` rows of `width` samples out of a strided caller plane,
+/// taking every `pixel_stride`-th sample of a row.
+pub(crate) unsafe fn read_yuv_plane<T: Copy>(
+    data: *const u8,
+    stride: u32,
+    pixel_stride: usize,
+    width: usize,
+    height: usize,
+    from_bytes: impl Fn(&[u8]) -> T,
+) -> Result<Vec<T>, anyhow::Error> {
+    if data.is_null() {
+        return Err(anyhow::anyhow!("YUV plane is null"));
+    }
+    let sample_size = size_of::<T>();
+    let pixel_stride = pixel_stride.max(1);
+    let step = pixel_stride * sample_size;
+    let row_bytes = width
+        .checked_sub(1)
+        .and_then(|x| x.checked_mul(step))
+        .and_then(|x| x.checked_add(sample_size))
+        .ok_or_else(|| anyhow::anyhow!("YUV plane is too big"))?;
+    if (stride as usize) < row_bytes {
+        return Err(anyhow::anyhow!("YUV plane stride {stride} is too small"));
+    }
+    let mut plane = Vec::with_capacity(width * height);
+    for y in 0..height {
+        // SAFETY: caller guarantees `height` rows of `stride` bytes, rows of u16
+        // samples may be unaligned so they are read bytewise.
+        let row = unsafe { std::slice::from_raw_parts(data.add(y * stride as usize), row_bytes) };
+        if pixel_stride == 1 {
+            plane.extend(row.chunks_exact(sample_size).map(&from_bytes));
+        } else {
+            plane.extend((0..width).map(|x| from_bytes(&row[x * step..x * step + sample_size])));
+        }
+    }
+    Ok(plane)
+}
+
+unsafe fn prepare_yuv_image(
+    image: &WeaveYuvImage,
+    lossless: bool,
+) -> Result<PreparedAv1Image, anyhow::Error> {
+    let width = image.width as usize;
+    let height = image.height as usize;
+    if width == 0 || height == 0 {
+        return Err(anyhow::anyhow!("YUV image has no pixels"));
+    }
+    let chroma = chroma_format_from_code(image.chroma_subsampling_code);
+    let (chroma_width, chroma_height) = match chroma {
+        ChromaFormat::Yuv420 => (width.div_ceil(2), height.div_ceil(2)),
+        ChromaFormat::Yuv422 => (width.div_ceil(2), height),
+        ChromaFormat::Yuv444 => (width, height),
+        ChromaFormat::Monochrome => (0, 0),
+    };
+    let has_alpha = !image.a.is_null();
+    let shift = if image.msb_aligned {
+        16u32.saturating_sub(image.bit_depth)
+    } else {
+        0
+    };
+
+    macro_rules! read_planes {
+        ($from_bytes:expr) => {{
+            let y =
+                unsafe { read_yuv_plane(image.y, image.y_stride, 1, width, height, $from_bytes)? };
+            let a = if has_alpha {
+                unsafe { read_yuv_plane(image.a, image.a_stride, 1, width, height, $from_bytes)? }
+            } else {
+                vec![]
+            };
+            if chroma == ChromaFormat::Monochrome {
+                [y, a, vec![], vec![]]
+            } else {
+                let u = unsafe {
+                    read_yuv_plane(
+                        image.u,
+                        image.u_stride,
+                        image.chroma_pixel_stride as usize,
+                        chroma_width,
+                        chroma_height,
+                        $from_bytes,
+                    )?
+                };
+                let v = unsafe {
+                    read_yuv_plane(
+                        image.v,
+                        image.v_stride,
+                        image.chroma_pixel_stride as usize,
+                        chroma_width,
+                        chroma_height,
+                        $from_bytes,
+                    )?
+                };
+                [y, u, v, a]
+            }
+        }};
+    }
+
+    let planes = match image.bit_depth {
+        8 => PreparedPlanes::Eight(PlanarImage {
+            width,
+            height,
+            planes: read_planes!(|x: &[u8]| x[0]),
+            bit_depth: BitDepth::Eight,
+        }),
+        10 => PreparedPlanes::Ten(PlanarImage {
+            width,
+            height,
+            planes: read_planes!(|x: &[u8]| u16::from_ne_bytes([x[0], x[1]]) >> shift),
+            bit_depth: BitDepth::Ten,
+        }),
+        depth => {
+            return Err(anyhow::anyhow!(
+                "YUV bit depth {depth} is not supported, expected 8 or 10"
+            ));
+        }
+    };
+
+    Ok(PreparedAv1Image {
+        constant_alpha: planes.opaque_alpha(),
+        planes,
+        cicp: cicp_from_codes(
+            image.color_primaries,
+            image.transfer_characteristics,
+            image.matrix_coefficients,
+            image.full_range,
+        ),
+        chroma,
+        has_alpha,
+        lossless,
+    })
+}
+
+/// Encodes caller owned YUV planes as is, no colour conversion happens. Quality,
+/// speed, lossless and screen content come from `options`, colour space and chroma
+/// subsampling are described by `image`. `threads` 0 uses every core.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_encode_yuv(
+    image: WeaveYuvImage,
+    exif: *const u8,
+    exif_length: usize,
+    options: AvifEncodingOptions,
+    threads: u32,
+) -> EncodedImage {
+    init_logging();
+
+    let result = std::panic::catch_unwind(|| -> Result<Vec<u8>, anyhow::Error> {
+        let prepared = unsafe { prepare_yuv_image(&image, options.lossless)? };
+        dbg_log!(
+            debug,
+            "weave_av1_encode_yuv: {}x{} depth={} chroma={:?} alpha={}",
+            image.width,
+            image.height,
+            image.bit_depth,
+            prepared.chroma,
+            prepared.has_alpha
+        );
+        let exif_data = if exif.is_null() || exif_length == 0 {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(exif, exif_length) }.to_vec())
+        };
+        let threads = if threads == 0 {
+            available_parallelism()
+                .unwrap_or(NonZero::new(1).unwrap())
+                .get()
+        } else {
+            threads as usize
+        };
+        encode_prepared_av1(
+            &prepared,
+            &AvEncodingConfig {
+                cicp: prepared.cicp,
+                quality: options.quality.clamp(1, 100) as u32,
+                lossless: options.lossless,
+                exif: exif_data,
+                chroma: prepared.chroma,
+                speed: options.speed,
+                screen_content_coding: options.screen_content_coding,
+            },
+            threads,
+        )
+    });
+
+    match result {
+        Ok(Ok(encoded)) => EncodedImage::from_vec(encoded),
+        Ok(Err(e)) => {
+            dbg_log!(error, "weave_av1_encode_yuv failed: {e:#}");
+            EncodedImage::from_error(format!("AVIF/AV1 encoding failed: {e:#}"))
+        }
+        Err(p) => EncodedImage::from_error(format!(
+            "panic while encoding AVIF/AV1: {}",
+            panic_payload_to_string(p.as_ref())
+        )),
+    }
+}
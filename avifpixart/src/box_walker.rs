@@ -159,6 +159,226 @@ fn walk_boxes(data: &[u8], depth: u8) -> ImageContainer {
     ImageContainer::Unknown
 }
 
+/// Reads a `size` byte big endian field at `*pos`, 0 sized fields read as 0.
+fn read_be(data: &[u8], pos: &mut usize, size: usize) -> Option<u64> {
+    if size > 8 {
+        return None;
+    }
+    let bytes = data.get(*pos..pos.checked_add(size)?)?;
+    *pos += size;
+    Some(bytes.iter().fold(0u64, |acc, &b| (acc << 8) | b as u64))
+}
+
+/// Item id of the first `Exif` item listed in an `iinf` payload.
+fn exif_item_id(iinf: &[u8]) -> Option<u32> {
+    let version = *iinf.first()?;
+    let mut pos = if version == 0 { 6 } else { 8 };
+    while pos < iinf.len() {
+        let (b, consumed) = parse_box(&iinf[pos..])?;
+        pos += consumed;
+        if &b.kind != b"infe" || b.payload.is_empty() {
+            continue;
+        }
+        // Versions before 2 have no item type
+        let mut p = 4;
+        let id = match b.payload[0] {
+            2 => read_be(b.payload, &mut p, 2)?,
+            3 => read_be(b.payload, &mut p, 4)?,
+            _ => continue,
+        };
+        p += 2; // item_protection_index
+        if b.payload.get(p..p + 4) == Some(b"Exif".as_slice()) {
+            return Some(id as u32);
+        }
+    }
+    None
+}
+
+/// Extents of `item_id` from an `iloc` payload as absolute file ranges,
+/// `None` unless the item is stored in the file itself.
+fn item_extents(iloc: &[u8], item_id: u32) -> Option<Vec<(u64, u64)>> {
+    let version = *iloc.first()?;
+    let mut pos = 4;
+    let sizes = read_be(iloc, &mut pos, 1)? as usize;
+    let (offset_size, length_size) = (sizes >> 4, sizes & 0xF);
+    let sizes = read_be(iloc, &mut pos, 1)? as usize;
+    let base_offset_size = sizes >> 4;
+    let index_size = if version == 1 || version == 2 {
+        sizes & 0xF
+    } else {
+        0
+    };
+    let id_size = if version < 2 { 2 } else { 4 };
+    let item_count = read_be(iloc, &mut pos, id_size)?;
+    for _ in 0..item_count {
+        let id = read_be(iloc, &mut pos, id_size)? as u32;
+        let construction_method = if version == 1 || version == 2 {
+            read_be(iloc, &mut pos, 2)? & 0xF
+        } else {
+            0
+        };
+        read_be(iloc, &mut pos, 2)?; // data_reference_index
+        let base_offset = read_be(iloc, &mut pos, base_offset_size)?;
+        let extent_count = read_be(iloc, &mut pos, 2)?;
+        let mut extents = Vec::new();
+        for _ in 0..extent_count {
+            read_be(iloc, &mut pos, index_size)?;
+            let offset = read_be(iloc, &mut pos, offset_size)?;
+            let length = read_be(iloc, &mut pos, length_size)?;
+            extents.push((base_offset.checked_add(offset)?, length));
+        }
+        if id == item_id {
+            return (construction_method == 0).then_some(extents);
+        }
+    }
+    None
+}
+
+/// Children of the `meta` box of a HEIF file, past its version and flags.
+fn heif_meta(data: &[u8]) -> Option<&[u8]> {
+    let mut pos = 0;
+    while pos < data.len() {
+        let (b, consumed) = parse_box(&data[pos..])?;
+        if &b.kind == b"meta" && b.payload.len() > 4 {
+            return Some(&b.payload[4..]);
+        }
+        pos += consumed;
+    }
+    None
+}
+
+/// Exif of a HEIF file starting at its TIFF header, the leading header offset
+/// of the Exif item is dropped. `None` when the file has no Exif item.
+#[allow(unused)]
+pub(crate) fn heif_exif(data: &[u8]) -> Option<Vec<u8>> {
+    let meta = heif_meta(data)?;
+
+    let (mut iinf, mut iloc) = (None, None);
+    let mut pos = 0;
+    while pos < meta.len() {
+        let (b, consumed) = parse_box(&meta[pos..])?;
+        match &b.kind {
+            b"iinf" => iinf = Some(b.payload),
+            b"iloc" => iloc = Some(b.payload),
+            _ => {}
+        }
+        pos += consumed;
+    }
+
+    let item_id = exif_item_id(iinf?)?;
+    let mut item = Vec::new();
+    for (offset, length) in item_extents(iloc?, item_id)? {
+        let start = usize::try_from(offset).ok()?;
+        let end = if length == 0 {
+            data.len()
+        } else {
+            start.checked_add(usize::try_from(length).ok()?)?
+        };
+        item.extend_from_slice(data.get(start..end)?);
+    }
+    let tiff = usize::try_from(u32::from_be_bytes(item.get(0..4)?.try_into().ok()?))
+        .ok()?
+        .checked_add(4)?;
+    (tiff < item.len()).then(|| item.split_off(tiff))
+}
+
+/// `nclx` colour of a `colr` box, ITU-T H.273 code points as the file has them.
+#[derive(Debug, Clone, Copy, PartialEq, Eq)]
+pub(crate) struct HeifNclx {
+    pub(crate) color_primaries: u16,
+    pub(crate) transfer_characteristics: u16,
+    pub(crate) matrix_coefficients: u16,
+    pub(crate) full_range: bool,
+}
+
+/// 1-based `ipco` indices of the properties an `ipma` payload associates
+/// with `item_id`, 0 stands for no property.
+fn item_properties(ipma: &[u8], item_id: u32) -> Option<Vec<usize>> {
+    let version = *ipma.first()?;
+    let wide_indices = ipma.get(3)? & 1 != 0;
+    let mut pos = 4;
+    let entry_count = read_be(ipma, &mut pos, 4)?;
+    let id_size = if version < 1 { 2 } else { 4 };
+    for _ in 0..entry_count {
+        let id = read_be(ipma, &mut pos, id_size)? as u32;
+        let association_count = read_be(ipma, &mut pos, 1)?;
+        let mut indices = Vec::new();
+        for _ in 0..association_count {
+            // The top bit marks essential properties
+            let index = if wide_indices {
+                read_be(ipma, &mut pos, 2)? & 0x7FFF
+            } else {
+                read_be(ipma, &mut pos, 1)? & 0x7F
+            };
+            indices.push(index as usize);
+        }
+        if id == item_id {
+            return Some(indices);
+        }
+    }
+    None
+}
+
+/// `nclx` colour of the primary item of a HEIF file. `None` when the item
+/// has no `colr` property of that type, its colour then comes from the codec.
+#[allow(unused)]
+pub(crate) fn heif_nclx(data: &[u8]) -> Option<HeifNclx> {
+    let meta = heif_meta(data)?;
+
+    let (mut pitm, mut iprp) = (None, None);
+    let mut pos = 0;
+    while pos < meta.len() {
+        let (b, consumed) = parse_box(&meta[pos..])?;
+        match &b.kind {
+            b"pitm" => pitm = Some(b.payload),
+            b"iprp" => iprp = Some(b.payload),
+            _ => {}
+        }
+        pos += consumed;
+    }
+    let pitm = pitm?;
+    let mut p = 4;
+    let primary_id = read_be(pitm, &mut p, if *pitm.first()? == 0 { 2 } else { 4 })? as u32;
+
+    let iprp = iprp?;
+    let (mut properties, mut ipma) = (Vec::new(), None);
+    pos = 0;
+    while pos < iprp.len() {
+        let (b, consumed) = parse_box(&iprp[pos..])?;
+        match &b.kind {
+            b"ipco" => {
+                let mut q = 0;
+                while q < b.payload.len() {
+                    let (property, consumed) = parse_box(&b.payload[q..])?;
+                    properties.push(property);
+                    q += consumed;
+                }
+            }
+            b"ipma" if ipma.is_none() => ipma = Some(b.payload),
+            _ => {}
+        }
+        pos += consumed;
+    }
+
+    for index in item_properties(ipma?, primary_id)? {
+        let Some(property) = index.checked_sub(1).and_then(|x| properties.get(x)) else {
+            continue;
+        };
+        let colr = property.payload;
+        if &property.kind != b"colr" || colr.get(0..4) != Some(b"nclx".as_slice()) {
+            continue;
+        }
+        let mut p = 4;
+        return Some(HeifNclx {
+            color_primaries: read_be(colr, &mut p, 2)? as u16,
+            transfer_characteristics: read_be(colr, &mut p, 2)? as u16,
+            matrix_coefficients: read_be(colr, &mut p, 2)? as u16,
+            full_range: read_be(colr, &mut p, 1)? & 0x80 != 0,
+        });
+    }
+    None
+}
+
 fn detect_container(bytes: &[u8]) -> ImageContainer {
     if bytes.len() < 16 {
         return ImageContainer::Unknown;
@@ -222,3 +442,57 @@ pub unsafe extern "C" fn is_av2_image(data: *const u8, len: usize) -> bool {
 pub unsafe extern "C" fn container_recognisance(data: *const u8, len: usize) -> ImageContainer {
     detect_image_container(data, len)
 }
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    fn boxed(kind: &[u8; 4], payload: &[u8]) -> Vec<u8> {
+        let mut b = ((payload.len() + 8) as u32).to_be_bytes().to_vec();
+        b.extend_from_slice(kind);
+        b.extend_from_slice(payload);
+        b
+    }
+
+    /// HEIF with item 1 as primary and an `nclx` BT.2020 colour associated with
+    /// `colr_item`, after an `ispe` both items share.
+    fn heif_with_nclx(colr_item: u8) -> Vec<u8> {
+        let colr = boxed(
+            b"colr",
+            &[b"nclx".as_slice(), &[0, 9, 0, 14, 0, 9, 0x80]].concat(),
+        );
+        let ispe = boxed(b"ispe", &[0; 12]);
+        let ipco = boxed(b"ipco", &[ispe, colr].concat());
+        let associations = if colr_item == 1 {
+            vec![0, 1, 2, 0x81, 2, 0, 2, 1, 0x81]
+        } else {
+            vec![0, 1, 1, 0x81, 0, 2, 2, 0x81, 2]
+        };
+        let ipma = boxed(
+            b"ipma",
+            &[[0, 0, 0, 0, 0, 0, 0, 2].as_slice(), &associations].concat(),
+        );
+        let iprp = boxed(b"iprp", &[ipco, ipma].concat());
+        let pitm = boxed(b"pitm", &[0, 0, 0, 0, 0, 1]);
+        let meta = boxed(b"meta", &[[0u8; 4].as_slice(), &pitm, &iprp].concat());
+        [boxed(b"ftyp", b"heicmif1heic"), meta].concat()
+    }
+
+    #[test]
+    fn nclx_of_primary_item_keeps_code_points() {
+        assert_eq!(
+            heif_nclx(&heif_with_nclx(1)),
+            Some(HeifNclx {
+                color_primaries: 9,
+                transfer_characteristics: 14,
+                matrix_coefficients: 9,
+                full_range: true,
+            })
+        );
+    }
+
+    #[test]
+    fn nclx_of_other_items_is_ignored() {
+        assert_eq!(heif_nclx(&heif_with_nclx(2)), None);
+    }
+}
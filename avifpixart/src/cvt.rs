@@ -669,6 +669,60 @@ pub(crate) fn f16_bytes_to_rgba10(
     Ok(dst_u16)
 }
 
+/// Unpacks one row of little-endian RGB565 pixels into `dst` as RGBA8888.
+pub(crate) fn rgb565_row_to_rgba8888(src: &[u8], dst: &mut [u8]) {
+    for (dst, &b) in dst
+        .as_chunks_mut::<4>()
+        .0
+        .iter_mut()
+        .zip(src.as_chunks::<2>().0.iter())
+    {
+        *dst = rgb565_to_rgba8888(u16::from_le_bytes(b));
+    }
+}
+
+/// Unpacks one row of little-endian AR30 pixels into `dst` as RGBA 10 bit.
+pub(crate) fn ar30_row_to_rgba10(src: &[u8], dst: &mut [u16]) {
+    for (dst, &b) in dst
+        .as_chunks_mut::<4>()
+        .0
+        .iter_mut()
+        .zip(src.as_chunks::<4>().0.iter())
+    {
+        *dst = ar30_to_rgba10_pixel(u32::from_le_bytes(b));
+    }
+}
+
+/// Converts `rows` F16 rows, `stride` bytes apart, into tightly packed RGBA
+/// 10 bit in `dst`. `halfs` is a scratch of at least `width * rows * 4`,
+/// the bytes are moved there since the source is not always 2 byte aligned.
+pub(crate) fn f16_rows_to_rgba10(
+    src: &[u8],
+    stride: usize,
+    width: usize,
+    rows: usize,
+    halfs: &mut [f16],
+    dst: &mut [u16],
+) -> Result<(), anyhow::Error> {
+    let row_elements = width * 4;
+    for (y, dst) in halfs.chunks_exact_mut(row_elements).take(rows).enumerate() {
+        let row = &src[y * stride..y * stride + row_elements * 2];
+        for (dst, &b) in dst.iter_mut().zip(row.as_chunks::<2>().0.iter()) {
+            *dst = f16::from_ne_bytes(b);
+        }
+    }
+    convert_rgba_f16_to_rgba16(
+        &halfs[..row_elements * rows],
+        row_elements,
+        &mut dst[..row_elements * rows],
+        row_elements,
+        10,
+        width,
+        rows,
+    )
+    .map_err(|x| anyhow::anyhow!(x))
+}
+
 #[cfg(test)]
 mod tests {
     use super::*;
@@ -0,0 +1,55 @@
+/*
+ * Copyright (c) Radzivon Bartoshyk 2026/6. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+
+#[cfg(target_os = "android")]
+pub(crate) use ndk_sys::ADataSpace;
+
+/// `ADataSpace` values from the NDK `data_space.h`, for hosts without ndk-sys.
+/// Each one is `STANDARD | TRANSFER | RANGE` as documented there.
+#[cfg(not(target_os = "android"))]
+#[derive(Debug, Copy, Clone, PartialEq, Eq)]
+pub(crate) struct ADataSpace(pub i32);
+
+#[cfg(not(target_os = "android"))]
+impl ADataSpace {
+    pub(crate) const ADATASPACE_UNKNOWN: Self = Self(0);
+    pub(crate) const ADATASPACE_SCRGB_LINEAR: Self = Self(406913024);
+    pub(crate) const ADATASPACE_SRGB: Self = Self(142671872);
+    pub(crate) const ADATASPACE_SCRGB: Self = Self(411107328);
+    pub(crate) const ADATASPACE_DISPLAY_P3: Self = Self(143261696);
+    pub(crate) const ADATASPACE_BT2020_PQ: Self = Self(163971072);
+    pub(crate) const ADATASPACE_BT2020_ITU_PQ: Self = Self(298188800);
+    pub(crate) const ADATASPACE_BT601_625: Self = Self(281149440);
+    pub(crate) const ADATASPACE_BT601_525: Self = Self(281280512);
+    pub(crate) const ADATASPACE_BT2020: Self = Self(147193856);
+    pub(crate) const ADATASPACE_BT709: Self = Self(281083904);
+    pub(crate) const ADATASPACE_DCI_P3: Self = Self(155844608);
+    pub(crate) const ADATASPACE_BT2020_HLG: Self = Self(168165376);
+    pub(crate) const ADATASPACE_BT2020_ITU_HLG: Self = Self(302383104);
+}
@@ -59,3 +59,279 @@ pub struct HevcEncodingOptions {
     pub persistent_rice: bool,
     pub lossless_ycbcr: bool,
 }
+
+/// Pixel layout of a caller owned image handed to the `*_buffer` encoders.
+#[repr(C)]
+#[derive(Debug, Copy, Clone, PartialEq, Eq)]
+pub enum WeavePixelFormat {
+    Rgba8888,
+    Rgb565,
+    RgbaF16,
+    Rgba1010102,
+}
+
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WeaveImageBuffer {
+    pub data: *const u8,
+    pub stride: u32,
+    pub width: u32,
+    pub height: u32,
+    pub format: WeavePixelFormat,
+    pub premultiplied: bool,
+}
+
+/// Caller owned YUV image handed to `weave_av1_encode_yuv` and `weave_hevc_encode_yuv`.
+/// Samples are `u8` for 8 bit images and native endian `u16` otherwise,
+/// strides are in bytes. `u` and `v` are ignored for 4:0:0.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WeaveYuvImage {
+    pub y: *const u8,
+    pub y_stride: u32,
+    pub u: *const u8,
+    pub u_stride: u32,
+    pub v: *const u8,
+    pub v_stride: u32,
+    /// Null when the image has no alpha
+    pub a: *const u8,
+    pub a_stride: u32,
+    pub width: u32,
+    pub height: u32,
+    /// 8 or 10
+    pub bit_depth: u32,
+    /// Same codes as [AvifEncodingOptions::chroma_subsampling_code]
+    pub chroma_subsampling_code: i32,
+    pub color_primaries: u16,
+    pub transfer_characteristics: u16,
+    pub matrix_coefficients: u16,
+    pub full_range: bool,
+    /// Distance in samples between two chroma samples of a row. 2 reads
+    /// interleaved chroma (NV12, NV21, P010) where `u` and `v` point into
+    /// the same rows; 0 is treated as 1.
+    pub chroma_pixel_stride: u32,
+    /// `u16` samples keep their bits at the top, as in P010
+    pub msb_aligned: bool,
+}
+
+/// Encoded bitstream produced by the `*_buffer` encoders.
+/// Exactly one of `data` and `error` is set, both are released with
+/// [weave_encoded_image_free].
+#[repr(C)]
+pub struct EncodedImage {
+    pub data: *mut u8,
+    pub length: usize,
+    pub capacity: usize,
+    pub error: *mut std::ffi::c_char,
+}
+
+impl EncodedImage {
+    #[allow(unused)]
+    pub(crate) fn from_vec(data: Vec<u8>) -> Self {
+        let mut data = std::mem::ManuallyDrop::new(data);
+        EncodedImage {
+            data: data.as_mut_ptr(),
+            length: data.len(),
+            capacity: data.capacity(),
+            error: std::ptr::null_mut(),
+        }
+    }
+
+    pub(crate) fn from_error(message: impl Into<String>) -> Self {
+        let message = message.into().replace('\0', " ");
+        EncodedImage {
+            data: std::ptr::null_mut(),
+            length: 0,
+            capacity: 0,
+            error: std::ffi::CString::new(message)
+                .map(|x| x.into_raw())
+                .unwrap_or(std::ptr::null_mut()),
+        }
+    }
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn weave_encoded_image_free(image: EncodedImage) {
+    if !image.data.is_null() {
+        unsafe {
+            _ = Vec::from_raw_parts(image.data, image.length, image.capacity);
+        }
+    }
+    if !image.error.is_null() {
+        unsafe {
+            _ = std::ffi::CString::from_raw(image.error);
+        }
+    }
+}
+
+/// AV1 planes converted by `weave_av1_prepare`, opaque to callers.
+/// Released with [weave_av1_prepared_free].
+pub struct WeaveAv1Prepared {
+    #[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
+    pub(crate) image: crate::av1_encode_android::PreparedAv1Image,
+}
+
+/// Outcome of `weave_av1_prepare`. Exactly one of `prepared` and `error` is set,
+/// the error is released with [weave_av1_prepare_error_free].
+#[repr(C)]
+pub struct WeaveAv1PrepareResult {
+    pub prepared: *mut WeaveAv1Prepared,
+    pub error: *mut std::ffi::c_char,
+}
+
+impl WeaveAv1PrepareResult {
+    #[allow(unused)]
+    pub(crate) fn from_prepared(prepared: WeaveAv1Prepared) -> Self {
+        WeaveAv1PrepareResult {
+            prepared: Box::into_raw(Box::new(prepared)),
+            error: std::ptr::null_mut(),
+        }
+    }
+
+    pub(crate) fn from_error(message: impl Into<String>) -> Self {
+        let message = message.into().replace('\0', " ");
+        WeaveAv1PrepareResult {
+            prepared: std::ptr::null_mut(),
+            error: std::ffi::CString::new(message)
+                .map(|x| x.into_raw())
+                .unwrap_or(std::ptr::null_mut()),
+        }
+    }
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn weave_av1_prepared_free(prepared: *mut WeaveAv1Prepared) {
+    if !prepared.is_null() {
+        unsafe {
+            _ = Box::from_raw(prepared);
+        }
+    }
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn weave_av1_prepare_error_free(error: *mut std::ffi::c_char) {
+    if !error.is_null() {
+        unsafe {
+            _ = std::ffi::CString::from_raw(error);
+        }
+    }
+}
+
+/// What an AVIF file has to carry next to the planes of a transcoded HEIC.
+/// Pointers are borrowed from the [WeaveHeicTranscode] they were read from.
+#[repr(C)]
+#[derive(Debug, Copy, Clone)]
+pub struct WeaveHeicMetadata {
+    /// Null when the file has no ICC profile
+    pub icc: *const u8,
+    pub icc_length: usize,
+    /// TIFF header first, null when the file has no Exif
+    pub exif: *const u8,
+    pub exif_length: usize,
+    /// ITU-T H.273 code points of the planes
+    pub color_primaries: u16,
+    pub transfer_characteristics: u16,
+    pub matrix_coefficients: u16,
+    /// `irot` angle in anticlockwise quarter turns
+    pub rotation: u8,
+    /// `imir` axis, 0 exchanges top and bottom, 1 left and right, -1 doesn't mirror
+    pub mirror: i8,
+    pub has_clean_aperture: bool,
+    /// `clap` fractions as numerator, denominator pairs: width, height,
+    /// horizontal offset, vertical offset. Offsets are signed.
+    pub clean_aperture: [u32; 8],
+    /// Planes went through RGB, crop and orientation are already applied
+    pub converted: bool,
+}
+
+/// HEIC decoded by `weave_heic_transcode_prepare`, opaque to callers.
+/// Released with [weave_heic_transcode_free].
+pub struct WeaveHeicTranscode {
+    pub(crate) prepared: WeaveAv1Prepared,
+    pub(crate) icc: Option<Vec<u8>>,
+    pub(crate) exif: Option<Vec<u8>>,
+    pub(crate) metadata: WeaveHeicMetadata,
+}
+
+/// Outcome of `weave_heic_transcode_prepare`. Exactly one of `transcode` and
+/// `error` is set, the error is released with [weave_av1_prepare_error_free].
+#[repr(C)]
+pub struct WeaveHeicTranscodeResult {
+    pub transcode: *mut WeaveHeicTranscode,
+    pub error: *mut std::ffi::c_char,
+}
+
+impl WeaveHeicTranscodeResult {
+    #[allow(unused)]
+    pub(crate) fn from_transcode(transcode: WeaveHeicTranscode) -> Self {
+        WeaveHeicTranscodeResult {
+            transcode: Box::into_raw(Box::new(transcode)),
+            error: std::ptr::null_mut(),
+        }
+    }
+
+    pub(crate) fn from_error(message: impl Into<String>) -> Self {
+        let message = message.into().replace('\0', " ");
+        WeaveHeicTranscodeResult {
+            transcode: std::ptr::null_mut(),
+            error: std::ffi::CString::new(message)
+                .map(|x| x.into_raw())
+                .unwrap_or(std::ptr::null_mut()),
+        }
+    }
+}
+
+/// Planes of `transcode` for `weave_av1_prepared_planes` and
+/// `weave_av1_encode_prepared`, owned by `transcode`.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_heic_transcode_prepared(
+    transcode: *const WeaveHeicTranscode,
+) -> *const WeaveAv1Prepared {
+    if transcode.is_null() {
+        return std::ptr::null();
+    }
+    unsafe { &(*transcode).prepared }
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_heic_transcode_metadata(
+    transcode: *const WeaveHeicTranscode,
+) -> WeaveHeicMetadata {
+    let mut metadata = WeaveHeicMetadata {
+        icc: std::ptr::null(),
+        icc_length: 0,
+        exif: std::ptr::null(),
+        exif_length: 0,
+        color_primaries: 2,
+        transfer_characteristics: 2,
+        matrix_coefficients: 2,
+        rotation: 0,
+        mirror: -1,
+        has_clean_aperture: false,
+        clean_aperture: [0; 8],
+        converted: false,
+    };
+    if transcode.is_null() {
+        return metadata;
+    }
+    let transcode = unsafe { &*transcode };
+    metadata = transcode.metadata;
+    if let Some(icc) = transcode.icc.as_ref().filter(|x| !x.is_empty()) {
+        metadata.icc = icc.as_ptr();
+        metadata.icc_length = icc.len();
+    }
+    if let Some(exif) = transcode.exif.as_ref().filter(|x| !x.is_empty()) {
+        metadata.exif = exif.as_ptr();
+        metadata.exif_length = exif.len();
+    }
+    metadata
+}
+
+#[unsafe(no_mangle)]
+pub extern "C" fn weave_heic_transcode_free(transcode: *mut WeaveHeicTranscode) {
+    if !transcode.is_null() {
+        unsafe {
+            _ = Box::from_raw(transcode);
+        }
+    }
+}
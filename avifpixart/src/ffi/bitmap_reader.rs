@@ -29,8 +29,10 @@
 #![allow(unused)]
 
 use crate::WeaverPreferredColorConfig;
+use crate::encoding_options::{WeaveImageBuffer, WeavePixelFormat};
 use jni::Env;
 use jni::sys::{JNIEnv, jobject};
+#[cfg(target_os = "android")]
 use ndk_sys::{
     AndroidBitmap_getInfo, AndroidBitmap_lockPixels, AndroidBitmap_unlockPixels,
     AndroidBitmapFormat, AndroidBitmapInfo,
@@ -61,6 +63,7 @@ pub(crate) enum BitmapPixelFormat {
 }
 
 impl BitmapPixelFormat {
+    #[cfg(target_os = "android")]
     fn from_ndk(format: u32) -> Option<Self> {
         match format {
             f if f == AndroidBitmapFormat::ANDROID_BITMAP_FORMAT_RGBA_8888.0 => {
@@ -106,6 +109,15 @@ impl BitmapPixelFormat {
             Self::A8 => None,
         }
     }
+
+    fn from_weave(format: WeavePixelFormat) -> Self {
+        match format {
+            WeavePixelFormat::Rgba8888 => Self::Rgba8888,
+            WeavePixelFormat::Rgb565 => Self::Rgb565,
+            WeavePixelFormat::RgbaF16 => Self::RgbaF16,
+            WeavePixelFormat::Rgba1010102 => Self::Rgba1010102,
+        }
+    }
 }
 
 /// The underlying numeric type one element of the pixel buffer should be read
@@ -185,6 +197,8 @@ pub enum BitmapReadError {
     HardwareBitmap,
     /// `width * height * bpp` overflowed `usize`.
     SizeOverflow,
+    /// Row stride of a caller buffer is shorter than one row of pixels.
+    InvalidStride(usize),
 }
 
 impl fmt::Display for BitmapReadError {
@@ -198,12 +212,14 @@ impl fmt::Display for BitmapReadError {
                 "HARDWARE bitmaps have no CPU-mappable pixels; copy to a software config first",
             ),
             Self::SizeOverflow => f.write_str("bitmap dimensions overflowed usize"),
+            Self::InvalidStride(s) => write!(f, "row stride {s} is shorter than one row"),
         }
     }
 }
 
 impl std::error::Error for BitmapReadError {}
 
+#[cfg(target_os = "android")]
 pub(crate) unsafe fn get_bitmap_data(
     env: &mut Env,
     bitmap: jobject,
@@ -273,6 +289,7 @@ pub(crate) unsafe fn get_bitmap_data(
     })
 }
 
+#[cfg(target_os = "android")]
 pub unsafe fn is_hardware_bitmap(
     env: *mut JNIEnv,
     bitmap: jobject,
@@ -284,3 +301,215 @@ pub unsafe fn is_hardware_bitmap(
     }
     Ok(info.flags & FLAGS_IS_HARDWARE != 0)
 }
+
+/// Same as [get_bitmap_data] for a caller owned buffer, rows are repacked
+/// so the encoders see exactly the layout they get from a `Bitmap`.
+pub(crate) unsafe fn get_image_buffer_data(
+    image: &WeaveImageBuffer,
+) -> Result<BitmapData, BitmapReadError> {
+    if image.data.is_null() {
+        return Err(BitmapReadError::NullPixels);
+    }
+    let format = BitmapPixelFormat::from_weave(image.format);
+    let width = image.width as usize;
+    let height = image.height as usize;
+    let stride = image.stride as usize;
+
+    let row_bytes = width
+        .checked_mul(format.bytes_per_pixel())
+        .ok_or(BitmapReadError::SizeOverflow)?;
+    let total = row_bytes
+        .checked_mul(height)
+        .ok_or(BitmapReadError::SizeOverflow)?;
+    if stride < row_bytes {
+        return Err(BitmapReadError::InvalidStride(stride));
+    }
+
+    let mut data: Vec<u8> = Vec::with_capacity(total);
+    for y in 0..height {
+        // SAFETY: caller guarantees `height` rows of `stride` bytes.
+        let row = unsafe { std::slice::from_raw_parts(image.data.add(y * stride), row_bytes) };
+        data.extend_from_slice(row);
+    }
+
+    Ok(BitmapData {
+        data,
+        width,
+        height,
+        format,
+        component_type: format.component_type(),
+        alpha: if image.premultiplied {
+            BitmapAlpha::Premultiplied
+        } else {
+            BitmapAlpha::Unpremultiplied
+        },
+    })
+}
+
+/// Pixels of a bitmap or caller buffer read in place, rows keep their stride.
+/// Nothing is copied, so the view lives no longer than the lock or buffer it
+/// was taken from.
+pub(crate) struct BitmapView<'a> {
+    pixels: &'a [u8],
+    pub stride: usize,
+    pub width: usize,
+    pub height: usize,
+    pub format: BitmapPixelFormat,
+    pub alpha: BitmapAlpha,
+}
+
+impl<'a> BitmapView<'a> {
+    /// Bytes in one packed row, stride padding excluded.
+    #[inline]
+    pub fn row_bytes(&self) -> usize {
+        self.width * self.format.bytes_per_pixel()
+    }
+
+    /// Pixels of row `y`.
+    #[inline]
+    pub fn row(&self, y: usize) -> &'a [u8] {
+        let start = y * self.stride;
+        &self.pixels[start..start + self.row_bytes()]
+    }
+
+    /// Rows `[y, y + count)` as one slice, `stride` bytes apart. The last row
+    /// ends at its pixels, so the slice is shorter than `count * stride`.
+    #[inline]
+    pub fn rows(&self, y: usize, count: usize) -> &'a [u8] {
+        if count == 0 {
+            return &[];
+        }
+        let start = y * self.stride;
+        let end = (y + count - 1) * self.stride + self.row_bytes();
+        &self.pixels[start..end]
+    }
+
+    /// Rows `[y, y + count)` together with the padding after the last one,
+    /// `None` when the pixels end before that padding.
+    #[inline]
+    pub fn padded_rows(&self, y: usize, count: usize) -> Option<&'a [u8]> {
+        self.pixels.get(y * self.stride..(y + count) * self.stride)
+    }
+}
+
+/// Checks the geometry of a pixel region and wraps it without copying.
+unsafe fn view_pixels<'a>(
+    data: *const u8,
+    stride: usize,
+    width: usize,
+    height: usize,
+    format: BitmapPixelFormat,
+    alpha: BitmapAlpha,
+) -> Result<BitmapView<'a>, BitmapReadError> {
+    if data.is_null() {
+        return Err(BitmapReadError::NullPixels);
+    }
+    let row_bytes = width
+        .checked_mul(format.bytes_per_pixel())
+        .ok_or(BitmapReadError::SizeOverflow)?;
+    if stride < row_bytes {
+        return Err(BitmapReadError::InvalidStride(stride));
+    }
+    let len = if height == 0 {
+        0
+    } else {
+        stride
+            .checked_mul(height - 1)
+            .and_then(|x| x.checked_add(row_bytes))
+            .ok_or(BitmapReadError::SizeOverflow)?
+    };
+    Ok(BitmapView {
+        // SAFETY: caller guarantees `height` rows of `stride` bytes at `data`.
+        pixels: unsafe { std::slice::from_raw_parts(data, len) },
+        stride,
+        width,
+        height,
+        format,
+        alpha,
+    })
+}
+
+/// In place counterpart of [get_image_buffer_data].
+pub(crate) unsafe fn view_image_buffer(
+    image: &WeaveImageBuffer,
+) -> Result<BitmapView<'_>, BitmapReadError> {
+    unsafe {
+        view_pixels(
+            image.data,
+            image.stride as usize,
+            image.width as usize,
+            image.height as usize,
+            BitmapPixelFormat::from_weave(image.format),
+            if image.premultiplied {
+                BitmapAlpha::Premultiplied
+            } else {
+                BitmapAlpha::Unpremultiplied
+            },
+        )
+    }
+}
+
+/// Pixels of a `Bitmap` locked for as long as this lives, the in place
+/// counterpart of [get_bitmap_data].
+#[cfg(target_os = "android")]
+pub(crate) struct LockedBitmap {
+    env: *mut JNIEnv,
+    bitmap: jobject,
+    addr: *const u8,
+    info: AndroidBitmapInfo,
+    format: BitmapPixelFormat,
+}
+
+#[cfg(target_os = "android")]
+impl LockedBitmap {
+    pub unsafe fn lock(env: &mut Env, bitmap: jobject) -> Result<Self, BitmapReadError> {
+        let raw_env: *mut JNIEnv = env.get_raw().cast();
+        let mut info: AndroidBitmapInfo = unsafe { std::mem::zeroed() };
+        let ret = unsafe { AndroidBitmap_getInfo(raw_env.cast(), bitmap.cast(), &mut info) };
+        if ret != 0 {
+            return Err(BitmapReadError::GetInfo(ret));
+        }
+        if info.flags & FLAGS_IS_HARDWARE != 0 {
+            return Err(BitmapReadError::HardwareBitmap);
+        }
+        let format = BitmapPixelFormat::from_ndk(info.format as u32)
+            .ok_or(BitmapReadError::UnsupportedFormat(info.format as u32))?;
+
+        let mut addr: *mut std::ffi::c_void = std::ptr::null_mut();
+        let ret = unsafe { AndroidBitmap_lockPixels(raw_env.cast(), bitmap.cast(), &mut addr) };
+        if ret != 0 {
+            return Err(BitmapReadError::Lock(ret));
+        }
+        if addr.is_null() {
+            unsafe { AndroidBitmap_unlockPixels(raw_env.cast(), bitmap.cast()) };
+            return Err(BitmapReadError::NullPixels);
+        }
+        Ok(Self {
+            env: raw_env,
+            bitmap,
+            addr: addr as *const u8,
+            info,
+            format,
+        })
+    }
+
+    pub fn view(&self) -> Result<BitmapView<'_>, BitmapReadError> {
+        unsafe {
+            view_pixels(
+                self.addr,
+                self.info.stride as usize,
+                self.info.width as usize,
+                self.info.height as usize,
+                self.format,
+                BitmapAlpha::from_flags(self.info.flags),
+            )
+        }
+    }
+}
+
+#[cfg(target_os = "android")]
+impl Drop for LockedBitmap {
+    fn drop(&mut self) {
+        let _ = unsafe { AndroidBitmap_unlockPixels(self.env.cast(), self.bitmap.cast()) };
+    }
+}
@@ -26,12 +26,16 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+#[cfg(target_os = "android")]
 mod android_bitmap;
 mod bitmap_reader;
+#[cfg(target_os = "android")]
 mod hardware_buffers;
 
+#[cfg(target_os = "android")]
 pub(crate) use android_bitmap::{MIN_OS_BITMAP_COLOR_SPACE, software_bitmap, wrap_hardware_buffer};
 pub(crate) use bitmap_reader::*;
+#[cfg(target_os = "android")]
 pub(super) use hardware_buffers::{
     create_rgba8888_hardware_buffer, create_rgba8888_hardware_buffer_from_u16,
 };
@@ -73,7 +73,7 @@ pub(crate) struct DecodedHeicPacket<T> {
     pub(crate) has_real_alpha: bool,
 }
 
-fn clap_rect(
+pub(crate) fn clap_rect(
     width: usize,
     height: usize,
     clap: &hpvcd::CleanAperture,
@@ -163,13 +163,18 @@ struct HeicColors {
     range: yuv::YuvRange,
 }
 
-fn solve_heic_colors(decoded_yuv: &DecodedYuv) -> Result<HeicColors, WeaverError> {
-    let cicp = decoded_yuv.color.cicp.unwrap_or(Cicp {
+/// Colour description of the planes, files without one are read as sRGB.
+pub(crate) fn heic_cicp(decoded_yuv: &DecodedYuv) -> Cicp {
+    decoded_yuv.color.cicp.unwrap_or(Cicp {
         primaries: Primaries::Bt709,
         transfer: TransferFunction::Srgb,
         matrix: MatrixCoefficients::Smpte170m,
         full_range: true,
-    });
+    })
+}
+
+fn solve_heic_colors(decoded_yuv: &DecodedYuv) -> Result<HeicColors, WeaverError> {
+    let cicp = heic_cicp(decoded_yuv);
     let yuv_range = match cicp.full_range {
         false => yuv::YuvRange::Limited,
         true => yuv::YuvRange::Full,
@@ -787,24 +792,30 @@ fn decode_heic_inner_12bit(
     finalize(target_data, decoded_yuv, colors.cicp)
 }
 
-pub(crate) fn decode_packed_heic(data: &[u8]) -> Result<PackedHeic, WeaverError> {
+/// Decodes a HEIC image into YUV planes, nothing is converted yet.
+pub(crate) fn decode_heic_yuv(data: &[u8]) -> Result<DecodedYuv, WeaverError> {
     if !is_heic(data) {
         return Err(WeaverError::InvalidHeic);
     }
+    hpvcd::decode_heic_yuv(data).map_err(|x| WeaverError::FailedToDecodeHeic(x.to_string()))
+}
 
-    let decoded_heic =
-        hpvcd::decode_heic_yuv(data).map_err(|x| WeaverError::FailedToDecodeHeic(x.to_string()))?;
-
+/// Converts decoded planes to RGBA, cropped and oriented for display.
+pub(crate) fn pack_decoded_heic(decoded_heic: &DecodedYuv) -> Result<PackedHeic, WeaverError> {
     match (decoded_heic.bit_depth, &decoded_heic.planes) {
         (BitDepth::Eight, YuvBuffer::U8(planes)) => Ok(PackedHeic::Regular(
-            decode_inner_low_bit_depth(&decoded_heic, planes)?,
+            decode_inner_low_bit_depth(decoded_heic, planes)?,
         )),
         (BitDepth::Ten, YuvBuffer::U16(planes)) => Ok(PackedHeic::HighBitDepth(
-            decode_heic_inner_10bit(&decoded_heic, planes)?,
+            decode_heic_inner_10bit(decoded_heic, planes)?,
         )),
         (BitDepth::Twelve, YuvBuffer::U16(planes)) => Ok(PackedHeic::HighBitDepth(
-            decode_heic_inner_12bit(&decoded_heic, planes)?,
+            decode_heic_inner_12bit(decoded_heic, planes)?,
         )),
         _ => Err(WeaverError::MismatchedBitDepth),
     }
 }
+
+pub(crate) fn decode_packed_heic(data: &[u8]) -> Result<PackedHeic, WeaverError> {
+    pack_decoded_heic(&decode_heic_yuv(data)?)
+}
@@ -26,21 +26,29 @@
  * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
+use crate::av1_encode_android::read_yuv_plane;
 use crate::cvt::{ar30_bytes_to_rgba10, f16_bytes_to_rgba10, rgb565_bytes_to_rgba8888};
-use crate::encoding_options::HevcEncodingOptions;
-use crate::ffi::{BitmapData, BitmapPixelFormat, get_bitmap_data};
+use crate::data_space::ADataSpace;
+use crate::encoding_options::{EncodedImage, HevcEncodingOptions, WeaveImageBuffer, WeaveYuvImage};
+#[cfg(target_os = "android")]
+use crate::ffi::get_bitmap_data;
+use crate::ffi::{BitmapData, BitmapPixelFormat, get_image_buffer_data};
+use crate::support::{dbg_log, has_non_constant_alpha, init_logging, panic_payload_to_string};
+#[cfg(target_os = "android")]
 use crate::support::{
-    dbg_log, has_non_constant_alpha, init_logging, optional_bytebuffer_to_vec,
-    panic_payload_to_string, throw_runtime_exception, throw_runtime_exception_raw,
+    optional_bytebuffer_to_vec, throw_runtime_exception, throw_runtime_exception_raw,
 };
 use crate::weaver_error::WeaverError;
 use hpvca::{BitDepth, ChromaFormat, Cicp, MatrixCoefficients, Primaries, TransferFunction};
-use jni::objects::JObject;
-use jni::sys::{jbyteArray, jobject};
-use jni::{EnvUnowned, Outcome};
-use ndk_sys::ADataSpace;
+#[cfg(target_os = "android")]
+use jni::{
+    EnvUnowned, Outcome,
+    objects::JObject,
+    sys::{jbyteArray, jobject},
+};
 use std::borrow::Cow;
 use std::num::NonZero;
+#[cfg(target_os = "android")]
 use std::ptr::null_mut;
 use std::thread::available_parallelism;
 use yuv::{
@@ -872,6 +880,7 @@ fn encode_heic_inner(
     }
 }
 
+#[cfg(target_os = "android")]
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn encode_heic_file(
     env: *mut jni::sys::JNIEnv,
@@ -1026,3 +1035,308 @@ pub unsafe extern "C" fn encode_heic_file(
         }
     }
 }
+
+/// JNI free counterpart of [encode_heic_file] encoding a caller owned
+/// pixel buffer. Errors and panics are reported in [EncodedImage::error].
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn encode_heic_buffer(
+    image: WeaveImageBuffer,
+    exif: *const u8,
+    exif_length: usize,
+    options: HevcEncodingOptions,
+) -> EncodedImage {
+    init_logging();
+
+    let result = std::panic::catch_unwind(|| -> Result<Vec<u8>, anyhow::Error> {
+        let chroma_subsampling = match options.chroma_subsampling_code {
+            2 => ChromaFormat::Yuv422,
+            3 => ChromaFormat::Yuv444,
+            4 => ChromaFormat::Monochrome,
+            _ => ChromaFormat::Yuv420,
+        };
+        if chroma_subsampling == ChromaFormat::Monochrome {
+            return Err(anyhow::anyhow!(WeaverError::MonochromeIsNotSupported));
+        }
+        let mut bitmap_data = unsafe {
+            get_image_buffer_data(&image).map_err(|x| {
+                dbg_log!(error, "get_image_buffer_data failed: {x}");
+                anyhow::anyhow!(x)
+            })?
+        };
+        dbg_log!(
+            debug,
+            "encode_heic_buffer: {}x{} format={:?}",
+            bitmap_data.width,
+            bitmap_data.height,
+            bitmap_data.format
+        );
+
+        let exif_data = if exif.is_null() || exif_length == 0 {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(exif, exif_length) })
+        };
+
+        encode_heic_inner(
+            &mut bitmap_data,
+            resolve_cicp(options.color_space),
+            options.quality.clamp(1, 100) as u32,
+            options.lossless,
+            exif_data,
+            chroma_subsampling,
+            match options.speed {
+                0 => hpvca::Speed::Fast,
+                _ => hpvca::Speed::Slow,
+            },
+            options.screen_content_coding,
+            options.rdpcm,
+            options.persistent_rice,
+            options.lossless && options.lossless_ycbcr,
+        )
+    });
+
+    match result {
+        Ok(Ok(encoded)) => EncodedImage::from_vec(encoded),
+        Ok(Err(e)) => {
+            dbg_log!(error, "encode_heic_buffer failed: {e:#}");
+            EncodedImage::from_error(format!("HEIC encoding failed: {e:#}"))
+        }
+        Err(p) => EncodedImage::from_error(format!(
+            "panic while encoding HEIC: {}",
+            panic_payload_to_string(p.as_ref())
+        )),
+    }
+}
+
+fn hevc_cicp_from_codes(primaries: u16, transfer: u16, matrix: u16, full_range: bool) -> Cicp {
+    let mut cicp = Cicp::unspecified();
+    cicp.primaries = match primaries {
+        1 => Primaries::Bt709,
+        5 | 6 => Primaries::Bt601,
+        9 => Primaries::Bt2020,
+        11 => Primaries::Smpte431,
+        12 => Primaries::Smpte432,
+        _ => cicp.primaries,
+    };
+    cicp.transfer = match transfer {
+        1 => TransferFunction::Bt709,
+        6 => TransferFunction::Bt601,
+        8 => TransferFunction::Linear,
+        13 => TransferFunction::Srgb,
+        14 => TransferFunction::Bt202010bit,
+        16 => TransferFunction::Smpte2084,
+        17 => TransferFunction::Smpte428,
+        18 => TransferFunction::Hlg,
+        _ => cicp.transfer,
+    };
+    cicp.matrix = match matrix {
+        0 => MatrixCoefficients::Identity,
+        1 => MatrixCoefficients::Bt709,
+        4 => MatrixCoefficients::Fcc,
+        5 | 6 => MatrixCoefficients::Smpte170m,
+        9 => MatrixCoefficients::Bt2020Ncl,
+        _ => cicp.matrix,
+    };
+    cicp.full_range = full_range;
+    cicp
+}
+
+/// Repeats the last column and row of a plane up to the coded size.
+fn pad_plane_for_hpvca(
+    plane: Vec<u16>,
+    width: usize,
+    height: usize,
+    coded_width: usize,
+    coded_height: usize,
+) -> Vec<u16> {
+    if width == coded_width && height == coded_height {
+        return plane;
+    }
+    let mut out = Vec::with_capacity(coded_width * coded_height);
+    for y in 0..coded_height {
+        let row = &plane[y.min(height - 1) * width..][..width];
+        out.extend_from_slice(row);
+        out.extend(std::iter::repeat_n(row[width - 1], coded_width - width));
+    }
+    out
+}
+
+unsafe fn encode_hevc_yuv_inner(
+    image: &WeaveYuvImage,
+    exif: Option<&[u8]>,
+    options: &HevcEncodingOptions,
+    threads: usize,
+) -> Result<Vec<u8>, anyhow::Error> {
+    let width = image.width as usize;
+    let height = image.height as usize;
+    if width == 0 || height == 0 {
+        return Err(anyhow::anyhow!("YUV image has no pixels"));
+    }
+    let chroma_format = match image.chroma_subsampling_code {
+        2 => ChromaFormat::Yuv422,
+        3 => ChromaFormat::Yuv444,
+        4 => ChromaFormat::Monochrome,
+        _ => ChromaFormat::Yuv420,
+    };
+    if chroma_format == ChromaFormat::Monochrome {
+        return Err(anyhow::anyhow!(WeaverError::MonochromeIsNotSupported));
+    }
+    let (chroma_width, chroma_height) = match chroma_format {
+        ChromaFormat::Yuv420 => (width.div_ceil(2), height.div_ceil(2)),
+        ChromaFormat::Yuv422 => (width.div_ceil(2), height),
+        _ => (width, height),
+    };
+    let (coded_width, coded_height) = hpvca_coded_dimensions(width, height, chroma_format);
+    let bit_depth = match image.bit_depth {
+        8 => BitDepth::Eight,
+        10 => BitDepth::Ten,
+        depth => {
+            return Err(anyhow::anyhow!(
+                "YUV bit depth {depth} is not supported, expected 8 or 10"
+            ));
+        }
+    };
+    let shift = if image.msb_aligned {
+        16u32.saturating_sub(image.bit_depth)
+    } else {
+        0
+    };
+    let chroma_pixel_stride = image.chroma_pixel_stride as usize;
+
+    // hpvca takes u16 samples for every depth, so 8 bit planes are widened while read
+    let read = |data: *const u8, stride: u32, pixel_stride: usize, w: usize, h: usize| unsafe {
+        if image.bit_depth == 8 {
+            read_yuv_plane(data, stride, pixel_stride, w, h, |x: &[u8]| x[0] as u16)
+        } else {
+            read_yuv_plane(data, stride, pixel_stride, w, h, |x: &[u8]| {
+                u16::from_ne_bytes([x[0], x[1]]) >> shift
+            })
+        }
+    };
+
+    let y = read(image.y, image.y_stride, 1, width, height)?;
+    let cb = read(
+        image.u,
+        image.u_stride,
+        chroma_pixel_stride,
+        chroma_width,
+        chroma_height,
+    )?;
+    let cr = read(
+        image.v,
+        image.v_stride,
+        chroma_pixel_stride,
+        chroma_width,
+        chroma_height,
+    )?;
+    let alpha = if image.a.is_null() {
+        None
+    } else {
+        let a = read(image.a, image.a_stride, 1, width, height)?;
+        Some(pad_plane_for_hpvca(
+            a,
+            width,
+            height,
+            coded_width,
+            coded_height,
+        ))
+    };
+
+    let yuv = hpvca::Yuv {
+        y: pad_plane_for_hpvca(y, width, height, coded_width, coded_height),
+        cb,
+        cr,
+        width: coded_width as u32,
+        height: coded_height as u32,
+        display_w: image.width,
+        display_h: image.height,
+        chroma: chroma_format,
+        bit_depth,
+    };
+
+    let cicp = hevc_cicp_from_codes(
+        image.color_primaries,
+        image.transfer_characteristics,
+        image.matrix_coefficients,
+        image.full_range,
+    );
+    let speed: hpvca::Speed = match options.speed {
+        0 => hpvca::Speed::Fast,
+        _ => hpvca::Speed::Slow,
+    };
+    // Planes are coded as given, lossless YCbCr keeps a non identity matrix intact
+    let lossless_ycbcr = options.lossless && !matches!(cicp.matrix, MatrixCoefficients::Identity);
+    let mut config = hpvca::EncodeConfig::new()
+        .with_cicp(cicp)
+        .with_quality(options.quality.clamp(1, 100) as u8)
+        .with_threads(threads)
+        .with_lossless(options.lossless)
+        .with_speed(speed)
+        .with_screen_content(options.screen_content_coding)
+        .with_implicit_rdpcm(options.rdpcm)
+        .with_persistent_rice(options.persistent_rice)
+        .with_lossless_ycbcr(lossless_ycbcr);
+    if let Some(exif) = exif {
+        config = config.with_exif(exif.to_vec());
+    }
+
+    dbg_log!(
+        debug,
+        "encode_hevc_yuv_inner: {}x{} depth={} chroma={:?} alpha={}",
+        image.width,
+        image.height,
+        image.bit_depth,
+        chroma_format,
+        alpha.is_some()
+    );
+    let result = match alpha {
+        Some(alpha) => hpvca::encode_yuv_with_alpha(&yuv, &alpha, &config),
+        None => hpvca::encode_yuv(&yuv, &config),
+    };
+    result.map_err(|x| {
+        dbg_log!(error, "hpvca YUV encoding failed: {x}");
+        anyhow::anyhow!(x)
+    })
+}
+
+/// Encodes caller owned YUV planes as HEIC, no colour conversion happens. Colour
+/// space and chroma subsampling are described by `image`, the rest comes from
+/// `options`. `threads` 0 uses every core.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_hevc_encode_yuv(
+    image: WeaveYuvImage,
+    exif: *const u8,
+    exif_length: usize,
+    options: HevcEncodingOptions,
+    threads: u32,
+) -> EncodedImage {
+    init_logging();
+
+    let result = std::panic::catch_unwind(|| -> Result<Vec<u8>, anyhow::Error> {
+        let exif_data = if exif.is_null() || exif_length == 0 {
+            None
+        } else {
+            Some(unsafe { std::slice::from_raw_parts(exif, exif_length) })
+        };
+        let threads = if threads == 0 {
+            available_parallelism()
+                .unwrap_or(NonZero::new(1).unwrap())
+                .get()
+        } else {
+            threads as usize
+        };
+        unsafe { encode_hevc_yuv_inner(&image, exif_data, &options, threads) }
+    });
+
+    match result {
+        Ok(Ok(encoded)) => EncodedImage::from_vec(encoded),
+        Ok(Err(e)) => {
+            dbg_log!(error, "weave_hevc_encode_yuv failed: {e:#}");
+            EncodedImage::from_error(format!("HEIC encoding failed: {e:#}"))
+        }
+        Err(p) => EncodedImage::from_error(format!(
+            "panic while encoding HEIC: {}",
+            panic_payload_to_string(p.as_ref())
+        )),
+    }
+}
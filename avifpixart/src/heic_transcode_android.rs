@@ -0,0 +1,454 @@
+/*
+ * Copyright (c) Radzivon Bartoshyk 2026/10. All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without modification,
+ * are permitted provided that the following conditions are met:
+ *
+ * 1.  Redistributions of source code must retain the above copyright notice, this
+ * list of conditions and the following disclaimer.
+ *
+ * 2.  Redistributions in binary form must reproduce the above copyright notice,
+ * this list of conditions and the following disclaimer in the documentation
+ * and/or other materials provided with the distribution.
+ *
+ * 3.  Neither the name of the copyright holder nor the names of its
+ * contributors may be used to endorse or promote products derived from
+ * this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+ * DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+ * FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+ * DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+ * SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+ * CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+ * OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+ * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+ */
+use crate::av1_encode_android::{
+    AvEncodingConfig, PreparedAv1Image, PreparedPlanes, cicp_codes, cicp_from_codes,
+    prepare_av1_packed_u8, prepare_av1_packed_u16,
+};
+use crate::box_walker::{heif_exif, heif_nclx};
+use crate::encoding_options::{
+    AvifEncodingOptions, WeaveAv1Prepared, WeaveHeicMetadata, WeaveHeicTranscode,
+    WeaveHeicTranscodeResult,
+};
+use crate::heic_decode::{PackedHeic, clap_rect, decode_heic_yuv, heic_cicp, pack_decoded_heic};
+use crate::support::{dbg_log, init_logging, panic_payload_to_string, try_vec};
+use hpvcd::{
+    BitDepth, DecodedYuv, MatrixCoefficients, Orientation, PlanarImage, PlaneBuffer, Primaries,
+    TransferFunction, YuvBuffer,
+};
+use maroontree::ChromaFormat;
+use std::slice;
+
+#[allow(unreachable_patterns)]
+fn primaries_code(primaries: Primaries) -> u16 {
+    match primaries {
+        Primaries::Bt709 => 1,
+        Primaries::Bt470M => 4,
+        Primaries::Bt470Bg => 5,
+        Primaries::Bt601 => 6,
+        Primaries::Smpte240 => 7,
+        Primaries::GenericFilm => 8,
+        Primaries::Bt2020 => 9,
+        Primaries::Xyz => 10,
+        Primaries::Smpte431 => 11,
+        Primaries::Smpte432 => 12,
+        Primaries::Ebu3213 => 22,
+        _ => 2,
+    }
+}
+
+/// Code of the transfers hpvcd names, only used without an `nclx` property
+/// since [transcode_heic] passes the code point of the file through otherwise.
+#[allow(unreachable_patterns)]
+fn transfer_code(transfer: TransferFunction) -> u16 {
+    match transfer {
+        TransferFunction::Bt709 => 1,
+        TransferFunction::Linear => 8,
+        TransferFunction::Srgb => 13,
+        TransferFunction::Pq => 16,
+        TransferFunction::Smpte428 => 17,
+        TransferFunction::Hlg => 18,
+        _ => 2,
+    }
+}
+
+/// `None` when AV1 can't carry planes of this matrix as they are: HEVC GBR
+/// (identity) and matrices without a known code have to go through RGB.
+fn matrix_code(matrix: MatrixCoefficients) -> Option<u16> {
+    match matrix {
+        MatrixCoefficients::Bt709 => Some(1),
+        MatrixCoefficients::Unspecified => Some(2),
+        MatrixCoefficients::Fcc => Some(4),
+        MatrixCoefficients::Smpte170m => Some(6),
+        MatrixCoefficients::YCgCo => Some(8),
+        MatrixCoefficients::Bt2020Ncl => Some(9),
+        _ => None,
+    }
+}
+
+/// `irot` quarter turns anticlockwise and `imir` axis (-1 for none) that
+/// display the coded image the way `orientation` does. HEIF rotates first,
+/// `imir` axis 0 exchanges top and bottom, 1 exchanges left and right.
+#[allow(unreachable_patterns)]
+fn orientation_transforms(orientation: Orientation) -> (u8, i8) {
+    match orientation {
+        Orientation::Normal => (0, -1),
+        Orientation::FlipH => (0, 1),
+        Orientation::Rotate180 => (2, -1),
+        Orientation::FlipV => (0, 0),
+        Orientation::Rotate90 => (3, -1),
+        Orientation::Rotate270 => (1, -1),
+        Orientation::Transpose => (1, 0),
+        Orientation::Transverse => (3, 0),
+        _ => (0, -1),
+    }
+}
+
+fn chroma_format(decoded: &DecodedYuv) -> ChromaFormat {
+    match decoded.chroma {
+        hpvcd::ChromaFormat::Monochrome => ChromaFormat::Monochrome,
+        hpvcd::ChromaFormat::Yuv420 => ChromaFormat::Yuv420,
+        hpvcd::ChromaFormat::Yuv422 => ChromaFormat::Yuv422,
+        hpvcd::ChromaFormat::Yuv444 => ChromaFormat::Yuv444,
+    }
+}
+
+/// Copies the `width` x `height` samples of a strided plane, `narrow` maps
+/// every sample on the way.
+fn tight_plane<T: Copy + Default>(
+    plane: &PlaneBuffer<T>,
+    width: usize,
+    height: usize,
+    narrow: impl Fn(T) -> T,
+) -> Result<Vec<T>, anyhow::Error> {
+    let stride = plane.stride();
+    let data = plane.data();
+    let needed = stride
+        .checked_mul(height - 1)
+        .and_then(|x| x.checked_add(width));
+    if stride < width || needed.is_none_or(|x| data.len() < x) {
+        return Err(anyhow::anyhow!(
+            "HEIC plane of {} samples with stride {stride} can't hold {width}x{height}",
+            data.len()
+        ));
+    }
+    let mut tight = try_vec![T::default(); width * height];
+    for (dst, src) in tight.chunks_exact_mut(width).zip(data.chunks(stride)) {
+        for (dst, &src) in dst.iter_mut().zip(src[..width].iter()) {
+            *dst = narrow(src);
+        }
+    }
+    Ok(tight)
+}
+
+/// Planes in [maroontree::PlanarImage] order: Y, U, V, alpha, or Y, alpha
+/// for monochrome.
+fn coded_planes<T: Copy + Default>(
+    planes: &PlanarImage<T>,
+    alpha: Option<&PlaneBuffer<T>>,
+    chroma: ChromaFormat,
+    narrow: impl Fn(T) -> T + Copy,
+) -> Result<[Vec<T>; 4], anyhow::Error> {
+    let (width, height) = (planes.width(), planes.height());
+    let y = tight_plane(&planes.y, width, height, narrow)?;
+    let a = match alpha {
+        Some(alpha) => tight_plane(alpha, width, height, narrow)?,
+        None => vec![],
+    };
+    let (chroma_width, chroma_height) = match chroma {
+        ChromaFormat::Yuv420 => (width.div_ceil(2), height.div_ceil(2)),
+        ChromaFormat::Yuv422 => (width.div_ceil(2), height),
+        ChromaFormat::Yuv444 => (width, height),
+        ChromaFormat::Monochrome => return Ok([y, a, vec![], vec![]]),
+    };
+    let (Some(cb), Some(cr)) = (planes.cb.as_ref(), planes.cr.as_ref()) else {
+        return Err(anyhow::anyhow!(
+            "HEIC chroma format requires Cb and Cr planes"
+        ));
+    };
+    let u = tight_plane(cb, chroma_width, chroma_height, narrow)?;
+    let v = tight_plane(cr, chroma_width, chroma_height, narrow)?;
+    Ok([y, u, v, a])
+}
+
+/// Hands the decoded planes to AV1 unchanged, 12 bit samples are rounded
+/// to 10 bits since that is as deep as the encoder goes.
+fn prepare_coded_planes(
+    decoded: &DecodedYuv,
+    cicp: maroontree::Cicp,
+    lossless: bool,
+) -> Result<PreparedAv1Image, anyhow::Error> {
+    let chroma = chroma_format(decoded);
+    let (width, height) = (decoded.width(), decoded.height());
+    if width == 0 || height == 0 {
+        return Err(anyhow::anyhow!("HEIC image has no pixels"));
+    }
+    let planes = match (decoded.bit_depth, &decoded.planes) {
+        (BitDepth::Eight, YuvBuffer::U8(planes)) => {
+            let alpha = match decoded.alpha.as_ref() {
+                Some(alpha) => Some(alpha.as_u8().ok_or_else(|| {
+                    anyhow::anyhow!("HEIC alpha doesn't match the bit depth of the image")
+                })?),
+                None => None,
+            };
+            PreparedPlanes::Eight(maroontree::PlanarImage {
+                width,
+                height,
+                planes: coded_planes(planes, alpha, chroma, |x| x)?,
+                bit_depth: maroontree::BitDepth::Eight,
+            })
+        }
+        (BitDepth::Ten | BitDepth::Twelve, YuvBuffer::U16(planes)) => {
+            let alpha = match decoded.alpha.as_ref() {
+                Some(alpha) => Some(alpha.as_u16().ok_or_else(|| {
+                    anyhow::anyhow!("HEIC alpha doesn't match the bit depth of the image")
+                })?),
+                None => None,
+            };
+            let narrowed = if matches!(decoded.bit_depth, BitDepth::Twelve) {
+                coded_planes(planes, alpha, chroma, |x: u16| {
+                    (x.saturating_add(2) >> 2).min(1023)
+                })?
+            } else {
+                coded_planes(planes, alpha, chroma, |x| x)?
+            };
+            PreparedPlanes::Ten(maroontree::PlanarImage {
+                width,
+                height,
+                planes: narrowed,
+                bit_depth: maroontree::BitDepth::Ten,
+            })
+        }
+        _ => {
+            return Err(anyhow::anyhow!(
+                "HEIC planes don't match the bit depth of the image"
+            ));
+        }
+    };
+    Ok(PreparedAv1Image {
+        constant_alpha: planes.opaque_alpha(),
+        planes,
+        cicp,
+        chroma,
+        has_alpha: decoded.alpha.is_some(),
+        lossless,
+    })
+}
+
+/// Converts through RGB for planes AV1 can't carry as they are. Chroma of
+/// the source is kept, crop and orientation end up in the pixels.
+fn prepare_through_rgb(
+    decoded: &DecodedYuv,
+    cicp: maroontree::Cicp,
+    options: &AvifEncodingOptions,
+) -> Result<PreparedAv1Image, anyhow::Error> {
+    let config = AvEncodingConfig {
+        cicp,
+        quality: options.quality.clamp(1, 100) as u32,
+        lossless: options.lossless,
+        exif: None,
+        chroma: chroma_format(decoded),
+        speed: options.speed,
+        screen_content_coding: options.screen_content_coding,
+    };
+    match pack_decoded_heic(decoded).map_err(|x| anyhow::anyhow!(x))? {
+        PackedHeic::Regular(image) => prepare_av1_packed_u8(
+            &image.data,
+            image.width,
+            image.height,
+            &config,
+            image.has_real_alpha,
+        ),
+        PackedHeic::HighBitDepth(image) => prepare_av1_packed_u16(
+            &image.data,
+            image.width,
+            image.height,
+            image.bit_depth.bits() as u32,
+            &config,
+            image.has_real_alpha,
+        ),
+    }
+}
+
+fn transcode_heic(
+    data: &[u8],
+    options: &AvifEncodingOptions,
+    through_rgb: bool,
+) -> Result<WeaveHeicTranscode, anyhow::Error> {
+    let decoded = decode_heic_yuv(data).map_err(|x| anyhow::anyhow!(x))?;
+    let cicp = heic_cicp(&decoded);
+    let primaries = primaries_code(cicp.primaries);
+    let transfer = heif_nclx(data).map_or_else(
+        || transfer_code(cicp.transfer),
+        |nclx| nclx.transfer_characteristics,
+    );
+
+    let mut metadata = WeaveHeicMetadata {
+        icc: std::ptr::null(),
+        icc_length: 0,
+        exif: std::ptr::null(),
+        exif_length: 0,
+        color_primaries: primaries,
+        transfer_characteristics: transfer,
+        matrix_coefficients: 2,
+        rotation: 0,
+        mirror: -1,
+        has_clean_aperture: false,
+        clean_aperture: [0; 8],
+        converted: false,
+    };
+
+    let prepared = match matrix_code(cicp.matrix).filter(|_| !through_rgb) {
+        Some(matrix) => {
+            dbg_log!(
+                debug,
+                "transcode_heic: {}x{} depth={} matrix={:?} kept as YUV",
+                decoded.width(),
+                decoded.height(),
+                decoded.bit_depth.bits(),
+                cicp.matrix
+            );
+            metadata.matrix_coefficients = matrix;
+            (metadata.rotation, metadata.mirror) = orientation_transforms(decoded.orientation);
+            if let Some(clap) = decoded.clean_aperture.as_ref()
+                && let Some((_, _, crop_width, crop_height)) =
+                    clap_rect(decoded.width(), decoded.height(), clap)
+                && (crop_width != decoded.width() || crop_height != decoded.height())
+            {
+                metadata.has_clean_aperture = true;
+                metadata.clean_aperture = [
+                    clap.width_n as u32,
+                    clap.width_d as u32,
+                    clap.height_n as u32,
+                    clap.height_d as u32,
+                    clap.horiz_off_n as u32,
+                    clap.horiz_off_d as u32,
+                    clap.vert_off_n as u32,
+                    clap.vert_off_d as u32,
+                ];
+            }
+            prepare_coded_planes(
+                &decoded,
+                cicp_from_codes(primaries, transfer, matrix, cicp.full_range),
+                options.lossless,
+            )?
+        }
+        None => {
+            dbg_log!(
+                debug,
+                "transcode_heic: converting matrix={:?} through RGB, forced={through_rgb}",
+                cicp.matrix
+            );
+            metadata.converted = true;
+            let prepared = prepare_through_rgb(
+                &decoded,
+                cicp_from_codes(primaries, transfer, 1, cicp.full_range),
+                options,
+            )?;
+            metadata.matrix_coefficients = cicp_codes(&prepared.cicp).2;
+            prepared
+        }
+    };
+
+    Ok(WeaveHeicTranscode {
+        prepared: WeaveAv1Prepared { image: prepared },
+        icc: decoded.color.icc.as_ref().map(|x| x.to_vec()),
+        exif: heif_exif(data),
+        metadata,
+    })
+}
+
+/// Decodes a HEIC file for AVIF without leaving YUV: the HEVC planes, alpha,
+/// ICC and Exif are kept, orientation and clean aperture become AVIF transforms.
+/// Only planes AV1 can't carry as they are go through RGB, `through_rgb` forces
+/// that for callers that can't mux the transforms. Lossless comes from `options`,
+/// its colour space and chroma subsampling are ignored.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_heic_transcode_prepare(
+    data: *const u8,
+    length: usize,
+    options: AvifEncodingOptions,
+    through_rgb: bool,
+) -> WeaveHeicTranscodeResult {
+    init_logging();
+
+    if data.is_null() || length == 0 {
+        return WeaveHeicTranscodeResult::from_error("HEIC transcoding failed: input is empty");
+    }
+    let bytes = unsafe { slice::from_raw_parts(data, length) };
+
+    match std::panic::catch_unwind(|| transcode_heic(bytes, &options, through_rgb)) {
+        Ok(Ok(transcode)) => WeaveHeicTranscodeResult::from_transcode(transcode),
+        Ok(Err(e)) => {
+            dbg_log!(error, "weave_heic_transcode_prepare failed: {e:#}");
+            WeaveHeicTranscodeResult::from_error(format!("HEIC transcoding failed: {e:#}"))
+        }
+        Err(p) => WeaveHeicTranscodeResult::from_error(format!(
+            "panic while transcoding HEIC: {}",
+            panic_payload_to_string(p.as_ref())
+        )),
+    }
+}
+
+#[cfg(test)]
+mod tests {
+    use super::*;
+
+    /// Where pixel `(x, y)` of a `width` x `height` image lands once `irot`
+    /// and then `imir` are applied, as a HEIF reader displays it.
+    fn displayed(
+        (rotation, mirror): (u8, i8),
+        (x, y): (usize, usize),
+        (width, height): (usize, usize),
+    ) -> (usize, usize) {
+        let (mut x, mut y, mut width, mut height) = (x, y, width, height);
+        for _ in 0..rotation {
+            (x, y) = (y, width - 1 - x);
+            (width, height) = (height, width);
+        }
+        match mirror {
+            0 => (x, height - 1 - y),
+            1 => (width - 1 - x, y),
+            _ => (x, y),
+        }
+    }
+
+    const SIZE: (usize, usize) = (4, 3);
+    const CORNERS: [(usize, usize); 3] = [(0, 0), (3, 0), (0, 2)];
+
+    fn assert_displayed(orientation: Orientation, expected: [(usize, usize); 3]) {
+        let transforms = orientation_transforms(orientation);
+        for (corner, expected) in CORNERS.into_iter().zip(expected) {
+            assert_eq!(
+                displayed(transforms, corner, SIZE),
+                expected,
+                "{orientation:?} moved {corner:?}"
+            );
+        }
+    }
+
+    #[test]
+    fn exif_2_mirrors_left_to_right() {
+        assert_displayed(Orientation::FlipH, [(3, 0), (0, 0), (3, 2)]);
+    }
+
+    #[test]
+    fn exif_4_mirrors_top_to_bottom() {
+        assert_displayed(Orientation::FlipV, [(0, 2), (3, 2), (0, 0)]);
+    }
+
+    #[test]
+    fn exif_5_transposes() {
+        assert_displayed(Orientation::Transpose, [(0, 0), (0, 3), (2, 0)]);
+    }
+
+    #[test]
+    fn exif_7_transverses() {
+        assert_displayed(Orientation::Transverse, [(2, 3), (2, 0), (0, 3)]);
+    }
+}
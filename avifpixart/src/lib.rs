@@ -30,10 +30,7 @@
 #![allow(clippy::missing_safety_doc, clippy::map_identity)]
 #![feature(f16)]
 
-#[cfg(all(
-    target_os = "android",
-    any(target_arch = "aarch64", target_arch = "arm")
-))]
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
 mod av1_encode_android;
 #[cfg(all(
     target_os = "android",
@@ -52,30 +49,26 @@ mod av2_decode_android;
 mod av2_encode_android;
 mod box_walker;
 mod cvt;
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
+mod data_space;
 mod encoding_options;
 mod ffi;
-#[cfg(all(
-    target_os = "android",
-    any(target_arch = "aarch64", target_arch = "arm")
-))]
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
 mod heic_decode;
 #[cfg(all(
     target_os = "android",
     any(target_arch = "aarch64", target_arch = "arm")
 ))]
 mod heic_decode_android;
-#[cfg(all(
-    target_os = "android",
-    any(target_arch = "aarch64", target_arch = "arm")
-))]
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
 mod heic_encode_android;
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
+mod heic_transcode_android;
 mod icc;
 mod image_info;
+#[cfg(target_os = "android")]
 mod native_color_space;
-#[cfg(all(
-    target_os = "android",
-    any(target_arch = "aarch64", target_arch = "arm")
-))]
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
 mod orientation;
 mod rgb_to_yuv;
 mod scaling;
@@ -106,6 +99,11 @@ use std::fmt::Debug;
     any(target_arch = "aarch64", target_arch = "arm")
 ))]
 pub use av1_encode_android::encode_avif_av1_file;
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
+pub use av1_encode_android::{
+    encode_avif_av1_buffer, weave_av1_encode_prepared, weave_av1_encode_yuv, weave_av1_prepare,
+    weave_av1_prepared_constant_alpha, weave_av1_prepared_planes,
+};
 #[cfg(all(
     target_os = "android",
     any(target_arch = "aarch64", target_arch = "arm")
@@ -124,7 +122,13 @@ pub use cvt::{
     weave_cvt_rgba8_to_ar30, weave_cvt_rgba8_to_rgba_f16, weave_cvt_rgba16_to_ar30,
     weave_cvt_rgba16_to_rgba_f16, weave_premultiply_rgba_f16,
 };
-pub use encoding_options::{AvEncodingSpeed, AvifEncodingOptions, HevcEncodingOptions};
+pub use encoding_options::{
+    AvEncodingSpeed, AvifEncodingOptions, EncodedImage, HevcEncodingOptions, WeaveAv1PrepareResult,
+    WeaveAv1Prepared, WeaveHeicMetadata, WeaveHeicTranscode, WeaveHeicTranscodeResult,
+    WeaveImageBuffer, WeavePixelFormat, WeaveYuvImage, weave_av1_prepare_error_free,
+    weave_av1_prepared_free, weave_encoded_image_free, weave_heic_transcode_free,
+    weave_heic_transcode_metadata, weave_heic_transcode_prepared,
+};
 #[cfg(all(
     target_os = "android",
     any(target_arch = "aarch64", target_arch = "arm")
@@ -135,11 +139,16 @@ pub use heic_decode_android::{decode_heic_file, read_heic_file_info};
     any(target_arch = "aarch64", target_arch = "arm")
 ))]
 pub use heic_encode_android::encode_heic_file;
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
+pub use heic_encode_android::{encode_heic_buffer, weave_hevc_encode_yuv};
+#[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
+pub use heic_transcode_android::weave_heic_transcode_prepare;
 pub use image_info::HeicInfo;
 pub use rgb_to_yuv::{weave_rgba8_to_y08, weave_rgba8_to_yuv8};
 pub use scaling::{
     ScalingFunction, ScalingResult, ScalingResultU16, WeaveScaleMode, weave_scale_f16,
-    weave_scale_u8, weave_scale_u16, weave_scaling_result_free, weave_scaling_result16_free,
+    weave_scale_u8, weave_scale_u8_into, weave_scale_u16, weave_scale_u16_into, weave_scaled_size,
+    weave_scaling_result_free, weave_scaling_result16_free,
 };
 pub use tonemapper::{FfiTrc, ToneMapping, apply_tone_mapping_rgba8, apply_tone_mapping_rgba16};
 #[cfg(not(all(
@@ -147,6 +156,12 @@ pub use tonemapper::{FfiTrc, ToneMapping, apply_tone_mapping_rgba8, apply_tone_m
     any(target_arch = "aarch64", target_arch = "arm")
 )))]
 pub use unsupported_av2_decode_android::{decode_av2_file, read_av2_file_info};
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+pub use unsupported_encode_android::{
+    encode_avif_av1_buffer, encode_heic_buffer, weave_av1_encode_prepared, weave_av1_encode_yuv,
+    weave_av1_prepare, weave_av1_prepared_constant_alpha, weave_av1_prepared_planes,
+    weave_heic_transcode_prepare, weave_hevc_encode_yuv,
+};
 #[cfg(not(all(
     target_os = "android",
     any(target_arch = "aarch64", target_arch = "arm")
@@ -376,101 +376,202 @@ impl From<u32> for ScalingFunction {
     }
 }
 
-#[allow(clippy::too_many_arguments)]
-pub(crate) fn internal_scale_u8(
-    src: std::borrow::Cow<[u8]>,
-    src_stride: u32,
+/// Part of the source that is scaled and the size it is scaled to.
+struct ScaleSource<'a, T: Clone> {
+    data: std::borrow::Cow<'a, [T]>,
+    stride: usize,
+    width: usize,
+    height: usize,
+    scaled_width: usize,
+    scaled_height: usize,
+}
+
+/// Size a `width` x `height` image ends up with for `new_width` x `new_height`.
+fn scaled_dimensions(
     width: u32,
     height: u32,
     new_width: i32,
     new_height: i32,
-    premultiply_alpha: bool,
     scale_mode: WeaveScaleMode,
-) -> Result<ImageStoreMut<'static, u8, 4>, PicScaleError> {
+) -> (usize, usize) {
+    let (target_width, target_height) = resolve_dimensions(width, height, new_width, new_height);
+    match scale_mode {
+        WeaveScaleMode::ScaleToFit => {
+            scale_to_fit_dimensions(width as usize, height as usize, target_width, target_height)
+        }
+        WeaveScaleMode::ScaleToFill | WeaveScaleMode::JustResize => (target_width, target_height),
+    }
+}
+
+fn scale_source<'a, T: Copy>(
+    src: std::borrow::Cow<'a, [T]>,
+    src_stride: usize,
+    width: u32,
+    height: u32,
+    new_width: i32,
+    new_height: i32,
+    scale_mode: WeaveScaleMode,
+) -> Result<ScaleSource<'a, T>, PicScaleError> {
     if width == 0 || height == 0 {
         return Err(PicScaleError::Generic(format!(
             "RGBA source dimensions must be non-zero, got {width}x{height}"
         )));
     }
 
-    let scaler = Scaler::new(ResamplingFunction::MitchellNetravalli)
-        .set_threading_policy(ThreadingPolicy::Single);
-
-    let (target_width, target_height) = resolve_dimensions(width, height, new_width, new_height);
-    let (src, src_stride, source_width, source_height, scale_width, scale_height) = match scale_mode
-    {
-        WeaveScaleMode::ScaleToFill => {
-            let view = crop_rgba_for_scale_to_fill(
-                src,
-                src_stride as usize,
-                width as usize,
-                height as usize,
-                target_width,
-                target_height,
-            )?;
-            (
-                view.data,
-                view.stride,
-                view.width,
-                view.height,
-                target_width,
-                target_height,
-            )
-        }
-        WeaveScaleMode::ScaleToFit => {
-            let (scale_width, scale_height) = scale_to_fit_dimensions(
-                width as usize,
-                height as usize,
-                target_width,
-                target_height,
-            );
-            (
-                src,
-                src_stride as usize,
-                width as usize,
-                height as usize,
-                scale_width,
-                scale_height,
-            )
-        }
-        WeaveScaleMode::JustResize => (
+    let (scaled_width, scaled_height) =
+        scaled_dimensions(width, height, new_width, new_height, scale_mode);
+    if scale_mode == WeaveScaleMode::ScaleToFill {
+        let view = crop_rgba_for_scale_to_fill(
             src,
-            src_stride as usize,
+            src_stride,
             width as usize,
             height as usize,
-            target_width,
-            target_height,
-        ),
-    };
+            scaled_width,
+            scaled_height,
+        )?;
+        return Ok(ScaleSource {
+            data: view.data,
+            stride: view.stride,
+            width: view.width,
+            height: view.height,
+            scaled_width,
+            scaled_height,
+        });
+    }
+    Ok(ScaleSource {
+        data: src,
+        stride: src_stride,
+        width: width as usize,
+        height: height as usize,
+        scaled_width,
+        scaled_height,
+    })
+}
+
+fn resample_u8(
+    source: ScaleSource<u8>,
+    premultiply_alpha: bool,
+    dst: &mut ImageStoreMut<u8, 4>,
+) -> Result<(), PicScaleError> {
+    let scaler = Scaler::new(ResamplingFunction::MitchellNetravalli)
+        .set_threading_policy(ThreadingPolicy::Single);
 
     let source_store = ImageStore::<u8, 4> {
-        buffer: src,
+        buffer: source.data,
         channels: 4,
-        width: source_width,
-        height: source_height,
-        stride: src_stride,
+        width: source.width,
+        height: source.height,
+        stride: source.stride,
         bit_depth: 8,
     };
-    let mut scaled_store = ImageStoreMut::try_alloc(scale_width, scale_height)?;
 
-    let plan =
-        scaler.plan_rgba_resampling(source_store.size(), scaled_store.size(), premultiply_alpha)?;
-    plan.resample(&source_store, &mut scaled_store)?;
+    let plan = scaler.plan_rgba_resampling(source_store.size(), dst.size(), premultiply_alpha)?;
+    plan.resample(&source_store, dst)?;
+    Ok(())
+}
+
+#[allow(clippy::too_many_arguments)]
+pub(crate) fn internal_scale_u8(
+    src: std::borrow::Cow<[u8]>,
+    src_stride: u32,
+    width: u32,
+    height: u32,
+    new_width: i32,
+    new_height: i32,
+    premultiply_alpha: bool,
+    scale_mode: WeaveScaleMode,
+) -> Result<ImageStoreMut<'static, u8, 4>, PicScaleError> {
+    let source = scale_source(
+        src,
+        src_stride as usize,
+        width,
+        height,
+        new_width,
+        new_height,
+        scale_mode,
+    )?;
+    let mut scaled_store = ImageStoreMut::try_alloc(source.scaled_width, source.scaled_height)?;
+    resample_u8(source, premultiply_alpha, &mut scaled_store)?;
     Ok(scaled_store)
 }
 
+/// Size [weave_scale_u8_into] and [weave_scale_u16_into] produce for these
+/// arguments, so callers can size the destination first. False for an empty source.
 #[unsafe(no_mangle)]
-pub unsafe extern "C" fn weave_scale_u16(
-    src: *const u16,
-    src_stride: usize,
+pub unsafe extern "C" fn weave_scaled_size(
+    width: u32,
+    height: u32,
+    new_width: i32,
+    new_height: i32,
+    scale_mode: WeaveScaleMode,
+    scaled_width: *mut u32,
+    scaled_height: *mut u32,
+) -> bool {
+    if width == 0 || height == 0 || scaled_width.is_null() || scaled_height.is_null() {
+        return false;
+    }
+    let (w, h) = scaled_dimensions(width, height, new_width, new_height, scale_mode);
+    unsafe {
+        *scaled_width = w as u32;
+        *scaled_height = h as u32;
+    }
+    true
+}
+
+/// Same as [weave_scale_u8] but writes into caller owned `dst` of `dst_stride`
+/// bytes per row, sized by [weave_scaled_size]. Returns false when scaling fails.
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_scale_u8_into(
+    src: *const u8,
+    src_stride: u32,
     width: u32,
     height: u32,
     new_width: i32,
     new_height: i32,
-    bit_depth: usize,
     premultiply_alpha: bool,
     scale_mode: WeaveScaleMode,
-) -> ScalingResultU16 {
+    dst: *mut u8,
+    dst_stride: u32,
+) -> bool {
+    if src.is_null() || dst.is_null() {
+        return false;
+    }
+    let origin_slice = unsafe { slice::from_raw_parts(src, src_stride as usize * height as usize) };
+    let Ok(source) = scale_source(
+        std::borrow::Cow::Borrowed(origin_slice),
+        src_stride as usize,
+        width,
+        height,
+        new_width,
+        new_height,
+        scale_mode,
+    ) else {
+        return false;
+    };
+    let dst_stride = dst_stride as usize;
+    if dst_stride < source.scaled_width * 4 {
+        return false;
+    }
+    let dst_slice = unsafe { slice::from_raw_parts_mut(dst, dst_stride * source.scaled_height) };
+    let mut dst_store = ImageStoreMut::<u8, 4> {
+        buffer: BufferStore::Borrowed(dst_slice),
+        channels: 4,
+        width: source.scaled_width,
+        height: source.scaled_height,
+        stride: dst_stride,
+        bit_depth: 8,
+    };
+    resample_u8(source, premultiply_alpha, &mut dst_store).is_ok()
+}
+
+/// u16 samples of `src` with their row stride in samples, rows of a source
+/// that isn't aligned to u16 are copied out first.
+unsafe fn u16_source<'a>(
+    src: *const u16,
+    src_stride: usize,
+    width: u32,
+    height: u32,
+) -> (std::borrow::Cow<'a, [u16]>, usize) {
     let source_image: std::borrow::Cow<[u16]>;
     let mut j_src_stride = src_stride / 2;
 
@@ -497,6 +598,22 @@ pub unsafe extern "C" fn weave_scale_u16(
             ));
         }
     }
+    (source_image, j_src_stride)
+}
+
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_scale_u16(
+    src: *const u16,
+    src_stride: usize,
+    width: u32,
+    height: u32,
+    new_width: i32,
+    new_height: i32,
+    bit_depth: usize,
+    premultiply_alpha: bool,
+    scale_mode: WeaveScaleMode,
+) -> ScalingResultU16 {
+    let (source_image, j_src_stride) = unsafe { u16_source(src, src_stride, width, height) };
 
     let final_store = match internal_scale_u16(
         source_image,
@@ -547,6 +664,35 @@ pub unsafe extern "C" fn weave_scale_u16(
     }
 }
 
+fn resample_u16(
+    source: ScaleSource<u16>,
+    bit_depth: usize,
+    premultiply_alpha: bool,
+    dst: &mut ImageStoreMut<u16, 4>,
+) -> Result<(), PicScaleError> {
+    let scaler = Scaler::new(ResamplingFunction::MitchellNetravalli)
+        .set_threading_policy(ThreadingPolicy::Single)
+        .set_workload_strategy(WorkloadStrategy::PreferQuality);
+
+    let source_store = ImageStore::<u16, 4> {
+        buffer: source.data,
+        channels: 4,
+        width: source.width,
+        height: source.height,
+        stride: source.stride,
+        bit_depth,
+    };
+
+    let plan = scaler.plan_rgba_resampling16(
+        source_store.size(),
+        dst.size(),
+        premultiply_alpha,
+        bit_depth,
+    )?;
+    plan.resample(&source_store, dst)?;
+    Ok(())
+}
+
 #[allow(clippy::too_many_arguments)]
 pub(crate) fn internal_scale_u16(
     src: std::borrow::Cow<'_, [u16]>,
@@ -559,88 +705,72 @@ pub(crate) fn internal_scale_u16(
     premultiply_alpha: bool,
     scale_mode: WeaveScaleMode,
 ) -> Result<ImageStoreMut<'static, u16, 4>, PicScaleError> {
-    if width == 0 || height == 0 {
-        return Err(PicScaleError::Generic(format!(
-            "RGBA source dimensions must be non-zero, got {width}x{height}"
-        )));
-    }
-
-    let scaler = Scaler::new(ResamplingFunction::MitchellNetravalli)
-        .set_threading_policy(ThreadingPolicy::Single)
-        .set_workload_strategy(WorkloadStrategy::PreferQuality);
-
-    let (target_width, target_height) = resolve_dimensions(width, height, new_width, new_height);
-    let (src, src_stride, source_width, source_height, scale_width, scale_height) = match scale_mode
-    {
-        WeaveScaleMode::ScaleToFill => {
-            let view = crop_rgba_for_scale_to_fill(
-                src,
-                src_stride,
-                width as usize,
-                height as usize,
-                target_width,
-                target_height,
-            )?;
-            (
-                view.data,
-                view.stride,
-                view.width,
-                view.height,
-                target_width,
-                target_height,
-            )
-        }
-        WeaveScaleMode::ScaleToFit => {
-            let (scale_width, scale_height) = scale_to_fit_dimensions(
-                width as usize,
-                height as usize,
-                target_width,
-                target_height,
-            );
-            (
-                src,
-                src_stride,
-                width as usize,
-                height as usize,
-                scale_width,
-                scale_height,
-            )
-        }
-        WeaveScaleMode::JustResize => (
-            src,
-            src_stride,
-            width as usize,
-            height as usize,
-            target_width,
-            target_height,
-        ),
-    };
-
-    let source_store = ImageStore::<u16, 4> {
-        buffer: src,
-        channels: 4,
-        width: source_width,
-        height: source_height,
-        stride: src_stride,
-        bit_depth,
-    };
+    let source = scale_source(
+        src, src_stride, width, height, new_width, new_height, scale_mode,
+    )?;
 
     let Ok(mut scaled_store) =
-        ImageStoreMut::try_alloc_with_depth(scale_width, scale_height, bit_depth)
+        ImageStoreMut::try_alloc_with_depth(source.scaled_width, source.scaled_height, bit_depth)
     else {
         return Err(PicScaleError::Generic(
             "Can't allocate required buffer".to_string(),
         ));
     };
+    resample_u16(source, bit_depth, premultiply_alpha, &mut scaled_store)?;
+    Ok(scaled_store)
+}
 
-    let plan = scaler.plan_rgba_resampling16(
-        source_store.size(),
-        scaled_store.size(),
-        premultiply_alpha,
+/// Same as [weave_scale_u16] but writes into caller owned `dst` of `dst_stride`
+/// bytes per row, sized by [weave_scaled_size]. `dst` has to be aligned to u16.
+/// Returns false when scaling fails.
+#[allow(clippy::too_many_arguments)]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_scale_u16_into(
+    src: *const u16,
+    src_stride: usize,
+    width: u32,
+    height: u32,
+    new_width: i32,
+    new_height: i32,
+    bit_depth: usize,
+    premultiply_alpha: bool,
+    scale_mode: WeaveScaleMode,
+    dst: *mut u16,
+    dst_stride: usize,
+) -> bool {
+    if src.is_null()
+        || dst.is_null()
+        || !(dst as usize).is_multiple_of(2)
+        || !dst_stride.is_multiple_of(2)
+    {
+        return false;
+    }
+    let (source_image, j_src_stride) = unsafe { u16_source(src, src_stride, width, height) };
+    let Ok(source) = scale_source(
+        source_image,
+        j_src_stride,
+        width,
+        height,
+        new_width,
+        new_height,
+        scale_mode,
+    ) else {
+        return false;
+    };
+    let dst_stride = dst_stride / 2;
+    if dst_stride < source.scaled_width * 4 {
+        return false;
+    }
+    let dst_slice = unsafe { slice::from_raw_parts_mut(dst, dst_stride * source.scaled_height) };
+    let mut dst_store = ImageStoreMut::<u16, 4> {
+        buffer: BufferStore::Borrowed(dst_slice),
+        channels: 4,
+        width: source.scaled_width,
+        height: source.scaled_height,
+        stride: dst_stride,
         bit_depth,
-    )?;
-    plan.resample(&source_store, &mut scaled_store)?;
-    Ok(scaled_store)
+    };
+    resample_u16(source, bit_depth, premultiply_alpha, &mut dst_store).is_ok()
 }
 
 #[unsafe(no_mangle)]
@@ -34,6 +34,7 @@ use num_traits::AsPrimitive;
 use std::fmt::Debug;
 use std::ops::{AddAssign, BitXor};
 use std::slice;
+#[cfg(any(target_os = "android", feature = "logging"))]
 use std::sync::OnceLock;
 
 #[inline]
@@ -102,12 +103,16 @@ macro_rules! try_vec {
     }};
 }
 
+#[cfg(target_os = "android")]
 use crate::WeaverPreferredColorConfig;
 pub(crate) use try_vec;
 
+#[cfg(target_os = "android")]
 pub(crate) const MIN_OS_F16: i32 = 26;
+#[cfg(target_os = "android")]
 pub(crate) const MIN_OS_AR30: i32 = 33;
 
+#[cfg(target_os = "android")]
 pub(crate) struct PackedImageBuffer {
     pub(crate) data: Vec<u8>,
     pub(crate) width: usize,
@@ -115,13 +120,16 @@ pub(crate) struct PackedImageBuffer {
     pub(crate) format: WeaverPreferredColorConfig,
 }
 
+#[cfg(target_os = "android")]
 pub(crate) enum PackedImageTransfer {
     Image(PackedImageBuffer),
     HardwareBuffer(jobject),
 }
 
+#[cfg(target_os = "android")]
 static SDK_VERSION: OnceLock<i32> = OnceLock::new();
 
+#[cfg(target_os = "android")]
 pub(crate) fn android_os_version() -> i32 {
     *SDK_VERSION.get_or_init(|| {
         let key = b"ro.build.version.sdk\0";
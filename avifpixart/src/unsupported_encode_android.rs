@@ -28,18 +28,26 @@
  */
 
 use crate::encoding_options::{AvifEncodingOptions, HevcEncodingOptions};
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+use crate::encoding_options::{
+    EncodedImage, WeaveAv1PrepareResult, WeaveAv1Prepared, WeaveHeicTranscodeResult,
+    WeaveImageBuffer, WeaveYuvImage,
+};
 use crate::support::{init_logging, throw_runtime_exception_raw};
 use jni::sys::{jbyteArray, jobject};
 use std::ptr::null_mut;
 
 const SUPPORTED_ENCODING_TARGETS: &str = "aarch64-linux-android and armv7-linux-androideabi";
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+const SUPPORTED_BUFFER_ENCODING_ARCHS: &str = "aarch64 and arm";
 
 #[inline]
 unsafe fn unsupported_encoding(env: *mut jni::sys::JNIEnv, codec: &str) -> jbyteArray {
     init_logging();
     let message = format!(
-        "{codec} encoding is not supported on target architecture '{}'. Supported targets: {SUPPORTED_ENCODING_TARGETS}",
+        "{codec} encoding is not supported on target '{}-{}'. Supported targets: {SUPPORTED_ENCODING_TARGETS}",
         std::env::consts::ARCH,
+        std::env::consts::OS,
     );
     unsafe { throw_runtime_exception_raw(env, message) };
     null_mut()
@@ -55,6 +63,116 @@ pub unsafe extern "C" fn encode_avif_av1_file(
     unsafe { unsupported_encoding(env, "AV1/AVIF") }
 }
 
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn encode_avif_av1_buffer(
+    _image: WeaveImageBuffer,
+    _exif: *const u8,
+    _exif_length: usize,
+    _options: AvifEncodingOptions,
+) -> EncodedImage {
+    init_logging();
+    EncodedImage::from_error(format!(
+        "AV1/AVIF encoding is not supported on target architecture '{}'. Supported architectures: {SUPPORTED_BUFFER_ENCODING_ARCHS}",
+        std::env::consts::ARCH,
+    ))
+}
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_prepare(
+    _image: WeaveImageBuffer,
+    _options: AvifEncodingOptions,
+) -> WeaveAv1PrepareResult {
+    init_logging();
+    WeaveAv1PrepareResult::from_error(format!(
+        "AV1/AVIF encoding is not supported on target architecture '{}'. Supported architectures: {SUPPORTED_BUFFER_ENCODING_ARCHS}",
+        std::env::consts::ARCH,
+    ))
+}
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_encode_prepared(
+    _prepared: *const WeaveAv1Prepared,
+    _exif: *const u8,
+    _exif_length: usize,
+    _options: AvifEncodingOptions,
+    _threads: u32,
+) -> EncodedImage {
+    init_logging();
+    EncodedImage::from_error(format!(
+        "AV1/AVIF encoding is not supported on target architecture '{}'. Supported architectures: {SUPPORTED_BUFFER_ENCODING_ARCHS}",
+        std::env::consts::ARCH,
+    ))
+}
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_prepared_planes(
+    _prepared: *const WeaveAv1Prepared,
+) -> WeaveYuvImage {
+    WeaveYuvImage {
+        y: std::ptr::null(),
+        y_stride: 0,
+        u: std::ptr::null(),
+        u_stride: 0,
+        v: std::ptr::null(),
+        v_stride: 0,
+        a: std::ptr::null(),
+        a_stride: 0,
+        width: 0,
+        height: 0,
+        bit_depth: 0,
+        chroma_subsampling_code: 0,
+        color_primaries: 2,
+        transfer_characteristics: 2,
+        matrix_coefficients: 2,
+        full_range: false,
+        chroma_pixel_stride: 1,
+        msb_aligned: false,
+    }
+}
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_prepared_constant_alpha(
+    _prepared: *const WeaveAv1Prepared,
+) -> u16 {
+    255
+}
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_av1_encode_yuv(
+    _image: WeaveYuvImage,
+    _exif: *const u8,
+    _exif_length: usize,
+    _options: AvifEncodingOptions,
+    _threads: u32,
+) -> EncodedImage {
+    init_logging();
+    EncodedImage::from_error(format!(
+        "AV1/AVIF encoding is not supported on target architecture '{}'. Supported architectures: {SUPPORTED_BUFFER_ENCODING_ARCHS}",
+        std::env::consts::ARCH,
+    ))
+}
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_heic_transcode_prepare(
+    _data: *const u8,
+    _length: usize,
+    _options: AvifEncodingOptions,
+    _through_rgb: bool,
+) -> WeaveHeicTranscodeResult {
+    init_logging();
+    WeaveHeicTranscodeResult::from_error(format!(
+        "AV1/AVIF encoding is not supported on target architecture '{}'. Supported architectures: {SUPPORTED_BUFFER_ENCODING_ARCHS}",
+        std::env::consts::ARCH,
+    ))
+}
+
 #[unsafe(no_mangle)]
 pub unsafe extern "C" fn encode_avif_av2_file(
     env: *mut jni::sys::JNIEnv,
@@ -74,3 +192,34 @@ pub unsafe extern "C" fn encode_heic_file(
 ) -> jbyteArray {
     unsafe { unsupported_encoding(env, "HEIC") }
 }
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn encode_heic_buffer(
+    _image: WeaveImageBuffer,
+    _exif: *const u8,
+    _exif_length: usize,
+    _options: HevcEncodingOptions,
+) -> EncodedImage {
+    init_logging();
+    EncodedImage::from_error(format!(
+        "HEIC encoding is not supported on target architecture '{}'. Supported architectures: {SUPPORTED_BUFFER_ENCODING_ARCHS}",
+        std::env::consts::ARCH,
+    ))
+}
+
+#[cfg(not(any(target_arch = "aarch64", target_arch = "arm")))]
+#[unsafe(no_mangle)]
+pub unsafe extern "C" fn weave_hevc_encode_yuv(
+    _image: WeaveYuvImage,
+    _exif: *const u8,
+    _exif_length: usize,
+    _options: HevcEncodingOptions,
+    _threads: u32,
+) -> EncodedImage {
+    init_logging();
+    EncodedImage::from_error(format!(
+        "HEIC encoding is not supported on target architecture '{}'. Supported architectures: {SUPPORTED_BUFFER_ENCODING_ARCHS}",
+        std::env::consts::ARCH,
+    ))
+}
@@ -37,10 +37,7 @@ pub enum WeaverError {
     FailedToDecodeHeic(String),
     #[error("AVIF AV2 decoder failed with an errror {0}")]
     FailedToDecodeAv2(String),
-    #[cfg(all(
-        target_os = "android",
-        any(target_arch = "aarch64", target_arch = "arm")
-    ))]
+    #[cfg(any(target_arch = "aarch64", target_arch = "arm"))]
     #[error("Unsupported matrix coefficients {0:?}")]
     UnsupportedMatrix(hpvcd::MatrixCoefficients),
     #[cfg(all(